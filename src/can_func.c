@@ -138,6 +138,13 @@
 	*
 	*	03/23/2016		I have been making updates to TC/TM transactions and lately I have needed to update alert_can_data
 	*					to accommodate the new tasks that are running.
+	*
+	*	10/16/2026		Added the windowed TM transfer: send_tm_frame() sends 7B of a TM packet per frame,
+	*					and the handshake with the COMS SSM (OK_START_TM_PACKET, TM_TRANSACTION_RESP) gives a
+	*					semaphore which the packet router blocks on (tm_wait_start(), tm_wait_response())
+	*					instead of polling start_tm_transferf and tm_transfer_completef.
+	*
+	*					A TC chunk (SEND_TC) gives opr_wake_sem so that the packet router wakes up for it.
 	*					
 	*
 	*	DESCRIPTION:	
@@ -150,6 +157,11 @@
 volatile uint32_t g_ul_recv_status = 0;
 static void start_tc_packet(void);
 
+/* Windowed TM transfer, see can_func.h */
+static SemaphoreHandle_t tm_start_sem;				// Given by CAN1_Handler on OK_START_TM_PACKET.
+static SemaphoreHandle_t tm_resp_sem;				// Given by CAN1_Handler on TM_TRANSACTION_RESP.
+static volatile uint32_t tm_resp;					// Low word of the latest TM_TRANSACTION_RESP.
+
 /************************************************************************/
 /* Interrupt Handler for CAN1								    		*/
 /************************************************************************/
@@ -259,6 +271,7 @@ void decode_can_command(can_mb_conf_t *p_mailbox, Can* controller)
 	uint32_t uh_data_incom = p_mailbox->ul_datah;
 	uint8_t sender, destination, big_type, small_type, received_minute, minute_diff = 2;
 	BaseType_t wake_task;	// Not needed here.
+	BaseType_t woken = pdFALSE;
 	uint8_t dumbuf[152];
 	uint8_t i;
 	for(i = 0; i < 152; i ++)
@@ -316,15 +329,27 @@ void decode_can_command(can_mb_conf_t *p_mailbox, Can* controller)
 		case SEND_TC:
 			xQueueSendToBackFromISR(tc_msg_fifo, &ul_data_incom, &wake_task);		// Telecommand reception FIFO.
 			xQueueSendToBackFromISR(tc_msg_fifo, &uh_data_incom, &wake_task);
+			if(opr_wake_sem)
+				xSemaphoreGiveFromISR(opr_wake_sem, &woken);
+			portEND_SWITCHING_ISR(woken);		// The packet router answers every chunk.
 			break;
 		case TC_PACKET_READY:
 			start_tc_packet();
 			break;
 		case TM_TRANSACTION_RESP:
+#if (TM_TRANSFER_PROTOCOL == TM_TRANSFER_LEGACY)
 			tm_transfer_completef = (uint8_t)(ul_data_incom & 0x000000FF);
+#endif
+			tm_resp = ul_data_incom;
+			if(tm_resp_sem)
+				xSemaphoreGiveFromISR(tm_resp_sem, &woken);
+			portEND_SWITCHING_ISR(woken);		// The packet router is waiting for this.
 			break;
 		case OK_START_TM_PACKET:
 			start_tm_transferf = 1;
+			if(tm_start_sem)
+				xSemaphoreGiveFromISR(tm_start_sem, &woken);
+			portEND_SWITCHING_ISR(woken);
 			break;
 		case SEND_EVENT:
 			xQueueSendToBackFromISR(event_msg_fifo, &ul_data_incom, &wake_task);
@@ -692,6 +717,74 @@ int send_tc_can_command(uint32_t low, uint8_t byte_four, uint8_t sender_id, uint
 		return -1;												// CAN0 is currently busy, or something has gone wrong.
 }
 
+/************************************************************************/
+/* SEND_TM_FRAME 		                                                */
+/* @param: low: Packet bytes 7i .. 7i + 3.								*/
+/* @param: high: Sequence header << 24 | packet bytes 7i + 4 .. 7i + 6.	*/
+/* @Purpose: Sends one frame of a windowed TM transfer to TM_FRAME_ID	*/
+/* of the COMS SSM. Instead of a fixed delay after the frame, the next	*/
+/* call waits for mailbox 7 to finish sending this one.					*/
+/* @return: 0 == sent, -1 == CAN0 is busy.								*/
+/************************************************************************/
+int send_tm_frame(uint32_t low, uint32_t high)
+{
+	uint32_t timeout = TM_FRAME_TX_WAIT;
+
+	if (xSemaphoreTake(Can0_Mutex, (TickType_t) 1) == pdTRUE)		// Attempt to acquire CAN0 Mutex, block for 1 tick.
+	{
+		while(!(can_mailbox_get_status(CAN0, 7) & CAN_MSR_MRDY) && timeout--)
+			delay_us(10);
+		send_can_command_h(low, high, TM_FRAME_ID, COMMAND_PRIO);
+		xSemaphoreGive(Can0_Mutex);
+		return 0;
+	}
+
+	else
+		return -1;												// CAN0 is currently busy, or something has gone wrong.
+}
+
+/************************************************************************/
+/* TM_TRANSFER_RESET 	                                                */
+/* @Purpose: Discards a start or response from the COMS SSM which was	*/
+/* meant for an earlier transfer. Call before sending TM_PACKET_READY.	*/
+/************************************************************************/
+void tm_transfer_reset(void)
+{
+	if(!tm_start_sem || !tm_resp_sem)
+		return;
+	xSemaphoreTake(tm_start_sem, (TickType_t)0);
+	xSemaphoreTake(tm_resp_sem, (TickType_t)0);
+	return;
+}
+
+/************************************************************************/
+/* TM_WAIT_START 		                                                */
+/* @param: ticks: How long to wait.										*/
+/* @Purpose: Blocks until the COMS SSM sends OK_START_TM_PACKET.		*/
+/* @return: 1 == the SSM is ready, 0 == timed out.						*/
+/************************************************************************/
+int tm_wait_start(TickType_t ticks)
+{
+	if(!tm_start_sem)
+		return 0;
+	return (xSemaphoreTake(tm_start_sem, ticks) == pdTRUE);
+}
+
+/************************************************************************/
+/* TM_WAIT_RESPONSE 	                                                */
+/* @param: *resp: Set to the low word of the TM_TRANSACTION_RESP.		*/
+/* @param: ticks: How long to wait.										*/
+/* @Purpose: Blocks until the COMS SSM answers a window of TM frames.	*/
+/* @return: 1 == *resp was set, 0 == timed out.							*/
+/************************************************************************/
+int tm_wait_response(uint32_t* resp, TickType_t ticks)
+{
+	if(!tm_resp_sem || (xSemaphoreTake(tm_resp_sem, ticks) != pdTRUE))
+		return 0;
+	*resp = tm_resp;
+	return 1;
+}
+
 /************************************************************************/
 /* SEND_CAN_COMMAND_FROM_INT                                            */
 /* @NOTE: To be used only from the CAN1 interrupt handler.				*/
@@ -1011,6 +1104,11 @@ void can_initialize(void)
 		can_disable_interrupt(CAN0, CAN_DISABLE_ALL_INTERRUPT_MASK);
 		can_disable_interrupt(CAN1, CAN_DISABLE_ALL_INTERRUPT_MASK);
 
+		if(!tm_start_sem)
+			tm_start_sem = xSemaphoreCreateBinary();
+		if(!tm_resp_sem)
+			tm_resp_sem = xSemaphoreCreateBinary();
+
 		NVIC_EnableIRQ(CAN1_IRQn);
 		
 		can_reset_all_mailbox(CAN0);
@@ -47,6 +47,19 @@
 	*
 	*	07/07/2015		I changed 'decode_can_msg' to 'debug_can_msg' and added the function 'stora_can_msg'
 	*
+	*	10/16/2026		Added the SPI memory page cache variables (SPIMEM_CACHE_HITS, _MISSES, SPIMEM_FLASH_SAVED).
+	*
+	*					Added the memory wash variables (SPIMEM_WASH_RATE, SPIMEM_UPSETS_1/2/3).
+	*
+	*					Added the windowed TM transfer (TM_TRANSFER_PROTOCOL, TM_FRAME_*, TM_RESP_*) and the
+	*					prototypes for send_tm_frame(), tm_transfer_reset(), tm_wait_start() and tm_wait_response().
+	*					It is off by default (TM_TRANSFER_LEGACY) until the COMS SSM firmware supports it.
+	*
+	*					Added the TM queue variables (TM_VERIFY_DEPTH ... TM_SCIENCE_DROPS), three per TM class.
+	*
+	*					Added TM_STORED_DEPTH, _AGE, _DROPS for the queue of packets read back from the TM
+	*					store, and the number of packets in the TM and TC stores (TM_STORE_COUNT, TC_STORE_COUNT).
+	*
 */
 #ifndef CAN_FUNCH
 #define CAN_FUNCH
@@ -395,10 +408,65 @@ SemaphoreHandle_t	Can0_Mutex;
 #define EPS_HEAT_INTV			0xE6
 #define EPS_TRGT_TMP			0xE5
 #define EPS_TEMP_INTV			0xE4
+#define SPIMEM_CACHE_HITS		0xE3
+#define SPIMEM_CACHE_MISSES		0xE2
+#define SPIMEM_FLASH_SAVED		0xE1
+#define SPIMEM_WASH_RATE		0xE0
+#define SPIMEM_UPSETS_1			0xDF
+#define SPIMEM_UPSETS_2			0xDE
+#define SPIMEM_UPSETS_3			0xDD
+#define TM_VERIFY_DEPTH			0xDC
+#define TM_VERIFY_AGE			0xDB
+#define TM_VERIFY_DROPS			0xDA
+#define TM_EVENT_DEPTH			0xD9
+#define TM_EVENT_AGE			0xD8
+#define TM_EVENT_DROPS			0xD7
+#define TM_HK_DEPTH				0xD6
+#define TM_HK_AGE				0xD5
+#define TM_HK_DROPS				0xD4
+#define TM_DUMP_DEPTH			0xD3
+#define TM_DUMP_AGE				0xD2
+#define TM_DUMP_DROPS			0xD1
+#define TM_SCIENCE_DEPTH		0xD0
+#define TM_SCIENCE_AGE			0xCF
+#define TM_SCIENCE_DROPS		0xCE
+#define TM_STORED_DEPTH			0xCD
+#define TM_STORED_AGE			0xCC
+#define TM_STORED_DROPS			0xCB
+#define TM_STORE_COUNT			0xCA
+#define TC_STORE_COUNT			0xC9
 
 /* CAN frame max data length */
 #define MAX_CAN_FRAME_DATA_LEN      8
 
+/* TM packet transfer to the COMS SSM (send_pus_packet_tm())	*/
+/* The COMS SSM firmware which is flying only speaks the legacy protocol, build with	*/
+/* -DTM_TRANSFER_PROTOCOL=1 (TM_TRANSFER_WINDOWED) once it has been updated as well.	*/
+#define TM_TRANSFER_LEGACY		0			// 4B per frame behind a command header, 25 ms apart, one response per packet.
+#define TM_TRANSFER_WINDOWED	1			// 7B per frame, one response per window of frames.
+#ifndef TM_TRANSFER_PROTOCOL
+#define TM_TRANSFER_PROTOCOL	TM_TRANSFER_LEGACY		// Must match the COMS SSM firmware.
+#endif
+
+/* Windowed transfer frames go to TM_FRAME_ID, which the COMS SSM only uses for them, so they carry
+ * no command header. Byte 7 of a frame is the sequence header, bytes 0..6 are packet data:
+ * low = packet[7i .. 7i + 3], high bits 0..23 = packet[7i + 4 .. 7i + 6] (LSB first).
+ * The last frame of a window sets TM_FRAME_ACKREQ and the SSM answers with TM_TRANSACTION_RESP:
+ * low bits 0..21 = frames of the packet received so far (bit i = frame i), bits 24..31 = tag,
+ * or TM_RESP_ABORT if the SSM has given up on the packet. The leading ones acknowledge frames
+ * cumulatively, a zero below the last frame sent is a selective NAK. */
+#define TM_FRAME_ID				SUB0_ID4
+#define TM_FRAME_DATA			7
+#define TM_FRAMES				((PACKET_LENGTH + TM_FRAME_DATA - 1) / TM_FRAME_DATA)	// 22 frames per packet.
+#define TM_WINDOW				8			// Frames sent before waiting for a response.
+#define TM_FRAME_ACKREQ			0x80		// Sequence header: bit 7 = respond, bits 5..6 = tag, bits 0..4 = frame.
+#define TM_FRAME_TAG_SHIFT		5
+#define TM_FRAME_TAG_MASK		0x03		// Changes with every packet so that stale responses are ignored.
+#define TM_FRAME_INDEX_MASK		0x1F
+#define TM_RESP_BITMAP			0x003FFFFF
+#define TM_RESP_ABORT			0xFF
+#define TM_FRAME_TX_WAIT		200			// x 10 us, for mailbox 7 to finish with the previous frame.
+
 /* CAN0 Transfer mailbox structure */
 can_mb_conf_t can0_mailbox;
 
@@ -443,4 +511,8 @@ int send_can_command_from_int(uint32_t low, uint8_t byte_four, uint8_t sender_id
 int send_can_command_h2(uint32_t low, uint8_t byte_four, uint8_t sender_id, uint8_t ssm_id, uint8_t smalltype, uint8_t priority);
 int send_tc_can_command(uint32_t low, uint8_t byte_four, uint8_t sender_id, uint8_t ssm_id, uint8_t smalltype, uint8_t priority);
 int send_tc_can_command_from_int(uint32_t low, uint8_t byte_four, uint8_t sender_id, uint8_t ssm_id, uint8_t smalltype, uint8_t priority);
+int send_tm_frame(uint32_t low, uint32_t high);													// API Function.
+void tm_transfer_reset(void);																	// API Function.
+int tm_wait_start(TickType_t ticks);															// API Function, BLOCKS FOR ticks
+int tm_wait_response(uint32_t* resp, TickType_t ticks);											// API Function, BLOCKS FOR ticks
 #endif
\ No newline at end of file
@@ -32,6 +32,29 @@
 	*
 	*	11/12/2015		K:I added functions fletcher64() and fletcher64_on_spimem()
 	*
+	*	10/16/2026		fletcher64_on_spimem() now streams the region with spimem_read_stream_cb()
+	*					instead of reading (and taking Spi0_Mutex) one page at a time.
+	*
+	*					fletcher64_on_spimem() answers page-aligned regions from the checksum index
+	*					(spimem_index.c), which only re-reads the pages written since it last looked.
+	*
+	*					fletcher16() now keeps 32-bit sums and only reduces them modulo 255 once every
+	*					FLETCHER16_BLOCK bytes instead of twice per byte. Word-aligned data is loaded a
+	*					word at a time. The result is bit for bit the same.
+	*
+	*					Added crc16_ccitt() (table driven) and pus_pec(), the PUS packet error control,
+	*					which is one or the other depending on PUS_PEC_ALGORITHM.
+	*
+	*					Fletcher-16, Fletcher-64 and the CRC now have an incremental form (_init/_update/_final)
+	*					so that data can be checksummed while it is being copied or read. The Fletcher sums of
+	*					two pieces can be combined (fletcher16_combine(), fletcher64_combine()).
+	*
+	*					fletcher32() is unchanged, including skipping the last word of every block of 359
+	*					words, because ground compares its output.
+	*
+	*					The word-aligned paths test the address as a uintptr_t, (uint32_t)data truncated
+	*					the pointer on 64-bit hosts.
+	*
 	*	DESCRIPTION: 
 	*	An optimized version of Fletcher32 checksum to be used to verify data consistency
 	*	after deployment. To be run during the initial boot process in kernel mode. 
@@ -42,6 +65,43 @@
 
 static void clear_check_array(void);
 
+/* CRC-16-CCITT (x^16 + x^12 + x^5 + 1), one entry per value of the top byte. */
+static const uint16_t crc16_table[256] =
+{
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+	0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+	0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+	0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+	0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+	0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+	0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+	0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+	0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+	0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+	0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+	0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+	0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+	0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+	0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+	0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+	0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+	0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+	0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+	0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+	0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+	0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+	0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+	0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+	0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+	0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+	0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+	0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+	0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+	0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+	0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
 /************************************************************************/
 /* FLETCHER64				                                            */
 /* @Purpose: This function runs Fletcher's checksum algorithm on memory	*/
@@ -49,18 +109,107 @@ static void clear_check_array(void);
 /* hashing.																*/
 /* @param: count: how many BYTES in memory, you would like to hash		*/
 /* @return: the 64-bit checksum value.									*/
+/* @NOTE: Only whole words are hashed, a partial word at the end is		*/
+/* left out.															*/
 /************************************************************************/
 uint64_t fletcher64(uint32_t* data, int count)
 {
-	uint64_t sum1 = 0, sum2 = 0;
-	int count_ints = count / 4;
-	int i;
-	for(i = 0; i < count_ints; i++)
+	fletcher64_ctx_t ctx;
+	fletcher64_init(&ctx);
+	if(count > 0)
+		fletcher64_update(&ctx, (uint8_t*)data, (uint32_t)count & ~0x3);
+	return fletcher64_final(&ctx);
+}
+
+/************************************************************************/
+/* FLETCHER64_INIT, _UPDATE & _FINAL                                    */
+/* @Purpose: Incremental form of fletcher64(). Bytes are folded in as	*/
+/* 32-bit little-endian words, a word may be split across updates.		*/
+/* @param: *ctx: the running checksum.									*/
+/* @param: *data, count: the next count BYTES.							*/
+/* @return: (final) the 64-bit checksum value, a partial word which is	*/
+/* still pending is left out (as in fletcher64()).						*/
+/************************************************************************/
+void fletcher64_init(fletcher64_ctx_t* ctx)
+{
+	ctx->sum1 = 0;
+	ctx->sum2 = 0;
+	ctx->word = 0;
+	ctx->partial = 0;
+	return;
+}
+
+void fletcher64_update(fletcher64_ctx_t* ctx, uint8_t* data, uint32_t count)
+{
+	uint32_t word;
+
+	while(count && ctx->partial)
+	{
+		ctx->word |= ((uint32_t)*(data++)) << (8 * ctx->partial);
+		count--;
+		if(++ctx->partial == 4)
+		{
+			ctx->sum1 += ctx->word;
+			ctx->sum2 += ctx->sum1;
+			ctx->word = 0;
+			ctx->partial = 0;
+		}
+	}
+	for(; count >= 4; count -= 4)
 	{
-		sum1 = (sum1 + data[i]) % (uint64_t)0x100000000;
-		sum2 = (sum2 + sum1) % (uint64_t)0x100000000;
+		if(!((uintptr_t)data & 0x3))
+			word = *(uint32_t*)data;
+		else
+		{
+			word = (uint32_t)data[0];
+			word |= ((uint32_t)data[1]) << 8;
+			word |= ((uint32_t)data[2]) << 16;
+			word |= ((uint32_t)data[3]) << 24;
+		}
+		ctx->sum1 += word;
+		ctx->sum2 += ctx->sum1;
+		data += 4;
 	}
-	return (sum2 << 32) | sum1;
+	while(count--)
+	{
+		ctx->word |= ((uint32_t)*(data++)) << (8 * ctx->partial);
+		ctx->partial++;
+	}
+	return;
+}
+
+uint64_t fletcher64_final(fletcher64_ctx_t* ctx)
+{
+	return (((uint64_t)ctx->sum2) << 32) | (uint64_t)ctx->sum1;
+}
+
+/************************************************************************/
+/* FLETCHER64_COMBINE                                                   */
+/* @Purpose: Fletcher-64 of two pieces of data laid end to end, from	*/
+/* the checksums of each piece.											*/
+/* @param: first, second: fletcher64() of the two pieces.				*/
+/* @param: second_words: length of the second piece in 32-bit words.	*/
+/* @return: the 64-bit checksum value of the whole.						*/
+/************************************************************************/
+uint64_t fletcher64_combine(uint64_t first, uint64_t second, uint32_t second_words)
+{
+	uint32_t sum1 = (uint32_t)first + (uint32_t)second;
+	uint32_t sum2 = (uint32_t)(first >> 32) + (uint32_t)(second >> 32) + second_words * (uint32_t)first;
+	return (((uint64_t)sum2) << 32) | (uint64_t)sum1;
+}
+
+/************************************************************************/
+/* FLETCHER64_SPIMEM_CHUNK                                              */
+/* @Purpose: Streaming consumer for fletcher64_on_spimem(), folds each	*/
+/* chunk of SPI memory into the running checksum as it is read.			*/
+/* @param: *arg: the running checksum (fletcher64_ctx_t).				*/
+/* @param: *data: chunk which was just read.							*/
+/* @return: 1, the read is never stopped early.							*/
+/************************************************************************/
+static int fletcher64_spimem_chunk(void* arg, uint32_t addr, uint8_t* data, uint32_t size)
+{
+	fletcher64_update((fletcher64_ctx_t*)arg, data, size);
+	return 1;
 }
 
 /************************************************************************/
@@ -71,36 +220,31 @@ uint64_t fletcher64(uint32_t* data, int count)
 /* @param: count: how many BYTES in memory, you would like to hash		*/
 /* @param: *status: 0xFF = failure, 0x01 = success.						*/	
 /* @return: the 64-bit checksum value.									*/
+/* @NOTE: Whole pages are hashed, count is rounded up to a multiple of	*/
+/* 256 bytes. Page-aligned regions come from the checksum index,		*/
+/* anything else is streamed with a single RD command.					*/
 /************************************************************************/
 uint64_t fletcher64_on_spimem(uint32_t address, int count, uint8_t* status)
 {
-	uint32_t i, j;
-	int num = 0;
-	uint64_t sum1 = 0, sum2 = 0;
-	uint8_t num_pages = (count / 256);
+	fletcher64_ctx_t ctx;
+	uint64_t checksum;
+	uint32_t num_pages = (count / 256);
 	if(count % 256)
 		num_pages++;
+	if(!INTERNAL_MEMORY_FALLBACK_MODE && (spimem_index_checksum(address, num_pages, &checksum) > 0))
+	{
+		*status = 1;
+		return checksum;
+	}
+	fletcher64_init(&ctx);
 	clear_check_array();
-	for(i = 0; i < num_pages; i++)
+	if(spimem_read_stream_cb(address, num_pages * 256, check_arr, 256, fletcher64_spimem_chunk, &ctx) != (int)(num_pages * 256))
 	{
-		if(spimem_read((address + i * 256), check_arr, (count - i * 256)) < 0)
-		{
-			*status = 0xFF;
-			return 0;
-		}
-		for(j = 0; j < 256; j+=4)
-		{
-			num = (int)check_arr[j];
-			num += ((int)check_arr[j + 1]) << 8;
-			num += ((int)check_arr[j + 2]) << 16;
-			num += ((int)check_arr[j + 3]) << 24;
-			
-			sum1 = (sum1 + num) % (uint64_t)0x100000000;
-			sum2 = (sum2 + sum1) % (uint64_t)0x100000000;
-		}
+		*status = 0xFF;
+		return 0;
 	}
 	*status = 1;
-	return (sum2 << 32) | sum1;
+	return fletcher64_final(&ctx);
 }
 
 /************************************************************************/
@@ -110,6 +254,11 @@ uint64_t fletcher64_on_spimem(uint32_t address, int count, uint8_t* status)
 /* hashing.																*/
 /* @param: words: how many WORDS in memory, you would like to hash		*/
 /* @return: the 32-bit checksum value.									*/
+/* @NOTE: Each block of up to 359 words only adds its first len - 1		*/
+/* words, so the last word of every block is left out. This is kept on	*/
+/* purpose: the result is sent to COMS in SAFE_MODE and compared with	*/
+/* the value computed on the ground. There is no incremental form for	*/
+/* the same reason, which words are left out depends on the total.		*/
 /************************************************************************/
 uint32_t fletcher32(uint32_t *data, size_t words )
 {
@@ -148,17 +297,199 @@ uint32_t fletcher32(uint32_t *data, size_t words )
 /************************************************************************/
 uint16_t fletcher16(uint8_t* data, int count)
 {
-	uint16_t sum1 = 0;
-	uint16_t sum2 = 0;
-	int i;
-	
-	for(i = 0; i < count; i++)
+	fletcher16_ctx_t ctx;
+	fletcher16_init(&ctx);
+	if(count > 0)
+		fletcher16_update(&ctx, data, (uint32_t)count);
+	return fletcher16_final(&ctx);
+}
+
+/************************************************************************/
+/* FLETCHER16_INIT, _UPDATE, _COPY & _FINAL                             */
+/* @Purpose: Incremental form of fletcher16().							*/
+/* @param: *ctx: the running checksum.									*/
+/* @param: *data, count: the next count BYTES.							*/
+/* @param: *dst: (copy) where the bytes are copied to as they are		*/
+/* folded in, so a packet can be assembled and checksummed in one pass.	*/
+/* @return: (final) the 16-bit checksum value.							*/
+/* @NOTE: The sums are only reduced modulo 255 once every				*/
+/* FLETCHER16_BLOCK bytes, the largest block for which sum2 can't		*/
+/* overflow 32 bits. When data is word-aligned, it is loaded four bytes	*/
+/* at a time (little-endian, like the Cortex-M3).						*/
+/************************************************************************/
+void fletcher16_init(fletcher16_ctx_t* ctx)
+{
+	ctx->sum1 = 0;
+	ctx->sum2 = 0;
+	ctx->pending = 0;
+	return;
+}
+
+void fletcher16_update(fletcher16_ctx_t* ctx, uint8_t* data, uint32_t count)
+{
+	uint32_t sum1 = ctx->sum1, sum2 = ctx->sum2;
+	uint32_t word, block;
+
+	while(count)
 	{
-		sum1 = (sum1 + data[i]) % 255;
-		sum2 = (sum2 + sum1) % 255;
+		block = FLETCHER16_BLOCK - ctx->pending;
+		if(block > count)
+			block = count;
+		count -= block;
+		ctx->pending += block;
+		if(!((uintptr_t)data & 0x3))
+		{
+			for(; block >= 4; block -= 4)
+			{
+				word = *(uint32_t*)data;
+				sum1 += word & 0xFF;
+				sum2 += sum1;
+				sum1 += (word >> 8) & 0xFF;
+				sum2 += sum1;
+				sum1 += (word >> 16) & 0xFF;
+				sum2 += sum1;
+				sum1 += word >> 24;
+				sum2 += sum1;
+				data += 4;
+			}
+		}
+		for(; block > 0; block--)
+		{
+			sum1 += *(data++);
+			sum2 += sum1;
+		}
+		if(ctx->pending == FLETCHER16_BLOCK)
+		{
+			sum1 %= 255;
+			sum2 %= 255;
+			ctx->pending = 0;
+		}
 	}
-	
-	return (sum2 << 8) | sum1;
+	ctx->sum1 = sum1;
+	ctx->sum2 = sum2;
+	return;
+}
+
+void fletcher16_copy(fletcher16_ctx_t* ctx, uint8_t* dst, uint8_t* src, uint32_t count)
+{
+	uint32_t sum1 = ctx->sum1, sum2 = ctx->sum2;
+	uint32_t block;
+
+	while(count)
+	{
+		block = FLETCHER16_BLOCK - ctx->pending;
+		if(block > count)
+			block = count;
+		count -= block;
+		ctx->pending += block;
+		for(; block > 0; block--)
+		{
+			*dst = *(src++);
+			sum1 += *(dst++);
+			sum2 += sum1;
+		}
+		if(ctx->pending == FLETCHER16_BLOCK)
+		{
+			sum1 %= 255;
+			sum2 %= 255;
+			ctx->pending = 0;
+		}
+	}
+	ctx->sum1 = sum1;
+	ctx->sum2 = sum2;
+	return;
+}
+
+uint16_t fletcher16_final(fletcher16_ctx_t* ctx)
+{
+	return (uint16_t)(((ctx->sum2 % 255) << 8) | (ctx->sum1 % 255));
+}
+
+/************************************************************************/
+/* FLETCHER16_COMBINE                                                   */
+/* @Purpose: Fletcher-16 of two pieces of data laid end to end, from	*/
+/* the checksums of each piece.											*/
+/* @param: first, second: fletcher16() of the two pieces.				*/
+/* @param: second_len: length of the second piece in bytes.				*/
+/* @return: the 16-bit checksum value of the whole.						*/
+/************************************************************************/
+uint16_t fletcher16_combine(uint16_t first, uint16_t second, uint32_t second_len)
+{
+	uint32_t sum1 = ((first & 0xFF) + (second & 0xFF)) % 255;
+	uint32_t sum2 = ((first >> 8) + (second >> 8) + (second_len % 255) * (first & 0xFF)) % 255;
+	return (uint16_t)((sum2 << 8) | sum1);
+}
+
+/************************************************************************/
+/* CRC16_CCITT				                                            */
+/* @Purpose: CRC-16-CCITT as used for the PUS packet error control:		*/
+/* polynomial 0x1021, preset to 0xFFFF, no reflection, no final XOR.	*/
+/* @param: *data: first byte to include.								*/
+/* @param: count: how many BYTES to include.							*/
+/* @return: the 16-bit CRC.												*/
+/************************************************************************/
+uint16_t crc16_ccitt(uint8_t* data, int count)
+{
+	crc16_ctx_t ctx;
+	crc16_ccitt_init(&ctx);
+	if(count > 0)
+		crc16_ccitt_update(&ctx, data, (uint32_t)count);
+	return crc16_ccitt_final(&ctx);
+}
+
+/************************************************************************/
+/* CRC16_CCITT_INIT, _UPDATE, _COPY & _FINAL                            */
+/* @Purpose: Incremental form of crc16_ccitt(), see fletcher16_init().	*/
+/************************************************************************/
+void crc16_ccitt_init(crc16_ctx_t* ctx)
+{
+	ctx->crc = 0xFFFF;
+	return;
+}
+
+void crc16_ccitt_update(crc16_ctx_t* ctx, uint8_t* data, uint32_t count)
+{
+	uint16_t crc = ctx->crc;
+	while(count--)
+	{
+		crc = (uint16_t)(crc << 8) ^ crc16_table[(uint8_t)(crc >> 8) ^ *(data++)];
+	}
+	ctx->crc = crc;
+	return;
+}
+
+void crc16_ccitt_copy(crc16_ctx_t* ctx, uint8_t* dst, uint8_t* src, uint32_t count)
+{
+	uint16_t crc = ctx->crc;
+	while(count--)
+	{
+		*dst = *(src++);
+		crc = (uint16_t)(crc << 8) ^ crc16_table[(uint8_t)(crc >> 8) ^ *(dst++)];
+	}
+	ctx->crc = crc;
+	return;
+}
+
+uint16_t crc16_ccitt_final(crc16_ctx_t* ctx)
+{
+	return ctx->crc;
+}
+
+/************************************************************************/
+/* PUS_PEC					                                            */
+/* @Purpose: Packet error control of a PUS packet, fletcher16() or		*/
+/* crc16_ccitt() depending on PUS_PEC_ALGORITHM.						*/
+/* @param: *data: first byte to include.								*/
+/* @param: count: how many BYTES to include.							*/
+/* @return: the 16-bit PEC.												*/
+/************************************************************************/
+uint16_t pus_pec(uint8_t* data, int count)
+{
+#if (PUS_PEC_ALGORITHM == PUS_PEC_CRC16)
+	return crc16_ccitt(data, count);
+#else
+	return fletcher16(data, count);
+#endif
 }
 
 /************************************************************************/
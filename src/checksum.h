@@ -24,6 +24,11 @@
 	*
 	*	DEVELOPMENT HISTORY:		
 	*	11/05/2015		K:Created
+	*
+	*	10/16/2026		Added crc16_ccitt(), pus_pec(), PUS_PEC_ALGORITHM and FLETCHER16_BLOCK.
+	*
+	*					Added the incremental checksum contexts (fletcher16_ctx_t, fletcher64_ctx_t,
+	*					crc16_ctx_t and pus_pec_ctx_t).
  */
 
 /* Standard includes */
@@ -31,6 +36,48 @@
 #include <stdint.h>
 #include "spimem.h"
 
+/* Packet error control used for PUS packets, must match COMS and the ground station. */
+#define PUS_PEC_FLETCHER16		0
+#define PUS_PEC_CRC16			1			// CRC-16-CCITT, the PEC defined by the PUS standard.
+#ifndef PUS_PEC_ALGORITHM
+#define PUS_PEC_ALGORITHM		PUS_PEC_FLETCHER16
+#endif
+
+#define FLETCHER16_BLOCK		5802		// Bytes between reductions, sum2 stays below 2^32.
+
+/* Running checksums, see the _init/_update/_final functions */
+typedef struct
+{
+	uint32_t sum1, sum2;
+	uint32_t pending;						// Bytes added since the sums were last reduced.
+} fletcher16_ctx_t;
+
+typedef struct
+{
+	uint32_t sum1, sum2;
+	uint32_t word;							// Bytes of a word split across two updates.
+	uint8_t partial;
+} fletcher64_ctx_t;
+
+typedef struct
+{
+	uint16_t crc;
+} crc16_ctx_t;
+
+#if (PUS_PEC_ALGORITHM == PUS_PEC_CRC16)
+typedef crc16_ctx_t pus_pec_ctx_t;
+#define pus_pec_init(ctx)						crc16_ccitt_init(ctx)
+#define pus_pec_update(ctx, data, count)		crc16_ccitt_update(ctx, data, count)
+#define pus_pec_copy(ctx, dst, src, count)		crc16_ccitt_copy(ctx, dst, src, count)
+#define pus_pec_final(ctx)						crc16_ccitt_final(ctx)
+#else
+typedef fletcher16_ctx_t pus_pec_ctx_t;
+#define pus_pec_init(ctx)						fletcher16_init(ctx)
+#define pus_pec_update(ctx, data, count)		fletcher16_update(ctx, data, count)
+#define pus_pec_copy(ctx, dst, src, count)		fletcher16_copy(ctx, dst, src, count)
+#define pus_pec_final(ctx)						fletcher16_final(ctx)
+#endif
+
 /* Array required for hashing SPI memory */
 uint8_t check_arr[256];
 
@@ -38,3 +85,19 @@ uint64_t fletcher64(uint32_t* data, int count);
 uint64_t fletcher64_on_spimem(uint32_t address, int count, uint8_t* status);
 uint32_t fletcher32(uint32_t *data, size_t words );
 uint16_t fletcher16(uint8_t* data, int count);
+uint16_t crc16_ccitt(uint8_t* data, int count);
+uint16_t pus_pec(uint8_t* data, int count);
+
+void fletcher16_init(fletcher16_ctx_t* ctx);
+void fletcher16_update(fletcher16_ctx_t* ctx, uint8_t* data, uint32_t count);
+void fletcher16_copy(fletcher16_ctx_t* ctx, uint8_t* dst, uint8_t* src, uint32_t count);
+uint16_t fletcher16_final(fletcher16_ctx_t* ctx);
+uint16_t fletcher16_combine(uint16_t first, uint16_t second, uint32_t second_len);
+void fletcher64_init(fletcher64_ctx_t* ctx);
+void fletcher64_update(fletcher64_ctx_t* ctx, uint8_t* data, uint32_t count);
+uint64_t fletcher64_final(fletcher64_ctx_t* ctx);
+uint64_t fletcher64_combine(uint64_t first, uint64_t second, uint32_t second_words);
+void crc16_ccitt_init(crc16_ctx_t* ctx);
+void crc16_ccitt_update(crc16_ctx_t* ctx, uint8_t* data, uint32_t count);
+void crc16_ccitt_copy(crc16_ctx_t* ctx, uint8_t* dst, uint8_t* src, uint32_t count);
+uint16_t crc16_ccitt_final(crc16_ctx_t* ctx);
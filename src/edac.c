@@ -0,0 +1,622 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		edac.c
+*
+*	PURPOSE:		Reed-Solomon error detection and correction (EDAC) for data kept in SPI memory.
+*
+*	FILE REFERENCES:		edac.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	A codeword holds at most RS_MAX_DATA data bytes.
+*
+*	NOTES:		The code is a shortened RS(255, 241) over GF(2^8) (field polynomial x^8+x^4+x^3+x^2+1,
+*				0x11D). The generator polynomial has the roots a^0 ... a^13, so each codeword carries
+*				RS_PARITY = 14 parity bytes and any 7 bad bytes in it (data or parity) are corrected.
+*				A 256B page is split into EDAC_INTERLEAVE = 2 codewords of 128 bytes (even and odd
+*				bytes), so a burst of up to 14 consecutive bad bytes is corrected as well. That is
+*				28B of ECC per page.
+*
+*				Encoding is a table-driven LFSR: rs_gen_table[f] holds f times the generator's
+*				coefficients, packed four to a 32-bit word, so each data byte costs one lookup and
+*				four word shifts/XORs instead of 14 field multiplications.
+*
+*				Decoding first re-encodes the data and compares the parity (the common case, nothing
+*				to correct, costs the same as encoding). The parity which was stored XOR the parity
+*				which was worked out is the codeword modulo the generator, so the syndromes come from
+*				those 14 bytes instead of from the whole codeword. Only then are Berlekamp-Massey,
+*				a Chien search and Forney's algorithm run.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include "edac.h"
+
+#define RS_T		(RS_PARITY / 2)
+#define RS_WORDS	4					// rs_remainder() keeps up to 16 parity bytes in four words.
+
+/* gf_exp[i] = a^i (doubled so that gf_exp[log a + log b] needs no modulo), gf_log[a^i] = i. */
+static const uint8_t gf_exp[512] =
+{
+	0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26,
+	0x4C, 0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0,
+	0x9D, 0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23,
+	0x46, 0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1,
+	0x5F, 0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0,
+	0xFD, 0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2,
+	0xD9, 0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE,
+	0x81, 0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC,
+	0x85, 0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54,
+	0xA8, 0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73,
+	0xE6, 0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF,
+	0xE3, 0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41,
+	0x82, 0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6,
+	0x51, 0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09,
+	0x12, 0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16,
+	0x2C, 0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E, 0x01,
+	0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26, 0x4C,
+	0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0, 0x9D,
+	0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23, 0x46,
+	0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1, 0x5F,
+	0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0, 0xFD,
+	0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2, 0xD9,
+	0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE, 0x81,
+	0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC, 0x85,
+	0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54, 0xA8,
+	0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73, 0xE6,
+	0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF, 0xE3,
+	0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41, 0x82,
+	0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6, 0x51,
+	0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09, 0x12,
+	0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16, 0x2C,
+	0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E, 0x01, 0x02
+};
+
+static const uint8_t gf_log[256] =
+{
+	0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1A, 0xC6, 0x03, 0xDF, 0x33, 0xEE, 0x1B, 0x68, 0xC7, 0x4B,
+	0x04, 0x64, 0xE0, 0x0E, 0x34, 0x8D, 0xEF, 0x81, 0x1C, 0xC1, 0x69, 0xF8, 0xC8, 0x08, 0x4C, 0x71,
+	0x05, 0x8A, 0x65, 0x2F, 0xE1, 0x24, 0x0F, 0x21, 0x35, 0x93, 0x8E, 0xDA, 0xF0, 0x12, 0x82, 0x45,
+	0x1D, 0xB5, 0xC2, 0x7D, 0x6A, 0x27, 0xF9, 0xB9, 0xC9, 0x9A, 0x09, 0x78, 0x4D, 0xE4, 0x72, 0xA6,
+	0x06, 0xBF, 0x8B, 0x62, 0x66, 0xDD, 0x30, 0xFD, 0xE2, 0x98, 0x25, 0xB3, 0x10, 0x91, 0x22, 0x88,
+	0x36, 0xD0, 0x94, 0xCE, 0x8F, 0x96, 0xDB, 0xBD, 0xF1, 0xD2, 0x13, 0x5C, 0x83, 0x38, 0x46, 0x40,
+	0x1E, 0x42, 0xB6, 0xA3, 0xC3, 0x48, 0x7E, 0x6E, 0x6B, 0x3A, 0x28, 0x54, 0xFA, 0x85, 0xBA, 0x3D,
+	0xCA, 0x5E, 0x9B, 0x9F, 0x0A, 0x15, 0x79, 0x2B, 0x4E, 0xD4, 0xE5, 0xAC, 0x73, 0xF3, 0xA7, 0x57,
+	0x07, 0x70, 0xC0, 0xF7, 0x8C, 0x80, 0x63, 0x0D, 0x67, 0x4A, 0xDE, 0xED, 0x31, 0xC5, 0xFE, 0x18,
+	0xE3, 0xA5, 0x99, 0x77, 0x26, 0xB8, 0xB4, 0x7C, 0x11, 0x44, 0x92, 0xD9, 0x23, 0x20, 0x89, 0x2E,
+	0x37, 0x3F, 0xD1, 0x5B, 0x95, 0xBC, 0xCF, 0xCD, 0x90, 0x87, 0x97, 0xB2, 0xDC, 0xFC, 0xBE, 0x61,
+	0xF2, 0x56, 0xD3, 0xAB, 0x14, 0x2A, 0x5D, 0x9E, 0x84, 0x3C, 0x39, 0x53, 0x47, 0x6D, 0x41, 0xA2,
+	0x1F, 0x2D, 0x43, 0xD8, 0xB7, 0x7B, 0xA4, 0x76, 0xC4, 0x17, 0x49, 0xEC, 0x7F, 0x0C, 0x6F, 0xF6,
+	0x6C, 0xA1, 0x3B, 0x52, 0x29, 0x9D, 0x55, 0xAA, 0xFB, 0x60, 0x86, 0xB1, 0xBB, 0xCC, 0x3E, 0x5A,
+	0xCB, 0x59, 0x5F, 0xB0, 0x9C, 0xA9, 0xA0, 0x51, 0x0B, 0xF5, 0x16, 0xEB, 0x7A, 0x75, 0x2C, 0xD7,
+	0x4F, 0xAE, 0xD5, 0xE9, 0xE6, 0xE7, 0xAD, 0xE8, 0x74, 0xD6, 0xF4, 0xEA, 0xA8, 0x50, 0x58, 0xAF
+};
+
+/* rs_gen_table[f] = f * g(x), g(x) = (x + a^0)(x + a^1)...(x + a^13), packed as in rs_remainder(). */
+static const uint32_t rs_gen_table[256][4] =
+{
+	{0x00000000, 0x00000000, 0x00000000, 0x00000000},
+	{0x4672360E, 0x9E2B97AE, 0xD2A67FC3, 0x0000A3EA},
+	{0x8CE46C1C, 0x21563341, 0xB951FE9B, 0x00005BC9},
+	{0xCA965A12, 0xBF7DA4EF, 0x6BF78158, 0x0000F823},
+	{0x05D5D838, 0x42AC6682, 0x6FA2E12B, 0x0000B68F},
+	{0x43A7EE36, 0xDC87F12C, 0xBD049EE8, 0x00001565},
+	{0x8931B424, 0x63FA55C3, 0xD6F31FB0, 0x0000ED46},
+	{0xCF43822A, 0xFDD1C26D, 0x04556073, 0x00004EAC},
+	{0x0AB7AD70, 0x8445CC19, 0xDE59DF56, 0x00007103},
+	{0x4CC59B7E, 0x1A6E5BB7, 0x0CFFA095, 0x0000D2E9},
+	{0x8653C16C, 0xA513FF58, 0x670821CD, 0x00002ACA},
+	{0xC021F762, 0x3B3868F6, 0xB5AE5E0E, 0x00008920},
+	{0x0F627548, 0xC6E9AA9B, 0xB1FB3E7D, 0x0000C78C},
+	{0x49104346, 0x58C23D35, 0x635D41BE, 0x00006466},
+	{0x83861954, 0xE7BF99DA, 0x08AAC0E6, 0x00009C45},
+	{0xC5F42F5A, 0x79940E74, 0xDA0CBF25, 0x00003FAF},
+	{0x147347E0, 0x158A8532, 0xA1B2A3AC, 0x0000E206},
+	{0x520171EE, 0x8BA1129C, 0x7314DC6F, 0x000041EC},
+	{0x98972BFC, 0x34DCB673, 0x18E35D37, 0x0000B9CF},
+	{0xDEE51DF2, 0xAAF721DD, 0xCA4522F4, 0x00001A25},
+	{0x11A69FD8, 0x5726E3B0, 0xCE104287, 0x00005489},
+	{0x57D4A9D6, 0xC90D741E, 0x1CB63D44, 0x0000F763},
+	{0x9D42F3C4, 0x7670D0F1, 0x7741BC1C, 0x00000F40},
+	{0xDB30C5CA, 0xE85B475F, 0xA5E7C3DF, 0x0000ACAA},
+	{0x1EC4EA90, 0x91CF492B, 0x7FEB7CFA, 0x00009305},
+	{0x58B6DC9E, 0x0FE4DE85, 0xAD4D0339, 0x000030EF},
+	{0x9220868C, 0xB0997A6A, 0xC6BA8261, 0x0000C8CC},
+	{0xD452B082, 0x2EB2EDC4, 0x141CFDA2, 0x00006B26},
+	{0x1B1132A8, 0xD3632FA9, 0x10499DD1, 0x0000258A},
+	{0x5D6304A6, 0x4D48B807, 0xC2EFE212, 0x00008660},
+	{0x97F55EB4, 0xF2351CE8, 0xA918634A, 0x00007E43},
+	{0xD18768BA, 0x6C1E8B46, 0x7BBE1C89, 0x0000DDA9},
+	{0x28E68EDD, 0x2A091764, 0x5F795B45, 0x0000D90C},
+	{0x6E94B8D3, 0xB42280CA, 0x8DDF2486, 0x00007AE6},
+	{0xA402E2C1, 0x0B5F2425, 0xE628A5DE, 0x000082C5},
+	{0xE270D4CF, 0x9574B38B, 0x348EDA1D, 0x0000212F},
+	{0x2D3356E5, 0x68A571E6, 0x30DBBA6E, 0x00006F83},
+	{0x6B4160EB, 0xF68EE648, 0xE27DC5AD, 0x0000CC69},
+	{0xA1D73AF9, 0x49F342A7, 0x898A44F5, 0x0000344A},
+	{0xE7A50CF7, 0xD7D8D509, 0x5B2C3B36, 0x000097A0},
+	{0x225123AD, 0xAE4CDB7D, 0x81208413, 0x0000A80F},
+	{0x642315A3, 0x30674CD3, 0x5386FBD0, 0x00000BE5},
+	{0xAEB54FB1, 0x8F1AE83C, 0x38717A88, 0x0000F3C6},
+	{0xE8C779BF, 0x11317F92, 0xEAD7054B, 0x0000502C},
+	{0x2784FB95, 0xECE0BDFF, 0xEE826538, 0x00001E80},
+	{0x61F6CD9B, 0x72CB2A51, 0x3C241AFB, 0x0000BD6A},
+	{0xAB609789, 0xCDB68EBE, 0x57D39BA3, 0x00004549},
+	{0xED12A187, 0x539D1910, 0x8575E460, 0x0000E6A3},
+	{0x3C95C93D, 0x3F839256, 0xFECBF8E9, 0x00003B0A},
+	{0x7AE7FF33, 0xA1A805F8, 0x2C6D872A, 0x000098E0},
+	{0xB071A521, 0x1ED5A117, 0x479A0672, 0x000060C3},
+	{0xF603932F, 0x80FE36B9, 0x953C79B1, 0x0000C329},
+	{0x39401105, 0x7D2FF4D4, 0x916919C2, 0x00008D85},
+	{0x7F32270B, 0xE304637A, 0x43CF6601, 0x00002E6F},
+	{0xB5A47D19, 0x5C79C795, 0x2838E759, 0x0000D64C},
+	{0xF3D64B17, 0xC252503B, 0xFA9E989A, 0x000075A6},
+	{0x3622644D, 0xBBC65E4F, 0x209227BF, 0x00004A09},
+	{0x70505243, 0x25EDC9E1, 0xF234587C, 0x0000E9E3},
+	{0xBAC60851, 0x9A906D0E, 0x99C3D924, 0x000011C0},
+	{0xFCB43E5F, 0x04BBFAA0, 0x4B65A6E7, 0x0000B22A},
+	{0x33F7BC75, 0xF96A38CD, 0x4F30C694, 0x0000FC86},
+	{0x75858A7B, 0x6741AF63, 0x9D96B957, 0x00005F6C},
+	{0xBF13D069, 0xD83C0B8C, 0xF661380F, 0x0000A74F},
+	{0xF961E667, 0x46179C22, 0x24C747CC, 0x000004A5},
+	{0x50D101A7, 0x54122EC8, 0xBEF2B68A, 0x0000AF18},
+	{0x16A337A9, 0xCA39B966, 0x6C54C949, 0x00000CF2},
+	{0xDC356DBB, 0x75441D89, 0x07A34811, 0x0000F4D1},
+	{0x9A475BB5, 0xEB6F8A27, 0xD50537D2, 0x0000573B},
+	{0x5504D99F, 0x16BE484A, 0xD15057A1, 0x00001997},
+	{0x1376EF91, 0x8895DFE4, 0x03F62862, 0x0000BA7D},
+	{0xD9E0B583, 0x37E87B0B, 0x6801A93A, 0x0000425E},
+	{0x9F92838D, 0xA9C3ECA5, 0xBAA7D6F9, 0x0000E1B4},
+	{0x5A66ACD7, 0xD057E2D1, 0x60AB69DC, 0x0000DE1B},
+	{0x1C149AD9, 0x4E7C757F, 0xB20D161F, 0x00007DF1},
+	{0xD682C0CB, 0xF101D190, 0xD9FA9747, 0x000085D2},
+	{0x90F0F6C5, 0x6F2A463E, 0x0B5CE884, 0x00002638},
+	{0x5FB374EF, 0x92FB8453, 0x0F0988F7, 0x00006894},
+	{0x19C142E1, 0x0CD013FD, 0xDDAFF734, 0x0000CB7E},
+	{0xD35718F3, 0xB3ADB712, 0xB658766C, 0x0000335D},
+	{0x95252EFD, 0x2D8620BC, 0x64FE09AF, 0x000090B7},
+	{0x44A24647, 0x4198ABFA, 0x1F401526, 0x00004D1E},
+	{0x02D07049, 0xDFB33C54, 0xCDE66AE5, 0x0000EEF4},
+	{0xC8462A5B, 0x60CE98BB, 0xA611EBBD, 0x000016D7},
+	{0x8E341C55, 0xFEE50F15, 0x74B7947E, 0x0000B53D},
+	{0x41779E7F, 0x0334CD78, 0x70E2F40D, 0x0000FB91},
+	{0x0705A871, 0x9D1F5AD6, 0xA2448BCE, 0x0000587B},
+	{0xCD93F263, 0x2262FE39, 0xC9B30A96, 0x0000A058},
+	{0x8BE1C46D, 0xBC496997, 0x1B157555, 0x000003B2},
+	{0x4E15EB37, 0xC5DD67E3, 0xC119CA70, 0x00003C1D},
+	{0x0867DD39, 0x5BF6F04D, 0x13BFB5B3, 0x00009FF7},
+	{0xC2F1872B, 0xE48B54A2, 0x784834EB, 0x000067D4},
+	{0x8483B125, 0x7AA0C30C, 0xAAEE4B28, 0x0000C43E},
+	{0x4BC0330F, 0x87710161, 0xAEBB2B5B, 0x00008A92},
+	{0x0DB20501, 0x195A96CF, 0x7C1D5498, 0x00002978},
+	{0xC7245F13, 0xA6273220, 0x17EAD5C0, 0x0000D15B},
+	{0x8156691D, 0x380CA58E, 0xC54CAA03, 0x000072B1},
+	{0x78378F7A, 0x7E1B39AC, 0xE18BEDCF, 0x00007614},
+	{0x3E45B974, 0xE030AE02, 0x332D920C, 0x0000D5FE},
+	{0xF4D3E366, 0x5F4D0AED, 0x58DA1354, 0x00002DDD},
+	{0xB2A1D568, 0xC1669D43, 0x8A7C6C97, 0x00008E37},
+	{0x7DE25742, 0x3CB75F2E, 0x8E290CE4, 0x0000C09B},
+	{0x3B90614C, 0xA29CC880, 0x5C8F7327, 0x00006371},
+	{0xF1063B5E, 0x1DE16C6F, 0x3778F27F, 0x00009B52},
+	{0xB7740D50, 0x83CAFBC1, 0xE5DE8DBC, 0x000038B8},
+	{0x7280220A, 0xFA5EF5B5, 0x3FD23299, 0x00000717},
+	{0x34F21404, 0x6475621B, 0xED744D5A, 0x0000A4FD},
+	{0xFE644E16, 0xDB08C6F4, 0x8683CC02, 0x00005CDE},
+	{0xB8167818, 0x4523515A, 0x5425B3C1, 0x0000FF34},
+	{0x7755FA32, 0xB8F29337, 0x5070D3B2, 0x0000B198},
+	{0x3127CC3C, 0x26D90499, 0x82D6AC71, 0x00001272},
+	{0xFBB1962E, 0x99A4A076, 0xE9212D29, 0x0000EA51},
+	{0xBDC3A020, 0x078F37D8, 0x3B8752EA, 0x000049BB},
+	{0x6C44C89A, 0x6B91BC9E, 0x40394E63, 0x00009412},
+	{0x2A36FE94, 0xF5BA2B30, 0x929F31A0, 0x000037F8},
+	{0xE0A0A486, 0x4AC78FDF, 0xF968B0F8, 0x0000CFDB},
+	{0xA6D29288, 0xD4EC1871, 0x2BCECF3B, 0x00006C31},
+	{0x699110A2, 0x293DDA1C, 0x2F9BAF48, 0x0000229D},
+	{0x2FE326AC, 0xB7164DB2, 0xFD3DD08B, 0x00008177},
+	{0xE5757CBE, 0x086BE95D, 0x96CA51D3, 0x00007954},
+	{0xA3074AB0, 0x96407EF3, 0x446C2E10, 0x0000DABE},
+	{0x66F365EA, 0xEFD47087, 0x9E609135, 0x0000E511},
+	{0x208153E4, 0x71FFE729, 0x4CC6EEF6, 0x000046FB},
+	{0xEA1709F6, 0xCE8243C6, 0x27316FAE, 0x0000BED8},
+	{0xAC653FF8, 0x50A9D468, 0xF597106D, 0x00001D32},
+	{0x6326BDD2, 0xAD781605, 0xF1C2701E, 0x0000539E},
+	{0x25548BDC, 0x335381AB, 0x23640FDD, 0x0000F074},
+	{0xEFC2D1CE, 0x8C2E2544, 0x48938E85, 0x00000857},
+	{0xA9B0E7C0, 0x1205B2EA, 0x9A35F146, 0x0000ABBD},
+	{0xA0BF0253, 0xA8245C8D, 0x61F97109, 0x00004330},
+	{0xE6CD345D, 0x360FCB23, 0xB35F0ECA, 0x0000E0DA},
+	{0x2C5B6E4F, 0x89726FCC, 0xD8A88F92, 0x000018F9},
+	{0x6A295841, 0x1759F862, 0x0A0EF051, 0x0000BB13},
+	{0xA56ADA6B, 0xEA883A0F, 0x0E5B9022, 0x0000F5BF},
+	{0xE318EC65, 0x74A3ADA1, 0xDCFDEFE1, 0x00005655},
+	{0x298EB677, 0xCBDE094E, 0xB70A6EB9, 0x0000AE76},
+	{0x6FFC8079, 0x55F59EE0, 0x65AC117A, 0x00000D9C},
+	{0xAA08AF23, 0x2C619094, 0xBFA0AE5F, 0x00003233},
+	{0xEC7A992D, 0xB24A073A, 0x6D06D19C, 0x000091D9},
+	{0x26ECC33F, 0x0D37A3D5, 0x06F150C4, 0x000069FA},
+	{0x609EF531, 0x931C347B, 0xD4572F07, 0x0000CA10},
+	{0xAFDD771B, 0x6ECDF616, 0xD0024F74, 0x000084BC},
+	{0xE9AF4115, 0xF0E661B8, 0x02A430B7, 0x00002756},
+	{0x23391B07, 0x4F9BC557, 0x6953B1EF, 0x0000DF75},
+	{0x654B2D09, 0xD1B052F9, 0xBBF5CE2C, 0x00007C9F},
+	{0xB4CC45B3, 0xBDAED9BF, 0xC04BD2A5, 0x0000A136},
+	{0xF2BE73BD, 0x23854E11, 0x12EDAD66, 0x000002DC},
+	{0x382829AF, 0x9CF8EAFE, 0x791A2C3E, 0x0000FAFF},
+	{0x7E5A1FA1, 0x02D37D50, 0xABBC53FD, 0x00005915},
+	{0xB1199D8B, 0xFF02BF3D, 0xAFE9338E, 0x000017B9},
+	{0xF76BAB85, 0x61292893, 0x7D4F4C4D, 0x0000B453},
+	{0x3DFDF197, 0xDE548C7C, 0x16B8CD15, 0x00004C70},
+	{0x7B8FC799, 0x407F1BD2, 0xC41EB2D6, 0x0000EF9A},
+	{0xBE7BE8C3, 0x39EB15A6, 0x1E120DF3, 0x0000D035},
+	{0xF809DECD, 0xA7C08208, 0xCCB47230, 0x000073DF},
+	{0x329F84DF, 0x18BD26E7, 0xA743F368, 0x00008BFC},
+	{0x74EDB2D1, 0x8696B149, 0x75E58CAB, 0x00002816},
+	{0xBBAE30FB, 0x7B477324, 0x71B0ECD8, 0x000066BA},
+	{0xFDDC06F5, 0xE56CE48A, 0xA316931B, 0x0000C550},
+	{0x374A5CE7, 0x5A114065, 0xC8E11243, 0x00003D73},
+	{0x71386AE9, 0xC43AD7CB, 0x1A476D80, 0x00009E99},
+	{0x88598C8E, 0x822D4BE9, 0x3E802A4C, 0x00009A3C},
+	{0xCE2BBA80, 0x1C06DC47, 0xEC26558F, 0x000039D6},
+	{0x04BDE092, 0xA37B78A8, 0x87D1D4D7, 0x0000C1F5},
+	{0x42CFD69C, 0x3D50EF06, 0x5577AB14, 0x0000621F},
+	{0x8D8C54B6, 0xC0812D6B, 0x5122CB67, 0x00002CB3},
+	{0xCBFE62B8, 0x5EAABAC5, 0x8384B4A4, 0x00008F59},
+	{0x016838AA, 0xE1D71E2A, 0xE87335FC, 0x0000777A},
+	{0x471A0EA4, 0x7FFC8984, 0x3AD54A3F, 0x0000D490},
+	{0x82EE21FE, 0x066887F0, 0xE0D9F51A, 0x0000EB3F},
+	{0xC49C17F0, 0x9843105E, 0x327F8AD9, 0x000048D5},
+	{0x0E0A4DE2, 0x273EB4B1, 0x59880B81, 0x0000B0F6},
+	{0x48787BEC, 0xB915231F, 0x8B2E7442, 0x0000131C},
+	{0x873BF9C6, 0x44C4E172, 0x8F7B1431, 0x00005DB0},
+	{0xC149CFC8, 0xDAEF76DC, 0x5DDD6BF2, 0x0000FE5A},
+	{0x0BDF95DA, 0x6592D233, 0x362AEAAA, 0x00000679},
+	{0x4DADA3D4, 0xFBB9459D, 0xE48C9569, 0x0000A593},
+	{0x9C2ACB6E, 0x97A7CEDB, 0x9F3289E0, 0x0000783A},
+	{0xDA58FD60, 0x098C5975, 0x4D94F623, 0x0000DBD0},
+	{0x10CEA772, 0xB6F1FD9A, 0x2663777B, 0x000023F3},
+	{0x56BC917C, 0x28DA6A34, 0xF4C508B8, 0x00008019},
+	{0x99FF1356, 0xD50BA859, 0xF09068CB, 0x0000CEB5},
+	{0xDF8D2558, 0x4B203FF7, 0x22361708, 0x00006D5F},
+	{0x151B7F4A, 0xF45D9B18, 0x49C19650, 0x0000957C},
+	{0x53694944, 0x6A760CB6, 0x9B67E993, 0x00003696},
+	{0x969D661E, 0x13E202C2, 0x416B56B6, 0x00000939},
+	{0xD0EF5010, 0x8DC9956C, 0x93CD2975, 0x0000AAD3},
+	{0x1A790A02, 0x32B43183, 0xF83AA82D, 0x000052F0},
+	{0x5C0B3C0C, 0xAC9FA62D, 0x2A9CD7EE, 0x0000F11A},
+	{0x9348BE26, 0x514E6440, 0x2EC9B79D, 0x0000BFB6},
+	{0xD53A8828, 0xCF65F3EE, 0xFC6FC85E, 0x00001C5C},
+	{0x1FACD23A, 0x70185701, 0x97984906, 0x0000E47F},
+	{0x59DEE434, 0xEE33C0AF, 0x453E36C5, 0x00004795},
+	{0xF06E03F4, 0xFC367245, 0xDF0BC783, 0x0000EC28},
+	{0xB61C35FA, 0x621DE5EB, 0x0DADB840, 0x00004FC2},
+	{0x7C8A6FE8, 0xDD604104, 0x665A3918, 0x0000B7E1},
+	{0x3AF859E6, 0x434BD6AA, 0xB4FC46DB, 0x0000140B},
+	{0xF5BBDBCC, 0xBE9A14C7, 0xB0A926A8, 0x00005AA7},
+	{0xB3C9EDC2, 0x20B18369, 0x620F596B, 0x0000F94D},
+	{0x795FB7D0, 0x9FCC2786, 0x09F8D833, 0x0000016E},
+	{0x3F2D81DE, 0x01E7B028, 0xDB5EA7F0, 0x0000A284},
+	{0xFAD9AE84, 0x7873BE5C, 0x015218D5, 0x00009D2B},
+	{0xBCAB988A, 0xE65829F2, 0xD3F46716, 0x00003EC1},
+	{0x763DC298, 0x59258D1D, 0xB803E64E, 0x0000C6E2},
+	{0x304FF496, 0xC70E1AB3, 0x6AA5998D, 0x00006508},
+	{0xFF0C76BC, 0x3ADFD8DE, 0x6EF0F9FE, 0x00002BA4},
+	{0xB97E40B2, 0xA4F44F70, 0xBC56863D, 0x0000884E},
+	{0x73E81AA0, 0x1B89EB9F, 0xD7A10765, 0x0000706D},
+	{0x359A2CAE, 0x85A27C31, 0x050778A6, 0x0000D387},
+	{0xE41D4414, 0xE9BCF777, 0x7EB9642F, 0x00000E2E},
+	{0xA26F721A, 0x779760D9, 0xAC1F1BEC, 0x0000ADC4},
+	{0x68F92808, 0xC8EAC436, 0xC7E89AB4, 0x000055E7},
+	{0x2E8B1E06, 0x56C15398, 0x154EE577, 0x0000F60D},
+	{0xE1C89C2C, 0xAB1091F5, 0x111B8504, 0x0000B8A1},
+	{0xA7BAAA22, 0x353B065B, 0xC3BDFAC7, 0x00001B4B},
+	{0x6D2CF030, 0x8A46A2B4, 0xA84A7B9F, 0x0000E368},
+	{0x2B5EC63E, 0x146D351A, 0x7AEC045C, 0x00004082},
+	{0xEEAAE964, 0x6DF93B6E, 0xA0E0BB79, 0x00007F2D},
+	{0xA8D8DF6A, 0xF3D2ACC0, 0x7246C4BA, 0x0000DCC7},
+	{0x624E8578, 0x4CAF082F, 0x19B145E2, 0x000024E4},
+	{0x243CB376, 0xD2849F81, 0xCB173A21, 0x0000870E},
+	{0xEB7F315C, 0x2F555DEC, 0xCF425A52, 0x0000C9A2},
+	{0xAD0D0752, 0xB17ECA42, 0x1DE42591, 0x00006A48},
+	{0x679B5D40, 0x0E036EAD, 0x7613A4C9, 0x0000926B},
+	{0x21E96B4E, 0x9028F903, 0xA4B5DB0A, 0x00003181},
+	{0xD8888D29, 0xD63F6521, 0x80729CC6, 0x00003524},
+	{0x9EFABB27, 0x4814F28F, 0x52D4E305, 0x000096CE},
+	{0x546CE135, 0xF7695660, 0x3923625D, 0x00006EED},
+	{0x121ED73B, 0x6942C1CE, 0xEB851D9E, 0x0000CD07},
+	{0xDD5D5511, 0x949303A3, 0xEFD07DED, 0x000083AB},
+	{0x9B2F631F, 0x0AB8940D, 0x3D76022E, 0x00002041},
+	{0x51B9390D, 0xB5C530E2, 0x56818376, 0x0000D862},
+	{0x17CB0F03, 0x2BEEA74C, 0x8427FCB5, 0x00007B88},
+	{0xD23F2059, 0x527AA938, 0x5E2B4390, 0x00004427},
+	{0x944D1657, 0xCC513E96, 0x8C8D3C53, 0x0000E7CD},
+	{0x5EDB4C45, 0x732C9A79, 0xE77ABD0B, 0x00001FEE},
+	{0x18A97A4B, 0xED070DD7, 0x35DCC2C8, 0x0000BC04},
+	{0xD7EAF861, 0x10D6CFBA, 0x3189A2BB, 0x0000F2A8},
+	{0x9198CE6F, 0x8EFD5814, 0xE32FDD78, 0x00005142},
+	{0x5B0E947D, 0x3180FCFB, 0x88D85C20, 0x0000A961},
+	{0x1D7CA273, 0xAFAB6B55, 0x5A7E23E3, 0x00000A8B},
+	{0xCCFBCAC9, 0xC3B5E013, 0x21C03F6A, 0x0000D722},
+	{0x8A89FCC7, 0x5D9E77BD, 0xF36640A9, 0x000074C8},
+	{0x401FA6D5, 0xE2E3D352, 0x9891C1F1, 0x00008CEB},
+	{0x066D90DB, 0x7CC844FC, 0x4A37BE32, 0x00002F01},
+	{0xC92E12F1, 0x81198691, 0x4E62DE41, 0x000061AD},
+	{0x8F5C24FF, 0x1F32113F, 0x9CC4A182, 0x0000C247},
+	{0x45CA7EED, 0xA04FB5D0, 0xF73320DA, 0x00003A64},
+	{0x03B848E3, 0x3E64227E, 0x25955F19, 0x0000998E},
+	{0xC64C67B9, 0x47F02C0A, 0xFF99E03C, 0x0000A621},
+	{0x803E51B7, 0xD9DBBBA4, 0x2D3F9FFF, 0x000005CB},
+	{0x4AA80BA5, 0x66A61F4B, 0x46C81EA7, 0x0000FDE8},
+	{0x0CDA3DAB, 0xF88D88E5, 0x946E6164, 0x00005E02},
+	{0xC399BF81, 0x055C4A88, 0x903B0117, 0x000010AE},
+	{0x85EB898F, 0x9B77DD26, 0x429D7ED4, 0x0000B344},
+	{0x4F7DD39D, 0x240A79C9, 0x296AFF8C, 0x00004B67},
+	{0x090FE593, 0xBA21EE67, 0xFBCC804F, 0x0000E88D}
+};
+
+static uint8_t gf_mul(uint8_t a, uint8_t b);
+static uint8_t gf_div(uint8_t a, uint8_t b);
+static void rs_remainder(uint8_t* data, uint32_t size, uint32_t stride, uint32_t* reg);
+static int rs_locate(uint8_t* data, uint32_t size, uint32_t stride, uint8_t* parity, uint8_t* where, uint8_t* value);
+static void rs_apply(uint8_t* data, uint32_t size, uint32_t stride, uint8_t* parity, uint8_t* where, uint8_t* value, int count);
+
+/************************************************************************/
+/* RS_ENCODE                                                            */
+/* @param: data: The first data byte of the codeword.					*/
+/* @param: size: Number of data bytes (at most RS_MAX_DATA).			*/
+/* @param: stride: Distance between consecutive data bytes (1 = packed,	*/
+/* 2 = every other byte, ...).											*/
+/* @param: parity: Where the RS_PARITY parity bytes are placed.			*/
+/************************************************************************/
+void rs_encode(uint8_t* data, uint32_t size, uint32_t stride, uint8_t* parity)
+{
+	uint32_t reg[RS_WORDS];
+	uint32_t i;
+
+	rs_remainder(data, size, stride, reg);
+	for(i = 0; i < RS_PARITY; i++)
+		parity[i] = (uint8_t)(reg[i >> 2] >> ((i & 3) << 3));
+	return;
+}
+
+/************************************************************************/
+/* RS_DECODE                                                            */
+/* @param: data, size, stride: As in rs_encode().						*/
+/* @param: parity: The RS_PARITY parity bytes stored with the data.		*/
+/* @return: -1 == Too many bad bytes to correct (nothing is changed),	*/
+/* otherwise the number of bytes which were corrected (data or parity).	*/
+/************************************************************************/
+int rs_decode(uint8_t* data, uint32_t size, uint32_t stride, uint8_t* parity)
+{
+	uint8_t where[RS_T], value[RS_T];
+	int count;
+
+	count = rs_locate(data, size, stride, parity, where, value);
+	if(count > 0)
+		rs_apply(data, size, stride, parity, where, value, count);
+	return count;
+}
+
+/************************************************************************/
+/* EDAC_ENCODE_PAGE                                                     */
+/* @param: page: 256B of data.											*/
+/* @param: ecc: Where the EDAC_PAGE_PARITY bytes of ECC are placed.		*/
+/************************************************************************/
+void edac_encode_page(uint8_t* page, uint8_t* ecc)
+{
+	uint32_t i;
+
+	for(i = 0; i < EDAC_INTERLEAVE; i++)
+		rs_encode(page + i, 256 / EDAC_INTERLEAVE, EDAC_INTERLEAVE, ecc + i * RS_PARITY);
+	return;
+}
+
+/************************************************************************/
+/* EDAC_DECODE_PAGE                                                     */
+/* @param: page: 256B of data, corrected in place.						*/
+/* @param: ecc: The ECC stored with the page, corrected in place.		*/
+/* @return: -1 == A codeword can't be corrected (nothing is changed),	*/
+/* otherwise the number of bytes which were corrected.					*/
+/* @NOTE: Every codeword is decoded before anything is changed, so a	*/
+/* page is either corrected as a whole or left alone.					*/
+/************************************************************************/
+int edac_decode_page(uint8_t* page, uint8_t* ecc)
+{
+	uint8_t where[EDAC_INTERLEAVE][RS_T], value[EDAC_INTERLEAVE][RS_T];
+	int count[EDAC_INTERLEAVE];
+	int i, total = 0;
+
+	for(i = 0; i < EDAC_INTERLEAVE; i++)
+	{
+		count[i] = rs_locate(page + i, 256 / EDAC_INTERLEAVE, EDAC_INTERLEAVE, ecc + i * RS_PARITY, where[i], value[i]);
+		if(count[i] < 0)
+			return -1;
+	}
+	for(i = 0; i < EDAC_INTERLEAVE; i++)
+	{
+		rs_apply(page + i, 256 / EDAC_INTERLEAVE, EDAC_INTERLEAVE, ecc + i * RS_PARITY, where[i], value[i], count[i]);
+		total += count[i];
+	}
+	return total;
+}
+
+/************************************************************************/
+/* RS_REMAINDER                                                         */
+/* @Purpose: data(x) * x^14 modulo the generator polynomial. Byte k of	*/
+/* the remainder (k = 0 is the coefficient of x^13) is kept in bits		*/
+/* 8*(k%4) to 8*(k%4)+7 of reg[k/4], so shifting the LFSR along by one	*/
+/* byte is four word shifts.											*/
+/************************************************************************/
+static void rs_remainder(uint8_t* data, uint32_t size, uint32_t stride, uint32_t* reg)
+{
+	uint32_t r0 = 0, r1 = 0, r2 = 0, r3 = 0;
+	const uint32_t* row;
+
+	while(size--)
+	{
+		row = rs_gen_table[(uint8_t)(r0 ^ *data)];
+		data += stride;
+		r0 = ((r0 >> 8) | (r1 << 24)) ^ row[0];
+		r1 = ((r1 >> 8) | (r2 << 24)) ^ row[1];
+		r2 = ((r2 >> 8) | (r3 << 24)) ^ row[2];
+		r3 = (r3 >> 8) ^ row[3];
+	}
+	reg[0] = r0;
+	reg[1] = r1;
+	reg[2] = r2;
+	reg[3] = r3;
+	return;
+}
+
+/************************************************************************/
+/* RS_LOCATE                                                            */
+/* @param: data, size, stride, parity: The codeword, as in rs_decode().	*/
+/* @param: where: Set to the position of each bad byte (0 = first data	*/
+/* byte, size = first parity byte).										*/
+/* @param: value: Set to what each bad byte must be XORed with.			*/
+/* @return: -1 == Can't be corrected, otherwise the number of bad bytes	*/
+/* (up to RS_T).														*/
+/************************************************************************/
+static int rs_locate(uint8_t* data, uint32_t size, uint32_t stride, uint8_t* parity, uint8_t* where, uint8_t* value)
+{
+	uint8_t rem[RS_PARITY], synd[RS_PARITY], lambda[RS_T + 1], prev[RS_T + 1], tmp[RS_T + 1], omega[RS_T + 1];
+	uint32_t reg[RS_WORDS];
+	uint32_t n = size + RS_PARITY, i, j, k, len = 0, shift = 1, errors = 0;
+	uint8_t d, b = 1, scale, x, xinv, num, den, term;
+
+	if(size > RS_MAX_DATA)
+		return -1;
+
+	/* Stored parity XOR fresh parity == codeword mod g(x) */
+	rs_remainder(data, size, stride, reg);
+	d = 0;
+	for(k = 0; k < RS_PARITY; k++)
+	{
+		rem[k] = (uint8_t)(reg[k >> 2] >> ((k & 3) << 3)) ^ parity[k];
+		d |= rem[k];
+	}
+	if(!d)
+		return 0;
+
+	/* Syndromes: S_j = rem(a^j), the roots of g(x) are also roots of the codeword. */
+	for(j = 0; j < RS_PARITY; j++)
+	{
+		synd[j] = 0;
+		for(k = 0; k < RS_PARITY; k++)
+			synd[j] = gf_mul(synd[j], gf_exp[j]) ^ rem[k];
+	}
+
+	/* Berlekamp-Massey: error locator lambda(x), lambda[0] = 1 */
+	for(i = 0; i < (RS_T + 1); i++)
+	{
+		lambda[i] = 0;
+		prev[i] = 0;
+	}
+	lambda[0] = 1;
+	prev[0] = 1;
+	for(j = 0; j < RS_PARITY; j++)
+	{
+		d = synd[j];
+		for(i = 1; (i <= len) && (i <= j); i++)
+			d ^= gf_mul(lambda[i], synd[j - i]);
+		if(!d)
+		{
+			shift++;
+			continue;
+		}
+		scale = gf_div(d, b);
+		for(i = 0; i < (RS_T + 1); i++)
+			tmp[i] = lambda[i];
+		for(i = shift; i < (RS_T + 1); i++)
+			lambda[i] ^= gf_mul(scale, prev[i - shift]);
+		if((2 * len) <= j)
+		{
+			len = j + 1 - len;
+			if(len > RS_T)
+				return -1;
+			for(i = 0; i < (RS_T + 1); i++)
+				prev[i] = tmp[i];
+			b = d;
+			shift = 1;
+		}
+		else
+			shift++;
+	}
+
+	/* Error evaluator omega(x) = S(x) * lambda(x) mod x^len */
+	for(k = 0; k < len; k++)
+	{
+		omega[k] = 0;
+		for(i = 0; i <= k; i++)
+			omega[k] ^= gf_mul(synd[k - i], lambda[i]);
+	}
+
+	/* Chien search (position p is the coefficient of x^(n-1-p)) and Forney */
+	for(i = 0; i < n; i++)
+	{
+		xinv = gf_exp[(255 - (n - 1 - i)) % 255];
+		d = lambda[len];
+		for(k = len; k > 0; k--)
+			d = gf_mul(d, xinv) ^ lambda[k - 1];
+		if(d)
+			continue;
+		if(errors == len)
+			return -1;
+
+		num = 0;
+		for(k = len; k > 0; k--)
+			num = gf_mul(num, xinv) ^ omega[k - 1];
+		den = 0;
+		term = 1;									// xinv^(k-1) for odd k: the formal derivative of lambda.
+		for(k = 1; k <= len; k += 2)
+		{
+			den ^= gf_mul(lambda[k], term);
+			term = gf_mul(term, gf_mul(xinv, xinv));
+		}
+		x = gf_exp[n - 1 - i];
+		if(!den || !num)
+			return -1;
+		where[errors] = (uint8_t)i;
+		value[errors] = gf_mul(x, gf_div(num, den));
+		errors++;
+	}
+	if(errors != len)
+		return -1;									// Some roots fall outside the (shortened) codeword.
+	return (int)errors;
+}
+
+static void rs_apply(uint8_t* data, uint32_t size, uint32_t stride, uint8_t* parity, uint8_t* where, uint8_t* value, int count)
+{
+	int i;
+
+	for(i = 0; i < count; i++)
+	{
+		if(where[i] < size)
+			data[where[i] * stride] ^= value[i];
+		else
+			parity[where[i] - size] ^= value[i];
+	}
+	return;
+}
+
+static uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+	if(!a || !b)
+		return 0;
+	return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+static uint8_t gf_div(uint8_t a, uint8_t b)
+{
+	if(!a)
+		return 0;
+	return gf_exp[gf_log[a] + 255 - gf_log[b]];
+}
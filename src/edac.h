@@ -0,0 +1,43 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		edac.h
+*
+*	PURPOSE:		Houses the includes and definitions for edac.c
+*
+*	FILE REFERENCES:		stdint.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	None
+*
+*	NOTES:
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created
+*
+*/
+
+#ifndef EDAC_H
+#define EDAC_H
+
+#include <stdint.h>
+
+#define RS_PARITY				14			// Parity bytes per codeword (at most 16), up to RS_PARITY / 2 bad bytes are corrected.
+#define RS_MAX_DATA				(255 - RS_PARITY)
+#define EDAC_INTERLEAVE			2			// Codewords per 256B page, byte i of the page is in codeword i % 2.
+#define EDAC_PAGE_PARITY		(RS_PARITY * EDAC_INTERLEAVE)	// ECC bytes per 256B page.
+
+/*		Function Prototypes				*/
+void rs_encode(uint8_t* data, uint32_t size, uint32_t stride, uint8_t* parity);
+int rs_decode(uint8_t* data, uint32_t size, uint32_t stride, uint8_t* parity);
+void edac_encode_page(uint8_t* page, uint8_t* ecc);
+int edac_decode_page(uint8_t* page, uint8_t* ecc);
+
+#endif
@@ -64,6 +64,14 @@ Author: Keenan Burnett, Bill Bateman
 *
 * 03/27/2016		K: Added function headers which were missing.
 *
+* 10/16/2026		recreate_fifo_h() is given the item size of the FIFO, hk_to_obc_fifo and mem_to_obc_fifo
+*					carry PUS packet pool descriptors. The FIFOs are passed by address as it expects.
+*
+* 10/16/2026		Memory dumps in exec_commands() are built in PUS pool buffers and sent as descriptors on
+*					mem_to_obc_fifo with the sequence flags and count the router expects, 128B per packet.
+*					The MEMORY_CHECK_ABS send is gone: it put a 147B item on the 1-byte FIFO and the router
+*					doesn't downlink it.
+*
 * DESCRIPTION:
 *
 */
@@ -101,9 +109,14 @@ Author: Keenan Burnett, Bill Bateman
 /* Checksum related includes			*/
 #include "checksum.h"
 
+#include "pus_pool.h"
+
 /* Priorities at which the tasks are created. */
 #define FDIR_PRIORITY		( tskIDLE_PRIORITY + 5 )
 
+/* Ticks to wait for a pool buffer or for the packet router to take a dump packet. */
+#define FDIR_DUMP_WAIT		5000
+
 /* Values passed to the two tasks just to check the task parameter
 functionality. */
 #define FDIR_PARAMETER			( 0xABCD )
@@ -126,7 +139,7 @@ static void time_update(void);
 static void enter_SAFE_MODE(uint8_t reason);
 static void init_vars(void);
 void clear_fifo_buffer(void);
-int recreate_fifo_h(QueueHandle_t *queue_to_recreate);
+int recreate_fifo_h(QueueHandle_t *queue_to_recreate, UBaseType_t item_size);
 int recreate_fifo(uint8_t task_id, uint8_t direction);
 static void clear_fdir_signal(uint8_t task);
 static int request_enter_low_power_mode(void);
@@ -1132,7 +1145,9 @@ static uint8_t get_fdir_signal(uint8_t task)
 /************************************************************************/
 static void exec_commands(void)
 {
-	uint8_t i, status, j;
+	uint8_t i, status, desc;
+	uint32_t j, size;
+	uint8_t* packet;
 	num_transfers = 0;
 	uint32_t val;
 	uint8_t* mem_ptr = 0;
@@ -1309,37 +1324,62 @@ static void exec_commands(void)
 						}
 					}
 					send_tc_execution_verify(1, packet_id, psc);
+					return;
 				case	DUMP_REQUEST_ABS:
-					clear_current_command();		// Only clears lower data section.
-					if(length > 128)
-					{
-						num_transfers = length / 128;
-					}
+					num_transfers = (length + PUS_POOL_DATA_LENGTH - 1) / PUS_POOL_DATA_LENGTH;
 					for (j = 0; j < num_transfers; j++)
 					{
+						size = PUS_POOL_DATA_LENGTH;
+						if((length - (j * PUS_POOL_DATA_LENGTH)) < PUS_POOL_DATA_LENGTH)
+							size = length - (j * PUS_POOL_DATA_LENGTH);
+						desc = pus_pool_alloc(PUS_POOL_RESERVE, (TickType_t)FDIR_DUMP_WAIT);
+						if(desc == PUS_POOL_NONE)
+						{
+							send_tc_execution_verify(0xFF, packet_id, psc);		// FAILURE_RECOVERY
+							return;
+						}
+						packet = pus_pool_buf(desc);
+						for (i = 0; i < PUS_POOL_DATA_LENGTH; i++)
+						{
+							packet[PUS_POOL_DATA + i] = 0;
+						}
 						if(!memid)
 						{
-							mem_ptr = address;
-							for (i = 0; i < length; i++)
+							mem_ptr = address + (j * PUS_POOL_DATA_LENGTH);
+							for (i = 0; i < size; i++)
 							{
-								current_command[i] = *(mem_ptr + i);
+								packet[PUS_POOL_DATA + i] = *(mem_ptr + i);
 							}
 						}
 						else
 						{
-							check = spimem_read(address, current_command, length);
+							check = spimem_read(address + (j * PUS_POOL_DATA_LENGTH), packet + PUS_POOL_DATA, size);
 							if (check<0)
 							{
+								pus_pool_release(desc);
 								send_tc_execution_verify(0xFF, packet_id, psc);
 								return;
 							}
 						}
-						current_command[146] = MEMORY_DUMP_ABS;
-						current_command[145] = num_transfers - j;
-						xQueueSendToBackTask(MEMORY_TASK_ID, 1, mem_to_obc_fifo, current_command, (TickType_t)1);	// FAILURE_RECOVERY if this doesn't return pdTrue
-						taskYIELD();	// Give the packet router a chance to downlink the dump packet.
+						if(num_transfers == 1)
+							packet[145] = SEQ_FLAG_STANDALONE;
+						else if(!j)
+							packet[145] = SEQ_FLAG_FIRST;
+						else if(j == (num_transfers - 1))
+							packet[145] = SEQ_FLAG_LAST;
+						else
+							packet[145] = SEQ_FLAG_CONT;
+						packet[146] = MEMORY_DUMP_ABS;
+						packet[144] = (uint8_t)((j >> 8) & 0x3F);
+						packet[143] = (uint8_t)(j & 0xFF);
+						if(pus_pool_send(mem_to_obc_fifo, desc, (TickType_t)FDIR_DUMP_WAIT) != pdTRUE)
+						{
+							send_tc_execution_verify(0xFF, packet_id, psc);		// FAILURE_RECOVERY
+							return;
+						}
 					}
 					send_tc_execution_verify(1, packet_id, psc);
+					return;
 				case	CHECK_MEM_REQUEST:
 					if(!memid)
 					{
@@ -1357,16 +1397,7 @@ static void exec_commands(void)
 						}
 						send_tc_execution_verify(1, packet_id, psc);
 					}
-					current_command[146] = MEMORY_CHECK_ABS;
-					current_command[7] = (uint8_t)((check & 0xFF00000000000000) >> 56);
-					current_command[6] = (uint8_t)((check & 0x00FF000000000000) >> 48);
-					current_command[5] = (uint8_t)((check & 0x0000FF0000000000) >> 40);
-					current_command[4] = (uint8_t)((check & 0xFF0000FF00000000) >> 32);
-					current_command[3] = (uint8_t)((check & 0xFF000000FF000000) >> 24);
-					current_command[2] = (uint8_t)((check & 0xFF00000000FF0000) >> 26);
-					current_command[1] = (uint8_t)((check & 0xFF0000000000FF00) >> 8);
-					current_command[0] = (uint8_t)(check & 0x00000000000000FF);
-					xQueueSendToBackTask(MEMORY_TASK_ID, 1, mem_to_obc_fifo, current_command, (TickType_t)1);
+					return;		// The packet router has no MEMORY_CHECK_ABS report to downlink the checksum in.
 				default:
 					return;
 			}
@@ -1673,24 +1704,24 @@ int recreate_fifo(uint8_t task_id, uint8_t direction)
 	{
 		case HK_TASK_ID:
 			if(direction)
-				recreate_fifo_h(hk_to_obc_fifo);
+				recreate_fifo_h(&hk_to_obc_fifo, PUS_POOL_DESC_SIZE);
 			else
-				recreate_fifo_h(obc_to_hk_fifo);
+				recreate_fifo_h(&obc_to_hk_fifo, 147);
 		case TIME_TASK_ID:
 			if(direction)
-				recreate_fifo_h(time_to_obc_fifo);
+				recreate_fifo_h(&time_to_obc_fifo, 10);
 			else
-				recreate_fifo_h(obc_to_time_fifo);
+				recreate_fifo_h(&obc_to_time_fifo, 10);
 		case SCHEDULING_TASK_ID:
 			if(direction)
-				recreate_fifo_h(sched_to_obc_fifo);
+				recreate_fifo_h(&sched_to_obc_fifo, 147);
 			else
-				recreate_fifo_h(obc_to_sched_fifo);
+				recreate_fifo_h(&obc_to_sched_fifo, 147);
 		case MEMORY_TASK_ID:
 			if(direction)
-				recreate_fifo_h(mem_to_obc_fifo);
+				recreate_fifo_h(&mem_to_obc_fifo, PUS_POOL_DESC_SIZE);
 			else
-				recreate_fifo_h(obc_to_mem_fifo);
+				recreate_fifo_h(&obc_to_mem_fifo, 147);
 		default:
 			enter_SAFE_MODE(ERROR_IN_RS5);
 				return -1;		// SAFE_MODE ?
@@ -1698,11 +1729,10 @@ int recreate_fifo(uint8_t task_id, uint8_t direction)
 	return 1;
 }
 
-int recreate_fifo_h(QueueHandle_t *queue_to_recreate)
+int recreate_fifo_h(QueueHandle_t *queue_to_recreate, UBaseType_t item_size)
 {
-	UBaseType_t fifo_length, item_size;
+	UBaseType_t fifo_length;
 	fifo_length = 4;
-	item_size = 147;
 	uint8_t counter;
 	if(!*queue_to_recreate)		// FIFO got deleted somehow.
 	{
@@ -1894,9 +1924,8 @@ static void enter_SAFE_MODE(uint8_t reason)
 static void time_update(void)
 {
 	uint32_t report_timeout = 60;	// Produce a time report once every 60 minutes.
-	if (rtc_triggered_a2())
+	if (rtc_triggered_a2() && (rtc_get(&time) > 0))		// Try again next time if SPI0 was busy.
 	{
-		rtc_get(&time);
 		minute_count++;
 		if(minute_count == report_timeout)
 		report_time();
@@ -1954,7 +1983,7 @@ void exit_INTERNAL_MEMORY_FALLBACK(void)
 	EVENT_BASE		=	0x0E000;	// EVENT = 8kB: 0x0E000 - 0x0FFFF
 	SCHEDULE_BASE	=	0x10000;	// SCHEDULE = 8kB: 0x10000 - 0x11FFF
 	SCIENCE_BASE	=	0x12000;	// SCIENCE = 8kB: 0x12000 - 0x13FFF
-	TIME_BASE		=	0xFFFFC;	// TIME = 4B: 0xFFFFC - 0xFFFFF
+	TIME_BASE		=	0xBFFFC;	// TIME = 4B: 0xBFFFC - 0xBFFFF (top of the logical SPI memory space)
 	MAX_SCHED_COMMANDS = 511;
 	LENGTH_OF_HK	= 8192;
 	send_event_report(1, INTERNAL_MEMORY_FALLBACK_EXITED, 0, 0);
@@ -46,6 +46,22 @@
 	*	11/25/2015			Adding some the definitions that have been created since I started
 	*						working on the groundstation.
 	*
+	*	10/16/2026			Added WASH_BASE, where the memory wash keeps its cursor.
+	*
+	*						Added SPI_UPSETS1/2/3 and WASH_RATE (memory wash statistics).
+	*
+	*						Added the PUS sequence flags (SEQ_FLAG_*) used by multi-packet memory dumps.
+	*
+	*						Added the MEMORY_LOAD_FAILED event.
+	*
+	*						Added CHECKSUM_BASE, where the checksum index keeps its page digests.
+	*
+	*						Added EDAC_BASE (ECC of the protected regions) and the EDAC_UNCORRECTABLE event.
+	*
+	*						Added opr_wake_sem, the packet router blocks on it instead of polling its FIFOs.
+	*
+	*						Removed tm_buffer (replaced by the TM queues of tm_sched.c).
+	*
 */
 
 #ifndef GLOBAL_VARH
@@ -96,6 +112,11 @@
 #define MEMORY_DUMP_ABS					6
 #define CHECK_MEM_REQUEST				9
 #define MEMORY_CHECK_ABS				10
+/* PUS sequence flags (packet header) */
+#define SEQ_FLAG_CONT					0x0		// Continuation packet.
+#define SEQ_FLAG_FIRST					0x1
+#define SEQ_FLAG_LAST					0x2
+#define SEQ_FLAG_STANDALONE				0x3
 /* K-Service							*/
 #define ADD_SCHEDULE					1
 #define CLEAR_SCHEDULE					2
@@ -175,6 +196,8 @@
 #define COMMAND_NOT_SCHEDULABLE			0x2B
 #define TM_BUFFER_HALF_FULL				0x2C
 #define TC_BUFFER_HALF_FULL				0x2D
+#define MEMORY_LOAD_FAILED				0x2E			// A memory load session failed to write or verify.
+#define EDAC_UNCORRECTABLE				0x2F			// A protected SPI memory page had more bad bytes than its ECC corrects.
 
 /*  CAN GLOBAL FIFOS				*/
 /* Initialized in prvInitializeFifos() in main.c	*/
@@ -210,8 +233,10 @@ QueueHandle_t sched_to_memory_fifo;		// scheduling			-->		housekeep
 QueueHandle_t high_sev_to_fdir_fifo;	// Any task				-->		fdir
 QueueHandle_t low_sev_to_fdir_fifo;		// Any task				-->		fdir
 
-QueueHandle_t tc_buffer;
-QueueHandle_t tm_buffer;
+QueueHandle_t tc_buffer;				// Complete TCs waiting to be decoded by the packet router (152B items).
+
+/* Given after sending to tc_msg_fifo or to a FIFO which leads to the packet router, which blocks on it */
+SemaphoreHandle_t opr_wake_sem;
 
 /* MUTEX LOCKS FOR ERROR HANDLING FIFOs	*/
 SemaphoreHandle_t Highsev_Mutex;
@@ -280,6 +305,8 @@ uint8_t antenna_deploy;
 
 /* Global variables for indicating SPI Chip health */
 uint8_t SPI_HEALTH1, SPI_HEALTH2, SPI_HEALTH3;
+uint32_t SPI_UPSETS1, SPI_UPSETS2, SPI_UPSETS3;		// Bits corrected on each chip by the memory wash.
+uint32_t WASH_RATE;									// Pages the memory wash covers per wake-up.
 
 uint32_t time_of_deploy;
 
@@ -294,6 +321,7 @@ TaskHandle_t pay_HANDLE;
 TaskHandle_t scheduling_HANDLE;
 TaskHandle_t fdir_HANDLE;
 TaskHandle_t wdt_reset_HANDLE;
+TaskHandle_t spimem_server_HANDLE;
 
 /* Global variable for determining whether scheduled operations are currently running */
 uint8_t scheduling_on;
@@ -318,7 +346,10 @@ uint32_t	SCIENCE_BASE;		// SCIENCE = 256kB: 0x24000 - 0x63FFF
 uint32_t	TM_BASE;			// TM = 128kB: 0x64000 - 0x83FFF
 uint32_t	TC_BASE;			// TC = 128kB: 0x84000 - 0xA3FFF
 uint32_t	DIAG_BASE;			// DIAGNOSTICS = 8kB: 0xA4000 - 0xA5FFF
-uint32_t	TIME_BASE;			// TIME = 4B: 0xFFFFC - 0xFFFFF
+uint32_t	CHECKSUM_BASE;		// CHECKSUM = 24kB: 0xA6000 - 0xABFFF (page digests, spimem_index.c)
+uint32_t	EDAC_BASE;			// EDAC = 12kB: 0xAC000 - 0xAEFFF (ECC records, spimem_edac.c)
+uint32_t	WASH_BASE;			// WASH = 4B: 0xBFFF8 - 0xBFFFB (memory wash cursor)
+uint32_t	TIME_BASE;			// TIME = 4B: 0xBFFFC - 0xBFFFF
 
 /* Limits for task operations */
 uint32_t	MAX_SCHED_COMMANDS;
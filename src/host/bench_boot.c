@@ -0,0 +1,110 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_boot.c
+*
+*	PURPOSE:		Boot time of the SPI memory stack (user-007): spimem_initialize() mounting the
+*					chips at several fill levels, against the chip erase it used to do on every reset
+*					(ERASE_SPIMEM_ON_RESET = 1).
+*
+*	FILE REFERENCES:		host_test.h, spimem.h, spimem_ftl.h, string.h
+*
+*	EXTERNAL VARIABLES:		spi_bit_map (spimem.h)
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if data doesn't
+*					survive the reset or if a written page comes back clean in spi_bit_map.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The time is host_test_reset(), i.e. from spi_initialize() until the scheduler
+*				starts. The erase row is a mount of blank chips followed by spimem_ftl_format_h(),
+*				which is the ERASE_SPIMEM_ON_RESET path. nor_sim's chip erase takes 3s, the data
+*				sheet allows up to 7s.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "spimem.h"
+#include "spimem_ftl.h"
+#include "host_test.h"
+
+static uint8_t data[256], check[256];
+
+static uint32_t dirty_pages(void)
+{
+	uint32_t i, count = 0;
+
+	for(i = 0; i < 128 * 32; i++)
+		count += (spi_bit_map[i >> 5] >> (i & 31)) & 1;
+	return count;
+}
+
+static void fill(uint32_t percent)
+{
+	uint32_t i, pages = FTL_LOGICAL_PAGES * percent / 100;
+
+	for(i = 0; i < pages; i++)
+	{
+		data[0] = (uint8_t)i;
+		data[1] = (uint8_t)(i >> 8);
+		spimem_write(i << 8, data, 256);
+	}
+	spimem_cache_flush();
+	return;
+}
+
+static void boot(uint32_t percent)
+{
+	char name[32];
+	uint64_t start, us;
+	uint32_t pages = FTL_LOGICAL_PAGES * percent / 100;
+
+	host_test_open("bench_boot", 0);
+	fill(percent);
+	start = nor_sim_now_us();
+	host_test_reset();
+	us = nor_sim_now_us() - start;
+	snprintf(name, sizeof(name), "mount, %lu%% full", (unsigned long)percent);
+	printf("%-30s %10.1fms %10lu\n", name, us / 1000.0, (unsigned long)dirty_pages());
+	HOST_CHECK(dirty_pages() >= pages);
+	if(pages)
+	{
+		spimem_read((pages - 1) << 8, check, 256);
+		HOST_CHECK(check[0] == (uint8_t)(pages - 1) && check[1] == (uint8_t)((pages - 1) >> 8));
+	}
+	host_test_close();
+	return;
+}
+
+int main(void)
+{
+	uint64_t start, us;
+
+	memset(data, 0x3C, sizeof(data));
+	printf("bench_boot: spi_initialize() to scheduler start, simulated time\n");
+	printf("%-30s %12s %10s\n", "", "boot", "dirty pages");
+
+	host_test_open("bench_boot", 0);
+	fill(50);
+	start = nor_sim_now_us();
+	host_test_reset();
+	xSemaphoreTake(Spi0_Mutex, portMAX_DELAY);
+	spimem_ftl_format_h();
+	xSemaphoreGive(Spi0_Mutex);
+	us = nor_sim_now_us() - start;
+	printf("%-30s %10.1fms %10s\n", "chip erase (old)", us / 1000.0, "lost");
+	host_test_close();
+
+	boot(0);
+	boot(50);
+	boot(100);
+	return host_test_failures ? 1 : 0;
+}
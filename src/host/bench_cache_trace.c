@@ -0,0 +1,212 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_cache_trace.c
+*
+*	PURPOSE:		Trace replay for the page cache (user-008): one hour of the SPI memory accesses
+*					made by the payload, FDIR, scheduling, time and housekeeping tasks, with the cache
+*					and with every access going to the FTL.
+*
+*	FILE REFERENCES:		host_test.h, spimem.h, spimem_cache.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if an access fails, if
+*					the two runs leave different data in SPI memory or if the cache saves nothing.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The accesses are the ones the tasks make, at these rates:
+*
+*					every 1s	store_science() (payload.c): read the offset at SCIENCE_BASE, write
+*								type, time stamp and a 10/16/144B sample, write the offset back.
+*					every 10s	check_schedule() (scheduling.c): voted read of the command count,
+*								read of the first command's time.
+*					every 60s	update_absolute_time() (time_manage.c): 4B at TIME_BASE.
+*								store_diag_in_spimem() (fdir.c): 4B + 1B + 128B record, offset header.
+*					every 600s	add_command_to_end() (scheduling.c): 16B command and the count.
+*					once		set_hk_mem_offset() (housekeep.c) and set_diag_mem_offset() (fdir.c).
+*
+*				The server isn't running, so spimem_cache_flush() is called every
+*				SPIMEM_CACHE_FLUSH_PERIOD ticks the way it would flush an idle cache. In the uncached
+*				run every access is followed by a flush and an invalidate of the whole cache.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "spimem.h"
+#include "spimem_cache.h"
+#include "spimem_ftl.h"
+#include "host_test.h"
+
+#define TRACE_SECONDS		3600
+
+static uint8_t image[2][0x30000];
+static uint8_t uncached;
+static uint32_t trace_science = 4, trace_diag = 4, trace_commands, trace_failures;
+
+static void bypass_cache(void)
+{
+	if(!uncached)
+		return;
+	xSemaphoreTake(Spi0_Mutex, portMAX_DELAY);
+	spimem_cache_flush_h(0, SPIMEM_LOGICAL_SIZE);
+	spimem_cache_invalidate_h(0, SPIMEM_LOGICAL_SIZE);
+	xSemaphoreGive(Spi0_Mutex);
+	return;
+}
+
+static void trace_read(uint32_t addr, uint8_t* buff, uint32_t size, uint8_t voted)
+{
+	if((voted ? spimem_read_voted(addr, buff, size) : spimem_read(addr, buff, size)) != (int)size)
+		trace_failures++;
+	bypass_cache();
+	return;
+}
+
+static void trace_write(uint32_t addr, uint8_t* buff, uint32_t size)
+{
+	if(spimem_write(addr, buff, size) != (int)size)
+		trace_failures++;
+	bypass_cache();
+	return;
+}
+
+static void put_offset(uint8_t* buff, uint32_t offset)
+{
+	buff[0] = (uint8_t)(offset >> 24);
+	buff[1] = (uint8_t)(offset >> 16);
+	buff[2] = (uint8_t)(offset >> 8);
+	buff[3] = (uint8_t)offset;
+	return;
+}
+
+static void trace_science_sample(uint32_t t)
+{
+	static const uint32_t sizes[3] = {10, 16, 144};
+	uint8_t header[5], sample[144], offset[4];
+	uint32_t size = sizes[t % 3];
+
+	memset(sample, (uint8_t)t, sizeof(sample));
+	header[0] = (uint8_t)(0xCC + 0x11 * (t % 3));
+	memcpy(header + 1, &t, 4);
+	trace_read(SCIENCE_BASE, offset, 4, 0);
+	trace_write(SCIENCE_BASE + trace_science, header, 1);
+	trace_write(SCIENCE_BASE + trace_science + 1, header + 1, 4);
+	trace_write(SCIENCE_BASE + trace_science + 5, sample, size);
+	trace_science += 5 + size;
+	put_offset(offset, trace_science);
+	trace_write(SCIENCE_BASE, offset, 4);
+	return;
+}
+
+static void check_schedule(void)
+{
+	uint8_t temp[4];
+
+	trace_read(SCHEDULE_BASE, temp, 4, 1);
+	trace_read(SCHEDULE_BASE + 4, temp, 4, 0);
+	return;
+}
+
+static void add_command(uint32_t t)
+{
+	uint8_t command[16], count[4];
+
+	memset(command, (uint8_t)t, sizeof(command));
+	trace_write(SCHEDULE_BASE + 4 + trace_commands * 16, command, 16);
+	trace_commands++;
+	put_offset(count, trace_commands);
+	trace_write(SCHEDULE_BASE, count, 4);
+	return;
+}
+
+static void store_diag(uint32_t t)
+{
+	uint8_t diag[128], sid = 1, offset[4];
+
+	memset(diag, (uint8_t)t, sizeof(diag));
+	trace_write(DIAG_BASE + trace_diag, (uint8_t*)&t, 4);
+	trace_write(DIAG_BASE + trace_diag + 4, &sid, 1);
+	trace_write(DIAG_BASE + trace_diag + 5, diag, 128);
+	trace_diag = (trace_diag + 137) % 16384;
+	if(trace_diag < 4)
+		trace_diag = 4;
+	put_offset(offset, trace_diag);
+	trace_write(DIAG_BASE, offset, 4);
+	return;
+}
+
+static uint64_t replay(const char* name)
+{
+	nor_sim_stats_t stats;
+	uint8_t temp[4] = {0, 0, 0, 4};
+	uint32_t t, hits, misses, saved;
+
+	host_test_open("bench_cache_trace", 0);
+	trace_science = 4;
+	trace_diag = 4;
+	trace_commands = 0;
+	nor_sim_reset_stats();
+	hits = spimem_cache_stat(SPIMEM_CACHE_STAT_HITS);
+	misses = spimem_cache_stat(SPIMEM_CACHE_STAT_MISSES);
+	saved = spimem_cache_stat(SPIMEM_CACHE_STAT_SAVED);
+
+	trace_read(HK_BASE, temp, 4, 0);
+	temp[3] = 4;
+	trace_write(HK_BASE + 3, temp + 3, 1);
+	trace_read(DIAG_BASE, temp, 4, 0);
+	trace_write(DIAG_BASE + 3, temp + 3, 1);
+	for(t = 0; t < TRACE_SECONDS; t++)
+	{
+		trace_science_sample(t);
+		if(!(t % 10))
+			check_schedule();
+		if(!(t % 60))
+		{
+			trace_write(TIME_BASE, (uint8_t*)&t, 4);
+			store_diag(t);
+		}
+		if(!(t % 600))
+			add_command(t);
+		if(!((t * 1000) % SPIMEM_CACHE_FLUSH_PERIOD))
+			spimem_cache_flush();
+		vTaskDelay(1000);
+	}
+	spimem_cache_flush();
+
+	nor_sim_get_stats(&stats);
+	hits = spimem_cache_stat(SPIMEM_CACHE_STAT_HITS) - hits;
+	misses = spimem_cache_stat(SPIMEM_CACHE_STAT_MISSES) - misses;
+	saved = spimem_cache_stat(SPIMEM_CACHE_STAT_SAVED) - saved;
+	printf("%-12s %10llu %10llu %10llu %8.1f%% %10lu\n", name, (unsigned long long)stats.reads,
+		(unsigned long long)stats.programs, (unsigned long long)stats.sect_erases,
+		(hits + misses) ? 100.0 * hits / (hits + misses) : 0.0, (unsigned long)saved);
+
+	spimem_read_stream(0, image[uncached], sizeof(image[0]));
+	host_test_close();
+	return stats.reads + stats.programs;
+}
+
+int main(void)
+{
+	uint64_t flash_ops;
+
+	printf("bench_cache_trace: %d s of task accesses, %d cache entries\n", TRACE_SECONDS, SPIMEM_CACHE_ENTRIES);
+	printf("%-12s %10s %10s %10s %9s %10s\n", "", "RD cmds", "programs", "erases", "hit rate", "saved");
+	uncached = 1;
+	flash_ops = replay("uncached");
+	uncached = 0;
+	HOST_CHECK(replay("cached") < flash_ops);
+	HOST_CHECK(!trace_failures);
+	HOST_CHECK(!memcmp(image[0], image[1], sizeof(image[0])));
+	return host_test_failures ? 1 : 0;
+}
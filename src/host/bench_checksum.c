@@ -0,0 +1,121 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_checksum.c
+*
+*	PURPOSE:		Micro-benchmark of the PUS packet error control (user-018): the Fletcher-16 with
+*					two modulo 255 per byte against fletcher16() with its deferred reduction, and a bit
+*					at a time CRC-16-CCITT against the table driven crc16_ccitt(), over the 150 bytes
+*					of a TM packet which the PEC covers and over a 4kB buffer.
+*
+*	FILE REFERENCES:		host_test.h, checksum.h, time.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a new checksum
+*					differs from the old one, or if it isn't faster than the old one.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		Unlike the other benchmarks this one is host CPU time (clock()), there is nothing
+*				to simulate. The ratios are the host's, on the OBC each modulo 255 is a UDIV (2 to
+*				12 cycles) and an MLS, which the deferred reduction takes out of the byte loop.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <time.h>
+#include "checksum.h"
+#include "host_test.h"
+
+#define BENCH_BYTES		(64 * 1024 * 1024)		// Per case.
+
+typedef uint16_t (*checksum_fn_t)(uint8_t* data, int count);
+
+static uint32_t buff_words[1024];
+static uint8_t* buff = (uint8_t*)buff_words;
+static volatile uint16_t sink;
+
+/* fletcher16() before user-018. */
+static uint16_t old_fletcher16(uint8_t* data, int count)
+{
+	uint16_t sum1 = 0;
+	uint16_t sum2 = 0;
+	int index;
+
+	for(index = 0; index < count; ++index)
+	{
+		sum1 = (sum1 + data[index]) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+	return (sum2 << 8) | sum1;
+}
+
+/* CRC-16-CCITT one bit at a time, what a CRC PEC costs without the table. */
+static uint16_t bitwise_crc16(uint8_t* data, int count)
+{
+	uint16_t crc = 0xFFFF;
+	int i, bit;
+
+	for(i = 0; i < count; i++)
+	{
+		crc ^= (uint16_t)data[i] << 8;
+		for(bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+	}
+	return crc;
+}
+
+/* Checksums BENCH_BYTES in pieces of size bytes (changing one byte each time). Returns the MB/s. */
+static double measure(checksum_fn_t fn, uint8_t* data, uint32_t size)
+{
+	uint32_t i, runs = BENCH_BYTES / size;
+	clock_t start;
+	double secs;
+
+	start = clock();
+	for(i = 0; i < runs; i++)
+	{
+		data[0] = (uint8_t)i;
+		sink = fn(data, (int)size);
+	}
+	secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+	return (double)runs * size / 1e6 / secs;
+}
+
+/* One row: old and new over the same data, checked against each other first. */
+static void compare(const char* name, checksum_fn_t old_fn, checksum_fn_t new_fn, uint8_t* data, uint32_t size)
+{
+	double old_rate, new_rate;
+
+	HOST_CHECK(new_fn(data, (int)size) == old_fn(data, (int)size));
+	old_rate = measure(old_fn, data, size);
+	new_rate = measure(new_fn, data, size);
+	printf("%-28s %10.1f %10.1f %8.1fx\n", name, old_rate, new_rate, new_rate / old_rate);
+	HOST_CHECK(new_rate > old_rate);
+	return;
+}
+
+int main(void)
+{
+	uint32_t i;
+
+	for(i = 0; i < sizeof(buff_words); i++)
+		buff[i] = (uint8_t)((i * 131) ^ (i >> 5));
+
+	printf("bench_checksum: packet error control, host CPU time\n");
+	printf("%-28s %10s %10s %9s\n", "", "old MB/s", "new MB/s", "speedup");
+	compare("fletcher16, 150B packet", old_fletcher16, fletcher16, buff + 2, 150);
+	compare("fletcher16, 150B unaligned", old_fletcher16, fletcher16, buff + 3, 150);
+	compare("fletcher16, 4kB", old_fletcher16, fletcher16, buff, 4096);
+	compare("crc16_ccitt, 150B packet", bitwise_crc16, crc16_ccitt, buff + 2, 150);
+	compare("crc16_ccitt, 4kB", bitwise_crc16, crc16_ccitt, buff, 4096);
+	return host_test_failures ? 1 : 0;
+}
@@ -0,0 +1,248 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_dump.c
+*
+*	PURPOSE:		Memory dump throughput in bytes/s (user-015): a 32KB region of SPI memory is dumped
+*					to the simulated COMS SSM, with the old dump (one 128B read, then the packet) and
+*					with dump_memory(). The packets are checked on the way out: sequence
+*					flags, sequence counts, addresses and data, also for a dump resumed from an offset.
+*
+*	FILE REFERENCES:		host_test.h, obc_sim.h, rtos_sim.h, router_sim.h, spimem_cache.h,
+*							memory_manage.c (build/src), string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a packet is wrong,
+*					missing or out of order, or if dump_memory() leaves the downlink idle for more
+*					than 1% of the time.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The memory task is main(). The packet router is an rtos_sim event which takes a dump
+*				packet off mem_to_obc_fifo and sends it with the router's send_pus_packet_tm() (see
+*				router_sim.h), then comes back once the transfer is over, plus OPR_TM_PACE for the
+*				paced links, which is what the router waits between TM packets in flight. With
+*				nothing to send it looks again every tick, and that time counts as idle while the
+*				dump is running. Some idle time is unavoidable: the router is ready before the
+*				first read of the dump has finished.
+*
+*				The links without the pace show how fast the dump can go once the router no longer
+*				waits on COMS, the one with 1% frame loss how it copes with retransmissions.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*	10/16/2026			dump_memory() no longer reads ahead, the "new" columns are its synchronous loop.
+*
+*/
+
+#include <string.h>
+#include "memory_manage.c"
+#include "spimem_cache.h"
+#include "rtos_sim.h"
+#include "obc_sim.h"
+#include "router_sim.h"
+#include "host_test.h"
+
+#define DUMP_BYTES			(32 * 1024)
+#define DUMP_PACKETS		(DUMP_BYTES / DUMP_PACKET)
+#define RESUME_OFFSET		((100 * DUMP_PACKET) + 17)		// Rounded down to packet 100.
+#define ROUTER_POLL_US		1000
+#define ROUTER_RETRY_US		10000						// OPR_RETRY_WAIT
+#define DRAIN_US			60000000
+
+typedef struct
+{
+	const char* name;
+	uint8_t windowed;
+	uint8_t paced;
+	double loss;
+} dump_link_t;
+
+typedef int (*dump_fn_t)(uint8_t memid, uint32_t address, uint32_t length, uint32_t offset);
+
+static uint8_t reference[DUMP_BYTES];
+static const dump_link_t* cur_link;
+static uint32_t link_pace_us;
+static uint8_t link_desc;
+static uint8_t dump_running;
+static uint64_t link_idle_us, last_rx_us;
+static uint32_t rx_next, rx_count, rx_failures;
+
+/* The dump before user-015: each 128B packet read on its own, then handed to the router. */
+static int old_dump(uint8_t memid, uint32_t address, uint32_t length, uint32_t offset)
+{
+	uint8_t buff[DUMP_PACKET];
+	uint32_t pos, size, index = offset / DUMP_PACKET;
+
+	for(pos = index * DUMP_PACKET; pos < length; pos += DUMP_PACKET)
+	{
+		size = ((length - pos) < DUMP_PACKET) ? (length - pos) : DUMP_PACKET;
+		if(spimem_read(address + pos, buff, size) != (int)size)
+			return -1;
+		if(dump_send_packet(buff, size, index++, DUMP_PACKETS, address + pos) < 0)
+			return -1;
+	}
+	return length - offset;
+}
+
+/* A packet as it reached COMS: the next one in the sequence, with the right flags, address and data. */
+static void check_packet(const uint8_t* packet)
+{
+	uint32_t index, addr, size;
+	uint8_t flags;
+
+	index = ((uint32_t)packet[144] << 8) | packet[143];
+	addr = ((uint32_t)packet[135] << 24) | ((uint32_t)packet[134] << 16) | ((uint32_t)packet[133] << 8) | packet[132];
+	if(!index)
+		flags = SEQ_FLAG_FIRST;
+	else if(index == DUMP_PACKETS - 1)
+		flags = SEQ_FLAG_LAST;
+	else
+		flags = SEQ_FLAG_CONT;
+	size = DUMP_PACKET;
+	HOST_CHECK(packet[146] == MEMORY_DUMP_ABS);
+	HOST_CHECK(index == rx_next);
+	HOST_CHECK(packet[145] == flags);
+	HOST_CHECK(addr == TM_BASE + (index * DUMP_PACKET));
+	if(index < DUMP_PACKETS)
+		HOST_CHECK(!memcmp(packet + PUS_POOL_DATA, reference + (index * DUMP_PACKET), size));
+	rx_next = index + 1;
+	rx_count++;
+	return;
+}
+
+/* The packet router: one dump packet to COMS, then back after the transfer (and the pace). */
+static void router_event(void* arg)
+{
+	uint8_t sent[PACKET_LENGTH];
+	uint64_t start, busy;
+	int ret;
+
+	if(link_desc == PUS_POOL_NONE)
+	{
+		if(xQueueReceive(mem_to_obc_fifo, &link_desc, (TickType_t)0) != pdTRUE)
+		{
+			link_desc = PUS_POOL_NONE;
+			if(dump_running)
+				link_idle_us += ROUTER_POLL_US;
+			rtos_sim_at(nor_sim_now_us() + ROUTER_POLL_US, router_event, 0);
+			return;
+		}
+	}
+	memcpy(sent, pus_pool_buf(link_desc), PACKET_LENGTH);
+	start = coms_sim_now_us();
+	if(cur_link->windowed)
+		ret = router_sim_windowed_send_tm(link_desc);
+	else
+		ret = router_sim_send_tm(link_desc);
+	busy = coms_sim_now_us() - start;
+	if(ret < 0)
+	{
+		rx_failures++;							// Tried again, like tm_down_fullf.
+		busy += ROUTER_RETRY_US;
+	}
+	else
+	{
+		HOST_CHECK(!memcmp(coms_sim_packet(), sent, PACKET_LENGTH));
+		check_packet(sent);
+		link_desc = PUS_POOL_NONE;
+		last_rx_us = nor_sim_now_us() + busy;
+		busy += link_pace_us;
+	}
+	rtos_sim_at(nor_sim_now_us() + busy, router_event, 0);
+	return;
+}
+
+/* Fresh chips holding the region, and a link with nothing in flight. */
+static void setup(const dump_link_t* l)
+{
+	coms_sim_config_t config;
+	uint32_t i;
+
+	host_test_open("bench_dump", 0);
+	for(i = 0; i < DUMP_BYTES; i++)
+		reference[i] = (uint8_t)((i * 131) ^ (i >> 8));
+	for(i = 0; i < DUMP_BYTES; i += 256)
+		spimem_write(TM_BASE + i, reference + i, 256);
+	spimem_cache_flush();
+
+	cur_link = l;
+	coms_sim_default_config(&config);
+	config.loss = l->loss;
+	if(l->windowed)
+	{
+		router_sim_windowed_open(&config);
+		link_pace_us = l->paced ? router_sim_windowed_tm_pace() * 1000 : 0;
+	}
+	else
+	{
+		router_sim_open(&config);
+		link_pace_us = l->paced ? router_sim_tm_pace() * 1000 : 0;
+	}
+	link_desc = PUS_POOL_NONE;
+	link_idle_us = 0;
+	rx_count = 0;
+	rx_failures = 0;
+	rtos_sim_at(nor_sim_now_us(), router_event, 0);
+	return;
+}
+
+/* Dumps the region from offset and waits until COMS has it all. Returns the bytes/s. */
+static double run(const dump_link_t* l, dump_fn_t dump, uint32_t offset, uint64_t* idle_us)
+{
+	uint64_t start, deadline;
+	uint32_t first = offset / DUMP_PACKET;
+
+	setup(l);
+	rx_next = first;
+	start = nor_sim_now_us();
+	dump_running = 1;
+	HOST_CHECK(dump(1, TM_BASE, DUMP_BYTES, offset) == (int)(DUMP_BYTES - first * DUMP_PACKET));
+	dump_running = 0;
+	deadline = nor_sim_now_us() + DRAIN_US + (uint64_t)DUMP_PACKETS * link_pace_us;
+	while((rx_count < DUMP_PACKETS - first) && (nor_sim_now_us() < deadline))
+		rtos_sim_run_until(nor_sim_now_us() + ROUTER_POLL_US);
+	HOST_CHECK(rx_count == DUMP_PACKETS - first);
+	HOST_CHECK(rx_next == DUMP_PACKETS);
+	*idle_us = link_idle_us;
+	host_test_close();
+	return (double)(DUMP_BYTES - first * DUMP_PACKET) * 1e6 / (double)(last_rx_us - start);
+}
+
+int main(void)
+{
+	static const dump_link_t links[] = {
+		{"legacy, paced", 0, 1, 0.0},
+		{"windowed, paced", 1, 1, 0.0},
+		{"legacy", 0, 0, 0.0},
+		{"windowed", 1, 0, 0.0},
+		{"windowed, 1% loss", 1, 0, 0.01},
+	};
+	uint64_t old_idle, new_idle;
+	double old_rate, new_rate, total_us;
+	uint32_t i;
+
+	printf("bench_dump: %dKB from SPI memory to the simulated COMS SSM, simulated time\n", DUMP_BYTES / 1024);
+	printf("%-20s %12s %10s %12s %10s\n", "link", "old B/s", "old idle", "new B/s", "new idle");
+	for(i = 0; i < sizeof(links) / sizeof(links[0]); i++)
+	{
+		old_rate = run(&links[i], old_dump, 0, &old_idle);
+		new_rate = run(&links[i], dump_memory, 0, &new_idle);
+		printf("%-20s %12.1f %8.1fms %12.1f %8.1fms\n", links[i].name, old_rate, old_idle / 1e3, new_rate,
+			new_idle / 1e3);
+		total_us = (double)DUMP_BYTES * 1e6 / new_rate;
+		HOST_CHECK(new_idle <= total_us / 100);
+	}
+
+	new_rate = run(&links[3], dump_memory, RESUME_OFFSET, &new_idle);
+	printf("resumed at %u (packet %u of %u) over \"%s\": %.1f B/s, sequence checked\n", RESUME_OFFSET,
+		RESUME_OFFSET / DUMP_PACKET, DUMP_PACKETS, links[3].name, new_rate);
+	return host_test_failures ? 1 : 0;
+}
@@ -0,0 +1,375 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_edac.c
+*
+*	PURPOSE:		Benchmark of the Reed-Solomon EDAC (user-020): encode and decode MB/s of edac.c
+*					against a byte at a time LFSR, the share of pages corrected under random bit flips,
+*					and spimem_edac_scrub() keeping two protected regions intact on the simulated chips
+*					with only one chip left in service.
+*
+*	FILE REFERENCES:		host_test.h, edac.h, spimem.h, spimem_edac.h, spimem_ftl.h, spimem_cache.h,
+*							string.h, time.h
+*
+*	EXTERNAL VARIABLES:		SPI_HEALTH1, SPI_HEALTH2, DIAG_BASE, SCHEDULE_BASE
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if edac.c's parity
+*					differs from the LFSR's, the table encode isn't faster than the LFSR, a page with
+*					up to RS_T flipped bits isn't corrected, a page which can't be corrected is changed,
+*					or a protected byte is wrong after the scrub passes.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The codec rows are host CPU time (clock()), the scrub passes simulated time.
+*
+*				Under flips, a page is "corrected" when page and ECC are back as they were,
+*				"detected" when edac_decode_page() refused it and "miscorrected" when it returned
+*				something else. The flips are spread over the 256B page and its 28B of ECC.
+*
+*				For the scrub, chips 1 and 2 are failed and taken out of service the way the wash
+*				would, then every pass flips bits in the copies of protected pages on chip 3 (found
+*				through the FTL's summary pages) and calls spimem_edac_scrub() once per slot.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include <time.h>
+#include "edac.h"
+#include "spimem.h"
+#include "spimem_edac.h"
+#include "spimem_ftl.h"
+#include "spimem_cache.h"
+#include "host_test.h"
+
+#define BENCH_PAGES			200000				// Per codec row.
+#define FLIP_TRIALS			20000				// Pages per flip count.
+#define SCRUB_PASSES		50
+#define SCRUB_FLIPS			20					// Bits flipped on chip 3 before each pass.
+#define SCRUB_SLOTS			(3 * 64 + 3 * 32 + 64 + 1)	// Slots in edac_regions[] (spimem_edac.c).
+#define RS_T				(RS_PARITY / 2)
+
+typedef struct
+{
+	uint32_t* base;
+	uint32_t size;
+} scrub_region_t;
+
+static uint8_t gf_exp[512], gf_log[256];
+static uint8_t rs_gen[RS_PARITY];				// g(x) less its leading 1, rs_gen[0] is the coefficient of x^13.
+static uint8_t page[256], ecc[EDAC_PAGE_PARITY], ref_ecc[EDAC_PAGE_PARITY];
+static uint8_t good_page[256], good_ecc[EDAC_PAGE_PARITY];
+static uint8_t region_data[0x6000];
+static uint32_t rng_state = 1;
+static volatile uint32_t sink;
+
+static uint32_t rng(void)
+{
+	rng_state = rng_state * 1103515245 + 12345;
+	return rng_state >> 8;
+}
+
+static uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+	if(!a || !b)
+		return 0;
+	return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+/* GF(2^8) over 0x11D and g(x) = (x + a^0)...(x + a^13), worked out here rather than taken from edac.c. */
+static void gf_setup(void)
+{
+	uint8_t g[RS_PARITY + 1];
+	uint32_t i, j, x = 1;
+
+	for(i = 0; i < 255; i++)
+	{
+		gf_exp[i] = gf_exp[i + 255] = (uint8_t)x;
+		gf_log[x] = (uint8_t)i;
+		x <<= 1;
+		if(x & 0x100)
+			x ^= 0x11D;
+	}
+	memset(g, 0, sizeof(g));
+	g[0] = 1;										// g[k] is the coefficient of x^k.
+	for(i = 0; i < RS_PARITY; i++)
+	{
+		for(j = i + 1; j > 0; j--)
+			g[j] = g[j - 1] ^ gf_mul(g[j], gf_exp[i]);
+		g[0] = gf_mul(g[0], gf_exp[i]);
+	}
+	for(i = 0; i < RS_PARITY; i++)
+		rs_gen[i] = g[RS_PARITY - 1 - i];
+	return;
+}
+
+/* The encoder without tables: an LFSR which takes a byte at a time, 14 field multiplications each. */
+static void lfsr_encode_page(uint8_t* data, uint8_t* parity)
+{
+	uint8_t rem[RS_PARITY], fb;
+	uint32_t c, i, k;
+
+	for(c = 0; c < EDAC_INTERLEAVE; c++)
+	{
+		memset(rem, 0, sizeof(rem));
+		for(i = c; i < 256; i += EDAC_INTERLEAVE)
+		{
+			fb = data[i] ^ rem[0];
+			for(k = 0; k < RS_PARITY - 1; k++)
+				rem[k] = rem[k + 1] ^ gf_mul(fb, rs_gen[k]);
+			rem[RS_PARITY - 1] = gf_mul(fb, rs_gen[RS_PARITY - 1]);
+		}
+		for(k = 0; k < RS_PARITY; k++)
+			parity[c * RS_PARITY + k] = rem[k];
+	}
+	return;
+}
+
+static void fill_page(void)
+{
+	uint32_t i;
+
+	for(i = 0; i < 256; i++)
+		good_page[i] = (uint8_t)rng();
+	edac_encode_page(good_page, good_ecc);
+	return;
+}
+
+static double rate(clock_t start, uint32_t pages)
+{
+	return (double)pages * 256 / 1e6 / ((double)(clock() - start) / CLOCKS_PER_SEC);
+}
+
+static void bench_encode(double* lfsr, double* table)
+{
+	clock_t start;
+	uint32_t i;
+
+	for(i = 0; i < 1000; i++)
+	{
+		fill_page();
+		lfsr_encode_page(good_page, ref_ecc);
+		HOST_CHECK(!memcmp(ref_ecc, good_ecc, EDAC_PAGE_PARITY));
+	}
+	start = clock();
+	for(i = 0; i < BENCH_PAGES; i++)
+	{
+		good_page[0] = (uint8_t)i;
+		lfsr_encode_page(good_page, ref_ecc);
+		sink = ref_ecc[0];
+	}
+	*lfsr = rate(start, BENCH_PAGES);
+	start = clock();
+	for(i = 0; i < BENCH_PAGES; i++)
+	{
+		good_page[0] = (uint8_t)i;
+		edac_encode_page(good_page, ecc);
+		sink = ecc[0];
+	}
+	*table = rate(start, BENCH_PAGES);
+	return;
+}
+
+/* Decodes BENCH_PAGES pages with bad bytes in each codeword. Returns the MB/s. */
+static double bench_decode(uint32_t bad)
+{
+	clock_t start;
+	uint32_t i, j;
+
+	fill_page();
+	start = clock();
+	for(i = 0; i < BENCH_PAGES; i++)
+	{
+		memcpy(page, good_page, 256);
+		memcpy(ecc, good_ecc, EDAC_PAGE_PARITY);
+		for(j = 0; j < bad * EDAC_INTERLEAVE; j++)
+			page[(j * 37) & 0xFF] ^= (uint8_t)(j + 1);		// j * 37 alternates between the codewords.
+		sink = (uint32_t)edac_decode_page(page, ecc);
+	}
+	HOST_CHECK(sink == bad * EDAC_INTERLEAVE);
+	HOST_CHECK(!memcmp(page, good_page, 256));
+	return rate(start, BENCH_PAGES);
+}
+
+/* Flips distinct bits of page and ECC. */
+static void flip_bits(uint32_t flips)
+{
+	uint32_t bits[32], i, j, bit;
+
+	for(i = 0; i < flips; i++)
+	{
+		do
+		{
+			bit = rng() % ((256 + EDAC_PAGE_PARITY) * 8);
+			for(j = 0; (j < i) && (bits[j] != bit); j++);
+		} while(j < i);
+		bits[i] = bit;
+		if((bit >> 3) < 256)
+			page[bit >> 3] ^= (uint8_t)(1 << (bit & 7));
+		else
+			ecc[(bit >> 3) - 256] ^= (uint8_t)(1 << (bit & 7));
+	}
+	return;
+}
+
+static void bench_flips(uint32_t flips)
+{
+	uint8_t hit_page[256], hit_ecc[EDAC_PAGE_PARITY];
+	uint32_t i, corrected = 0, detected = 0, miscorrected = 0;
+	int ret;
+
+	for(i = 0; i < FLIP_TRIALS; i++)
+	{
+		fill_page();
+		memcpy(page, good_page, 256);
+		memcpy(ecc, good_ecc, EDAC_PAGE_PARITY);
+		flip_bits(flips);
+		memcpy(hit_page, page, 256);
+		memcpy(hit_ecc, ecc, EDAC_PAGE_PARITY);
+		ret = edac_decode_page(page, ecc);
+		if(ret < 0)
+		{
+			detected++;
+			HOST_CHECK(!memcmp(page, hit_page, 256) && !memcmp(ecc, hit_ecc, EDAC_PAGE_PARITY));
+		}
+		else if(!memcmp(page, good_page, 256) && !memcmp(ecc, good_ecc, EDAC_PAGE_PARITY))
+			corrected++;
+		else
+			miscorrected++;
+	}
+	printf("%6u %11.2f%% %9.2f%% %12.2f%%\n", flips, 100.0 * corrected / FLIP_TRIALS, 100.0 * detected / FLIP_TRIALS,
+		100.0 * miscorrected / FLIP_TRIALS);
+	if(flips <= RS_T)
+		HOST_CHECK(corrected == FLIP_TRIALS);
+	return;
+}
+
+/* Physical address on chip 3 of the current copy of a logical page, from the summary pages. */
+static uint32_t phys_page(uint32_t lpn)
+{
+	uint8_t* mem = nor_sim_memory(3);
+	uint8_t* rec;
+	uint32_t sect, p, seq, best_seq = 0, best = 0;
+	uint8_t found = 0;
+
+	for(sect = 0; sect < FTL_NUM_SECTS; sect++)
+	{
+		for(p = 0; p < FTL_DATA_PAGES; p++)
+		{
+			rec = mem + (sect << 12) + (FTL_SUMMARY_PAGE << 8) + p * FTL_REC_SIZE;
+			if(((uint32_t)rec[FTL_REC_LPN] | ((uint32_t)rec[FTL_REC_LPN + 1] << 8)) != lpn)
+				continue;
+			seq = (uint32_t)rec[FTL_REC_SEQ] | ((uint32_t)rec[FTL_REC_SEQ + 1] << 8) |
+				((uint32_t)rec[FTL_REC_SEQ + 2] << 16) | ((uint32_t)rec[FTL_REC_SEQ + 3] << 24);
+			if(!found || (seq > best_seq))
+			{
+				found = 1;
+				best_seq = seq;
+				best = (sect << 12) + (p << 8);
+			}
+		}
+	}
+	HOST_CHECK(found);
+	return best;
+}
+
+static void bench_scrub(void)
+{
+	scrub_region_t regions[] = {
+		{&DIAG_BASE, 0x4000},
+		{&SCHEDULE_BASE, 0x2000},
+	};
+	uint8_t readback[256];
+	uint32_t pass, r, i, slot, lpn, off, flips = 0, bytes = 0, pages = 0, wrong = 0;
+	uint32_t scrub_addr;
+	uint64_t start, time_us = 0;
+	int ret, uncorrectable = 0, busy = 0;
+
+	host_test_open("bench_edac", 0);
+	for(r = 0, off = 0; r < 2; off += regions[r].size, r++)
+	{
+		for(i = 0; i < regions[r].size; i++)
+			region_data[off + i] = (uint8_t)rng();
+		HOST_CHECK(spimem_write(*regions[r].base, region_data + off, regions[r].size) == (int)regions[r].size);
+	}
+	spimem_cache_flush();
+	nor_sim_fail_chip(1, 1);
+	nor_sim_fail_chip(2, 1);
+	SPI_HEALTH1 = 0;
+	SPI_HEALTH2 = 0;
+
+	for(pass = 0; pass < SCRUB_PASSES; pass++)
+	{
+		for(i = 0; i < SCRUB_FLIPS; i++)
+		{
+			r = rng() % 3 ? 0 : 1;
+			lpn = (*regions[r].base + (rng() % regions[r].size)) >> 8;
+			nor_sim_flip_bit(3, phys_page(lpn) + (rng() & 0xFF), (uint8_t)(rng() & 7));
+			flips++;
+		}
+		start = nor_sim_now_us();
+		for(slot = 0; slot < SCRUB_SLOTS; slot++)
+		{
+			ret = spimem_edac_scrub(&scrub_addr);
+			if(ret == SPIMEM_EDAC_UNCORRECTABLE)
+				uncorrectable++;
+			else if(ret == SPIMEM_EDAC_BUSY)
+				busy++;
+			else if(ret > 0)
+			{
+				bytes += (uint32_t)ret;
+				pages++;
+			}
+		}
+		time_us += nor_sim_now_us() - start;
+	}
+	for(r = 0, off = 0; r < 2; off += regions[r].size, r++)
+	{
+		for(i = 0; i < regions[r].size; i += 256)
+		{
+			HOST_CHECK(spimem_read(*regions[r].base + i, readback, 256) == 256);
+			for(lpn = 0; lpn < 256; lpn++)
+				wrong += (readback[lpn] != region_data[off + i + lpn]);
+		}
+	}
+	printf("%u passes over %u protected slots, one chip left, %u flips: %u pages (%u bytes) corrected, "
+		"%d uncorrectable, %d busy, %u wrong bytes, %.1fms per pass\n", SCRUB_PASSES, SCRUB_SLOTS, flips, pages,
+		bytes, uncorrectable, busy, wrong, time_us / 1e3 / SCRUB_PASSES);
+	HOST_CHECK(!wrong);
+	HOST_CHECK(!uncorrectable);
+	host_test_close();
+	return;
+}
+
+int main(void)
+{
+	static const uint32_t flip_counts[] = {1, 2, 4, 7, 8, 10, 12, 16, 24};
+	double lfsr, table;
+	uint32_t i;
+
+	gf_setup();
+	printf("bench_edac: RS(255,241) x %d per 256B page, host CPU time\n", EDAC_INTERLEAVE);
+	bench_encode(&lfsr, &table);
+	printf("%-36s %8s\n", "", "MB/s");
+	printf("%-36s %8.1f\n", "encode, byte at a time LFSR", lfsr);
+	printf("%-36s %8.1f\n", "encode, edac_encode_page()", table);
+	printf("%-36s %8.1f\n", "decode, clean", bench_decode(0));
+	printf("%-36s %8.1f\n", "decode, 1 bad byte per codeword", bench_decode(1));
+	printf("%-36s %8.1f\n", "decode, 3 bad bytes per codeword", bench_decode(3));
+	printf("%-36s %8.1f\n", "decode, 7 bad bytes per codeword", bench_decode(RS_T));
+	HOST_CHECK(table > lfsr);
+
+	printf("%6s %12s %10s %13s   (%u pages each)\n", "flips", "corrected", "detected", "miscorrected", FLIP_TRIALS);
+	for(i = 0; i < sizeof(flip_counts) / sizeof(flip_counts[0]); i++)
+		bench_flips(flip_counts[i]);
+
+	bench_scrub();
+	return host_test_failures ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_ftl_wear.c
+*
+*	PURPOSE:		Wear simulation for the flash translation layer (user-003): erase counts for a
+*					stream of small rewrites (a 16B HK header and the 4B TIME word) through the FTL,
+*					against the old read-erase-rewrite of spimem_write_h().
+*
+*	FILE REFERENCES:		host_test.h, spimem.h, spimem_ftl.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if the data doesn't
+*					read back or if the FTL erases more than the old path.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		Half of the logical space is filled with cold data first, so that garbage collection
+*				and the cold data moves (FTL_WEAR_THRESHOLD) are part of the cost. The cache is
+*				flushed after every rewrite, which is the worst case for the FTL.
+*
+*				Erase counts are for chip 1 over the FTL's sectors (0 - 253), the other chips get the
+*				same operations. The lifetime column is the number of rewrites before the most worn sector reaches
+*				the 100,000 program/erase cycles of the S25FL208K.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "spimem.h"
+#include "spimem_ftl.h"
+#include "host_test.h"
+
+#define REWRITES		20000
+#define COLD_SIZE		(SPIMEM_LOGICAL_SIZE / 2)
+#define PE_CYCLES		100000.0
+
+static uint8_t cold[256];
+
+static uint64_t show(const char* name, uint64_t start)
+{
+	nor_sim_stats_t stats;
+	uint32_t sect, count, max = 0, min = 0xFFFFFFFF;
+	uint64_t us = nor_sim_now_us() - start;
+
+	nor_sim_get_stats(&stats);
+	for(sect = 0; sect < FTL_NUM_SECTS; sect++)
+	{
+		count = nor_sim_erase_count(1, sect);
+		if(count > max)
+			max = count;
+		if(count < min)
+			min = count;
+	}
+	printf("%-28s %10llu %8lu %8lu %10.1fs %14.0f\n", name, (unsigned long long)stats.sect_erases,
+		(unsigned long)max, (unsigned long)min, us / 1e6, max ? PE_CYCLES * REWRITES / max : 0.0);
+	return stats.sect_erases;
+}
+
+static uint64_t run_ftl(void)
+{
+	uint8_t header[16], time[4], check[16];
+	uint64_t start, erases;
+	uint32_t i;
+
+	host_test_open("bench_ftl_wear", 0);
+	memset(cold, 0x5A, sizeof(cold));
+	for(i = 0; i < COLD_SIZE; i += 256)
+		spimem_write(SCIENCE_BASE + i, cold, 256);
+	spimem_cache_flush();
+	nor_sim_reset_stats();
+	start = nor_sim_now_us();
+	for(i = 0; i < REWRITES; i++)
+	{
+		memset(header, (uint8_t)i, sizeof(header));
+		memcpy(time, &i, sizeof(time));
+		spimem_write(HK_BASE, header, sizeof(header));
+		spimem_write(TIME_BASE, time, sizeof(time));
+		spimem_cache_flush();
+	}
+	erases = show("FTL (spimem_write)", start);
+	host_test_reset();
+	spimem_read(HK_BASE, check, sizeof(check));
+	HOST_CHECK(check[0] == (uint8_t)(REWRITES - 1) && check[15] == (uint8_t)(REWRITES - 1));
+	spimem_read(SCIENCE_BASE + COLD_SIZE - 256, check, sizeof(check));
+	HOST_CHECK(!memcmp(check, cold, sizeof(check)));
+	host_test_close();
+	return erases;
+}
+
+static uint64_t run_legacy(void)
+{
+	uint8_t header[16], time[4];
+	uint64_t start, erases;
+	uint32_t i, chip;
+
+	host_test_open("bench_ftl_wear", 0);
+	nor_sim_reset_stats();
+	start = nor_sim_now_us();
+	for(i = 0; i < REWRITES; i++)
+	{
+		memset(header, (uint8_t)i, sizeof(header));
+		memcpy(time, &i, sizeof(time));
+		for(chip = 1; chip < 4; chip++)
+		{
+			spimem_write_h(chip, HK_BASE, header, sizeof(header));
+			spimem_write_h(chip, TIME_BASE, time, sizeof(time));
+		}
+	}
+	erases = show("old spimem_write_h() x3", start);
+	HOST_CHECK(nor_sim_memory(1)[HK_BASE] == (uint8_t)(REWRITES - 1));
+	host_test_close();
+	return erases;
+}
+
+int main(void)
+{
+	uint64_t legacy;
+
+	printf("bench_ftl_wear: %d rewrites of HK_BASE (16B) and TIME_BASE (4B), 50%% full\n", REWRITES);
+	printf("%-28s %10s %8s %8s %11s %14s\n", "", "erases", "max/sect", "min/sect", "time", "rewrites@100k");
+	legacy = run_legacy();
+	HOST_CHECK(run_ftl() < legacy);
+	return host_test_failures ? 1 : 0;
+}
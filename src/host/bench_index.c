@@ -0,0 +1,173 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_index.c
+*
+*	PURPOSE:		Benchmark of the checksum index (user-017): the Fletcher-64 of SCIENCE (256kB) and
+*					of the TM store (128kB), read page by page the way CHECK_MEM_REQUEST used to, streamed
+*					in one read, and answered by fletcher64_on_spimem() from spimem_index.c: cold, again
+*					with nothing written, after one page was written and after 64 scattered pages were.
+*
+*	FILE REFERENCES:		host_test.h, spimem.h, spimem_cache.h, checksum.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a checksum differs
+*					from the one worked out over the data in RAM, or if a checksum with nothing
+*					written since the last one isn't at least 100 times faster than the page by page
+*					read.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		"cold" is the first checksum after the region was written, every page is stale.
+*				Writes go through spimem_write() and the cache is flushed before each checksum, so
+*				that a digest is never worked out from a page which is still in RAM only.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "spimem.h"
+#include "spimem_cache.h"
+#include "checksum.h"
+#include "host_test.h"
+
+#define REGION_MAX			0x40000
+
+typedef struct
+{
+	const char* name;
+	uint32_t* base;
+	uint32_t size;
+} index_region_t;
+
+static uint8_t region_data[REGION_MAX];
+static uint8_t page_buff[256];
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+	rng_state = rng_state * 1103515245 + 12345;
+	return rng_state >> 8;
+}
+
+/* The Fletcher-64 of the copy in RAM. */
+static uint64_t reference(uint32_t size)
+{
+	fletcher64_ctx_t ctx;
+
+	fletcher64_init(&ctx);
+	fletcher64_update(&ctx, region_data, size);
+	return fletcher64_final(&ctx);
+}
+
+/* CHECK_MEM_REQUEST before user-017: one spimem_read() per page. */
+static uint64_t page_by_page(uint32_t base, uint32_t size)
+{
+	fletcher64_ctx_t ctx;
+	uint32_t pos;
+
+	fletcher64_init(&ctx);
+	for(pos = 0; pos < size; pos += 256)
+	{
+		HOST_CHECK(spimem_read(base + pos, page_buff, 256) == 256);
+		fletcher64_update(&ctx, page_buff, 256);
+	}
+	return fletcher64_final(&ctx);
+}
+
+static int stream_chunk(void* arg, uint32_t addr, uint8_t* data, uint32_t size)
+{
+	fletcher64_update((fletcher64_ctx_t*)arg, data, size);
+	return 1;
+}
+
+/* The region in one streamed read, what fletcher64_on_spimem() does when the index can't answer. */
+static uint64_t streamed(uint32_t base, uint32_t size)
+{
+	fletcher64_ctx_t ctx;
+
+	fletcher64_init(&ctx);
+	HOST_CHECK(spimem_read_stream_cb(base, size, page_buff, 256, stream_chunk, &ctx) == (int)size);
+	return fletcher64_final(&ctx);
+}
+
+static uint64_t indexed(uint32_t base, uint32_t size)
+{
+	uint8_t status = 0;
+	uint64_t checksum;
+
+	checksum = fletcher64_on_spimem(base, size, &status);
+	HOST_CHECK(status == 1);
+	return checksum;
+}
+
+/* Rewrites a page of the region with new data. */
+static void write_page(uint32_t base, uint32_t page)
+{
+	uint32_t i;
+
+	for(i = 0; i < 256; i++)
+		region_data[(page << 8) + i] = (uint8_t)rng();
+	HOST_CHECK(spimem_write(base + (page << 8), region_data + (page << 8), 256) == 256);
+	return;
+}
+
+/* Runs one way of working out the checksum, checks it and prints time and flash reads. Returns the time. */
+static uint64_t measure(const char* name, uint64_t (*fn)(uint32_t, uint32_t), uint32_t base, uint32_t size)
+{
+	nor_sim_stats_t stats;
+	uint64_t start, time_us, checksum;
+
+	spimem_cache_flush();
+	nor_sim_reset_stats();
+	start = nor_sim_now_us();
+	checksum = fn(base, size);
+	time_us = nor_sim_now_us() - start;
+	nor_sim_get_stats(&stats);
+	HOST_CHECK(checksum == reference(size));
+	printf("  %-24s %10.1fms %10lu %9lu\n", name, time_us / 1e3, (unsigned long)stats.bytes, (unsigned long)stats.programs);
+	return time_us;
+}
+
+int main(void)
+{
+	index_region_t regions[] = {
+		{"SCIENCE", &SCIENCE_BASE, 0x40000},
+		{"TM store", &TM_BASE, 0x20000},
+	};
+	uint64_t old_us, warm_us;
+	uint32_t r, i, base, size;
+
+	host_test_open("bench_index", 0);
+	printf("bench_index: Fletcher-64 of a region, simulated time\n");
+	for(r = 0; r < sizeof(regions) / sizeof(regions[0]); r++)
+	{
+		base = *regions[r].base;
+		size = regions[r].size;
+		for(i = 0; i < size; i += 256)
+			write_page(base, i >> 8);
+		printf("%s (%ukB at 0x%05X)%*s %12s %10s %9s\n", regions[r].name, size / 1024, base,
+			(int)(12 - strlen(regions[r].name)), "", "time", "SPI bytes", "programs");
+		old_us = measure("page by page (old)", page_by_page, base, size);
+		measure("streamed", streamed, base, size);
+		measure("index, cold", indexed, base, size);
+		warm_us = measure("index, nothing written", indexed, base, size);
+		HOST_CHECK(warm_us * 100 <= old_us);
+		write_page(base, rng() % (size >> 8));
+		measure("index, 1 page written", indexed, base, size);
+		for(i = 0; i < 64; i++)
+			write_page(base, rng() % (size >> 8));
+		measure("index, 64 pages written", indexed, base, size);
+	}
+
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_irq_off.c
+*
+*	PURPOSE:		Worst-case interrupts-off time of each SPI memory operation (user-006), against
+*					the time the same operation used to spend inside enter_atomic().
+*
+*	FILE REFERENCES:		host_test.h, rtos_sim.h, spimem.h, spimem_ftl.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if an operation keeps
+*					interrupts off for 1ms (one tick) or more, or blocks inside a critical section.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		rtos_sim times every taskENTER_CRITICAL() / taskEXIT_CRITICAL() pair on the nor_sim
+*				clock, which moves with SPI transfers, flash busy time and delays. CPU time isn't
+*				simulated, so a critical section which only touches RAM counts as 0us.
+*
+*				The "atomic" column is the length of the whole operation, which is how long the CAN
+*				ISR and the tick were held off while spimem_write_h() / spimem_read() ran inside
+*				enter_atomic(). The logical space is filled before the stream, GC and erase rows,
+*				so the GC row pays for garbage collection with sector erases. spimem_erase() only
+*				unmaps pages in the FTL.
+*
+*				rtc.c isn't part of the host build, it now takes Spi0_Mutex like the flash and
+*				disables no interrupts of its own.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "rtos_sim.h"
+#include "spimem.h"
+#include "spimem_ftl.h"
+#include "host_test.h"
+
+#define BENCH_OPS		20
+#define GC_OPS			2000		// Uses up the spare pages, garbage collection runs from about the 700th.
+#define IRQ_OFF_LIMIT	1000		// us, one tick.
+
+static uint8_t data[0x10000];
+
+typedef void (*bench_op_t)(uint32_t i);
+
+static void op_read(uint32_t i)
+{
+	spimem_read(TM_BASE + i * 256, data, 256);
+	return;
+}
+
+static void op_program(uint32_t i)
+{
+	spimem_write(TM_BASE + i * 256, data, 256);
+	return;
+}
+
+static void op_rewrite(uint32_t i)
+{
+	data[0] = (uint8_t)i;
+	spimem_write(HK_BASE, data, 16);
+	spimem_cache_flush();
+	return;
+}
+
+static void op_gc(uint32_t i)
+{
+	data[0] = (uint8_t)(i + 1);
+	spimem_write(((i * 17) % FTL_LOGICAL_PAGES) << 8, data, 256);
+	spimem_cache_flush();
+	return;
+}
+
+static void op_stream(uint32_t i)
+{
+	spimem_read_stream(SCIENCE_BASE, data, sizeof(data));
+	return;
+}
+
+static void op_erase(uint32_t i)
+{
+	spimem_erase(SCIENCE_BASE + i * 0x1000, 0x1000);
+	return;
+}
+
+static void op_legacy(uint32_t i)
+{
+	data[0] = (uint8_t)i;
+	spimem_write_h(1, 0xFE000, data, 16);		// Sector 254, outside the log. Dirty after the first time.
+	return;
+}
+
+static void op_format(uint32_t i)
+{
+	xSemaphoreTake(Spi0_Mutex, portMAX_DELAY);
+	spimem_ftl_format_h();
+	xSemaphoreGive(Spi0_Mutex);
+	return;
+}
+
+static void run(const char* name, bench_op_t op, uint32_t ops)
+{
+	rtos_sim_stats_t stats;
+	nor_sim_stats_t flash;
+	uint64_t start, us, longest = 0;
+	uint32_t i;
+
+	rtos_sim_reset_stats();
+	nor_sim_reset_stats();
+	for(i = 0; i < ops; i++)
+	{
+		start = nor_sim_now_us();
+		op(i);
+		us = nor_sim_now_us() - start;
+		if(us > longest)
+			longest = us;
+	}
+	rtos_sim_get_stats(&stats);
+	nor_sim_get_stats(&flash);
+	printf("%-34s %12.1fms %10lluus %10llu %8llu\n", name, longest / 1000.0, (unsigned long long)stats.critical_max_us,
+		(unsigned long long)stats.critical_sections, (unsigned long long)flash.sect_erases);
+	HOST_CHECK(stats.critical_max_us < IRQ_OFF_LIMIT);
+	HOST_CHECK(!stats.block_in_critical);
+	return;
+}
+
+int main(void)
+{
+	uint32_t i;
+
+	host_test_open("bench_irq_off", 0);
+	for(i = 0; i < sizeof(data); i++)
+		data[i] = (uint8_t)(i * 7);
+
+	printf("bench_irq_off: longest single operation, simulated time\n");
+	printf("%-34s %14s %12s %10s %8s\n", "", "atomic (old)", "irq-off now", "sections", "erases");
+	run("spimem_write() 256B", op_program, BENCH_OPS);
+	run("spimem_read() 256B", op_read, BENCH_OPS);
+	run("spimem_write() 16B rewrite", op_rewrite, BENCH_OPS);
+	run("spimem_write_h() dirty rewrite", op_legacy, BENCH_OPS);
+
+	for(i = 0; i < SPIMEM_LOGICAL_SIZE; i += 256)
+	{
+		data[0] = (uint8_t)(i >> 8);
+		spimem_write(i, data, 256);
+	}
+	spimem_cache_flush();
+	run("spimem_read_stream() 64kB", op_stream, BENCH_OPS);
+	run("spimem_write() with GC (full)", op_gc, GC_OPS);
+	run("spimem_erase() 4kB", op_erase, BENCH_OPS);
+	run("spimem_ftl_format_h()", op_format, 1);
+
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
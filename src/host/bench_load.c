@@ -0,0 +1,168 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_load.c
+*
+*	PURPOSE:		Upload of a 16KB SSM image to COMS_BASE (user-016): the old memory load, which wrote
+*					each packet with spimem_write() as it came, against MEMORY_LOAD_ABS requests through
+*					exec_commands_H(), which also write each packet as it comes and check the session
+*					against its running checksum (load_write()). Time, sector erases and page programs
+*					are compared.
+*
+*	FILE REFERENCES:		host_test.h, obc_sim.h, spimem_cache.h, memory_manage.c (build/src), string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if an image doesn't
+*					read back correctly, a request isn't verified, the load session fails
+*					(load_failed) or the session load erases or programs more than the old one.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The region holds the previous image before each upload, which is what the flight
+*				software finds when ground replaces an image. The time is the flash work only, the
+*				uplink of the packets is not part of it.
+*
+*				Ground sends 128B packets. In the 100B case nearly every packet ends part way into
+*				a page.
+*
+*				spimem_write() goes through the page cache (spimem_cache.c), which already holds a
+*				partial page until it is complete or SPIMEM_CACHE_FLUSH_PERIOD has passed, and the
+*				FTL writes out of place, so the old load no longer erases while it runs either. The
+*				session load does the same flash work, plus the voted read-back of the image which
+*				checks it against the running checksum.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*	10/16/2026			Loads are no longer staged in load_buff[], the "session" columns are load_write().
+*
+*/
+
+#include <string.h>
+#include "memory_manage.c"
+#include "spimem_cache.h"
+#include "obc_sim.h"
+#include "host_test.h"
+
+#define IMAGE_SIZE			LOAD_IMAGE_SIZE
+
+static uint8_t image[IMAGE_SIZE], readback[IMAGE_SIZE];
+
+/* Fresh chips with the previous image in the region. */
+static void setup(void)
+{
+	uint8_t page[256];
+	uint32_t i, j;
+
+	host_test_open("bench_load", 0);
+	for(i = 0; i < IMAGE_SIZE; i += 256)
+	{
+		for(j = 0; j < 256; j++)
+			page[j] = (uint8_t)((i >> 8) + j);
+		spimem_write(COMS_BASE + i, page, 256);
+	}
+	spimem_cache_flush();
+	for(i = 0; i < IMAGE_SIZE; i++)
+		image[i] = (uint8_t)((i * 29) ^ (i >> 7));
+	return;
+}
+
+/* The load before user-016: every packet written straight away. */
+static void old_load(uint32_t packet_size)
+{
+	uint32_t pos, n;
+
+	for(pos = 0; pos < IMAGE_SIZE; pos += n)
+	{
+		n = ((IMAGE_SIZE - pos) < packet_size) ? (IMAGE_SIZE - pos) : packet_size;
+		HOST_CHECK(spimem_write(COMS_BASE + pos, image + pos, n) == (int)n);
+	}
+	return;
+}
+
+/* MEMORY_LOAD_ABS requests as the memory task receives them, each one verified. */
+static void new_load(uint32_t packet_size)
+{
+	uint8_t packet[PACKET_LENGTH];
+	uint32_t pos, n, address, verified;
+
+	for(pos = 0; pos < IMAGE_SIZE; pos += n)
+	{
+		n = ((IMAGE_SIZE - pos) < packet_size) ? (IMAGE_SIZE - pos) : packet_size;
+		address = COMS_BASE + pos;
+		clear_current_command();
+		memcpy(current_command, image + pos, n);
+		current_command[146] = MEMORY_LOAD_ABS;
+		current_command[136] = 1;
+		current_command[135] = (uint8_t)(address >> 24);
+		current_command[134] = (uint8_t)(address >> 16);
+		current_command[133] = (uint8_t)(address >> 8);
+		current_command[132] = (uint8_t)address;
+		current_command[131] = 0;
+		current_command[130] = 0;
+		current_command[129] = 0;
+		current_command[128] = (uint8_t)n;
+		exec_commands_H();
+		verified = 0;
+		while(obc_sim_take_packet(mem_to_obc_fifo, packet))
+		{
+			if((packet[146] == TASK_TO_OPR_TCV) && (packet[145] == 1))
+				verified++;
+		}
+		HOST_CHECK(verified == 1);
+	}
+	HOST_CHECK(!load_active);					// Closed by the last packet of the image.
+	HOST_CHECK(!load_failed);
+	return;
+}
+
+/* Loads the image one way or the other, prints a column group and returns the sector erases. */
+static uint64_t run(uint32_t packet_size, uint8_t staged, uint64_t* programs)
+{
+	nor_sim_stats_t stats;
+	uint64_t start, time_us;
+
+	setup();
+	nor_sim_reset_stats();
+	start = nor_sim_now_us();
+	if(staged)
+		new_load(packet_size);
+	else
+		old_load(packet_size);
+	spimem_cache_flush();
+	time_us = nor_sim_now_us() - start;
+	nor_sim_get_stats(&stats);
+	HOST_CHECK(spimem_read(COMS_BASE, readback, IMAGE_SIZE) == IMAGE_SIZE);
+	HOST_CHECK(!memcmp(readback, image, IMAGE_SIZE));
+	printf(" %7lu %9lu %9.2fs", (unsigned long)stats.sect_erases, (unsigned long)stats.programs, time_us / 1e6);
+	*programs = stats.programs;
+	host_test_close();
+	return stats.sect_erases;
+}
+
+int main(void)
+{
+	static const uint32_t sizes[] = {128, 100};
+	uint64_t old_erases, new_erases, old_programs, new_programs;
+	uint32_t i;
+
+	printf("bench_load: %dKB image to COMS_BASE over the previous one, simulated time\n", IMAGE_SIZE / 1024);
+	printf("%-10s %27s %28s\n", "", "old (spimem_write)", "session (load_write)");
+	printf("%-10s %7s %9s %10s %7s %9s %10s\n", "packets", "erases", "programs", "time", "erases", "programs", "time");
+	for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+	{
+		printf("%7luB  ", (unsigned long)sizes[i]);
+		old_erases = run(sizes[i], 0, &old_programs);
+		new_erases = run(sizes[i], 1, &new_programs);
+		printf("\n");
+		HOST_CHECK(new_erases <= old_erases);
+		HOST_CHECK(new_programs <= old_programs);
+	}
+	return host_test_failures ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_packet.c
+*
+*	PURPOSE:		Cost of building a TM packet (user-019): the 128 bytes of data copied into the
+*					152B packet and the PEC worked out over bytes 2 to 151, the way the packet router
+*					did it originally, after user-018 and with copy_tm_data() (pus_pec_copy() and
+*					pus_pec_update() over the header).
+*
+*	FILE REFERENCES:		host_test.h, checksum.h, string.h, time.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if the packets or
+*					PECs differ, or if copy_tm_data() is slower than either of the builds before it.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		Host CPU time (clock()), the best of BENCH_TRIES. The header is written the same
+*				way in every case and is left out.
+*
+*				"original": the PEC was worked out twice, once before the data was copied (and
+*				then overwritten) and once after, each time with two modulo 255 per byte.
+*				"one-shot": a copy loop, then pus_pec() over the packet (after user-018).
+*				"incremental": copy_tm_data() in obc_packet_router.c.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include <time.h>
+#include "checksum.h"
+#include "host_test.h"
+
+#define PACKET_LENGTH		152
+#define BENCH_PACKETS		2000000
+#define BENCH_TRIES			3
+
+typedef uint16_t (*build_fn_t)(uint8_t* tm, uint8_t* data);
+
+static uint8_t data[128];
+static uint8_t tm[PACKET_LENGTH], reference_tm[PACKET_LENGTH];
+static volatile uint16_t sink;
+
+/* fletcher16() before user-018. */
+static uint16_t old_fletcher16(uint8_t* data, int count)
+{
+	uint16_t sum1 = 0;
+	uint16_t sum2 = 0;
+	int index;
+
+	for(index = 0; index < count; ++index)
+	{
+		sum1 = (sum1 + data[index]) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+	return (sum2 << 8) | sum1;
+}
+
+static uint16_t original_build(uint8_t* tm, uint8_t* data)
+{
+	uint16_t j, pec;
+
+	pec = old_fletcher16(tm + 2, 150);
+	tm[1] = (uint8_t)((pec & 0xFF00) >> 8);
+	tm[0] = (uint8_t)(pec & 0x00FF);
+	for(j = 2; j < 130; j++)
+		tm[j] = *(data + (j - 2));
+	return old_fletcher16(tm + 2, 150);
+}
+
+static uint16_t one_shot_build(uint8_t* tm, uint8_t* data)
+{
+	uint16_t j;
+
+	for(j = 2; j < 130; j++)
+		tm[j] = *(data + (j - 2));
+	return pus_pec(tm + 2, 150);
+}
+
+static uint16_t incremental_build(uint8_t* tm, uint8_t* data)
+{
+	pus_pec_ctx_t ctx;
+	pus_pec_init(&ctx);
+	pus_pec_copy(&ctx, tm + 2, data, 128);
+	pus_pec_update(&ctx, tm + 130, PACKET_LENGTH - 130);
+	return pus_pec_final(&ctx);
+}
+
+/* A header which differs from packet to packet, like the sequence count. */
+static void write_header(uint32_t i)
+{
+	memset(tm + 130, 0x5A, PACKET_LENGTH - 130);
+	tm[148] = (uint8_t)i;
+	tm[149] = (uint8_t)(i >> 8);
+	return;
+}
+
+/* Builds BENCH_PACKETS packets. Returns the fastest try, in ns per packet. */
+static double measure(build_fn_t build)
+{
+	uint32_t try, i;
+	clock_t start;
+	double ns, best = 0;
+
+	for(try = 0; try < BENCH_TRIES; try++)
+	{
+		start = clock();
+		for(i = 0; i < BENCH_PACKETS; i++)
+		{
+			tm[148] = (uint8_t)i;
+			sink = build(tm, data);
+		}
+		ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / BENCH_PACKETS;
+		if(!try || (ns < best))
+			best = ns;
+	}
+	return best;
+}
+
+/* The packet and its PEC come out the same whichever way it is built. */
+static void check(build_fn_t build, uint16_t pec)
+{
+	memset(tm, 0xEE, sizeof(tm));
+	write_header(1234);
+	HOST_CHECK(build(tm, data) == pec);
+	HOST_CHECK(!memcmp(tm + 2, reference_tm + 2, PACKET_LENGTH - 2));
+	return;
+}
+
+int main(void)
+{
+	static const struct
+	{
+		const char* name;
+		build_fn_t build;
+	} builds[] = {
+		{"original", original_build},
+		{"one-shot", one_shot_build},
+		{"incremental", incremental_build},
+	};
+	double ns[3];
+	uint16_t pec;
+	uint32_t i;
+
+	for(i = 0; i < sizeof(data); i++)
+		data[i] = (uint8_t)((i * 29) ^ 0xA5);
+	write_header(1234);
+	memcpy(tm + 2, data, 128);
+	memcpy(reference_tm, tm, PACKET_LENGTH);
+	pec = old_fletcher16(tm + 2, 150);
+#if (PUS_PEC_ALGORITHM == PUS_PEC_CRC16)
+	pec = crc16_ccitt(tm + 2, 150);
+#endif
+
+	printf("bench_packet: 152B TM packet, copy of the data and PEC, host CPU time\n");
+	printf("%-14s %10s %12s\n", "build", "ns/packet", "packets/s");
+	for(i = 0; i < sizeof(builds) / sizeof(builds[0]); i++)
+	{
+		if((builds[i].build != original_build) || (PUS_PEC_ALGORITHM == PUS_PEC_FLETCHER16))
+			check(builds[i].build, pec);
+		ns[i] = measure(builds[i].build);
+		printf("%-14s %10.1f %12.0f\n", builds[i].name, ns[i], 1e9 / ns[i]);
+	}
+	HOST_CHECK(ns[2] < ns[1]);
+	HOST_CHECK(ns[2] < ns[0]);
+	return host_test_failures ? 1 : 0;
+}
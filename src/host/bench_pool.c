@@ -0,0 +1,210 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_pool.c
+*
+*	PURPOSE:		Bytes copied and packets/s on the HK telemetry path (user-021), from the HK task's
+*					report to the 32-bit words which send_pus_packet_tm() puts in CAN frames: the
+*					147B and 152B queues the path had before the PUS packet pool, against the pool
+*					with hk_to_obc_fifo and the TM queues carrying one-byte descriptors.
+*
+*	FILE REFERENCES:		host_test.h, obc_sim.h, rtos_sim.h, router_sim.h, pus_pool.h, tm_sched.h,
+*							checksum.h, global_var.h, string.h, time.h
+*
+*	EXTERNAL VARIABLES:		hk_to_obc_fifo, time_to_obc_fifo, mem_to_obc_fifo (global_var.h)
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a packet is wrong
+*					or isn't the buffer the HK task filled, or if the pool copies as much as the queues.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		"queues": send_hk_as_tm() in housekeep.c, exec_commands(), packetize_send_telemetry()
+*				and the downlink as they were before the pool, rebuilt here on rtos_sim queues of
+*				the old sizes (hk_to_obc_fifo 147B, tm_buffer 152B). The PEC is pus_pec() in both, so
+*				that only the copies differ.
+*				"pool": the HK task's part as in housekeep.c, then the router's own exec_commands()
+*				(router_sim_exec_commands()), then tm_sched_get() and the words of the packet.
+*
+*				Bytes copied are the memcpy()s and loops here plus the bytes rtos_sim copied into
+*				and out of queues (rtos_sim_stats_t), plus 2 for the descriptor which tm_sched.c
+*				puts in and takes out of its queue. Reading the packet for the CAN frames is the
+*				same in both and is left out. Packets/s is host CPU time (clock()), the best of
+*				BENCH_TRIES, with the rtos_sim calls counted in. The first try checks every packet
+*				and isn't timed.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include <time.h>
+#include "global_var.h"
+#include "checksum.h"
+#include "pus_pool.h"
+#include "tm_sched.h"
+#include "rtos_sim.h"
+#include "obc_sim.h"
+#include "router_sim.h"
+#include "host_test.h"
+
+#define BENCH_PACKETS		200000
+#define BENCH_TRIES			4
+#define OLD_COMMAND			(DATA_LENGTH + 10)	// Items of hk_to_obc_fifo before the pool, 147B.
+#define TM_WORDS			(PACKET_LENGTH / 4)
+
+typedef int (*path_fn_t)(uint32_t i, int check);
+
+uint8_t current_hk[DATA_LENGTH];						// can_func.c in the OBC build.
+static QueueHandle_t old_hk_fifo, old_tm_buffer;
+static uint8_t hk_command[OLD_COMMAND], opr_command[OLD_COMMAND];	// current_command in housekeep.c and in the router.
+static uint8_t old_current_tm[PACKET_LENGTH], old_tm_to_downlink[PACKET_LENGTH];
+static uint64_t copied;					// Bytes copied outside of the queues.
+static volatile uint32_t sink;
+
+/* The words of the packet, as send_pus_packet_tm() takes them for the CAN frames. */
+static void downlink(const uint8_t* packet)
+{
+	uint32_t i, sum = 0;
+
+	for(i = 0; i < TM_WORDS; i++)
+		sum += (uint32_t)packet[4 * i] | ((uint32_t)packet[4 * i + 1] << 8) | ((uint32_t)packet[4 * i + 2] << 16) | ((uint32_t)packet[4 * i + 3] << 24);
+	sink += sum;
+	return;
+}
+
+/* Right data, right service and a PEC which checks. */
+static int packet_ok(const uint8_t* packet)
+{
+	uint16_t pec = ((uint16_t)packet[1] << 8) | packet[0];
+
+	return !memcmp(packet + 2, current_hk, PUS_POOL_DATA_LENGTH) && (packet[144] == HK_SERVICE) && (packet[143] == HK_REPORT)
+		&& (pus_pec((uint8_t*)packet + 2, PACKET_LENGTH - 2) == pec);
+}
+
+/* One HK report through the path as it was before the pool. */
+static int queue_path(uint32_t i, int check)
+{
+	uint16_t pec;
+
+	current_hk[0] = (uint8_t)i;
+	memset(hk_command, 0, OLD_COMMAND);						// send_hk_as_tm()
+	hk_command[146] = HK_REPORT;
+	memcpy(hk_command, current_hk, DATA_LENGTH);			// All of current_hk, 137B.
+	copied += DATA_LENGTH;
+	xQueueSendToBack(old_hk_fifo, hk_command, (TickType_t)1);
+
+	memset(opr_command, 0, OLD_COMMAND);						// exec_commands()
+	if(xQueueReceive(old_hk_fifo, opr_command, (TickType_t)0) != pdTRUE)
+		return 0;
+	if(opr_command[146] != HK_REPORT)
+		return 0;
+	memset(old_current_tm + 130, 0, PACKET_LENGTH - 130);	// packetize_send_telemetry()
+	old_current_tm[151] = 0x08;
+	old_current_tm[150] = HK_TASK_ID;
+	old_current_tm[149] = 0x3 << 6;
+	old_current_tm[146] = PACKET_LENGTH - 1;
+	old_current_tm[145] = 0x90;
+	old_current_tm[144] = HK_SERVICE;
+	old_current_tm[143] = HK_REPORT;
+	old_current_tm[142] = (uint8_t)i;
+	old_current_tm[141] = HK_GROUND_ID;
+	memcpy(old_current_tm + 2, opr_command, PUS_POOL_DATA_LENGTH);
+	copied += PUS_POOL_DATA_LENGTH;
+	pec = pus_pec(old_current_tm + 2, PACKET_LENGTH - 2);
+	old_current_tm[1] = (uint8_t)(pec >> 8);
+	old_current_tm[0] = (uint8_t)pec;
+	if(xQueueSendToBack(old_tm_buffer, old_current_tm, (TickType_t)1) != pdPASS)	// store_current_tm()
+		return 0;
+	xQueueReceive(time_to_obc_fifo, opr_command, (TickType_t)0);	// The rest of exec_commands(), both empty.
+	xQueueReceive(mem_to_obc_fifo, opr_command, (TickType_t)0);
+
+	if(xQueueReceive(old_tm_buffer, old_tm_to_downlink, (TickType_t)1) != pdTRUE)	// The router's loop.
+		return 0;
+	downlink(old_tm_to_downlink);
+	return !check || packet_ok(old_tm_to_downlink);
+}
+
+/* One HK report through the pool and the router's exec_commands(). */
+static int pool_path(uint32_t i, int check)
+{
+	uint8_t desc, down_desc;
+	uint8_t* packet;
+	int ok;
+
+	current_hk[0] = (uint8_t)i;
+	desc = pus_pool_alloc(0, (TickType_t)1);				// send_hk_as_tm()
+	if(desc == PUS_POOL_NONE)
+		return 0;
+	packet = pus_pool_buf(desc);
+	packet[146] = HK_REPORT;
+	memcpy(packet + PUS_POOL_DATA, current_hk, PUS_POOL_DATA_LENGTH);
+	copied += PUS_POOL_DATA_LENGTH;
+	pus_pool_send(hk_to_obc_fifo, desc, (TickType_t)1);
+
+	if(router_sim_exec_commands() != 1)
+		return 0;
+	if(tm_sched_get(&down_desc) != pdTRUE)
+		return 0;
+	copied += 2 * PUS_POOL_DESC_SIZE;						// tm_sched_put() and tm_sched_get().
+	packet = pus_pool_buf(down_desc);
+	downlink(packet);
+	ok = !check || ((down_desc == desc) && packet_ok(packet));	// Built in the buffer the HK task filled.
+	pus_pool_release(down_desc);
+	return ok;
+}
+
+/* BENCH_PACKETS reports, BENCH_TRIES times, every packet is checked the first time. Returns the best		*/
+/* packets/s of the other tries, the bytes copied per packet in *bytes.										*/
+static double measure(path_fn_t path, double* bytes)
+{
+	rtos_sim_stats_t stats;
+	uint32_t try, i, bad = 0;
+	clock_t start;
+	double secs, best = 0;
+
+	for(try = 0; try < BENCH_TRIES; try++)
+	{
+		rtos_sim_reset_stats();
+		copied = 0;
+		start = clock();
+		for(i = 0; i < BENCH_PACKETS; i++)
+			bad += !path(i, !try);
+		secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+		rtos_sim_get_stats(&stats);
+		*bytes = (double)(copied + stats.queue_bytes) / BENCH_PACKETS;
+		if(try && (BENCH_PACKETS / secs > best))
+			best = BENCH_PACKETS / secs;
+	}
+	HOST_CHECK(!bad);
+	HOST_CHECK(pus_pool_free_count() == PUS_POOL_SIZE);		// Every buffer came back.
+	return best;
+}
+
+int main(void)
+{
+	double old_rate, new_rate, old_bytes, new_bytes;
+	uint32_t i;
+
+	host_test_open("bench_pool", 0);
+	router_sim_start();
+	old_hk_fifo = xQueueCreate(4, OLD_COMMAND);
+	old_tm_buffer = xQueueCreate(10, PACKET_LENGTH);
+	for(i = 0; i < DATA_LENGTH; i++)
+		current_hk[i] = (uint8_t)((i * 37) ^ 0x5C);
+
+	old_rate = measure(queue_path, &old_bytes);
+	new_rate = measure(pool_path, &new_bytes);
+	printf("bench_pool: HK report to CAN words, %u packets, host CPU time\n", BENCH_PACKETS);
+	printf("%-10s %14s %12s\n", "path", "bytes/packet", "packets/s");
+	printf("%-10s %14.1f %12.0f\n", "queues", old_bytes, old_rate);
+	printf("%-10s %14.1f %12.0f\n", "pool", new_bytes, new_rate);
+	HOST_CHECK(new_bytes < old_bytes);
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
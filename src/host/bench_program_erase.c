@@ -0,0 +1,104 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_program_erase.c
+*
+*	PURPOSE:		Benchmark of the redundant program and erase (user-004): the three chips started
+*					together by spimem_program_all_h() / spimem_erase_all_h(), against one chip at a
+*					time (the old behaviour) and against a single chip.
+*
+*	FILE REFERENCES:		host_test.h, spimem.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if an operation fails,
+*					if the chips differ afterwards or if the overlapped run isn't faster.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		Sectors 254 & 255 are used, the FTL keeps them out of the log. Page program and
+*				sector erase take the nor_sim defaults (700us and 50ms).
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "spimem.h"
+#include "host_test.h"
+
+#define BENCH_SECT		254
+#define BENCH_PAGES		32			// Sectors 254 & 255.
+#define BENCH_ROUNDS	10
+
+static uint8_t page[256];
+
+static int program_erase(const uint8_t* masks, uint32_t count)
+{
+	uint32_t p, m;
+	uint8_t failed;
+	int ret = 1;
+
+	for(m = 0; m < count; m++)
+	{
+		if(spimem_erase_all_h(masks[m], BENCH_SECT, &failed) < 0 || failed)
+			ret = -1;
+		if(spimem_erase_all_h(masks[m], BENCH_SECT + 1, &failed) < 0 || failed)
+			ret = -1;
+	}
+	for(p = 0; p < BENCH_PAGES; p++)
+	{
+		page[0] = (uint8_t)p;
+		for(m = 0; m < count; m++)
+		{
+			if(spimem_program_all_h(masks[m], (BENCH_SECT << 12) + (p << 8), page, sizeof(page), &failed) < 0 || failed)
+				ret = -1;
+		}
+	}
+	return ret;
+}
+
+static uint64_t run(const char* name, const uint8_t* masks, uint32_t count)
+{
+	uint64_t start, us;
+	uint32_t i;
+
+	xSemaphoreTake(Spi0_Mutex, portMAX_DELAY);
+	start = nor_sim_now_us();
+	for(i = 0; i < BENCH_ROUNDS; i++)
+		HOST_CHECK(program_erase(masks, count) > 0);
+	us = nor_sim_now_us() - start;
+	xSemaphoreGive(Spi0_Mutex);
+	printf("%-30s %10.1fms %10.1fms\n", name, us / 1000.0 / BENCH_ROUNDS, us / 1000.0 / BENCH_ROUNDS / BENCH_PAGES);
+	return us;
+}
+
+int main(void)
+{
+	static const uint8_t all[] = {0x7}, each[] = {0x1, 0x2, 0x4}, one[] = {0x1};
+	uint64_t overlapped, sequential;
+	nor_sim_stats_t stats;
+
+	host_test_open("bench_program_erase", 0);
+	memset(page, 0xA5, sizeof(page));
+
+	printf("bench_program_erase: erase 2 sectors + program 32 pages, simulated time\n");
+	printf("%-30s %12s %12s\n", "", "per round", "per page");
+	overlapped = run("3 chips overlapped (mask 0x7)", all, 1);
+	sequential = run("3 chips one at a time", each, 3);
+	run("1 chip", one, 1);
+
+	HOST_CHECK(overlapped < sequential);
+	HOST_CHECK(!memcmp(nor_sim_memory(1) + (BENCH_SECT << 12), nor_sim_memory(2) + (BENCH_SECT << 12), BENCH_PAGES * 256));
+	HOST_CHECK(!memcmp(nor_sim_memory(1) + (BENCH_SECT << 12), nor_sim_memory(3) + (BENCH_SECT << 12), BENCH_PAGES * 256));
+	nor_sim_get_stats(&stats);
+	HOST_CHECK(!stats.busy_violations && !stats.wel_violations && !stats.over_programs);
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
@@ -0,0 +1,401 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_router.c
+*
+*	PURPOSE:		TC-to-verification latency, HK latency and CPU share of the packet router's loop
+*					(user-023): the loop which blocks on opr_wake_sem, against the loop it replaced
+*					which polled each FIFO with a 1-tick timeout and slept 3 s after every TM packet.
+*
+*	FILE REFERENCES:		host_test.h, router_sim.c (obc_packet_router.c), rtos_sim.h, nor_sim.h, coms_sim.h,
+*							pus_pool.h, tm_sched.h, checksum.h, global_var.h, string.h
+*
+*	EXTERNAL VARIABLES:		hk_to_obc_fifo, tc_msg_fifo, tc_buffer, opr_wake_sem (global_var.h)
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a TC or an HK report
+*					is lost, or if the new loop wakes more often when idle, uses more CPU when idle,
+*					or answers TCs or HK later than the old one.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		One simulated hour per scenario. The COMS SSM sends a TC as PACKET_LENGTH / 4 chunks
+*				TC_CHUNK_US apart, each one two words in tc_msg_fifo and a give of opr_wake_sem as in
+*				the CAN1 handler. TCs come every TC_PERIOD_US on average, at random times. The TC
+*				asks for service 17, which verify_telecommand() rejects: the acceptance report for
+*				a good TC is commented out, and a rejected one takes the same path up to its (1,2)
+*				verification report. The HK task sends a report through the pool every 10 s. TM
+*				transfers go to coms_sim (legacy transfer) with no frames lost.
+*
+*				"new": opr_wait_time(), xSemaphoreTake() on opr_wake_sem, opr_serve() and
+*				opr_downlink(), the router's loop as it is. "old": the loop before user-023, rebuilt
+*				here from the same functions (old_loop()). The 1-tick receives from tm_buffer and
+*				from the FIFOs in the old exec_commands() are stood in for by vTaskDelay(1) when
+*				tm_sched.c is empty and by a 1-tick xQueuePeek() before exec_commands(), and the
+*				calls are counted as the old ones would have been.
+*
+*				Latency is from the last chunk of a TC (or the HK task's send) to the end of the
+*				decode (or exec_commands()) which queued its TM packet. The router's functions run
+*				on coms_sim's clock, which is moved up to rtos_sim's before each step and which
+*				rtos_sim's events catch up with after it.
+*
+*				CPU is a model: RTOS_CALL_US per queue, semaphore or delay call the router makes
+*				(also charged to the simulated clock, rtos_sim_set_api_cost()) and CONTEXT_US per
+*				time it blocks and is woken. A wake is a call which blocked.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "router_sim.c"									// Also global_var.h, checksum.h, pus_pool.h, tm_sched.h.
+#include "rtos_sim.h"
+#include "nor_sim.h"
+#include "host_test.h"
+
+#undef xTaskGetTickCount									// The old loop's own waits are on rtos_sim.
+#undef vTaskDelayUntil
+
+#define BENCH_RUN_US		3600000000ULL					// One hour.
+#define RTOS_CALL_US		2
+#define CONTEXT_US			6
+#define HK_PERIOD_US		10000000
+#define TC_PERIOD_US		20000000
+#define TC_CHUNK_US			600
+#define TC_CHUNKS			(PACKET_LENGTH / 4)
+#define TC_SERVICE			17								// Rejected by verify_telecommand().
+#define BENCH_SEED			12345
+#define PENDING				64								// Reports on their way to the router.
+
+typedef struct
+{
+	const char* name;
+	uint8_t hk;
+	uint8_t tc;
+} scenario_t;
+
+typedef struct
+{
+	uint64_t at[PENDING];
+	uint32_t head, tail;
+	uint32_t sent, seen;
+	uint8_t count;											// Last value of the router's counter.
+	uint64_t sum_us, max_us;
+} latency_t;
+
+typedef struct
+{
+	latency_t tc, hk;
+	double cpu, wakes;
+} result_t;
+
+static uint8_t tc_packet[PACKET_LENGTH];
+static latency_t tc_latency, hk_latency;
+static uint64_t producer_calls;								// rtos_sim calls made by the events.
+static int64_t call_adjust;									// Calls the old loop's stand-ins saved or added.
+static uint64_t run_end;
+static uint32_t rng_state;
+
+/* The router's clocks are the same after this. */
+static void to_router(void)
+{
+	coms_sim_advance_to_us(nor_sim_now_us());
+	return;
+}
+
+/* The events which were due while the router was in a TM transfer. */
+static void from_router(void)
+{
+	if(coms_sim_now_us() > nor_sim_now_us())
+		rtos_sim_run_until(coms_sim_now_us());
+	return;
+}
+
+static uint64_t router_now(void)
+{
+	return (coms_sim_now_us() > nor_sim_now_us()) ? coms_sim_now_us() : nor_sim_now_us();
+}
+
+static void sent(latency_t* latency)
+{
+	latency->at[latency->head++ % PENDING] = nor_sim_now_us();
+	latency->sent++;
+	HOST_CHECK(latency->sent - latency->seen <= PENDING);
+	return;
+}
+
+/* Every report the router's counter says it has made since the last call. */
+static void seen(latency_t* latency, uint8_t count)
+{
+	uint64_t us;
+
+	while((latency->count != count) && (latency->seen < latency->sent))
+	{
+		latency->count++;
+		us = router_now() - latency->at[latency->tail++ % PENDING];
+		latency->sum_us += us;
+		if(us > latency->max_us)
+			latency->max_us = us;
+		latency->seen++;
+	}
+	return;
+}
+
+static void stamp(void)
+{
+	seen(&tc_latency, tc_verify_fail_count);
+	seen(&hk_latency, hk_telem_count);
+	return;
+}
+
+/* The HK task: one report through the pool. */
+static void hk_event(void* arg)
+{
+	rtos_sim_stats_t before, after;
+	uint8_t desc;
+
+	rtos_sim_get_stats(&before);
+	desc = pus_pool_alloc(0, 0);
+	HOST_CHECK(desc != PUS_POOL_NONE);
+	if(desc != PUS_POOL_NONE)
+	{
+		memset(pus_pool_buf(desc), 0x5A, PACKET_LENGTH);
+		pus_pool_buf(desc)[146] = HK_REPORT;
+		if(pus_pool_send(hk_to_obc_fifo, desc, 0) == pdTRUE)
+			sent(&hk_latency);
+	}
+	rtos_sim_get_stats(&after);
+	producer_calls += after.api_calls - before.api_calls;
+	rtos_sim_at(nor_sim_now_us() + HK_PERIOD_US, hk_event, 0);
+	return;
+}
+
+/* The CAN1 handler: one chunk of the TC from the COMS SSM. */
+static void chunk_event(void* arg)
+{
+	rtos_sim_stats_t before, after;
+	uint32_t chunk = (uint32_t)(uintptr_t)arg;
+	uint32_t low, high;
+
+	rtos_sim_get_stats(&before);
+	low = (uint32_t)tc_packet[4 * chunk] | ((uint32_t)tc_packet[4 * chunk + 1] << 8)
+		| ((uint32_t)tc_packet[4 * chunk + 2] << 16) | ((uint32_t)tc_packet[4 * chunk + 3] << 24);
+	high = chunk;
+	xQueueSendToBackFromISR(tc_msg_fifo, &low, 0);
+	xQueueSendToBackFromISR(tc_msg_fifo, &high, 0);
+	xSemaphoreGiveFromISR(opr_wake_sem, 0);
+	if(chunk == TC_CHUNKS - 1)
+		sent(&tc_latency);
+	rtos_sim_get_stats(&after);
+	producer_calls += after.api_calls - before.api_calls;
+	return;
+}
+
+static uint32_t rng(void)
+{
+	rng_state = rng_state * 1103515245 + 12345;
+	return rng_state >> 8;
+}
+
+/* The COMS SSM: a TC every TC_PERIOD_US on average, at no set phase to the HK reports. */
+static void tc_event(void* arg)
+{
+	uint32_t i;
+
+	for(i = 0; i < TC_CHUNKS; i++)
+		rtos_sim_at(nor_sim_now_us() + (uint64_t)i * TC_CHUNK_US, chunk_event, (void*)(uintptr_t)i);
+	rtos_sim_at(nor_sim_now_us() + TC_PERIOD_US / 2 + rng() % TC_PERIOD_US, tc_event, 0);
+	return;
+}
+
+/* The router's loop as it is. */
+static void new_loop(void)
+{
+	while(nor_sim_now_us() < run_end)
+	{
+		to_router();
+		xSemaphoreTake(opr_wake_sem, opr_wait_time());
+		to_router();
+		opr_serve();
+		stamp();
+		opr_downlink();
+		from_router();
+	}
+	return;
+}
+
+/* exec_commands() as it was, with a 1-tick wait on each FIFO. */
+static void old_exec_commands(void)
+{
+	uint8_t item[147];
+
+	xQueuePeek(hk_to_obc_fifo, item, (TickType_t)1);
+	xQueuePeek(time_to_obc_fifo, item, (TickType_t)1);
+	xQueuePeek(mem_to_obc_fifo, item, (TickType_t)1);
+	call_adjust -= 3;										// The receives in exec_commands() are the old calls.
+	to_router();
+	exec_commands();
+	stamp();
+	return;
+}
+
+/* The router's loop before user-023. */
+static void old_loop(void)
+{
+	TickType_t wait = 0, last_wake;							// xTimeToWait starts at 0.
+
+	while(nor_sim_now_us() < run_end)
+	{
+		if(!low_received)
+		{
+			if(xQueueReceive(tc_msg_fifo, &new_tc_msg_low, wait) == pdTRUE)
+				low_received = 1;
+		}
+		if(low_received & !high_received)
+		{
+			if(xQueueReceive(tc_msg_fifo, &new_tc_msg_high, wait) == pdTRUE)
+				high_received = 1;
+		}
+		to_router();
+		if(high_received)
+			receive_tc_msg();
+		if(!receiving_tcf)
+		{
+			if(xQueueReceive(tc_buffer, tc_to_decode, (TickType_t)1) == pdTRUE)
+			{
+				to_router();
+				decode_telecommand();
+				stamp();
+			}
+			if(!tm_down_fullf && !tm_sched_count())
+				vTaskDelay(1);								// xQueueReceive(tm_buffer, &down_desc, 1) found nothing.
+			else if(!tm_down_fullf)
+				call_adjust++;
+			to_router();
+			if(tm_down_fullf)
+				send_pus_packet_tm(tm_to_downlink[150]);
+			else if(tm_sched_get(&down_desc) == pdTRUE)
+			{
+				tm_to_downlink = pus_pool_buf(down_desc);
+				tm_down_fullf = 1;
+				send_pus_packet_tm(tm_to_downlink[150]);
+			}
+			from_router();
+			if(tm_transfer_completef)
+			{
+				wait = 3000;
+				last_wake = xTaskGetTickCount();
+				vTaskDelayUntil(&last_wake, wait);
+				tm_transfer_completef = 0;
+			}
+			old_exec_commands();
+		}
+	}
+	return;
+}
+
+static result_t run(const scenario_t* scenario, uint8_t old)
+{
+	rtos_sim_stats_t stats;
+	result_t result;
+	uint64_t start;
+	double secs;
+
+	host_test_reset();
+	router_sim_open(0);
+	to_router();
+	router_sim_start();
+	memset(&tc_latency, 0, sizeof(tc_latency));
+	memset(&hk_latency, 0, sizeof(hk_latency));
+	tc_latency.count = tc_verify_fail_count;
+	hk_latency.count = hk_telem_count;
+	producer_calls = 0;
+	call_adjust = 0;
+	rng_state = BENCH_SEED;
+	rtos_sim_set_api_cost(RTOS_CALL_US);
+	start = nor_sim_now_us();
+	run_end = start + BENCH_RUN_US;
+	if(scenario->hk)
+		rtos_sim_at(start + HK_PERIOD_US, hk_event, 0);
+	if(scenario->tc)
+		rtos_sim_at(start + TC_PERIOD_US / 2, tc_event, 0);
+	rtos_sim_reset_stats();
+	if(old)
+		old_loop();
+	else
+		new_loop();
+	rtos_sim_get_stats(&stats);
+	secs = (double)(nor_sim_now_us() - start) / 1e6;
+	result.tc = tc_latency;
+	result.hk = hk_latency;
+	result.cpu = (double)((int64_t)(stats.api_calls - producer_calls) + call_adjust) * RTOS_CALL_US + (double)stats.blocks * CONTEXT_US;
+	result.cpu = result.cpu / (secs * 1e6);
+	result.wakes = (double)stats.blocks / secs;
+	HOST_CHECK(tc_latency.sent - tc_latency.seen <= 1);	// All but one still on its way at the end.
+	HOST_CHECK(hk_latency.sent - hk_latency.seen <= 1);
+	HOST_CHECK(!scenario->tc || tc_latency.seen);
+	HOST_CHECK(!scenario->hk || hk_latency.seen);
+	return result;
+}
+
+static void print(const char* scenario, const char* loop, const result_t* result)
+{
+	printf("%-10s %-4s", scenario, loop);
+	if(result->tc.seen)
+		printf(" %5u %9.1f %9.1f", result->tc.seen, (double)result->tc.sum_us / result->tc.seen / 1000, (double)result->tc.max_us / 1000);
+	else
+		printf(" %5s %9s %9s", "-", "-", "-");
+	if(result->hk.seen)
+		printf(" %5u %9.1f %9.1f", result->hk.seen, (double)result->hk.sum_us / result->hk.seen / 1000, (double)result->hk.max_us / 1000);
+	else
+		printf(" %5s %9s %9s", "-", "-", "-");
+	printf(" %7.3f%% %8.1f\n", result->cpu * 100, result->wakes);
+	return;
+}
+
+int main(void)
+{
+	static const scenario_t scenarios[] = {{"idle", 0, 0}, {"hk", 1, 0}, {"tc+hk", 1, 1}};
+	result_t old, new;
+	uint16_t pec;
+	uint32_t i;
+
+	host_test_open("bench_router", 0);
+	memset(tc_packet, 0, sizeof(tc_packet));
+	tc_packet[151] = 0x18;									// TC with a data field header.
+	tc_packet[150] = HK_TASK_ID;
+	tc_packet[149] = 0xC0;
+	tc_packet[146] = PACKET_LENGTH - 1;
+	tc_packet[145] = 0x90;
+	tc_packet[144] = TC_SERVICE;
+	tc_packet[143] = 1;
+	pec = pus_pec(tc_packet + 2, PACKET_LENGTH - 2);
+	tc_packet[1] = (uint8_t)(pec >> 8);
+	tc_packet[0] = (uint8_t)pec;
+
+	printf("bench_router: %u s simulated per run, %u us per RTOS call, %u us per wake\n",
+		(uint32_t)(BENCH_RUN_US / 1000000), RTOS_CALL_US, CONTEXT_US);
+	printf("%-10s %-4s %5s %9s %9s %5s %9s %9s %8s %8s\n", "scenario", "loop", "TCs", "mean ms", "max ms",
+		"HK", "mean ms", "max ms", "CPU", "wakes/s");
+	for(i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+	{
+		old = run(&scenarios[i], 1);
+		new = run(&scenarios[i], 0);
+		print(scenarios[i].name, "old", &old);
+		print(scenarios[i].name, "new", &new);
+		HOST_CHECK(new.wakes < old.wakes);
+		if(!scenarios[i].hk)
+			HOST_CHECK(new.cpu < old.cpu);
+		if(scenarios[i].hk)
+			HOST_CHECK(new.hk.max_us < old.hk.max_us);
+		if(scenarios[i].tc)
+			HOST_CHECK(new.tc.max_us < old.tc.max_us);
+	}
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
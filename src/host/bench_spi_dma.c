@@ -0,0 +1,106 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_spi_dma.c
+*
+*	PURPOSE:		Benchmark of the SPI0 transfer engine (user-001): time of a page read and a page
+*					write, and the longest time with interrupts off, with the DMAC against the
+*					polled driver it replaced.
+*
+*	FILE REFERENCES:		host_test.h, rtos_sim.h, spimem.h, atomic.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The polled driver is modelled by nor_sim's word_gap_us = 100 (the delay_us(100) it
+*				left after every word) and by holding enter_atomic() around the whole operation,
+*				which is what spimem_read() and spimem_write() did before user-001 and user-006.
+*				Everything above the transfer layer (FTL, cache, three chips) is today's code in
+*				both columns, so the difference is the transfer engine alone. TM_BASE is used because
+*				it bypasses the page cache, every operation goes to the chips.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "rtos_sim.h"
+#include "spimem.h"
+#include "atomic.h"
+#include "host_test.h"
+
+#define BENCH_OPS		50
+
+typedef struct
+{
+	double read_us;
+	double write_us;
+	uint64_t irq_off_us;
+} bench_result_t;
+
+static uint8_t data[256];
+
+static void run(uint32_t word_gap_us, uint8_t atomic, bench_result_t* result)
+{
+	nor_sim_config_t config;
+	rtos_sim_stats_t stats;
+	uint64_t start;
+	uint32_t i;
+
+	nor_sim_default_config(&config);
+	config.word_gap_us = word_gap_us;
+	host_test_open("bench_spi_dma", &config);
+	for(i = 0; i < sizeof(data); i++)
+		data[i] = (uint8_t)i;
+	rtos_sim_reset_stats();
+
+	start = nor_sim_now_us();
+	for(i = 0; i < BENCH_OPS; i++)
+	{
+		if(atomic)
+			enter_atomic();
+		spimem_write(TM_BASE + i * 256, data, 256);
+		if(atomic)
+			exit_atomic();
+	}
+	result->write_us = (double)(nor_sim_now_us() - start) / BENCH_OPS;
+
+	start = nor_sim_now_us();
+	for(i = 0; i < BENCH_OPS; i++)
+	{
+		if(atomic)
+			enter_atomic();
+		spimem_read(TM_BASE + i * 256, data, 256);
+		if(atomic)
+			exit_atomic();
+	}
+	result->read_us = (double)(nor_sim_now_us() - start) / BENCH_OPS;
+
+	rtos_sim_get_stats(&stats);
+	result->irq_off_us = stats.critical_max_us;
+	host_test_close();
+	return;
+}
+
+int main(void)
+{
+	bench_result_t polled, dma;
+
+	run(100, 1, &polled);
+	run(0, 0, &dma);
+	printf("bench_spi_dma: one 256B page, %d operations each, simulated time\n", BENCH_OPS);
+	printf("%-28s %12s %12s\n", "", "polled", "DMAC");
+	printf("%-28s %10.0fus %10.0fus\n", "spimem_read()", polled.read_us, dma.read_us);
+	printf("%-28s %10.0fus %10.0fus\n", "spimem_write() (3 chips)", polled.write_us, dma.write_us);
+	printf("%-28s %10lluus %10lluus\n", "longest interrupts-off", (unsigned long long)polled.irq_off_us, (unsigned long long)dma.irq_off_us);
+	return 0;
+}
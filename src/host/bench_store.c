@@ -0,0 +1,173 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_store.c
+*
+*	PURPOSE:		Ingest and drain rates of the TM and TC stores (user-025) on the simulated SPI memory:
+*					the ring is filled, the OBC is reset, and the ring is opened again and emptied, twice
+*					so that the second lap wraps around the ring. Every packet is checked on the way
+*					out, also after the reset.
+*
+*	FILE REFERENCES:		host_test.h, nor_sim.h, spimem.h, spimem_cache.h, pus_store.h, global_var.h,
+*							string.h
+*
+*	EXTERNAL VARIABLES:		TM_BASE, TC_BASE (global_var.h)
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a packet is lost,
+*					comes back wrong or out of order, if the store doesn't hold the packets it took
+*					before the reset, or if it holds fewer packets than pus_store.c says it does.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		"TM": the TM store as the packet router opens it (the head is saved every
+*				OPR_TM_STORE_SAVE bytes read), packets are put back to back so SPI memory is written
+*				a whole page at a time. "TC": the TC store, which syncs after every packet
+*				(store_current_tc()) and saves the head after every packet read.
+*
+*				Rates are in simulated time (nor_sim.c) and include writing back the page cache
+*				(spimem_cache_flush()) at the end of the fill. Pages, headers and erases are what
+*				reached the chips per packet.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "global_var.h"
+#include "spimem.h"
+#include "spimem_cache.h"
+#include "pus_store.h"
+#include "nor_sim.h"
+#include "host_test.h"
+
+#define STORE_SIZE			0x20000							// OPR_STORE_SIZE
+#define TM_STORE_SAVE		(4 * PUS_STORE_PAGE)			// OPR_TM_STORE_SAVE
+#define LAPS				2
+#define HK_PERIOD_S			5								// HK_LOOP_TIMEOUT
+
+typedef struct
+{
+	const char* name;
+	uint32_t save;
+	uint8_t sync;											// Sync after every packet put.
+} store_config_t;
+
+typedef struct
+{
+	double pps, kbps;
+	double programs, erases;								// Per packet.
+	uint32_t headers;
+} rate_t;
+
+static pus_store_t store;
+
+/* The bytes of packet number n. */
+static void fill(uint8_t* packet, uint32_t n)
+{
+	uint32_t i;
+
+	for(i = 0; i < PACKET_LENGTH; i++)
+		packet[i] = (uint8_t)((n * 31) + (i * 7) + (n >> 8));
+	return;
+}
+
+static rate_t rate(uint32_t packets, uint64_t start_us, const nor_sim_stats_t* before, uint32_t headers)
+{
+	nor_sim_stats_t after;
+	rate_t result;
+	double secs = (double)(nor_sim_now_us() - start_us) / 1e6;
+
+	nor_sim_get_stats(&after);
+	result.pps = packets / secs;
+	result.kbps = packets * PACKET_LENGTH / secs / 1024;
+	result.programs = (double)(after.programs - before->programs) / packets;
+	result.erases = (double)(after.sect_erases - before->sect_erases) / packets;
+	result.headers = headers;
+	return result;
+}
+
+static void print(const char* name, uint32_t lap, const char* way, const rate_t* result)
+{
+	printf("%-4s %3u %-6s %9.1f %9.1f %12.2f %12.4f %8u\n", name, lap, way, result->pps, result->kbps,
+		result->programs, result->erases, result->headers);
+	return;
+}
+
+/* LAPS times: fill the store, reset, open it again and empty it. */
+static void run(const store_config_t* config, uint32_t base)
+{
+	static uint8_t packet[PACKET_LENGTH], expect[PACKET_LENGTH];
+	nor_sim_stats_t before;
+	rate_t ingest, drain;
+	uint64_t start;
+	uint32_t lap, i, n = 0, first, stored, bad = 0;
+	uint32_t headers;
+
+	HOST_CHECK(pus_store_open(&store, base, STORE_SIZE, config->save) >= 0);
+	for(lap = 1; lap <= LAPS; lap++)
+	{
+		/* Fill */
+		first = n;
+		headers = store.headers_written;
+		nor_sim_get_stats(&before);
+		start = nor_sim_now_us();
+		for(;;)
+		{
+			fill(packet, n);
+			if(pus_store_put(&store, packet) < 0)
+				break;
+			n++;
+			if(config->sync)
+				pus_store_sync(&store);
+		}
+		pus_store_sync(&store);
+		spimem_cache_flush();
+		stored = n - first;
+		ingest = rate(stored, start, &before, store.headers_written - headers);
+		HOST_CHECK(stored >= store.capacity - 1);			// Less the page kept in front of the head.
+
+		/* Reset and drain */
+		host_test_reset();
+		HOST_CHECK(pus_store_open(&store, base, STORE_SIZE, config->save) == (int)stored);
+		headers = store.headers_written;
+		nor_sim_get_stats(&before);
+		start = nor_sim_now_us();
+		for(i = first; i < n; i++)
+		{
+			if(pus_store_get(&store, packet) <= 0)
+				break;
+			fill(expect, i);
+			bad += (memcmp(packet, expect, PACKET_LENGTH) != 0);
+		}
+		spimem_cache_flush();
+		HOST_CHECK(i == n);
+		HOST_CHECK(!bad);
+		HOST_CHECK(pus_store_get(&store, packet) == 0);
+		drain = rate(n - first, start, &before, store.headers_written - headers);
+		print(config->name, lap, "ingest", &ingest);
+		print(config->name, lap, "drain", &drain);
+	}
+	return;
+}
+
+int main(void)
+{
+	static const store_config_t configs[] = {{"TM", TM_STORE_SAVE, 0}, {"TC", 0, 1}};
+
+	host_test_open("bench_store", 0);
+	pus_store_open(&store, TM_BASE, STORE_SIZE, TM_STORE_SAVE);
+	printf("bench_store: %u kB ring, %u packets (%u minutes of HK at one per %u s), simulated time\n",
+		STORE_SIZE / 1024, store.capacity, store.capacity * HK_PERIOD_S / 60, HK_PERIOD_S);
+	HOST_CHECK(store.capacity == (STORE_SIZE - 2 * PUS_STORE_PAGE) / PACKET_LENGTH);	// The sizing in pus_store.c.
+	printf("%-4s %3s %-6s %9s %9s %12s %12s %8s\n", "ring", "lap", "", "pkt/s", "kB/s", "programs/pkt", "erases/pkt", "headers");
+	run(&configs[0], TM_BASE);
+	run(&configs[1], TC_BASE);
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_stream_read.c
+*
+*	PURPOSE:		Benchmark of the streaming reads (user-002): time to read 64kB of SPI memory
+*					page by page with spimem_read(), in one call to spimem_read_stream(), and in
+*					256B chunks through spimem_read_stream_cb().
+*
+*	FILE REFERENCES:		host_test.h, rtos_sim.h, spimem.h, checksum.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a read doesn't
+*					return what was written, or if spimem_read_stream_cb() needs more RD commands
+*					than spimem_read_stream().
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The OBC is reset (host_test_reset()) before every run so that none of the pages are
+*				in the page cache. The FTL writes the region into consecutive physical pages, so a
+*				stream only has to start a new RD command at each sector's summary page.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*	10/16/2026			spimem_read_stream_cb() now takes as few RD commands as spimem_read_stream().
+*
+*/
+
+#include <string.h>
+#include "rtos_sim.h"
+#include "spimem.h"
+#include "checksum.h"
+#include "host_test.h"
+
+#define BENCH_SIZE		0x10000
+
+static uint8_t pattern[BENCH_SIZE], data[BENCH_SIZE];
+static uint16_t chunk_sum;
+
+static int checksum_chunk(void* arg, uint32_t addr, uint8_t* chunk, uint32_t size)
+{
+	memcpy(data + (addr - SCIENCE_BASE), chunk, size);
+	chunk_sum ^= fletcher16(chunk, size);
+	return 1;
+}
+
+/* Prints a row and returns the number of RD commands. */
+static uint64_t show(const char* name, uint64_t start, nor_sim_stats_t* before)
+{
+	nor_sim_stats_t after;
+	uint64_t us = nor_sim_now_us() - start;
+
+	nor_sim_get_stats(&after);
+	printf("%-34s %8.1fms %8.1fkB/s %8llu %10llu\n", name, us / 1000.0, (BENCH_SIZE / 1024.0) / (us / 1e6),
+		(unsigned long long)(after.reads - before->reads), (unsigned long long)(after.bytes - before->bytes));
+	if(memcmp(data, pattern, BENCH_SIZE))
+	{
+		printf("%s: read back the wrong data\n", name);
+		host_test_failures++;
+	}
+	memset(data, 0, BENCH_SIZE);
+	return after.reads - before->reads;
+}
+
+int main(void)
+{
+	nor_sim_stats_t before;
+	uint8_t chunk[256];
+	uint64_t start, stream_reads;
+	uint32_t i;
+
+	host_test_open("bench_stream_read", 0);
+	for(i = 0; i < BENCH_SIZE; i++)
+		pattern[i] = (uint8_t)((i * 13) ^ (i >> 8));
+	for(i = 0; i < BENCH_SIZE; i += 256)
+		spimem_write(SCIENCE_BASE + i, pattern + i, 256);
+	spimem_cache_flush();
+
+	printf("bench_stream_read: 64kB from SCIENCE_BASE, simulated time\n");
+	printf("%-34s %10s %12s %8s %10s\n", "", "time", "rate", "RD cmds", "SPI bytes");
+
+	host_test_reset();
+	nor_sim_get_stats(&before);
+	start = nor_sim_now_us();
+	for(i = 0; i < BENCH_SIZE; i += 256)
+		spimem_read(SCIENCE_BASE + i, data + i, 256);
+	show("spimem_read() per page", start, &before);
+
+	host_test_reset();
+	nor_sim_get_stats(&before);
+	start = nor_sim_now_us();
+	spimem_read_stream(SCIENCE_BASE, data, BENCH_SIZE);
+	stream_reads = show("spimem_read_stream()", start, &before);
+
+	host_test_reset();
+	nor_sim_get_stats(&before);
+	start = nor_sim_now_us();
+	spimem_read_stream_cb(SCIENCE_BASE, BENCH_SIZE, chunk, sizeof(chunk), checksum_chunk, 0);
+	if(show("spimem_read_stream_cb() 256B", start, &before) > stream_reads)
+	{
+		printf("spimem_read_stream_cb(): more RD commands than spimem_read_stream()\n");
+		host_test_failures++;
+	}
+
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
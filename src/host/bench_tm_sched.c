@@ -0,0 +1,292 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_tm_sched.c
+*
+*	PURPOSE:		Load test of the TM queues (user-024): the packet router's loop with the science
+*					downlink saturated, TCs and HK reports coming in on top, and the time from a TC
+*					to its verification report reaching COMS.
+*
+*	FILE REFERENCES:		host_test.h, router_sim.c (obc_packet_router.c), rtos_sim.h, nor_sim.h, coms_sim.h,
+*							pus_pool.h, tm_sched.h, checksum.h, global_var.h, string.h
+*
+*	EXTERNAL VARIABLES:		hk_to_obc_fifo, mem_to_obc_fifo, tc_msg_fifo, opr_wake_sem (global_var.h)
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a verification report
+*					is lost or takes longer than VERIFY_BOUND_US, if the science downlink isn't
+*					saturated (no science dropped) or if science gets nothing through.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		One simulated hour of opr_wait_time(), xSemaphoreTake() on opr_wake_sem, opr_serve()
+*				and opr_downlink(), with the legacy transfer to coms_sim and no frames lost. The
+*				memory task offers a science packet through mem_to_obc_fifo every SCIENCE_PERIOD_US,
+*				far more than the downlink takes (one packet per transfer + OPR_TM_PACE). The HK
+*				task sends a report every 10 s. The COMS SSM sends a TC every 20 s on average, at
+*				random times, as in bench_router.c; it is rejected by verify_telecommand(), so its
+*				(1,2) report is the verification.
+*
+*				Latency is from the last chunk of the TC (or the HK task's send) to the end of the
+*				transfer which took the report to COMS. A verification can wait for the packet
+*				being sent and the OPR_TM_PACE after it, then its own transfer: VERIFY_BOUND_US.
+*
+*				Depth and age are tm_sched_stat() (TM_*_DEPTH and _AGE in HK), the largest seen
+*				after each wake. "FIFO" is what a verification would wait behind a full tm_buffer
+*				of 10 packets at the same downlink rate, for reference.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "router_sim.c"									// Also global_var.h, checksum.h, pus_pool.h, tm_sched.h.
+#include "rtos_sim.h"
+#include "nor_sim.h"
+#include "host_test.h"
+
+#define BENCH_RUN_US		3600000000ULL					// One hour.
+#define BENCH_SEED			12345
+#define SCIENCE_PERIOD_US	50000
+#define HK_PERIOD_US		10000000
+#define TC_PERIOD_US		20000000
+#define TC_CHUNK_US			600
+#define TC_CHUNKS			(PACKET_LENGTH / 4)
+#define TC_SERVICE			17								// Rejected by verify_telecommand().
+#define OLD_TM_BUFFER		10								// Depth of tm_buffer before the TM queues.
+#define TRANSFER_MAX_US		1500000							// Longest legacy transfer with no frames lost.
+#define VERIFY_BOUND_US		((uint64_t)OPR_TM_PACE * 1000 + 2 * TRANSFER_MAX_US)
+#define PENDING				64								// Reports on their way to COMS.
+
+typedef struct
+{
+	uint64_t at[PENDING];
+	uint32_t head, tail;
+	uint32_t sent, seen;
+	uint64_t sum_us, max_us;
+} latency_t;
+
+static uint8_t tc_packet[PACKET_LENGTH];
+static latency_t tc_latency, hk_latency;
+static uint32_t downlinked[TM_CLASSES];
+static uint32_t max_depth[TM_CLASSES], max_age[TM_CLASSES];
+static uint32_t science_offered, science_refused;
+static uint64_t transfer_max_us;
+static uint32_t rng_state;
+
+/* The router's clocks are the same after this. */
+static void to_router(void)
+{
+	coms_sim_advance_to_us(nor_sim_now_us());
+	return;
+}
+
+/* The events which were due while the router was in a TM transfer. */
+static void from_router(void)
+{
+	if(coms_sim_now_us() > nor_sim_now_us())
+		rtos_sim_run_until(coms_sim_now_us());
+	return;
+}
+
+static uint32_t rng(void)
+{
+	rng_state = rng_state * 1103515245 + 12345;
+	return rng_state >> 8;
+}
+
+static void sent(latency_t* latency)
+{
+	latency->at[latency->head++ % PENDING] = nor_sim_now_us();
+	latency->sent++;
+	HOST_CHECK(latency->sent - latency->seen <= PENDING);
+	return;
+}
+
+static void seen(latency_t* latency)
+{
+	uint64_t us;
+
+	if(latency->seen == latency->sent)
+		return;
+	us = coms_sim_now_us() - latency->at[latency->tail++ % PENDING];
+	latency->sum_us += us;
+	if(us > latency->max_us)
+		latency->max_us = us;
+	latency->seen++;
+	return;
+}
+
+/* The memory task: one science packet, unless mem_to_obc_fifo is full. */
+static void science_event(void* arg)
+{
+	uint8_t desc;
+
+	science_offered++;
+	desc = pus_pool_alloc(PUS_POOL_RESERVE, 0);
+	if(desc == PUS_POOL_NONE)
+		science_refused++;
+	else
+	{
+		memset(pus_pool_buf(desc), 0xA5, PACKET_LENGTH);
+		pus_pool_buf(desc)[146] = DOWNLINKING_SCIENCE;
+		if(pus_pool_send(mem_to_obc_fifo, desc, 0) != pdTRUE)
+			science_refused++;
+	}
+	rtos_sim_at(nor_sim_now_us() + SCIENCE_PERIOD_US, science_event, 0);
+	return;
+}
+
+/* The HK task: one report through the pool. */
+static void hk_event(void* arg)
+{
+	uint8_t desc;
+
+	desc = pus_pool_alloc(0, 0);
+	HOST_CHECK(desc != PUS_POOL_NONE);
+	if(desc != PUS_POOL_NONE)
+	{
+		memset(pus_pool_buf(desc), 0x5A, PACKET_LENGTH);
+		pus_pool_buf(desc)[146] = HK_REPORT;
+		if(pus_pool_send(hk_to_obc_fifo, desc, 0) == pdTRUE)
+			sent(&hk_latency);
+	}
+	rtos_sim_at(nor_sim_now_us() + HK_PERIOD_US, hk_event, 0);
+	return;
+}
+
+/* The CAN1 handler: one chunk of the TC from the COMS SSM. */
+static void chunk_event(void* arg)
+{
+	uint32_t chunk = (uint32_t)(uintptr_t)arg;
+	uint32_t low, high;
+
+	low = (uint32_t)tc_packet[4 * chunk] | ((uint32_t)tc_packet[4 * chunk + 1] << 8)
+		| ((uint32_t)tc_packet[4 * chunk + 2] << 16) | ((uint32_t)tc_packet[4 * chunk + 3] << 24);
+	high = chunk;
+	xQueueSendToBackFromISR(tc_msg_fifo, &low, 0);
+	xQueueSendToBackFromISR(tc_msg_fifo, &high, 0);
+	xSemaphoreGiveFromISR(opr_wake_sem, 0);
+	if(chunk == TC_CHUNKS - 1)
+		sent(&tc_latency);
+	return;
+}
+
+/* The COMS SSM: a TC every TC_PERIOD_US on average. */
+static void tc_event(void* arg)
+{
+	uint32_t i;
+
+	for(i = 0; i < TC_CHUNKS; i++)
+		rtos_sim_at(nor_sim_now_us() + (uint64_t)i * TC_CHUNK_US, chunk_event, (void*)(uintptr_t)i);
+	rtos_sim_at(nor_sim_now_us() + TC_PERIOD_US / 2 + rng() % TC_PERIOD_US, tc_event, 0);
+	return;
+}
+
+/* Which report reached COMS in the last opr_downlink(), and the HK export of the queues. */
+static void account(uint64_t packets_before, uint64_t start_us)
+{
+	coms_sim_stats_t stats;
+	uint8_t tm_class;
+	uint32_t val;
+
+	coms_sim_get_stats(&stats);
+	if(stats.packets != packets_before)
+	{
+		if(coms_sim_now_us() - start_us > transfer_max_us)
+			transfer_max_us = coms_sim_now_us() - start_us;
+		tm_class = tm_sched_class(coms_sim_packet());
+		downlinked[tm_class]++;
+		if(tm_class == TM_CLASS_VERIFY)
+			seen(&tc_latency);
+		if(tm_class == TM_CLASS_HK)
+			seen(&hk_latency);
+	}
+	for(tm_class = 0; tm_class < TM_CLASSES; tm_class++)
+	{
+		val = tm_sched_stat(tm_class, TM_STAT_DEPTH);
+		if(val > max_depth[tm_class])
+			max_depth[tm_class] = val;
+		val = tm_sched_stat(tm_class, TM_STAT_AGE);
+		if(val > max_age[tm_class])
+			max_age[tm_class] = val;
+	}
+	return;
+}
+
+int main(void)
+{
+	static const char* names[TM_CLASSES] = {"verify", "event", "hk", "dump", "science", "stored"};
+	coms_sim_stats_t stats;
+	uint64_t start, end, before_us;
+	uint32_t i, total = 0;
+	uint16_t pec;
+	double secs, period_s;
+
+	host_test_open("bench_tm_sched", 0);
+	memset(tc_packet, 0, sizeof(tc_packet));
+	tc_packet[151] = 0x18;									// TC with a data field header.
+	tc_packet[150] = HK_TASK_ID;
+	tc_packet[149] = 0xC0;
+	tc_packet[146] = PACKET_LENGTH - 1;
+	tc_packet[145] = 0x90;
+	tc_packet[144] = TC_SERVICE;
+	tc_packet[143] = 1;
+	pec = pus_pec(tc_packet + 2, PACKET_LENGTH - 2);
+	tc_packet[1] = (uint8_t)(pec >> 8);
+	tc_packet[0] = (uint8_t)pec;
+
+	router_sim_open(0);
+	to_router();
+	router_sim_start();
+	rng_state = BENCH_SEED;
+	start = nor_sim_now_us();
+	end = start + BENCH_RUN_US;
+	rtos_sim_at(start, science_event, 0);
+	rtos_sim_at(start + HK_PERIOD_US, hk_event, 0);
+	rtos_sim_at(start + TC_PERIOD_US / 2, tc_event, 0);
+	while(nor_sim_now_us() < end)
+	{
+		to_router();
+		xSemaphoreTake(opr_wake_sem, opr_wait_time());
+		to_router();
+		opr_serve();
+		coms_sim_get_stats(&stats);
+		before_us = coms_sim_now_us();
+		opr_downlink();
+		account(stats.packets, before_us);
+		from_router();
+	}
+	secs = (double)(nor_sim_now_us() - start) / 1e6;
+
+	for(i = 0; i < TM_CLASSES; i++)
+		total += downlinked[i];
+	period_s = total ? secs / total : 0;
+	printf("bench_tm_sched: %u s simulated, science offered every %u ms, %u packets downlinked (one per %.2f s)\n",
+		(uint32_t)secs, SCIENCE_PERIOD_US / 1000, total, period_s);
+	printf("%-8s %6s %6s %10s %10s\n", "class", "sent", "drops", "max depth", "max age s");
+	for(i = 0; i < TM_CLASSES; i++)
+		printf("%-8s %6u %6u %10u %10.1f\n", names[i], downlinked[i], tm_sched_stat(i, TM_STAT_DROPS), max_depth[i], max_age[i] / 1000.0);
+	printf("science offered %u, refused by the pool or mem_to_obc_fifo %u\n", science_offered, science_refused);
+	printf("%-14s %5s %9s %9s %9s\n", "latency", "n", "mean s", "max s", "bound s");
+	printf("%-14s %5u %9.2f %9.2f %9.2f\n", "TC->verify", tc_latency.seen,
+		tc_latency.seen ? (double)tc_latency.sum_us / tc_latency.seen / 1e6 : 0, (double)tc_latency.max_us / 1e6, (double)VERIFY_BOUND_US / 1e6);
+	printf("%-14s %5u %9.2f %9.2f %9s\n", "HK", hk_latency.seen,
+		hk_latency.seen ? (double)hk_latency.sum_us / hk_latency.seen / 1e6 : 0, (double)hk_latency.max_us / 1e6, "-");
+	printf("%-14s %5s %9s %9.2f %9s\n", "FIFO (ref)", "-", "-", OLD_TM_BUFFER * period_s, "-");
+	printf("longest transfer %.2f s\n", transfer_max_us / 1e6);
+
+	HOST_CHECK(tc_latency.seen && (tc_latency.sent - tc_latency.seen <= 1));
+	HOST_CHECK(tm_sched_stat(TM_CLASS_VERIFY, TM_STAT_DROPS) == 0);
+	HOST_CHECK(tc_latency.max_us <= VERIFY_BOUND_US);
+	HOST_CHECK(transfer_max_us <= TRANSFER_MAX_US);
+	HOST_CHECK(tm_sched_stat(TM_CLASS_SCIENCE, TM_STAT_DROPS) > 0);	// Saturated.
+	HOST_CHECK(downlinked[TM_CLASS_SCIENCE] > 0);						// But not starved.
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
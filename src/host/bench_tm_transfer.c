@@ -0,0 +1,147 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_tm_transfer.c
+*
+*	PURPOSE:		TM packets/s from the packet router to the COMS SSM over CAN (user-022): the router's
+*					send_pus_packet_tm() with the legacy transfer and with the windowed transfer,
+*					against coms_sim.c with 0, 0.1%, 1% and 5% of the frames lost in either direction.
+*
+*	FILE REFERENCES:		host_test.h, obc_sim.h, router_sim.h, coms_sim.h, pus_pool.h, global_var.h,
+*							string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a packet reaches
+*					COMS with a wrong byte, if one never gets there, if the windowed transfer delivers
+*					one twice, or if it is slower than the legacy one on any link.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		Simulated time on coms_sim's clock, 250 kbps CAN (coms_sim_default_config()).
+*				Each packet is random data and is compared byte for byte with what the SSM put
+*				together. A transfer which fails is tried again OPR_RETRY_WAIT later with the same
+*				packet, as the router does with tm_down_fullf set. The OPR_TM_PACE pause between
+*				packets is left out, it would hide the transfer behind 3 s per packet.
+*
+*				"retx" is the share of the data frames sent which repeated data the SSM had been
+*				sent before for the same packet. "dups" are packets which the legacy SSM put
+*				together twice: the response to the last frame was lost, so the router sent the
+*				whole packet again. The windowed transfer's packet tag prevents that.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "global_var.h"
+#include "pus_pool.h"
+#include "obc_sim.h"
+#include "coms_sim.h"
+#include "router_sim.h"
+#include "host_test.h"
+
+#define BENCH_PACKETS		300
+#define BENCH_SEED			12345
+#define ROUTER_RETRY_US		10000						// OPR_RETRY_WAIT
+#define MAX_TRIES			50							// Per packet, then the link counts as broken.
+
+typedef struct
+{
+	double pps;
+	double retx;
+	uint32_t failures;									// Transfers which were tried again.
+	uint32_t duplicates;								// Packets the SSM put together more than once.
+} transfer_result_t;
+
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+	rng_state = rng_state * 1103515245 + 12345;
+	return rng_state >> 8;
+}
+
+/* BENCH_PACKETS packets over a link which loses a share loss of the frames. */
+static transfer_result_t run(uint8_t windowed, double loss)
+{
+	static uint8_t sent[PACKET_LENGTH];
+	coms_sim_config_t config;
+	coms_sim_stats_t stats;
+	transfer_result_t result;
+	uint64_t start;
+	uint32_t packet, i, tries;
+	uint8_t desc;
+	int ret;
+
+	obc_sim_init();
+	coms_sim_default_config(&config);
+	config.loss = loss;
+	config.seed = BENCH_SEED;
+	if(windowed)
+		router_sim_windowed_open(&config);
+	else
+		router_sim_open(&config);
+	memset(&result, 0, sizeof(result));
+	start = coms_sim_now_us();
+	for(packet = 0; packet < BENCH_PACKETS; packet++)
+	{
+		desc = pus_pool_alloc(0, 0);
+		if(desc == PUS_POOL_NONE)
+		{
+			HOST_CHECK(0);
+			break;
+		}
+		for(i = 0; i < PACKET_LENGTH; i++)
+			sent[i] = (uint8_t)rng();
+		memcpy(pus_pool_buf(desc), sent, PACKET_LENGTH);
+		for(tries = 0; tries < MAX_TRIES; tries++)
+		{
+			ret = windowed ? router_sim_windowed_send_tm(desc) : router_sim_send_tm(desc);
+			if(ret >= 0)
+				break;
+			result.failures++;
+			coms_sim_delay_us(ROUTER_RETRY_US);
+		}
+		HOST_CHECK(ret >= 0);
+		if(ret < 0)
+		{
+			pus_pool_release(desc);
+			break;
+		}
+		HOST_CHECK(!memcmp(coms_sim_packet(), sent, PACKET_LENGTH));
+	}
+	coms_sim_get_stats(&stats);
+	HOST_CHECK(stats.packets >= packet);
+	HOST_CHECK(!windowed || (stats.packets == packet));		// The tag keeps a packet from being taken twice.
+	result.duplicates = (uint32_t)(stats.packets - packet);
+	HOST_CHECK(pus_pool_free_count() == PUS_POOL_SIZE);
+	result.pps = (double)packet * 1e6 / (double)(coms_sim_now_us() - start);
+	result.retx = stats.frames ? (double)stats.retransmissions / (double)stats.frames : 0;
+	return result;
+}
+
+int main(void)
+{
+	static const double losses[] = {0, 0.001, 0.01, 0.05};
+	transfer_result_t legacy, windowed;
+	uint32_t i;
+
+	printf("bench_tm_transfer: %u TM packets to COMS, 250 kbps CAN, simulated time\n", BENCH_PACKETS);
+	printf("%-6s %12s %7s %6s %5s %12s %7s %6s\n", "loss", "legacy pkt/s", "retx", "fails", "dups", "window pkt/s", "retx", "fails");
+	for(i = 0; i < sizeof(losses) / sizeof(losses[0]); i++)
+	{
+		legacy = run(0, losses[i]);
+		windowed = run(1, losses[i]);
+		printf("%5.1f%% %12.2f %6.1f%% %6u %5u %12.2f %6.1f%% %6u\n", losses[i] * 100, legacy.pps, legacy.retx * 100,
+			legacy.failures, legacy.duplicates, windowed.pps, windowed.retx * 100, windowed.failures);
+		HOST_CHECK(windowed.pps > legacy.pps);
+	}
+	return host_test_failures ? 1 : 0;
+}
@@ -0,0 +1,106 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_voted_read.c
+*
+*	PURPOSE:		Cost of the majority-voted read (user-009): spimem_read_voted() against
+*					spimem_read() for 16B, 256B and 4kB, and what the vote does for a bit flip on the
+*					first chip.
+*
+*	FILE REFERENCES:		host_test.h, spimem.h, spimem_ftl.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if the voted read
+*					returns the flipped bit or the repair doesn't fix chip 1.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		TM_BASE bypasses the page cache, so every read goes to the chips. The time is SPI
+*				and flash time, the word-wise vote itself runs on the CPU and isn't simulated.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#define _GNU_SOURCE
+#include <string.h>
+#include "spimem.h"
+#include "spimem_ftl.h"
+#include "host_test.h"
+
+#define BENCH_OPS		50
+#define BENCH_SIZE		4096
+
+static uint8_t pattern[BENCH_SIZE], data[BENCH_SIZE];
+
+static double time_reads(uint32_t size, uint8_t voted)
+{
+	uint64_t start;
+	uint32_t i;
+
+	start = nor_sim_now_us();
+	for(i = 0; i < BENCH_OPS; i++)
+	{
+		if(voted)
+			HOST_CHECK(spimem_read_voted(TM_BASE, data, size) == (int)size);
+		else
+			HOST_CHECK(spimem_read(TM_BASE, data, size) == (int)size);
+	}
+	return (double)(nor_sim_now_us() - start) / BENCH_OPS;
+}
+
+int main(void)
+{
+	static const uint32_t sizes[] = {16, 256, 4096};
+	double single, voted;
+	uint8_t* copy;
+	uint32_t i, phys;
+	int repaired;
+
+	host_test_open("bench_voted_read", 0);
+	for(i = 0; i < BENCH_SIZE; i++)
+		pattern[i] = (uint8_t)((i * 29) ^ (i >> 7) ^ 0x5A);
+	for(i = 0; i < BENCH_SIZE; i += 256)
+		spimem_write(TM_BASE + i, pattern + i, 256);
+
+	printf("bench_voted_read: %d reads at TM_BASE, simulated time\n", BENCH_OPS);
+	printf("%-10s %14s %14s %8s\n", "", "spimem_read", "voted", "ratio");
+	for(i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+	{
+		single = time_reads(sizes[i], 0);
+		voted = time_reads(sizes[i], 1);
+		printf("%8luB %12.0fus %12.0fus %7.2fx\n", (unsigned long)sizes[i], single, voted, voted / single);
+	}
+
+	/* Flip a bit in chip 1's copy of the first page. */
+	copy = memmem(nor_sim_memory(1), 0x100000, pattern, 256);
+	HOST_CHECK(copy != 0);
+	if(!copy)
+		return 1;
+	phys = (uint32_t)(copy - nor_sim_memory(1));
+	nor_sim_flip_bit(1, phys + 100, 3);
+
+	spimem_read(TM_BASE, data, 256);
+	printf("bit flip on chip 1: spimem_read() %s", memcmp(data, pattern, 256) ? "returns the flip" : "is correct");
+	HOST_CHECK(spimem_read_voted(TM_BASE, data, 256) == 256);
+	HOST_CHECK(!memcmp(data, pattern, 256));
+	printf(", spimem_read_voted() %s", memcmp(data, pattern, 256) ? "returns the flip" : "is correct");
+
+	xSemaphoreTake(Spi0_Mutex, portMAX_DELAY);
+	repaired = spimem_ftl_repair_h();
+	xSemaphoreGive(Spi0_Mutex);
+	HOST_CHECK(repaired == 1);
+	HOST_CHECK(spimem_read(TM_BASE, data, 256) == 256);
+	HOST_CHECK(!memcmp(data, pattern, 256));
+	printf(", %s\n", (repaired == 1) ? "repaired" : "NOT repaired");
+
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
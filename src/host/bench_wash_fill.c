@@ -0,0 +1,142 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_wash_fill.c
+*
+*	PURPOSE:		Time for one full memory wash at 10%, 50% and 100% fill (user-014): the old wash,
+*					which read every page from each chip and compared it, against memory_wash(), which
+*					skips blank and garbage pages (without using up its budget) and compares checksums
+*					first.
+*
+*	FILE REFERENCES:		host_test.h, obc_sim.h, rtos_sim.h, spimem_cache.h, memory_manage.c (build/src)
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a pass doesn't
+*					finish, if at 10% fill it isn't at least five times shorter than the old one, in
+*					wake-ups and in SPI time, or if at any fill it takes more SPI time than the old one.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The fill is a share of the logical space (FTL_LOGICAL_PAGES), written from address 0
+*				and flushed out of the page cache. The memory task washes WASH_PAGES_PER_SLICE pages
+*				per wake-up, one wake-up a second. "SPI time" is the time spent inside the wash
+*				calls, "pass" the time from the first wake-up to MEMORY_WASH_FINISHED.
+*
+*				The summary page of every FTL sector holds its erase count and is washed like a live
+*				page, so even an empty memory has 254 pages to wash each pass. The state of a page
+*				comes from a voted read of its sector's summary.
+*
+*				The SPI time also holds the ECC scrub of one protected page per wake-up
+*				(memory_scrub()). The fill leaves the ECC records at EDAC_BASE alone, like any other
+*				writer would, otherwise the scrub spends the pass rebuilding them.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*	10/16/2026			The fill skips EDAC_BASE. The new wash must not take more SPI time than the old one.
+*
+*/
+
+#include <string.h>
+#include "memory_manage.c"
+#include "spimem_cache.h"
+#include "rtos_sim.h"
+#include "obc_sim.h"
+#include "host_test.h"
+
+/* The wash before user-014: every page read once from each chip and compared byte by byte. */
+static void old_wash(void)
+{
+	uint32_t p;
+
+	for(p = 0; p < WASH_PAGES; p++)
+	{
+		spimem_read_alt(1, p << 8, page_buff1, 256);
+		spimem_read_alt(2, p << 8, page_buff2, 256);
+		spimem_read_alt(3, p << 8, page_buff3, 256);
+	}
+	return;
+}
+
+static void fill(uint32_t percent)
+{
+	uint8_t data[256];
+	uint32_t i, j, pages = (FTL_LOGICAL_PAGES * percent) / 100;
+
+	host_test_open("bench_wash_fill", 0);
+	for(i = 0; i < pages; i++)
+	{
+		if(((i << 8) >= EDAC_BASE) && ((i << 8) < (EDAC_BASE + SPIMEM_EDAC_SIZE)))
+			continue;							// The ECC records stay what spimem_edac.c wrote.
+		for(j = 0; j < 256; j++)
+			data[j] = (uint8_t)((i * 5) + (j * 7));
+		spimem_write(i << 8, data, 256);
+	}
+	spimem_cache_flush();
+	wash_cursor_loaded = 0;
+	wash_hot = 0;
+	wash_hot_page = 0;
+	WASH_RATE = WASH_PAGES_PER_SLICE;
+	return;
+}
+
+int main(void)
+{
+	static const uint32_t fills[] = {10, 50, 100};
+	uint8_t packet[PACKET_LENGTH];
+	nor_sim_stats_t stats;
+	uint64_t start, wash_start, spi_us;
+	double old_s, old_spi_s, new_s, new_spi_s;
+	uint32_t i, wakes, finished;
+
+	printf("bench_wash_fill: one full wash, %d pages per wake-up, simulated time\n", WASH_PAGES_PER_SLICE);
+	printf("%-6s %12s %12s %10s %12s %12s %10s %8s %8s\n", "fill", "old pass", "old SPI", "old reads", "new pass",
+		"new SPI", "new reads", "pass", "SPI");
+	for(i = 0; i < sizeof(fills) / sizeof(fills[0]); i++)
+	{
+		/* Every page used to count against the budget, so a pass took 4096 / 8 wake-ups whatever the fill. */
+		fill(fills[i]);
+		nor_sim_reset_stats();
+		start = nor_sim_now_us();
+		old_wash();
+		old_spi_s = (double)(nor_sim_now_us() - start) / 1e6;
+		old_s = (double)(WASH_PAGES / WASH_PAGES_PER_SLICE);
+		nor_sim_get_stats(&stats);
+		printf("%5lu%% %11.1fs %11.2fs %10lu", (unsigned long)fills[i], old_s, old_spi_s, (unsigned long)stats.reads);
+		host_test_close();
+
+		fill(fills[i]);
+		nor_sim_reset_stats();
+		start = nor_sim_now_us();
+		spi_us = 0;
+		for(wakes = 0, finished = 0; !finished && (wakes < WASH_PAGES); wakes++)
+		{
+			rtos_sim_run_until(start + (uint64_t)wakes * 1000000);
+			wash_start = nor_sim_now_us();
+			memory_wash(WASH_RATE);
+			spi_us += nor_sim_now_us() - wash_start;
+			while(obc_sim_take_packet(mem_to_obc_fifo, packet))
+			{
+				if((packet[146] == TASK_TO_OPR_EVENT) && (packet[136] == MEMORY_WASH_FINISHED))
+					finished = 1;
+			}
+		}
+		new_s = (double)(nor_sim_now_us() - start) / 1e6;
+		new_spi_s = (double)spi_us / 1e6;
+		nor_sim_get_stats(&stats);
+		printf(" %11.1fs %11.2fs %10lu %7.1fx %7.1fx\n", new_s, new_spi_s, (unsigned long)stats.reads, old_s / new_s,
+			old_spi_s / new_spi_s);
+		HOST_CHECK(finished);
+		if(fills[i] == 10)
+			HOST_CHECK(((old_s / new_s) >= 5.0) && ((old_spi_s / new_spi_s) >= 5.0));
+		HOST_CHECK(new_spi_s <= old_spi_s);
+		host_test_close();
+	}
+	return host_test_failures ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_wash_latency.c
+*
+*	PURPOSE:		Latency of task_spimem_write() while the memory wash runs (user-011): the old wash,
+*					which read every page three times from each chip in one go, against the
+*					incremental memory_wash() at the starting rate and at the ceiling.
+*
+*	FILE REFERENCES:		host_test.h, rtos_sim.h, obc_sim.h, memory_manage.c (build/src), stdlib.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a write fails, the
+*					incremental wash doesn't finish a full pass or its p99 latency isn't below the old one.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The writer is the housekeeping task: 16B to HK_BASE every WRITE_PERIOD_US. It has a
+*				lower priority than the memory task, so it only gets the CPU once the memory task
+*				blocks, which is at the end of a wash slice (or of the whole wash, for the old one).
+*				A write's latency is the time from when it was due until it returned.
+*
+*				Half of the logical space is written first so that the wash has live pages to read.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <stdlib.h>
+#include "memory_manage.c"
+#include "rtos_sim.h"
+#include "obc_sim.h"
+#include "host_test.h"
+
+#define WRITE_PERIOD_US		50000
+#define WRITES_MAX			(WASH_PAGES * 20)
+#define FILL_PAGES			(FTL_LOGICAL_PAGES / 2)
+
+static uint64_t write_due;
+static uint32_t write_latency[WRITES_MAX], write_count, write_failures;
+static uint8_t hk_data[16];
+
+/* Runs the writes which fell due up to time_us, each one at its due time or now if it is late. */
+static void run_writes(uint64_t time_us)
+{
+	while(write_due <= time_us)
+	{
+		if(write_due > nor_sim_now_us())
+			rtos_sim_run_until(write_due);
+		hk_data[0] = (uint8_t)write_count;
+		hk_data[1] = (uint8_t)(write_count >> 8);
+		if(task_spimem_write(HK_TASK_ID, HK_BASE + ((write_count * 16) % LENGTH_OF_HK), hk_data, 16) < 0)
+			write_failures++;
+		if(write_count < WRITES_MAX)
+			write_latency[write_count++] = (uint32_t)(nor_sim_now_us() - write_due);
+		write_due += WRITE_PERIOD_US;
+	}
+	return;
+}
+
+/* The wash before user-011: three reads of every page from each chip, without giving up the CPU. */
+static void old_wash(void)
+{
+	uint32_t p, c;
+
+	for(p = 0; p < WASH_PAGES; p++)
+	{
+		for(c = 1; c < 4; c++)
+		{
+			spimem_read_alt(c, p << 8, page_buff1, 256);
+			spimem_read_alt(c, p << 8, page_buff2, 256);
+			spimem_read_alt(c, p << 8, page_buff3, 256);
+		}
+	}
+	return;
+}
+
+static int compare_latency(const void* a, const void* b)
+{
+	uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+	return (x > y) - (x < y);
+}
+
+/* Washes 4096 pages, old (rate 0) or incremental, and prints the write latencies. Returns the p99. */
+static uint32_t measure(const char* name, uint32_t rate)
+{
+	uint8_t packet[PACKET_LENGTH];
+	uint64_t start, wake;
+	uint32_t wakes, finished = 0, p99;
+
+	write_count = 0;
+	write_failures = 0;
+	start = nor_sim_now_us();
+	write_due = start + WRITE_PERIOD_US;
+	if(!rate)
+	{
+		old_wash();
+		run_writes(nor_sim_now_us());
+		finished = 1;
+	}
+	else
+	{
+		WASH_RATE = rate;
+		for(wakes = 0; !finished && (wakes < WASH_PAGES); wakes++)
+		{
+			wake = start + (uint64_t)wakes * 1000000;
+			run_writes(wake);
+			memory_wash(WASH_RATE);
+			run_writes(nor_sim_now_us());		// The memory task blocks until its next wake-up.
+			while(obc_sim_take_packet(mem_to_obc_fifo, packet))
+			{
+				if((packet[146] == TASK_TO_OPR_EVENT) && (packet[136] == MEMORY_WASH_FINISHED))
+					finished++;
+			}
+		}
+	}
+	HOST_CHECK(finished == 1);
+	HOST_CHECK(!write_failures);
+	qsort(write_latency, write_count, sizeof(write_latency[0]), compare_latency);
+	p99 = write_latency[(write_count * 99) / 100];
+	printf("%-22s %9.1fs %7u %9.1fms %9.1fms %9.1fms\n", name, (double)(nor_sim_now_us() - start) / 1e6,
+		write_count, write_latency[write_count / 2] / 1e3, p99 / 1e3, write_latency[write_count - 1] / 1e3);
+	return p99;
+}
+
+int main(void)
+{
+	uint8_t fill[256];
+	uint32_t i, j, old_p99, new_p99;
+
+	host_test_open("bench_wash_latency", 0);
+	for(i = 0; i < FILL_PAGES; i++)
+	{
+		for(j = 0; j < 256; j++)
+			fill[j] = (uint8_t)((i * 7) ^ j);
+		spimem_write(i << 8, fill, 256);
+	}
+
+	printf("bench_wash_latency: one full wash (%d pages), 16B HK write every %dms, simulated time\n",
+		WASH_PAGES, WRITE_PERIOD_US / 1000);
+	printf("%-22s %10s %7s %11s %11s %11s\n", "wash", "pass", "writes", "p50", "p99", "max");
+	old_p99 = measure("old (3 reads/chip)", 0);
+	new_p99 = measure("memory_wash(8)", WASH_PAGES_PER_SLICE);
+	HOST_CHECK(new_p99 < old_p99);
+	new_p99 = measure("memory_wash(64)", WASH_RATE_MAX);
+	HOST_CHECK(new_p99 < old_p99);
+
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
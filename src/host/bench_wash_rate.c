@@ -0,0 +1,209 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_wash_rate.c
+*
+*	PURPOSE:		Simulation of the adaptive wash rate (user-013): upsets are injected at a rate which
+*					changes over time (quiet orbit, an SAA pass, quiet again) and the wash runs once a
+*					second at a fixed rate or with memory_wash_adjust_rate(). For each it prints the
+*					flash bandwidth spent against how long upsets stay in memory and the resulting
+*					chance of an uncorrectable error.
+*
+*	FILE REFERENCES:		host_test.h, obc_sim.h, rtos_sim.h, memory_manage.c (build/src), string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if an upset is left
+*					unrepaired, the upset counters (SPI_UPSETS1/2/3) count none or too many, or the adaptive rate
+*					uses more bandwidth than the ceiling or lets upsets stay longer than the floor does.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		Upsets go into the live pages only (a blank page is not washed and is erased before it
+*				is used), one random bit on one random chip. The nor_sim SEU generator isn't used
+*				because its rate is fixed and it also hits the blank half of the chips.
+*
+*				A page can only be voted wrong if another chip is upset in the same bit before the
+*				first upset is repaired, so the expected number of uncorrectable errors is the sum
+*				over the upsets of 2 * (upset rate per bit per chip) * (time the upset stayed).
+*				The upset rates are far above what is seen in orbit so that the run has something
+*				to count, the ratios between the strategies are what matters.
+*
+*				"counted" is what SPI_UPSETS1/2/3 add up to. It can be lower than the number injected:
+*				a repair which rewrites a sector votes the whole sector, so the other upsets in it are
+*				fixed before the wash gets to their pages and are never counted.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "memory_manage.c"
+#include "rtos_sim.h"
+#include "obc_sim.h"
+#include "host_test.h"
+
+#define FILL_PAGES			(FTL_LOGICAL_PAGES / 2)
+#define RUN_SECONDS			(4 * 3600)
+#define INJECT_SECONDS		(3 * 3600)		// The last hour lets the slowest wash finish its pass.
+#define QUIET_RATE			(1.0 / 600)		// Upsets per second outside the SAA.
+#define SAA_RATE			0.25
+#define SAA_START			3600
+#define SAA_END				(SAA_START + 1200)
+#define UPSETS_MAX			1024
+
+typedef struct
+{
+	uint32_t addr;
+	uint8_t chip, bit;
+	uint32_t time;
+} upset_t;
+
+static uint8_t reference[NOR_SIM_CHIP_SIZE];
+static uint16_t live[WASH_PAGES];
+static uint32_t live_count;
+static upset_t pending[UPSETS_MAX];
+static uint32_t pending_count;
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+	rng_state = rng_state * 1103515245 + 12345;
+	return rng_state >> 8;
+}
+
+static double upset_rate(uint32_t t)
+{
+	return ((t >= SAA_START) && (t < SAA_END)) ? SAA_RATE : QUIET_RATE;
+}
+
+/* Fresh chips, half full, and the wash state the memory task starts with. */
+static void setup(void)
+{
+	uint8_t fill[256];
+	uint16_t sum;
+	uint32_t i, j;
+
+	host_test_open("bench_wash_rate", 0);
+	for(i = 0; i < FILL_PAGES; i++)
+	{
+		for(j = 0; j < 256; j++)
+			fill[j] = (uint8_t)((i * 11) ^ (j * 3));
+		spimem_write(TM_BASE + (i << 8), fill, 256);
+	}
+	xSemaphoreTake(Spi0_Mutex, portMAX_DELAY);
+	for(i = 0, live_count = 0; i < WASH_PAGES; i++)
+	{
+		if(spimem_ftl_page_state_h(i, &sum) == FTL_PAGE_LIVE)
+			live[live_count++] = (uint16_t)i;
+	}
+	xSemaphoreGive(Spi0_Mutex);
+	memcpy(reference, nor_sim_memory(1), NOR_SIM_CHIP_SIZE);
+
+	wash_cursor_loaded = 0;
+	wash_period_upsets = 0;
+	wash_periods = 0;
+	wash_quiet = 0;
+	wash_hot = 0;
+	wash_hot_page = 0;
+	memset(wash_region_upsets, 0, sizeof(wash_region_upsets));
+	WASH_RATE = WASH_PAGES_PER_SLICE;
+	SPI_UPSETS1 = 0;
+	SPI_UPSETS2 = 0;
+	SPI_UPSETS3 = 0;
+	pending_count = 0;
+	rng_state = 1;
+	return;
+}
+
+/* Runs the whole profile with a fixed rate, or the adaptive one (rate 0). Returns the flash bytes. */
+static uint64_t run(const char* name, uint32_t rate, double* worst)
+{
+	uint8_t packet[PACKET_LENGTH];
+	nor_sim_stats_t stats;
+	upset_t* u;
+	uint64_t start;
+	uint32_t t, i, injected = 0, rate_min = 0xFF, rate_max = 0;
+	double total_latency = 0.0, max_latency = 0.0, expected = 0.0, latency;
+
+	setup();
+	nor_sim_reset_stats();
+	start = nor_sim_now_us();
+	for(t = 0; t < RUN_SECONDS; t++)
+	{
+		rtos_sim_run_until(start + (uint64_t)t * 1000000);
+		if((t < INJECT_SECONDS) && (pending_count < UPSETS_MAX) && ((rng() % 1000000) < (uint32_t)(upset_rate(t) * 1000000)))
+		{
+			u = &pending[pending_count++];
+			u->addr = ((uint32_t)live[rng() % live_count] << 8) + (rng() & 0xFF);
+			u->chip = (uint8_t)(1 + rng() % 3);
+			u->bit = (uint8_t)(rng() & 7);
+			u->time = t;
+			nor_sim_flip_bit(u->chip, u->addr, u->bit);
+			injected++;
+		}
+		if(rate)
+			WASH_RATE = rate;
+		memory_wash(WASH_RATE);
+		if(!rate)
+			memory_wash_adjust_rate();
+		if(WASH_RATE < rate_min)
+			rate_min = WASH_RATE;
+		if(WASH_RATE > rate_max)
+			rate_max = WASH_RATE;
+		while(obc_sim_take_packet(mem_to_obc_fifo, packet));
+
+		for(i = 0; i < pending_count; i++)
+		{
+			u = &pending[i];
+			if(nor_sim_memory(u->chip)[u->addr] != reference[u->addr])
+				continue;
+			latency = (double)(t - u->time) + 1.0;
+			total_latency += latency;
+			if(latency > max_latency)
+				max_latency = latency;
+			expected += 2.0 * (upset_rate(u->time) / (3.0 * live_count * 2048.0)) * latency;
+			pending[i--] = pending[--pending_count];
+		}
+	}
+	nor_sim_get_stats(&stats);
+	HOST_CHECK(!pending_count);
+	HOST_CHECK((SPI_UPSETS1 + SPI_UPSETS2 + SPI_UPSETS3) <= injected);
+	HOST_CHECK((SPI_UPSETS1 + SPI_UPSETS2 + SPI_UPSETS3) > 0);
+	printf("%-14s %5u-%-3u %9.1f %8u %8u %9.0fs %9.0fs %10.2e\n", name, rate_min, rate_max,
+		(double)stats.bytes / RUN_SECONDS, injected, SPI_UPSETS1 + SPI_UPSETS2 + SPI_UPSETS3,
+		total_latency / (injected ? injected : 1), max_latency, expected);
+	*worst = max_latency;
+	return stats.bytes;
+}
+
+int main(void)
+{
+	static const uint32_t rates[] = {WASH_RATE_MIN, WASH_PAGES_PER_SLICE, WASH_RATE_MAX};
+	static const char* names[] = {"fixed floor", "fixed start", "fixed ceiling"};
+	uint64_t bytes[3], adaptive;
+	double worst[3], adaptive_worst;
+	uint32_t i;
+
+	printf("bench_wash_rate: %dh, %.4f upsets/s, %.2f upsets/s from %ds to %ds (SAA), %d live pages\n",
+		RUN_SECONDS / 3600, QUIET_RATE, SAA_RATE, SAA_START, SAA_END, FILL_PAGES);
+	printf("%-14s %9s %9s %8s %8s %10s %10s %10s\n", "wash rate", "pages", "B/s SPI", "upsets", "counted", "mean stay",
+		"max stay", "E[uncorr]");
+	for(i = 0; i < 3; i++)
+	{
+		bytes[i] = run(names[i], rates[i], &worst[i]);
+		host_test_close();
+	}
+	adaptive = run("adaptive", 0, &adaptive_worst);
+	HOST_CHECK(adaptive < bytes[2]);
+	HOST_CHECK(adaptive_worst <= worst[0]);
+
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
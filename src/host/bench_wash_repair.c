@@ -0,0 +1,189 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		bench_wash_repair.c
+*
+*	PURPOSE:		Fault injection for the memory wash repair (user-012): bytes of a page are flipped
+*					on one or two chips and the page is repaired by the old per-byte path and by
+*					memory_wash_page(). Sector erases, page programs and time are compared.
+*
+*	FILE REFERENCES:		host_test.h, obc_sim.h, memory_manage.c (build/src), string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if either path leaves
+*					a damaged copy, the new path erases more than once per damaged chip or doesn't send
+*					exactly one BIT_FLIP_DETECTED with the number of bits it corrected.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The old path is the wash before user-012: every byte on which a chip was outvoted was
+*				rewritten with spimem_write_h() (a sector load, erase and rewrite, since the page is
+*				in use) and read back with a 1B spimem_read_alt().
+*
+*				Every case uses its own freshly written page for each path, and the flips alternate
+*				between 1->0 and 0->1 so that the new path can't repair them all in place.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#define _GNU_SOURCE
+#include <string.h>
+#include "memory_manage.c"
+#include "obc_sim.h"
+#include "host_test.h"
+
+typedef struct
+{
+	const char* name;
+	uint32_t bytes;					// Bytes flipped on each damaged chip.
+	uint8_t chips;					// Mask of damaged chips.
+} repair_case_t;
+
+static uint8_t pattern[256];
+static uint32_t next_page;
+
+/* Writes a new logical page and returns the physical address of its copies. */
+static uint32_t place_page(void)
+{
+	uint8_t* copy;
+	uint32_t i, phys;
+
+	for(i = 0; i < 256; i++)
+		pattern[i] = (uint8_t)((next_page * 13) + (i * 101));
+	HOST_CHECK(spimem_write(TM_BASE + (next_page << 8), pattern, 256) == 256);
+	next_page++;
+	copy = memmem(nor_sim_memory(1), NOR_SIM_CHIP_SIZE, pattern, 256);
+	HOST_CHECK(copy != 0);
+	phys = copy ? (uint32_t)(copy - nor_sim_memory(1)) : 0;
+	HOST_CHECK(!memcmp(nor_sim_memory(2) + phys, pattern, 256));
+	HOST_CHECK(!memcmp(nor_sim_memory(3) + phys, pattern, 256));
+	return phys;
+}
+
+static void inject(uint32_t phys, const repair_case_t* rc)
+{
+	uint32_t i, chip;
+
+	for(chip = 1; chip < 4; chip++)
+	{
+		if(!(rc->chips & (1 << (chip - 1))))
+			continue;
+		for(i = 0; i < rc->bytes; i++)
+			nor_sim_flip_bit(chip, phys + ((i * 37 + chip * 5) & 0xFF), (uint8_t)(i & 7));
+	}
+	return;
+}
+
+/* The repair before user-012, for one page. */
+static void old_repair(uint32_t phys)
+{
+	uint8_t correct_val, check_val, chip;
+	uint32_t b;
+
+	spimem_read_alt(1, phys, page_buff1, 256);
+	spimem_read_alt(2, phys, page_buff2, 256);
+	spimem_read_alt(3, phys, page_buff3, 256);
+	for(b = 0; b < 256; b++)
+	{
+		chip = 0;
+		if((page_buff1[b] != page_buff2[b]) && (page_buff2[b] == page_buff3[b]))
+			chip = 1;
+		else if((page_buff2[b] != page_buff1[b]) && (page_buff1[b] == page_buff3[b]))
+			chip = 2;
+		else if((page_buff3[b] != page_buff1[b]) && (page_buff1[b] == page_buff2[b]))
+			chip = 3;
+		if(!chip)
+			continue;
+		correct_val = (page_buff1[b] & page_buff2[b]) | (page_buff1[b] & page_buff3[b]) | (page_buff2[b] & page_buff3[b]);
+		spimem_write_h(chip, phys + b, &correct_val, 1);
+		spimem_read_alt(chip, phys + b, &check_val, 1);
+		HOST_CHECK(check_val == correct_val);
+	}
+	return;
+}
+
+static void check_copies(uint32_t phys)
+{
+	HOST_CHECK(!memcmp(nor_sim_memory(1) + phys, pattern, 256));
+	HOST_CHECK(!memcmp(nor_sim_memory(2) + phys, pattern, 256));
+	HOST_CHECK(!memcmp(nor_sim_memory(3) + phys, pattern, 256));
+	return;
+}
+
+/* Repairs one case with either path, prints a column group and returns the sector erases. */
+static uint64_t run_case(const repair_case_t* rc, uint8_t new_path)
+{
+	uint8_t packet[PACKET_LENGTH];
+	nor_sim_stats_t stats;
+	uint32_t phys, events = 0, flips = 0;
+	uint64_t start;
+
+	phys = place_page();
+	inject(phys, rc);
+	while(obc_sim_take_packet(mem_to_obc_fifo, packet));
+	nor_sim_reset_stats();
+	start = nor_sim_now_us();
+	if(new_path)
+		HOST_CHECK(memory_wash_page(phys >> 8) == 1);
+	else
+		old_repair(phys);
+	nor_sim_get_stats(&stats);
+	printf(" %7lu %8lu %9.1fms", (unsigned long)stats.sect_erases, (unsigned long)stats.programs,
+		(double)(nor_sim_now_us() - start) / 1e3);
+	check_copies(phys);
+	if(new_path)
+	{
+		while(obc_sim_take_packet(mem_to_obc_fifo, packet))
+		{
+			if((packet[146] == TASK_TO_OPR_EVENT) && (packet[136] == BIT_FLIP_DETECTED))
+			{
+				events++;
+				flips = packet[127];
+				HOST_CHECK((packet[131] & 0x07) == rc->chips);
+			}
+		}
+		HOST_CHECK(events == 1);
+		HOST_CHECK(flips == rc->bytes * __builtin_popcount(rc->chips));
+		HOST_CHECK(stats.sect_erases <= (uint64_t)__builtin_popcount(rc->chips));
+	}
+	return stats.sect_erases;
+}
+
+int main(void)
+{
+	static const repair_case_t cases[] = {
+		{"1B on chip 2", 1, 0x02},
+		{"4B on chip 2", 4, 0x02},
+		{"16B on chip 2", 16, 0x02},
+		{"64B on chip 2", 64, 0x02},
+		{"4B on chips 2 and 3", 4, 0x06},
+	};
+	uint64_t old_erases, new_erases;
+	uint32_t i;
+
+	host_test_open("bench_wash_repair", 0);
+	printf("bench_wash_repair: one damaged page, simulated time\n");
+	printf("%-20s %29s %37s\n", "", "old (per byte)", "memory_wash_page()");
+	printf("%-20s %7s %8s %11s %8s %7s %8s %11s\n", "flips", "erases", "programs", "time", "", "erases",
+		"programs", "time");
+	for(i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		printf("%-20s", cases[i].name);
+		old_erases = run_case(&cases[i], 0);
+		printf("         ");
+		new_erases = run_case(&cases[i], 1);
+		printf("\n");
+		HOST_CHECK((new_erases < old_erases) || ((new_erases == old_erases) && (cases[i].bytes == 1)));
+	}
+
+	host_test_close();
+	return host_test_failures ? 1 : 0;
+}
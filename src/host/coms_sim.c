@@ -0,0 +1,381 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		coms_sim.c
+*
+*	PURPOSE:		Host (Linux) simulation of the COMS SSM's side of a TM packet transfer, and of the
+*					CAN bus between it and the OBC.
+*
+*	FILE REFERENCES:		coms_sim.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY. This file is not part of the Atmel Studio
+*											project. It is not thread-safe, just like CAN0 it must
+*											only be used by whoever holds Can0_Mutex.
+*
+*	NOTES:		Both transfer protocols of send_pus_packet_tm() are understood, so that they can be
+*				compared under the same conditions:
+*					- Legacy: TM_PACKET_READY, then 38 SEND_TM frames of 4B with the frame number in
+*					  byte 4. The SSM answers the last frame with TM_TRANSACTION_RESP = 37, or with
+*					  0xFF as soon as a frame is missing, and the OBC starts the packet over.
+*					- Windowed: TM_PACKET_READY, then frames to TM_FRAME_ID as described in can_func.h.
+*					  The SSM answers every frame with TM_FRAME_ACKREQ set with its bitmap of the frames
+*					  it holds.
+*				Every frame in either direction is lost with probability config.loss, and a frame
+*				which arrives is always intact (CAN retransmits corrupted frames in hardware, so what
+*				software sees is loss, e.g. a mailbox overwritten before it was read).
+*
+*				Time is simulated, not real. Each frame takes frame_bits at can_bps on the bus and
+*				the SSM takes turnaround_us before it answers, so packets / coms_sim_now_us() is the
+*				throughput the OBC would see rather than what the host managed.
+*
+*				A frame counts as a retransmission when the same part of the same packet was already
+*				put on the bus (whether or not it arrived), until the packet has been received whole.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "coms_sim.h"
+
+/* Sequence header of a windowed transfer frame (same as can_func.h) */
+#define FRAME_ACKREQ		0x80
+#define FRAME_TAG_SHIFT		5
+#define FRAME_TAG_MASK		0x03
+#define FRAME_INDEX_MASK	0x1F
+#define ALL_FRAMES			((1ULL << COMS_SIM_FRAMES) - 1)
+
+#define RESP_ABORT			0xFF
+#define OBC_PACKET_ROUTER	0x0A		// OBC_PACKET_ROUTER_ID
+#define MT_COM				0x02
+
+static void coms_sim_advance(uint64_t ns);
+static uint8_t coms_sim_lost(void);
+static void coms_sim_respond(uint8_t smalltype, uint32_t low);
+static void coms_sim_legacy_frame(uint32_t low, uint32_t high);
+static void coms_sim_window_frame(uint32_t low, uint32_t high);
+static void coms_sim_sent(uint64_t bit);
+
+static coms_sim_config_t sim_config;
+static coms_sim_stats_t sim_stats;
+static uint64_t sim_now;						// Simulated time in ns.
+static uint64_t frame_ns;
+static uint32_t rng_state;
+
+/* State of the SSM */
+static uint8_t rx_packet[COMS_SIM_PACKET_LENGTH];	// Packet being received.
+static uint8_t done_packet[COMS_SIM_PACKET_LENGTH];	// Last packet received whole.
+static uint64_t rx_frames;						// Frames of rx_packet which have arrived.
+static uint64_t tx_frames;						// Frames of the packet which have been put on the bus.
+static uint8_t rx_tag;
+static uint8_t tx_tag;							// Tag of the last windowed frame put on the bus.
+static uint8_t legacy_next;						// Next SEND_TM frame expected, 0xFF = failed.
+static uint8_t delivered;						// rx_packet has been received whole.
+
+/************************************************************************/
+/* COMS_SIM_DEFAULT_CONFIG                                              */
+/* @param: config: Filled with 250 kbps, no loss and no receiver.		*/
+/************************************************************************/
+void coms_sim_default_config(coms_sim_config_t* config)
+{
+	config->can_bps = COMS_SIM_CAN_BPS;
+	config->frame_bits = COMS_SIM_FRAME_BITS;
+	config->turnaround_us = COMS_SIM_TURNAROUND_US;
+	config->loss = 0.0;
+	config->seed = 1;
+	config->to_obc = 0;
+	return;
+}
+
+/************************************************************************/
+/* COMS_SIM_OPEN                                                        */
+/* @param: config: Timing, loss rate and receiver. 0 = default.			*/
+/* @Purpose: Resets the clock, the statistics and the SSM.				*/
+/************************************************************************/
+void coms_sim_open(const coms_sim_config_t* config)
+{
+	if(config)
+		sim_config = *config;
+	else
+		coms_sim_default_config(&sim_config);
+	if(!sim_config.seed)
+		sim_config.seed = 1;
+
+	memset(&sim_stats, 0, sizeof(sim_stats));
+	memset(rx_packet, 0, sizeof(rx_packet));
+	memset(done_packet, 0, sizeof(done_packet));
+	sim_now = 0;
+	frame_ns = 0;
+	if(sim_config.can_bps)
+		frame_ns = (uint64_t)sim_config.frame_bits * 1000000000ULL / sim_config.can_bps;
+	rng_state = sim_config.seed;
+	rx_frames = 0;
+	tx_frames = 0;
+	rx_tag = 0xFF;
+	tx_tag = 0xFF;
+	legacy_next = RESP_ABORT;
+	delivered = 0;
+	return;
+}
+
+/************************************************************************/
+/* COMS_SIM_DELAY_US                                                    */
+/* @param: us: Microseconds of simulated time to let pass.				*/
+/* @Purpose: Stands in for delay_us() and tick delays in host builds.	*/
+/************************************************************************/
+void coms_sim_delay_us(uint32_t us)
+{
+	coms_sim_advance((uint64_t)us * 1000);
+	return;
+}
+
+/************************************************************************/
+/* COMS_SIM_ADVANCE_TO_US                                               */
+/* @param: time_us: Simulated time to move the clock up to, a time		*/
+/* which has passed already is ignored.									*/
+/* @Purpose: Keeps the clock in step with rtos_sim's (nor_sim.c) when	*/
+/* the router also blocks on rtos_sim queues.							*/
+/************************************************************************/
+void coms_sim_advance_to_us(uint64_t time_us)
+{
+	if(time_us * 1000 > sim_now)
+		coms_sim_advance(time_us * 1000 - sim_now);
+	return;
+}
+
+/************************************************************************/
+/* COMS_SIM_NOW_US                                                      */
+/* @return: Simulated time since coms_sim_open() in microseconds.		*/
+/************************************************************************/
+uint64_t coms_sim_now_us(void)
+{
+	return sim_now / 1000;
+}
+
+/************************************************************************/
+/* COMS_SIM_PACKET                                                      */
+/* @return: The last packet which the SSM received whole.				*/
+/************************************************************************/
+const uint8_t* coms_sim_packet(void)
+{
+	return done_packet;
+}
+
+/************************************************************************/
+/* COMS_SIM_GET_STATS / COMS_SIM_RESET_STATS                            */
+/* @param: stats: Where to copy the counters.							*/
+/************************************************************************/
+void coms_sim_get_stats(coms_sim_stats_t* stats)
+{
+	*stats = sim_stats;
+	return;
+}
+
+void coms_sim_reset_stats(void)
+{
+	memset(&sim_stats, 0, sizeof(sim_stats));
+	return;
+}
+
+/************************************************************************/
+/* SEND_CAN_COMMAND_H (host)                                            */
+/* @param: low: The lower 4 bytes of the frame.							*/
+/* @param: high: The upper 4 bytes of the frame.						*/
+/* @param: ID: The mailbox ID which the frame is sent to.				*/
+/* @param: PRIORITY: Ignored, the OBC is the only sender.				*/
+/* @Purpose: Puts a frame from CAN0 on the simulated bus. Frames for	*/
+/* other IDs take bus time but are otherwise ignored.					*/
+/* @return: 0, as on the OBC.											*/
+/************************************************************************/
+uint32_t send_can_command_h(uint32_t low, uint32_t high, uint32_t ID, uint32_t PRIORITY)
+{
+	uint8_t smalltype = (uint8_t)(high >> 8);
+
+	(void)PRIORITY;
+	coms_sim_advance(frame_ns);
+	if(ID == COMS_SIM_FRAME_ID)
+	{
+		sim_stats.frames++;
+		coms_sim_window_frame(low, high);
+	}
+	else if((ID == COMS_SIM_CMD_ID) && (smalltype == COMS_SIM_SEND_TM))
+	{
+		sim_stats.frames++;
+		coms_sim_legacy_frame(low, high);
+	}
+	else if((ID == COMS_SIM_CMD_ID) && (smalltype == COMS_SIM_TM_READY) && !coms_sim_lost())
+	{
+		if(delivered)
+		{
+			tx_frames = 0;
+			delivered = 0;
+		}
+		legacy_next = 0;
+		coms_sim_respond(COMS_SIM_OK_START, 0);
+	}
+	return 0;
+}
+
+/************************************************************************/
+/* COMS_SIM_LEGACY_FRAME                                                */
+/* @param: low, high: A SEND_TM frame, byte 4 is the frame number.		*/
+/* @Purpose: Receives 4B of a packet, the frames must arrive in order.	*/
+/************************************************************************/
+static void coms_sim_legacy_frame(uint32_t low, uint32_t high)
+{
+	uint8_t i = (uint8_t)high;
+
+	if(i < COMS_SIM_LEGACY_FRAMES)
+		coms_sim_sent(1ULL << i);
+	if(coms_sim_lost())
+	{
+		sim_stats.frames_lost++;
+		return;
+	}
+	if(legacy_next == RESP_ABORT)					// Waiting for the OBC to start over.
+		return;
+	if((i != legacy_next) || (i >= COMS_SIM_LEGACY_FRAMES))
+	{
+		legacy_next = RESP_ABORT;					// A frame went missing.
+		sim_stats.aborts++;
+		coms_sim_respond(COMS_SIM_TM_RESP, RESP_ABORT);
+		return;
+	}
+	memcpy(rx_packet + (i * 4), &low, 4);			// Little-endian, like the OBC.
+	legacy_next++;
+	if(legacy_next == COMS_SIM_LEGACY_FRAMES)
+	{
+		memcpy(done_packet, rx_packet, COMS_SIM_PACKET_LENGTH);
+		sim_stats.packets++;
+		delivered = 1;
+		legacy_next = RESP_ABORT;
+		coms_sim_respond(COMS_SIM_TM_RESP, COMS_SIM_LEGACY_FRAMES - 1);
+	}
+	return;
+}
+
+/************************************************************************/
+/* COMS_SIM_WINDOW_FRAME                                                */
+/* @param: low, high: A windowed transfer frame (see can_func.h).		*/
+/* @Purpose: Receives 7B of a packet in any order, and reports the		*/
+/* frames received so far if the OBC asked for it.						*/
+/************************************************************************/
+static void coms_sim_window_frame(uint32_t low, uint32_t high)
+{
+	uint8_t header = (uint8_t)(high >> 24);
+	uint8_t tag = (header >> FRAME_TAG_SHIFT) & FRAME_TAG_MASK;
+	uint8_t i = header & FRAME_INDEX_MASK;
+	uint8_t chunk[8];
+	uint32_t size;
+
+	if((tag != tx_tag) && delivered)			// The first frame of the next packet.
+	{
+		tx_frames = 0;
+		delivered = 0;
+	}
+	tx_tag = tag;
+	if(i < COMS_SIM_FRAMES)
+		coms_sim_sent(1ULL << i);
+	if(coms_sim_lost())
+	{
+		sim_stats.frames_lost++;
+		return;
+	}
+	if(tag != rx_tag)							// A new packet, or the OBC started this one over.
+	{
+		rx_tag = tag;
+		rx_frames = 0;
+	}
+	if(i < COMS_SIM_FRAMES)
+	{
+		memcpy(chunk, &low, 4);
+		chunk[4] = (uint8_t)high;
+		chunk[5] = (uint8_t)(high >> 8);
+		chunk[6] = (uint8_t)(high >> 16);
+		size = COMS_SIM_PACKET_LENGTH - (i * COMS_SIM_FRAME_DATA);
+		if(size > COMS_SIM_FRAME_DATA)
+			size = COMS_SIM_FRAME_DATA;
+		memcpy(rx_packet + (i * COMS_SIM_FRAME_DATA), chunk, size);
+		rx_frames |= 1ULL << i;
+	}
+	if((rx_frames == ALL_FRAMES) && !delivered)
+	{
+		memcpy(done_packet, rx_packet, COMS_SIM_PACKET_LENGTH);
+		sim_stats.packets++;
+		delivered = 1;
+	}
+	if(header & FRAME_ACKREQ)
+		coms_sim_respond(COMS_SIM_TM_RESP, ((uint32_t)tag << 24) | (uint32_t)rx_frames);
+	return;
+}
+
+/************************************************************************/
+/* COMS_SIM_SENT                                                        */
+/* @param: bit: The frame of the packet which was put on the bus.		*/
+/* @Purpose: Counts the frame as a retransmission if it was sent before.*/
+/************************************************************************/
+static void coms_sim_sent(uint64_t bit)
+{
+	if(tx_frames & bit)
+		sim_stats.retransmissions++;
+	tx_frames |= bit;
+	return;
+}
+
+/************************************************************************/
+/* COMS_SIM_RESPOND                                                     */
+/* @param: smalltype: OK_START_TM_PACKET or TM_TRANSACTION_RESP.		*/
+/* @param: low: The lower 4 bytes of the frame.							*/
+/* @Purpose: Sends a frame from the SSM to the OBC's packet router.		*/
+/************************************************************************/
+static void coms_sim_respond(uint8_t smalltype, uint32_t low)
+{
+	uint32_t high;
+
+	high = ((uint32_t)OBC_PACKET_ROUTER << 24) | ((uint32_t)MT_COM << 16) | ((uint32_t)smalltype << 8);	// From COMS_ID (0).
+	coms_sim_advance((uint64_t)sim_config.turnaround_us * 1000 + frame_ns);
+	sim_stats.responses++;
+	if(coms_sim_lost())
+	{
+		sim_stats.responses_lost++;
+		return;
+	}
+	if(sim_config.to_obc)
+		sim_config.to_obc(low, high);
+	return;
+}
+
+/************************************************************************/
+/* COMS_SIM_ADVANCE                                                     */
+/* @param: ns: Nanoseconds of simulated time which have passed.			*/
+/************************************************************************/
+static void coms_sim_advance(uint64_t ns)
+{
+	sim_now += ns;
+	return;
+}
+
+/************************************************************************/
+/* COMS_SIM_LOST                                                        */
+/* @return: 1 == the frame is lost, drawn from a xorshift32 generator	*/
+/* (repeatable by seed).												*/
+/************************************************************************/
+static uint8_t coms_sim_lost(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	if(sim_config.loss <= 0.0)
+		return 0;
+	return ((double)rng_state / 4294967296.0) < sim_config.loss;
+}
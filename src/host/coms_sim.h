@@ -0,0 +1,95 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		coms_sim.h
+*
+*	PURPOSE:		Houses the includes and definitions for coms_sim.c, the host (Linux) simulation
+*					of the COMS SSM's side of a TM packet transfer over CAN.
+*
+*	FILE REFERENCES:		stdint.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY. This file is not part of the Atmel Studio
+*											project and must never be compiled for the OBC.
+*
+*	NOTES:		A host build compiles the packet router's send_pus_packet_tm() against coms_sim.c
+*				instead of the CAN0 driver: coms_sim.c provides send_can_command_h(), and the frames
+*				which the COMS SSM sends back are handed to config.to_obc(), which should do what
+*				decode_can_command() does with them. The IDs, small types and frame format are
+*				repeated here because can_func.h pulls in the ASF; they must be kept in step with it.
+*
+*				delay_us() and the tick delays should be mapped onto coms_sim_delay_us() so that the
+*				OBC's waits advance the simulated clock (1 tick = 1 ms).
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created.
+*
+*/
+
+#ifndef COMS_SIM_H
+#define COMS_SIM_H
+
+#include <stdint.h>
+
+/* Same values as can_func.h */
+#define COMS_SIM_CMD_ID			23			// SUB0_ID3, TM_PACKET_READY and legacy SEND_TM frames.
+#define COMS_SIM_FRAME_ID		24			// TM_FRAME_ID, windowed transfer frames.
+#define COMS_SIM_SEND_TM		0x0D
+#define COMS_SIM_TM_READY		0x0F
+#define COMS_SIM_OK_START		0x10
+#define COMS_SIM_TM_RESP		0x13
+#define COMS_SIM_PACKET_LENGTH	152
+#define COMS_SIM_FRAME_DATA		7
+#define COMS_SIM_FRAMES			((COMS_SIM_PACKET_LENGTH + COMS_SIM_FRAME_DATA - 1) / COMS_SIM_FRAME_DATA)
+#define COMS_SIM_LEGACY_FRAMES	(COMS_SIM_PACKET_LENGTH / 4)
+
+/* Default timing */
+#define COMS_SIM_CAN_BPS		250000		// CAN_BPS_250K
+#define COMS_SIM_FRAME_BITS		125			// 8B standard frame with typical bit stuffing and the inter-frame space.
+#define COMS_SIM_TURNAROUND_US	200			// Time the SSM takes to answer a frame.
+
+typedef void (*coms_sim_rx_t)(uint32_t low, uint32_t high);
+
+typedef struct
+{
+	uint32_t can_bps;				// 0 == frames take no time.
+	uint32_t frame_bits;
+	uint32_t turnaround_us;
+	double loss;					// Probability that any one frame (either direction) is lost.
+	uint32_t seed;					// Seed for the loss generator (0 is replaced by 1).
+	coms_sim_rx_t to_obc;			// Receives the frames which the SSM sends to the OBC.
+} coms_sim_config_t;
+
+typedef struct
+{
+	uint64_t frames;				// TM data frames sent by the OBC (including lost ones).
+	uint64_t retransmissions;		// Of which carried data that had already been sent for the same packet.
+	uint64_t frames_lost;			// Frames dropped, OBC -> SSM.
+	uint64_t responses;				// Frames sent by the SSM.
+	uint64_t responses_lost;		// Frames dropped, SSM -> OBC.
+	uint64_t packets;				// Packets received whole.
+	uint64_t aborts;				// Legacy transfers which the SSM failed (0xFF).
+} coms_sim_stats_t;
+
+/*		Simulator API					*/
+void coms_sim_default_config(coms_sim_config_t* config);
+void coms_sim_open(const coms_sim_config_t* config);
+void coms_sim_delay_us(uint32_t us);
+void coms_sim_advance_to_us(uint64_t time_us);
+uint64_t coms_sim_now_us(void);
+const uint8_t* coms_sim_packet(void);
+void coms_sim_get_stats(coms_sim_stats_t* stats);
+void coms_sim_reset_stats(void);
+
+/*		CAN0 layer (see can_func.h)		*/
+uint32_t send_can_command_h(uint32_t low, uint32_t high, uint32_t ID, uint32_t PRIORITY);
+
+#endif
@@ -0,0 +1,110 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		host_test.c
+*
+*	PURPOSE:		What the host regression tests and benchmarks have in common: bringing up a fresh
+*					set of simulated chips and the SPI memory stack on them, and the pass/fail count.
+*
+*	FILE REFERENCES:		host_test.h, rtos_sim.h, obc_sim.h, spimem.h, unistd.h
+*
+*	EXTERNAL VARIABLES:		host_test_failures
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY. This file is not part of the Atmel Studio
+*											project.
+*
+*	NOTES:		The backing files are called <name>_mem1.bin .. <name>_mem3.bin and are created in the
+*				current directory (build/ under make test), so every test starts from erased chips
+*				and leaves its chips behind for inspection.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <unistd.h>
+#include "rtos_sim.h"
+#include "obc_sim.h"
+#include "spimem.h"
+#include "host_test.h"
+
+uint32_t host_test_failures;
+
+static char host_test_path[128];
+
+/************************************************************************/
+/* HOST_TEST_OPEN                                                       */
+/* @param: name: Prefix of the backing files.							*/
+/* @param: config: Chip timing and faults, 0 = nor_sim defaults.		*/
+/* @return: -1 == the chips could not be created, 1 == OK.				*/
+/* @Purpose: Erased chips, a fresh kernel with the scheduler running	*/
+/* and a mounted SPI memory stack, the way main.c leaves the OBC.		*/
+/************************************************************************/
+int host_test_open(const char* name, const nor_sim_config_t* config)
+{
+	nor_sim_config_t sim_config;
+	char file[160];
+	int i;
+
+	if(config)
+		sim_config = *config;
+	else
+		nor_sim_default_config(&sim_config);
+	snprintf(host_test_path, sizeof(host_test_path), "%s_mem", name);
+	for(i = 1; i <= NOR_SIM_CHIPS; i++)
+	{
+		snprintf(file, sizeof(file), "%s%d.bin", host_test_path, i);
+		unlink(file);
+	}
+	sim_config.path = host_test_path;
+	if(nor_sim_open(&sim_config) < 0)
+		return -1;
+	return host_test_reset();
+}
+
+/************************************************************************/
+/* HOST_TEST_RESET                                                      */
+/* @return: 1 == OK.													*/
+/* @Purpose: What an OBC reset does to the SPI memory stack: the RAM	*/
+/* state is lost and spimem_initialize() mounts the chips again. The	*/
+/* chips and the simulated clock carry on.								*/
+/************************************************************************/
+int host_test_reset(void)
+{
+	rtos_sim_reset();
+	obc_sim_init();
+	spi_initialize();
+	spimem_initialize();
+	rtos_sim_start();
+	return 1;
+}
+
+void host_test_close(void)
+{
+	nor_sim_close();
+	return;
+}
+
+/************************************************************************/
+/* HOST_TEST_DONE                                                       */
+/* @param: name: Name of the test, for the summary line.				*/
+/* @return: 0 == every HOST_CHECK() passed, 1 == some failed.			*/
+/************************************************************************/
+int host_test_done(const char* name)
+{
+	host_test_close();
+	if(host_test_failures)
+	{
+		printf("%s: %u FAILED\n", name, host_test_failures);
+		return 1;
+	}
+	printf("%s: passed\n", name);
+	return 0;
+}
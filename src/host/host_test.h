@@ -0,0 +1,49 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		host_test.h
+*
+*	PURPOSE:		Houses the includes and definitions for host_test.c, what the host regression tests
+*					and benchmarks have in common.
+*
+*	FILE REFERENCES:		stdio.h, stdint.h, nor_sim.h
+*
+*	EXTERNAL VARIABLES:		host_test_failures
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: HOST_CHECK() prints the condition
+*					which failed, host_test_done() returns 1 if any did.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY. This file is not part of the Atmel Studio
+*											project and must never be compiled for the OBC.
+*
+*	NOTES:		A test is a program test_<name>.c with a main() which returns host_test_done(), a
+*				benchmark is bench_<name>.c and prints its results in a table. Both are built and
+*				run by src/host/Makefile.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created.
+*
+*/
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "nor_sim.h"
+
+#define HOST_CHECK(cond)	do { if(!(cond)) { printf("%s:%d: FAILED: %s\n", __FILE__, __LINE__, #cond); host_test_failures++; } } while(0)
+
+extern uint32_t host_test_failures;
+
+int host_test_open(const char* name, const nor_sim_config_t* config);
+int host_test_reset(void);
+void host_test_close(void);
+int host_test_done(const char* name);
+
+#endif
@@ -0,0 +1,592 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		nor_sim.c
+*
+*	PURPOSE:		Host (Linux) simulation of the three S25FL208K SPI memory chips and of the SPI0
+*					transfer layer which spimem.c uses to talk to them.
+*
+*	FILE REFERENCES:		nor_sim.h, stdio.h, stdlib.h, string.h, fcntl.h, unistd.h, sys/mman.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: nor_sim_open() returns -1 if a
+*					backing file can't be created or mapped.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY. This file is not part of the Atmel Studio
+*											project. It is not thread-safe, just like SPI0 it must
+*											only be used by whoever holds Spi0_Mutex.
+*
+*	NOTES:		Each chip is backed by a 1 MB file which is mmap'd, so the contents of the memory
+*				survive from one run to the next (the same way they survive a reset on the OBC) and
+*				can be inspected or corrupted with ordinary tools. A missing file is created erased (0xFF).
+*
+*				The chips follow the S25FL208K command set used by spimem.c (WREN, WRDI, RDSR, READ,
+*				PP, SE, CE) and NOR semantics are enforced:
+*					- Page program can only clear bits (1 -> 0) and wraps within the 256B page.
+*					- Erase is by 4KB sector (or the whole chip) and sets every bit back to 1.
+*					- Program and erase need WEL and leave WIP set for the configured time. Commands
+*					  other than RDSR are ignored while WIP is set, like the real part.
+*				A command takes effect when CS is de-asserted, i.e. at the end of a spi_dma_transfer()
+*				without SPI_DMA_HOLD_CS or at spi_release_cs().
+*
+*				Time is simulated, not real. The clock advances by 8 bits per byte at spi_hz, by
+*				word_gap_us per word (to model a polled driver) and by nor_sim_delay_us(), so a benchmark reports the time the OBC would have spent rather than
+*				the time the host took. Erases are counted per sector (wear) and bits are flipped at
+*				random at seu_rate per bit per second of simulated time, in addition to the deliberate
+*				nor_sim_flip_bit() and nor_sim_fail_chip() faults.
+*
+*				Abuse that a real chip would silently tolerate (programming a 0 back to a 1, a command
+*				while busy, a program without WREN) is carried out the way the chip would carry it out
+*				and counted in nor_sim_stats_t, so that regression runs can check for it. A 0xFF byte
+*				is not counted, the FTL sends 0xFF to leave a byte as it is.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "nor_sim.h"
+
+/* S25FL208K commands */
+#define CMD_WRSR	0x01
+#define CMD_PP		0x02
+#define CMD_READ	0x03
+#define CMD_WRDI	0x04
+#define CMD_RDSR	0x05
+#define CMD_WREN	0x06
+#define CMD_SE		0x20
+#define CMD_CE		0xC7
+
+#define SR_WIP		0x01
+#define SR_WEL		0x02
+
+typedef struct
+{
+	uint8_t* mem;
+	int fd;
+	uint8_t failed;								// A failed chip leaves MISO floating high.
+	uint8_t selected;
+	uint8_t wel;
+	uint8_t cmd;
+	uint32_t count;								// Bytes received since CS was asserted.
+	uint32_t addr;
+	uint64_t busy_until;						// Simulated time (ns) at which WIP clears.
+	uint8_t page[NOR_SIM_PAGE_SIZE];			// Data latched by PP.
+	uint8_t latched[NOR_SIM_PAGE_SIZE];			// Which bytes of page[] were written.
+	uint32_t erases[NOR_SIM_SECTORS];
+} nor_sim_chip_t;
+
+static uint8_t nor_sim_xfer(nor_sim_chip_t* chip, uint8_t mosi);
+static void nor_sim_deselect(void);
+static void nor_sim_advance(uint64_t ns);
+static uint32_t nor_sim_rand(void);
+
+static nor_sim_chip_t chips[NOR_SIM_CHIPS];
+static nor_sim_config_t sim_config;
+static nor_sim_stats_t sim_stats;
+static uint64_t sim_now;						// Simulated time in ns.
+static double seu_carry;						// Fraction of an SEU which is still owed.
+static uint32_t rng_state;
+static uint8_t sim_cs;							// Chip select currently asserted, 0 = none.
+static uint8_t sim_open;
+
+/************************************************************************/
+/* NOR_SIM_DEFAULT_CONFIG                                               */
+/* @param: config: Filled with the datasheet timing, no SEUs and files	*/
+/* called nor_sim_mem1.bin, nor_sim_mem2.bin, nor_sim_mem3.bin.			*/
+/************************************************************************/
+void nor_sim_default_config(nor_sim_config_t* config)
+{
+	config->path = "nor_sim_mem";
+	config->spi_hz = NOR_SIM_SPI_HZ;
+	config->word_gap_us = 0;
+	config->program_us = NOR_SIM_PROGRAM_US;
+	config->sect_erase_us = NOR_SIM_SECT_ERASE_US;
+	config->chip_erase_us = NOR_SIM_CHIP_ERASE_US;
+	config->seu_rate = 0.0;
+	config->seed = 1;
+	return;
+}
+
+/************************************************************************/
+/* NOR_SIM_OPEN                                                         */
+/* @param: config: Timing, SEU rate and backing file prefix. 0 = default*/
+/* @return: -1 == a backing file could not be created/mapped, 1 == OK.	*/
+/* @Purpose: Maps the three chips, creating erased ones if necessary.	*/
+/* Erase counts and statistics start at zero for every run.				*/
+/************************************************************************/
+int nor_sim_open(const nor_sim_config_t* config)
+{
+	char name[256];
+	uint8_t i;
+	int fd, fresh;
+	off_t size;
+	uint8_t* mem;
+
+	if(sim_open)
+		nor_sim_close();
+	if(config)
+		sim_config = *config;
+	else
+		nor_sim_default_config(&sim_config);
+	if(!sim_config.seed)
+		sim_config.seed = 1;
+
+	memset(chips, 0, sizeof(chips));
+	memset(&sim_stats, 0, sizeof(sim_stats));
+	sim_now = 0;
+	seu_carry = 0.0;
+	rng_state = sim_config.seed;
+	sim_cs = 0;
+
+	for(i = 0; i < NOR_SIM_CHIPS; i++)
+	{
+		snprintf(name, sizeof(name), "%s%d.bin", sim_config.path, i + 1);
+		fd = open(name, O_RDWR | O_CREAT, 0644);
+		if(fd < 0)
+			goto fail;
+		size = lseek(fd, 0, SEEK_END);
+		fresh = (size < NOR_SIM_CHIP_SIZE);
+		if(fresh && (ftruncate(fd, NOR_SIM_CHIP_SIZE) < 0))
+		{
+			close(fd);
+			goto fail;
+		}
+		mem = mmap(0, NOR_SIM_CHIP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if(mem == MAP_FAILED)
+		{
+			close(fd);
+			goto fail;
+		}
+		if(fresh)
+			memset(mem + size, 0xFF, NOR_SIM_CHIP_SIZE - size);
+		chips[i].mem = mem;
+		chips[i].fd = fd;
+	}
+	sim_open = 1;
+	return 1;
+
+fail:
+	sim_open = 1;
+	nor_sim_close();
+	return -1;
+}
+
+/************************************************************************/
+/* NOR_SIM_CLOSE                                                        */
+/* @Purpose: Writes the chips back to their files and unmaps them.		*/
+/************************************************************************/
+void nor_sim_close(void)
+{
+	uint8_t i;
+
+	if(!sim_open)
+		return;
+	nor_sim_deselect();
+	for(i = 0; i < NOR_SIM_CHIPS; i++)
+	{
+		if(chips[i].mem)
+		{
+			msync(chips[i].mem, NOR_SIM_CHIP_SIZE, MS_SYNC);
+			munmap(chips[i].mem, NOR_SIM_CHIP_SIZE);
+			close(chips[i].fd);
+		}
+		chips[i].mem = 0;
+	}
+	sim_open = 0;
+	return;
+}
+
+/************************************************************************/
+/* NOR_SIM_DELAY_US                                                     */
+/* @param: us: Microseconds of simulated time to let pass.				*/
+/* @Purpose: Stands in for delay_us() in host builds.					*/
+/************************************************************************/
+void nor_sim_delay_us(uint32_t us)
+{
+	nor_sim_advance((uint64_t)us * 1000);
+	return;
+}
+
+/************************************************************************/
+/* NOR_SIM_NOW_US                                                       */
+/* @return: Simulated time since nor_sim_open() in microseconds.		*/
+/************************************************************************/
+uint64_t nor_sim_now_us(void)
+{
+	return sim_now / 1000;
+}
+
+/************************************************************************/
+/* NOR_SIM_FLIP_BIT                                                     */
+/* @param: chip: (1|2|3) chip select of the chip to corrupt.			*/
+/* @param: addr: Address within the chip.								*/
+/* @param: bit: (0-7) which bit of the byte to invert.					*/
+/* @Purpose: Injects a single upset at a known place.					*/
+/************************************************************************/
+void nor_sim_flip_bit(uint8_t chip, uint32_t addr, uint8_t bit)
+{
+	if(!sim_open || !chip || (chip > NOR_SIM_CHIPS) || (addr >= NOR_SIM_CHIP_SIZE))
+		return;
+	chips[chip - 1].mem[addr] ^= (uint8_t)(1 << (bit & 7));
+	return;
+}
+
+/************************************************************************/
+/* NOR_SIM_FAIL_CHIP                                                    */
+/* @param: chip: (1|2|3) chip select of the chip.						*/
+/* @param: failed: 1 = the chip stops responding, 0 = it comes back.	*/
+/* @Purpose: A failed chip ignores every command and reads as 0xFF,		*/
+/* so its status register reports WIP forever.							*/
+/************************************************************************/
+void nor_sim_fail_chip(uint8_t chip, uint8_t failed)
+{
+	if(!chip || (chip > NOR_SIM_CHIPS))
+		return;
+	chips[chip - 1].failed = failed;
+	return;
+}
+
+/************************************************************************/
+/* NOR_SIM_ERASE_COUNT                                                  */
+/* @param: chip: (1|2|3) chip select of the chip.						*/
+/* @param: sect: (0-255) sector number.									*/
+/* @return: How many times the sector was erased since nor_sim_open().	*/
+/* (A chip erase counts once for every sector)							*/
+/************************************************************************/
+uint32_t nor_sim_erase_count(uint8_t chip, uint32_t sect)
+{
+	if(!chip || (chip > NOR_SIM_CHIPS) || (sect >= NOR_SIM_SECTORS))
+		return 0;
+	return chips[chip - 1].erases[sect];
+}
+
+/************************************************************************/
+/* NOR_SIM_MEMORY                                                       */
+/* @param: chip: (1|2|3) chip select of the chip.						*/
+/* @return: The chip's contents (NOR_SIM_CHIP_SIZE bytes), 0 on error.	*/
+/* @NOTE: Writing through this pointer bypasses the NOR rules, which is	*/
+/* what a test wants when it sets up a particular memory image.			*/
+/************************************************************************/
+uint8_t* nor_sim_memory(uint8_t chip)
+{
+	if(!sim_open || !chip || (chip > NOR_SIM_CHIPS))
+		return 0;
+	return chips[chip - 1].mem;
+}
+
+/************************************************************************/
+/* NOR_SIM_GET_STATS / NOR_SIM_RESET_STATS                              */
+/* @param: stats: Where to copy the counters.							*/
+/************************************************************************/
+void nor_sim_get_stats(nor_sim_stats_t* stats)
+{
+	*stats = sim_stats;
+	return;
+}
+
+void nor_sim_reset_stats(void)
+{
+	memset(&sim_stats, 0, sizeof(sim_stats));
+	return;
+}
+
+/************************************************************************/
+/* NOR_SIM_XFER                                                         */
+/* @param: chip: The selected chip.										*/
+/* @param: mosi: Byte sent by the OBC.									*/
+/* @return: Byte returned by the chip.									*/
+/* @Purpose: One byte of a command. Reads happen here, programs and		*/
+/* erases are only latched and carried out in nor_sim_deselect().		*/
+/************************************************************************/
+static uint8_t nor_sim_xfer(nor_sim_chip_t* chip, uint8_t mosi)
+{
+	uint8_t miso = 0xFF;
+	uint8_t busy = (sim_now < chip->busy_until);
+	uint32_t offset;
+
+	if(chip->failed)
+		return 0xFF;
+
+	if(!chip->count)
+	{
+		chip->cmd = mosi;
+		chip->addr = 0;
+		if(busy && (mosi != CMD_RDSR))
+			sim_stats.busy_violations++;
+		if(mosi == CMD_PP)
+			memset(chip->latched, 0, sizeof(chip->latched));
+		if(mosi == CMD_READ)
+			sim_stats.reads++;
+	}
+	else if(busy && (chip->cmd != CMD_RDSR))
+		;												// The chip ignores everything but RDSR while busy.
+	else
+	{
+		switch(chip->cmd)
+		{
+			case CMD_RDSR:
+				miso = (busy ? SR_WIP : 0) | (chip->wel ? SR_WEL : 0);
+				break;
+			case CMD_READ:
+			case CMD_PP:
+			case CMD_SE:
+				if(chip->count < 4)
+				{
+					chip->addr = (chip->addr << 8) | mosi;
+					break;
+				}
+				if(chip->cmd == CMD_READ)
+				{
+					miso = chip->mem[chip->addr % NOR_SIM_CHIP_SIZE];
+					chip->addr = (chip->addr + 1) % NOR_SIM_CHIP_SIZE;
+				}
+				else if(chip->cmd == CMD_PP)
+				{
+					offset = (chip->addr + chip->count - 4) % NOR_SIM_PAGE_SIZE;	// Wraps within the page.
+					chip->page[offset] = mosi;
+					chip->latched[offset] = 1;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+	chip->count++;
+	return miso;
+}
+
+/************************************************************************/
+/* NOR_SIM_DESELECT                                                     */
+/* @Purpose: CS going high. Carries out the latched command.			*/
+/************************************************************************/
+static void nor_sim_deselect(void)
+{
+	nor_sim_chip_t* chip;
+	uint8_t* dst;
+	uint32_t base, i, sect;
+
+	if(!sim_cs)
+		return;
+	chip = &chips[sim_cs - 1];
+	sim_cs = 0;
+	if(chip->failed || !chip->count || (sim_now < chip->busy_until))
+	{
+		chip->count = 0;
+		return;
+	}
+
+	switch(chip->cmd)
+	{
+		case CMD_WREN:
+			chip->wel = 1;
+			break;
+		case CMD_WRDI:
+			chip->wel = 0;
+			break;
+		case CMD_WRSR:
+			chip->wel = 0;								// The protection bits are never set by spimem.c
+			break;
+		case CMD_PP:
+			if(chip->count < 5)
+				break;
+			if(!chip->wel)
+			{
+				sim_stats.wel_violations++;
+				break;
+			}
+			base = (chip->addr % NOR_SIM_CHIP_SIZE) & ~(uint32_t)(NOR_SIM_PAGE_SIZE - 1);
+			dst = chip->mem + base;
+			for(i = 0; i < NOR_SIM_PAGE_SIZE; i++)
+			{
+				if(!chip->latched[i])
+					continue;
+				if((chip->page[i] != 0xFF) && (chip->page[i] & ~dst[i]))
+					sim_stats.over_programs++;		// 0xFF is how the FTL leaves a byte alone.
+				dst[i] &= chip->page[i];				// NOR: 1 -> 0 only.
+			}
+			chip->wel = 0;
+			chip->busy_until = sim_now + (uint64_t)sim_config.program_us * 1000;
+			sim_stats.programs++;
+			break;
+		case CMD_SE:
+			if(chip->count != 4)
+				break;
+			if(!chip->wel)
+			{
+				sim_stats.wel_violations++;
+				break;
+			}
+			sect = (chip->addr % NOR_SIM_CHIP_SIZE) / NOR_SIM_SECT_SIZE;
+			memset(chip->mem + sect * NOR_SIM_SECT_SIZE, 0xFF, NOR_SIM_SECT_SIZE);
+			chip->erases[sect]++;
+			chip->wel = 0;
+			chip->busy_until = sim_now + (uint64_t)sim_config.sect_erase_us * 1000;
+			sim_stats.sect_erases++;
+			break;
+		case CMD_CE:
+			if(!chip->wel)
+			{
+				sim_stats.wel_violations++;
+				break;
+			}
+			memset(chip->mem, 0xFF, NOR_SIM_CHIP_SIZE);
+			for(sect = 0; sect < NOR_SIM_SECTORS; sect++)
+				chip->erases[sect]++;
+			chip->wel = 0;
+			chip->busy_until = sim_now + (uint64_t)sim_config.chip_erase_us * 1000;
+			sim_stats.chip_erases++;
+			break;
+		default:
+			break;
+	}
+	chip->count = 0;
+	return;
+}
+
+/************************************************************************/
+/* NOR_SIM_ADVANCE                                                      */
+/* @param: ns: Nanoseconds of simulated time which have passed.			*/
+/* @Purpose: Moves the clock and flips however many random bits the		*/
+/* SEU rate asks for over that time (across all chips).					*/
+/************************************************************************/
+static void nor_sim_advance(uint64_t ns)
+{
+	uint32_t r, chip, addr;
+
+	sim_now += ns;
+	if(!sim_open || (sim_config.seu_rate <= 0.0))
+		return;
+
+	seu_carry += sim_config.seu_rate * (double)NOR_SIM_CHIPS * NOR_SIM_CHIP_SIZE * 8 * ((double)ns / 1e9);
+	while(seu_carry >= 1.0)
+	{
+		r = nor_sim_rand();
+		chip = r % NOR_SIM_CHIPS;
+		addr = nor_sim_rand() % NOR_SIM_CHIP_SIZE;
+		chips[chip].mem[addr] ^= (uint8_t)(1 << ((r >> 8) & 7));
+		sim_stats.seu_flips++;
+		seu_carry -= 1.0;
+	}
+	return;
+}
+
+/************************************************************************/
+/* NOR_SIM_RAND                                                         */
+/* @return: Next value of a xorshift32 generator (repeatable by seed).	*/
+/************************************************************************/
+static uint32_t nor_sim_rand(void)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 17;
+	rng_state ^= rng_state << 5;
+	return rng_state;
+}
+
+/************************************************************************/
+/* SPI_DMA_TRANSFER (host)                                              */
+/* @param: tx_buf: Data to send (uint16_t array), 0 = send zeros.		*/
+/* @param: rx_buf: Where to put incoming data, 0 = discard it.			*/
+/* @param: size: Number of transfers (not bytes) to perform.			*/
+/* @param: chip_sel: (0|1|2|3) chip select, 0 is not a memory chip.		*/
+/* @param: flags: SPI_DMA_HOLD_CS, SPI_DMA_BYTES (see spi_func.h).		*/
+/* @return: -1 = Usage error, 1 = Success.								*/
+/************************************************************************/
+int spi_dma_transfer(const void* tx_buf, void* rx_buf, uint32_t size, uint8_t chip_sel, uint8_t flags)
+{
+	const uint16_t* tx = (const uint16_t*)tx_buf;
+	uint32_t i;
+	uint8_t mosi, miso;
+
+	if(!size || (chip_sel > 3))
+		return -1;
+	if(sim_cs != chip_sel)
+		nor_sim_deselect();
+	sim_cs = chip_sel;
+
+	for(i = 0; i < size; i++)
+	{
+		mosi = tx ? (uint8_t)tx[i] : 0;
+		miso = (sim_open && chip_sel) ? nor_sim_xfer(&chips[chip_sel - 1], mosi) : 0xFF;
+		if(rx_buf)
+		{
+			if(flags & SPI_DMA_BYTES)
+				((uint8_t*)rx_buf)[i] = miso;
+			else
+				((uint16_t*)rx_buf)[i] = miso;
+		}
+	}
+	sim_stats.bytes += size;
+	if(sim_config.spi_hz)
+		nor_sim_advance((uint64_t)size * 8 * 1000000000 / sim_config.spi_hz);
+	if(sim_config.word_gap_us)
+		nor_sim_advance((uint64_t)size * sim_config.word_gap_us * 1000);
+
+	if(!(flags & SPI_DMA_HOLD_CS))
+		nor_sim_deselect();
+	return 1;
+}
+
+/************************************************************************/
+/* SPI_DMA_TRANSFER_ASYNC (host)                                        */
+/* @Purpose: Same as spi_dma_transfer(), the transfer is finished (and	*/
+/* the callback has run) by the time this function returns.				*/
+/************************************************************************/
+int spi_dma_transfer_async(const void* tx_buf, void* rx_buf, uint32_t size, uint8_t chip_sel, uint8_t flags, spi_dma_callback_t callback, void* arg)
+{
+	if(spi_dma_transfer(tx_buf, rx_buf, size, chip_sel, flags) < 0)
+		return -1;
+	if(callback)
+		callback(arg, 1);
+	return 1;
+}
+
+int spi_dma_wait(uint32_t timeout)
+{
+	(void)timeout;								// Transfers finish inside spi_dma_transfer().
+	return 1;
+}
+
+uint32_t spi_dma_busy(void)
+{
+	return 0;
+}
+
+void spi_release_cs(void)
+{
+	nor_sim_deselect();
+	return;
+}
+
+int spi_master_transfer(void *p_buf, uint32_t size, uint8_t chip_sel)
+{
+	return spi_dma_transfer(p_buf, p_buf, size, chip_sel, 0);
+}
+
+int spi_master_transfer_keepcslow(void *p_buf, uint32_t size, uint8_t chip_sel)
+{
+	return spi_dma_transfer(p_buf, p_buf, size, chip_sel, SPI_DMA_HOLD_CS);
+}
+
+int spi_master_read(void *p_buf, uint32_t size, uint32_t chip_sel)
+{
+	return spi_dma_transfer(0, p_buf, size, (uint8_t)chip_sel, SPI_DMA_HOLD_CS);
+}
+
+void spi_initialize(void)
+{
+	nor_sim_deselect();
+	return;
+}
@@ -0,0 +1,112 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		nor_sim.h
+*
+*	PURPOSE:		Houses the includes and definitions for nor_sim.c, the host (Linux) simulation
+*					of the three SPI memory chips and of the SPI0 transfer layer in front of them.
+*
+*	FILE REFERENCES:		stdint.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY. This file is not part of the Atmel Studio
+*											project and must never be compiled for the OBC.
+*
+*	NOTES:		A host build compiles spimem.c (and the modules above it) against nor_sim.c instead of
+*				spi_func.c. The prototypes for the SPI0 functions are repeated here because spi_func.h
+*				pulls in the ASF; they must be kept in step with spi_func.h.
+*
+*				The host build (Makefile in this directory) does this with stub/spi_func.h, and
+*				rtos_sim.c maps delay_us(), delay_ms() and the tick count onto the clock kept here,
+*				so the busy waits in spimem.c advance the simulated time.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created.
+*
+*/
+
+#ifndef NOR_SIM_H
+#define NOR_SIM_H
+
+#include <stdint.h>
+
+/* Geometry of the S25FL208K, must agree with spimem.h */
+#define NOR_SIM_CHIPS			3			// Chip selects 1, 2 and 3.
+#define NOR_SIM_CHIP_SIZE		0x100000	// 1 MB per chip.
+#define NOR_SIM_SECT_SIZE		4096
+#define NOR_SIM_PAGE_SIZE		256
+#define NOR_SIM_SECTORS			(NOR_SIM_CHIP_SIZE / NOR_SIM_SECT_SIZE)
+
+/* Flags for spi_dma_transfer(), same values as spi_func.h */
+#ifndef SPI_DMA_HOLD_CS
+#define SPI_DMA_HOLD_CS			0x01
+#define SPI_DMA_BYTES			0x02
+#endif
+
+/* Default timing (typical values from the S25FL208K datasheet) */
+#define NOR_SIM_SPI_HZ			4000000		// SPI_CLK_FREQ
+#define NOR_SIM_PROGRAM_US		700
+#define NOR_SIM_SECT_ERASE_US	50000
+#define NOR_SIM_CHIP_ERASE_US	3000000
+
+typedef struct
+{
+	const char* path;				// Backing files are <path>1.bin, <path>2.bin and <path>3.bin.
+	uint32_t spi_hz;				// 0 == transfers take no time.
+	uint32_t word_gap_us;			// Time the SPI0 driver leaves after each word, 0 == DMAC (the
+									// polled spi_master_transfer() this replaced waited 100us).
+	uint32_t program_us;			// WIP time of a page program.
+	uint32_t sect_erase_us;			// WIP time of a sector erase.
+	uint32_t chip_erase_us;			// WIP time of a chip erase.
+	double seu_rate;				// Bit flips per bit per second of simulated time.
+	uint32_t seed;					// Seed for the SEU generator (0 is replaced by 1).
+} nor_sim_config_t;
+
+typedef struct
+{
+	uint64_t bytes;					// Bytes clocked over SPI0 (all chips).
+	uint64_t reads;					// READ commands.
+	uint64_t programs;				// Page programs.
+	uint64_t sect_erases;
+	uint64_t chip_erases;
+	uint64_t over_programs;			// Bytes other than 0xFF programmed over a 0 bit (driver bug).
+	uint64_t busy_violations;		// Commands other than RSR sent while WIP was set (driver bug).
+	uint64_t wel_violations;		// Program/erase commands sent without WEL set (driver bug).
+	uint64_t seu_flips;				// Bits flipped by the SEU generator.
+} nor_sim_stats_t;
+
+typedef void (*spi_dma_callback_t)(void* arg, int status);
+
+/*		Simulator API					*/
+void nor_sim_default_config(nor_sim_config_t* config);
+int nor_sim_open(const nor_sim_config_t* config);
+void nor_sim_close(void);
+void nor_sim_delay_us(uint32_t us);
+uint64_t nor_sim_now_us(void);
+void nor_sim_flip_bit(uint8_t chip, uint32_t addr, uint8_t bit);
+void nor_sim_fail_chip(uint8_t chip, uint8_t failed);
+uint32_t nor_sim_erase_count(uint8_t chip, uint32_t sect);
+uint8_t* nor_sim_memory(uint8_t chip);
+void nor_sim_get_stats(nor_sim_stats_t* stats);
+void nor_sim_reset_stats(void);
+
+/*		SPI0 layer (see spi_func.h)		*/
+void spi_initialize(void);
+int spi_master_transfer(void *p_buf, uint32_t size, uint8_t chip_sel);
+int spi_master_transfer_keepcslow(void *p_buf, uint32_t size, uint8_t chip_sel);
+int spi_master_read(void *p_buf, uint32_t size, uint32_t chip_sel);
+int spi_dma_transfer(const void* tx_buf, void* rx_buf, uint32_t size, uint8_t chip_sel, uint8_t flags);
+int spi_dma_transfer_async(const void* tx_buf, void* rx_buf, uint32_t size, uint8_t chip_sel, uint8_t flags, spi_dma_callback_t callback, void* arg);
+int spi_dma_wait(uint32_t timeout);
+uint32_t spi_dma_busy(void);
+void spi_release_cs(void);
+
+#endif
@@ -0,0 +1,182 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		obc_sim.c
+*
+*	PURPOSE:		Host (Linux) stand-ins for the OBC modules which host builds don't compile.
+*
+*	FILE REFERENCES:		obc_sim.h, global_var.h, error_handling.h, spimem.h, pus_pool.h, tm_sched.h,
+*								string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY. This file is not part of the Atmel Studio
+*											project.
+*
+*	NOTES:		error_handling.c hands errors to the FDIR task and waits for it. There is no FDIR
+*				task in a host build, so an error is counted and the call returns straight away
+*				as if FDIR had not resolved it.
+*
+*				There is no packet router task either. A test which drives the memory task takes its
+*				packets off mem_to_obc_fifo with obc_sim_take_packet(), or sends them to the
+*				simulated COMS SSM with router_sim.c, which can also run the router's own request
+*				handling (router_sim_exec_commands()).
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "global_var.h"
+#include "error_handling.h"
+#include "spimem.h"
+#include "pus_pool.h"
+#include "tm_sched.h"
+#include "obc_sim.h"
+
+static obc_sim_errors_t sim_errors;
+
+/************************************************************************/
+/* OBC_SIM_INIT                                                         */
+/* @Purpose: Creates the mutexes and sets the SPI memory globals the	*/
+/* way prvInitializeMutexes() and prvInitializeFifos() in main.c do,	*/
+/* except that all three chips start out healthy. The FIFOs of the		*/
+/* memory task and the packet router, the PUS packet pool and the TM	*/
+/* queues are emptied. Must be called before spimem_initialize().		*/
+/************************************************************************/
+void obc_sim_init(void)
+{
+	if(!Spi0_Mutex)
+	{
+		Spi0_Mutex = xSemaphoreCreateBinary();
+		Highsev_Mutex = xSemaphoreCreateBinary();
+		Lowsev_Mutex = xSemaphoreCreateBinary();
+		mem_to_obc_fifo = xQueueCreate(4, PUS_POOL_DESC_SIZE);
+		obc_to_mem_fifo = xQueueCreate(4, 147);
+		sched_to_memory_fifo = xQueueCreate(2, 147);
+		hk_to_obc_fifo = xQueueCreate(4, PUS_POOL_DESC_SIZE);
+		time_to_obc_fifo = xQueueCreate(4, 10);
+		obc_to_hk_fifo = xQueueCreate(4, 147);
+		obc_to_sched_fifo = xQueueCreate(4, 147);
+		obc_to_fdir_fifo = xQueueCreate(4, 147);
+		obc_to_time_fifo = xQueueCreate(4, 10);
+		tc_msg_fifo = xQueueCreate(152, 4);
+		tc_buffer = xQueueCreate(10, 152);
+		opr_wake_sem = xSemaphoreCreateBinary();
+	}
+	xQueueReset(Spi0_Mutex);
+	xQueueReset(Highsev_Mutex);
+	xQueueReset(Lowsev_Mutex);
+	xQueueReset(mem_to_obc_fifo);
+	xQueueReset(obc_to_mem_fifo);
+	xQueueReset(sched_to_memory_fifo);
+	xQueueReset(hk_to_obc_fifo);
+	xQueueReset(time_to_obc_fifo);
+	xQueueReset(obc_to_hk_fifo);
+	xQueueReset(obc_to_sched_fifo);
+	xQueueReset(obc_to_fdir_fifo);
+	xQueueReset(obc_to_time_fifo);
+	xQueueReset(tc_msg_fifo);
+	xQueueReset(tc_buffer);
+	xQueueReset(opr_wake_sem);
+	pus_pool_init();
+	tm_sched_init();
+	xSemaphoreGive(Spi0_Mutex);
+	xSemaphoreGive(Highsev_Mutex);
+	xSemaphoreGive(Lowsev_Mutex);
+
+	erase_sector_timeout = 30;
+	chip_erase_timeout = 1500;
+	COMS_BASE		=	0x00000;
+	EPS_BASE		=	0x04000;
+	PAY_BASE		=	0x08000;
+	HK_BASE			=	0x0C000;
+	EVENT_BASE		=	0x0E000;
+	SCHEDULE_BASE	=	0x10000;
+	DIAG_BASE		=	0x12000;
+	SCIENCE_BASE	=	0x24000;
+	TM_BASE			=	0x64000;
+	TC_BASE			=	0x84000;
+	CHECKSUM_BASE	=	0xA6000;
+	EDAC_BASE		=	0xAC000;
+	WASH_BASE		=	0xBFFF8;
+	TIME_BASE		=	0xBFFFC;
+	MAX_SCHED_COMMANDS = 511;
+	LENGTH_OF_HK = 8192;
+	INTERNAL_MEMORY_FALLBACK_MODE = 0;
+	SPI_HEALTH1 = 1;
+	SPI_HEALTH2 = 1;
+	SPI_HEALTH3 = 1;
+	obc_sim_reset_errors();
+	return;
+}
+
+/************************************************************************/
+/* OBC_SIM_TAKE_PACKET                                                  */
+/* @param: fifo: A FIFO which carries PUS packet pool descriptors.		*/
+/* @param: packet: Where to copy the 152B buffer.						*/
+/* @return: 1 == a packet was taken, 0 == the FIFO was empty.			*/
+/* @Purpose: Does the packet router's part: the buffer is copied out	*/
+/* and given back to the pool.											*/
+/************************************************************************/
+uint8_t obc_sim_take_packet(QueueHandle_t fifo, uint8_t* packet)
+{
+	uint8_t desc;
+
+	if(xQueueReceive(fifo, &desc, 0) != pdTRUE)
+		return 0;
+	memcpy(packet, pus_pool_buf(desc), PACKET_LENGTH);
+	pus_pool_release(desc);
+	return 1;
+}
+
+void obc_sim_get_errors(obc_sim_errors_t* errors)
+{
+	*errors = sim_errors;
+	return;
+}
+
+void obc_sim_reset_errors(void)
+{
+	memset(&sim_errors, 0, sizeof(sim_errors));
+	return;
+}
+
+/*		error_handling.h				*/
+int errorASSERT(uint8_t task, uint8_t code, uint32_t error, uint8_t* data, SemaphoreHandle_t mutex)
+{
+	sim_errors.asserts++;
+	sim_errors.last_error = error;
+	sim_errors.last_task = task;
+	sim_errors.last_code = code;
+	if(mutex)
+		xSemaphoreGive(mutex);
+	return -1;
+}
+
+int errorREPORT(uint8_t task, uint8_t code, uint32_t error, uint8_t* data)
+{
+	sim_errors.reports++;
+	sim_errors.last_error = error;
+	sim_errors.last_task = task;
+	sim_errors.last_code = code;
+	return 1;
+}
+
+BaseType_t xQueueSendToBackTask(uint8_t task, uint8_t direction, QueueHandle_t fifo, uint8_t *itemToQueue, TickType_t ticks)
+{
+	return xQueueSendToBack(fifo, itemToQueue, ticks);
+}
+
+BaseType_t xQueueReceiveTask(uint8_t task, uint8_t direction, QueueHandle_t fifo, uint8_t *itemToQueue, TickType_t ticks)
+{
+	return xQueueReceive(fifo, itemToQueue, ticks);
+}
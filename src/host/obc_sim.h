@@ -0,0 +1,51 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		obc_sim.h
+*
+*	PURPOSE:		Houses the includes and definitions for obc_sim.c, the host (Linux) stand-ins for
+*					the OBC modules which host builds don't compile (error_handling.c for now).
+*
+*	FILE REFERENCES:		stdint.h, FreeRTOS.h (host stub)
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY. This file is not part of the Atmel Studio
+*											project and must never be compiled for the OBC.
+*
+*	NOTES:		Errors are counted instead of being sent to FDIR, so that a test can check that an
+*				operation raised (or didn't raise) one.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created.
+*
+*/
+
+#ifndef OBC_SIM_H
+#define OBC_SIM_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+typedef struct
+{
+	uint32_t asserts;				// errorASSERT() calls (high severity).
+	uint32_t reports;				// errorREPORT() calls (low severity).
+	uint32_t last_error;			// Error code of the last call of either.
+	uint8_t last_task;
+	uint8_t last_code;
+} obc_sim_errors_t;
+
+void obc_sim_init(void);
+uint8_t obc_sim_take_packet(QueueHandle_t fifo, uint8_t* packet);
+void obc_sim_get_errors(obc_sim_errors_t* errors);
+void obc_sim_reset_errors(void);
+
+#endif
@@ -0,0 +1,281 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		router_sim.c
+*
+*	PURPOSE:		Host (Linux) build of the packet router's TM transfer against the simulated COMS SSM:
+*					obc_packet_router.c is compiled as it is, and the CAN0 functions it calls from
+*					can_func.c are replaced by ones which put the frames on coms_sim's bus.
+*
+*	FILE REFERENCES:		router_sim.h, coms_sim.h, FreeRTOS.h (host stub), obc_packet_router.c (build/src)
+*
+*	EXTERNAL VARIABLES:		start_tm_transferf, tm_transfer_completef (global_var.h)
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile). The task itself is
+*											never started, its functions are called one at a time.
+*
+*	NOTES:		The router's own waits (vTaskDelayUntil(), taskYIELD(), xTaskGetTickCount()) are
+*				redefined onto coms_sim's clock before obc_packet_router.c is included, see
+*				router_sim.h.
+*
+*				The SSM answers while the OBC's frame is being sent, so the CAN1 handler's part
+*				(OK_START_TM_PACKET and TM_TRANSACTION_RESP in decode_can_command()) has happened by
+*				the time a wait starts. A wait which finds nothing lets its whole timeout pass.
+*
+*				router_sim_windowed.c includes this file again with TM_TRANSFER_PROTOCOL set to
+*				TM_TRANSFER_WINDOWED, and with every global name renamed through ROUTER_SIM().
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include "FreeRTOS.h"
+#include "coms_sim.h"
+#include "router_sim.h"
+
+#ifndef ROUTER_SIM
+#define ROUTER_SIM(name)		router_sim_##name
+#endif
+
+#define ROUTER_SIM_YIELD_US		20			// One pass through taskYIELD() with nothing else to run.
+#define ROUTER_SIM_SEND_US		100			// delay_us() at the end of send_can_command().
+
+static void ROUTER_SIM(delay_until)(TickType_t* previous, TickType_t ticks);
+
+#undef taskYIELD
+#define taskYIELD()							coms_sim_delay_us(ROUTER_SIM_YIELD_US)
+#define xTaskGetTickCount()					((TickType_t)(coms_sim_now_us() / 1000))
+#define vTaskDelayUntil(previous, ticks)	ROUTER_SIM(delay_until)(previous, ticks)
+
+#include "obc_packet_router.c"
+
+static void ROUTER_SIM(to_obc)(uint32_t low, uint32_t high);
+
+static uint8_t sim_started;					// tm_start_sem
+static uint8_t sim_responded;				// tm_resp_sem
+static uint32_t sim_resp;					// tm_resp
+
+/************************************************************************/
+/* ROUTER_SIM_OPEN                                                      */
+/* @param: config: Timing and loss of the COMS SSM, 0 = default. Its	*/
+/* receiver is replaced by the router's.								*/
+/* @Purpose: Opens coms_sim and forgets any transfer in progress.		*/
+/************************************************************************/
+void ROUTER_SIM(open)(const coms_sim_config_t* config)
+{
+	coms_sim_config_t sim_config;
+
+	if(config)
+		sim_config = *config;
+	else
+		coms_sim_default_config(&sim_config);
+	sim_config.to_obc = ROUTER_SIM(to_obc);
+	coms_sim_open(&sim_config);
+	sim_started = 0;
+	sim_responded = 0;
+	sim_resp = 0;
+	start_tm_transferf = 0;
+	tm_transfer_completef = 0;
+	tm_down_fullf = 0;
+	down_desc = PUS_POOL_NONE;
+	return;
+}
+
+/************************************************************************/
+/* ROUTER_SIM_START                                                     */
+/* @Purpose: What the router task does before it enters its loop		*/
+/* (opr_init()). The TM and TC stores are opened, so the SPI memory		*/
+/* must be mounted (host_test_open()).									*/
+/************************************************************************/
+void ROUTER_SIM(start)(void)
+{
+	current_tm_fullf = 0;
+	receiving_tcf = 0;
+	opr_init();
+	return;
+}
+
+/************************************************************************/
+/* ROUTER_SIM_EXEC_COMMANDS                                             */
+/* @return: What exec_commands() returned, the number of requests		*/
+/* handled.																*/
+/* @Purpose: One pass over the FIFOs from the other tasks, as the		*/
+/* router's loop makes up to OPR_REQUEST_BATCH times per wake. TM		*/
+/* packets go to the TM queues (tm_sched.c).							*/
+/************************************************************************/
+int ROUTER_SIM(exec_commands)(void)
+{
+	return exec_commands();
+}
+
+/************************************************************************/
+/* ROUTER_SIM_SEND_TM                                                   */
+/* @param: desc: Pool descriptor of the packet to send.					*/
+/* @Purpose: Hands the packet to send_pus_packet_tm() the way the		*/
+/* router's loop does.													*/
+/* @return: What send_pus_packet_tm() returned. On success the buffer	*/
+/* has been released, on failure it is still the caller's.				*/
+/************************************************************************/
+int ROUTER_SIM(send_tm)(uint8_t desc)
+{
+	int ret;
+
+	down_desc = desc;
+	tm_to_downlink = pus_pool_buf(desc);
+	tm_down_fullf = 1;
+	ret = send_pus_packet_tm(OBC_PACKET_ROUTER_ID);
+	if(ret < 0)
+	{
+		tm_down_fullf = 0;
+		down_desc = PUS_POOL_NONE;
+	}
+	return ret;
+}
+
+/************************************************************************/
+/* ROUTER_SIM_TM_PACE                                                   */
+/* @return: OPR_TM_PACE, the ticks the router leaves between two TM		*/
+/* packets so that COMS can downlink the first.							*/
+/************************************************************************/
+uint32_t ROUTER_SIM(tm_pace)(void)
+{
+	return OPR_TM_PACE;
+}
+
+/************************************************************************/
+/* SEND_CAN_COMMAND / SEND_TC_CAN_COMMAND (host)                        */
+/* @Purpose: As in can_func.c. Frames for EPS and PAY take bus time and	*/
+/* are otherwise dropped.												*/
+/************************************************************************/
+int send_can_command(uint32_t low, uint8_t byte_four, uint8_t sender_id, uint8_t ssm_id, uint8_t smalltype, uint8_t priority)
+{
+	uint32_t high;
+
+	high = ((uint32_t)sender_id << 28) | ((uint32_t)ssm_id << 24) | ((uint32_t)MT_COM << 16) | ((uint32_t)smalltype << 8);
+	high |= (uint32_t)byte_four;
+	send_can_command_h(low, high, (ssm_id == COMS_ID) ? SUB0_ID0 : SUB1_ID0, priority);
+	coms_sim_delay_us(ROUTER_SIM_SEND_US);
+	return 0;
+}
+
+int send_tc_can_command(uint32_t low, uint8_t byte_four, uint8_t sender_id, uint8_t ssm_id, uint8_t smalltype, uint8_t priority)
+{
+	uint32_t high;
+
+	if(ssm_id != COMS_ID)
+		return -1;
+	high = ((uint32_t)sender_id << 28) | ((uint32_t)ssm_id << 24) | ((uint32_t)MT_COM << 16) | ((uint32_t)smalltype << 8);
+	high |= (uint32_t)byte_four;
+	send_can_command_h(low, high, SUB0_ID3, priority);
+	coms_sim_delay_us(ROUTER_SIM_SEND_US);
+	return 0;
+}
+
+/************************************************************************/
+/* SEND_TM_FRAME / TM_TRANSFER_RESET / TM_WAIT_START /					*/
+/* TM_WAIT_RESPONSE (host)												*/
+/* @Purpose: As in can_func.c, with flags instead of the semaphores.	*/
+/************************************************************************/
+int send_tm_frame(uint32_t low, uint32_t high)
+{
+	send_can_command_h(low, high, TM_FRAME_ID, COMMAND_PRIO);
+	return 0;
+}
+
+void tm_transfer_reset(void)
+{
+	sim_started = 0;
+	sim_responded = 0;
+	return;
+}
+
+int tm_wait_start(TickType_t ticks)
+{
+	if(!sim_started)
+	{
+		coms_sim_delay_us((uint32_t)ticks * 1000);
+		return 0;
+	}
+	sim_started = 0;
+	return 1;
+}
+
+int tm_wait_response(uint32_t* resp, TickType_t ticks)
+{
+	if(!sim_responded)
+	{
+		coms_sim_delay_us((uint32_t)ticks * 1000);
+		return 0;
+	}
+	sim_responded = 0;
+	*resp = sim_resp;
+	return 1;
+}
+
+/************************************************************************/
+/* GET_SSM_ID / REQUEST_SENSOR_DATA / SET_VARIABLE (host)               */
+/* @Purpose: There are no SSMs to ask, every request fails.				*/
+/************************************************************************/
+uint8_t get_ssm_id(uint8_t sensor_name)
+{
+	return 0xFF;
+}
+
+uint32_t request_sensor_data(uint8_t sender_id, uint8_t ssm_id, uint8_t sensor_name, int* status)
+{
+	*status = -1;
+	return 0;
+}
+
+int set_variable(uint8_t sender_id, uint8_t ssm_id, uint8_t var_name, uint16_t value)
+{
+	return -1;
+}
+
+/************************************************************************/
+/* ROUTER_SIM_TO_OBC                                                    */
+/* @param: low, high: A frame from the COMS SSM.						*/
+/* @Purpose: The TM part of decode_can_command() in can_func.c.			*/
+/************************************************************************/
+static void ROUTER_SIM(to_obc)(uint32_t low, uint32_t high)
+{
+	switch((uint8_t)(high >> 8))
+	{
+		case TM_TRANSACTION_RESP:
+#if (TM_TRANSFER_PROTOCOL == TM_TRANSFER_LEGACY)
+			tm_transfer_completef = (uint8_t)(low & 0x000000FF);
+#endif
+			sim_resp = low;
+			sim_responded = 1;
+			break;
+		case OK_START_TM_PACKET:
+			start_tm_transferf = 1;
+			sim_started = 1;
+			break;
+		default:
+			break;
+	}
+	return;
+}
+
+/************************************************************************/
+/* ROUTER_SIM_DELAY_UNTIL                                               */
+/* @Purpose: vTaskDelayUntil() on coms_sim's clock.						*/
+/************************************************************************/
+static void ROUTER_SIM(delay_until)(TickType_t* previous, TickType_t ticks)
+{
+	uint64_t due = ((uint64_t)*previous + ticks) * 1000;
+
+	if(due > coms_sim_now_us())
+		coms_sim_delay_us((uint32_t)(due - coms_sim_now_us()));
+	*previous += ticks;
+	return;
+}
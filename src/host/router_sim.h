@@ -0,0 +1,56 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		router_sim.h
+*
+*	PURPOSE:		Houses the includes and definitions for router_sim.c, which runs the packet router's
+*					TM transfer (send_pus_packet_tm() in obc_packet_router.c) against the simulated COMS
+*					SSM in coms_sim.c, and its handling of requests from the other tasks.
+*
+*	FILE REFERENCES:		stdint.h, coms_sim.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY. This file is not part of the Atmel Studio
+*											project.
+*
+*	NOTES:		router_sim_* is the router built with the default TM_TRANSFER_PROTOCOL (the legacy
+*				transfer), router_sim_windowed_* the same code built with TM_TRANSFER_WINDOWED.
+*
+*				A transfer runs on the COMS simulator's clock (coms_sim_now_us()), not on the one
+*				which rtos_sim and nor_sim share. It can therefore be made from main() or from an
+*				rtos_sim event, and the caller decides how the time it took fits its own time line.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created.
+*
+*/
+
+#ifndef ROUTER_SIM_H
+#define ROUTER_SIM_H
+
+#include <stdint.h>
+#include "coms_sim.h"
+
+/*		Legacy transfer (default build)		*/
+void router_sim_open(const coms_sim_config_t* config);
+void router_sim_start(void);
+int router_sim_exec_commands(void);
+int router_sim_send_tm(uint8_t desc);
+uint32_t router_sim_tm_pace(void);
+
+/*		Windowed transfer					*/
+void router_sim_windowed_open(const coms_sim_config_t* config);
+void router_sim_windowed_start(void);
+int router_sim_windowed_exec_commands(void);
+int router_sim_windowed_send_tm(uint8_t desc);
+uint32_t router_sim_windowed_tm_pace(void);
+
+#endif
@@ -0,0 +1,47 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		router_sim_windowed.c
+*
+*	PURPOSE:		router_sim.c built with the windowed TM transfer (TM_TRANSFER_WINDOWED), so that a
+*					host program can run both protocols against coms_sim.
+*
+*	FILE REFERENCES:		router_sim.c
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The global functions of obc_packet_router.c and of the CAN0 stand-ins are renamed
+*				so that they don't clash with the ones in router_sim.o.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#define TM_TRANSFER_PROTOCOL		1		// TM_TRANSFER_WINDOWED (can_func.h)
+#define ROUTER_SIM(name)			router_sim_windowed_##name
+
+#define obc_packet_router			ROUTER_SIM(obc_packet_router)
+#define opr_kill					ROUTER_SIM(opr_kill)
+#define get_obc_variable			ROUTER_SIM(get_obc_variable)
+#define set_obc_variable			ROUTER_SIM(set_obc_variable)
+#define send_can_command			ROUTER_SIM(send_can_command)
+#define send_tc_can_command			ROUTER_SIM(send_tc_can_command)
+#define send_tm_frame				ROUTER_SIM(send_tm_frame)
+#define tm_transfer_reset			ROUTER_SIM(tm_transfer_reset)
+#define tm_wait_start				ROUTER_SIM(tm_wait_start)
+#define tm_wait_response			ROUTER_SIM(tm_wait_response)
+#define get_ssm_id					ROUTER_SIM(get_ssm_id)
+#define request_sensor_data			ROUTER_SIM(request_sensor_data)
+#define set_variable				ROUTER_SIM(set_variable)
+
+#include "router_sim.c"
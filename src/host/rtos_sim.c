@@ -0,0 +1,606 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		rtos_sim.c
+*
+*	PURPOSE:		Host (Linux) stand-in for the part of the FreeRTOS kernel which the firmware uses
+*					(queues, semaphores, tick count, delays, critical sections) and for time.c.
+*
+*	FILE REFERENCES:		rtos_sim.h, nor_sim.h, time.h, stdio.h, stdlib.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: configASSERT() failures and running
+*					out of queues, tasks or event slots end the program with a message on stderr.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY. This file is not part of the Atmel Studio
+*											project.
+*
+*	NOTES:		See rtos_sim.h. A call which would block on the OBC lets simulated time pass instead:
+*				the events which fall due run in time order until the queue or semaphore can be used
+*				or the ticks run out. An event must not block itself, the calls it makes behave as
+*				their FromISR versions.
+*
+*				Critical sections are timed, which is how the host build measures the worst case
+*				time the OBC would spend with interrupts off (rtos_sim_stats_t).
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nor_sim.h"
+#include "time.h"
+#include "rtos_sim.h"
+
+#define RTOS_SIM_TASKS			32
+#define RTOS_SIM_FOREVER		0xFFFFFFFFFFFFFFFFULL
+
+struct rtos_sim_queue
+{
+	UBaseType_t length;
+	UBaseType_t item_size;				// 0 == semaphore.
+	UBaseType_t count;
+	UBaseType_t head;
+	uint8_t* items;
+};
+
+struct rtos_sim_task
+{
+	char name[16];
+	TaskFunction_t code;
+	void* param;
+	UBaseType_t priority;
+	uint16_t stack;
+	uint8_t deleted;
+};
+
+typedef struct
+{
+	uint64_t time;						// Simulated time (us) the event is due at.
+	uint64_t order;						// Events which are due together run in the order they were added.
+	rtos_sim_event_t event;
+	void* arg;
+} rtos_sim_pending_t;
+
+static void rtos_sim_block(QueueHandle_t queue, uint8_t send, TickType_t ticks);
+static void rtos_sim_advance_to(uint64_t time_us);
+static void rtos_sim_catch_up(void);
+static void rtos_sim_api(void);
+static void rtos_sim_pass(uint64_t us);
+static rtos_sim_pending_t rtos_sim_pop(void);
+
+static struct rtos_sim_task tasks[RTOS_SIM_TASKS];
+static uint32_t task_count;
+static TaskHandle_t current_task;
+static BaseType_t scheduler_state = taskSCHEDULER_NOT_STARTED;
+static rtos_sim_pending_t pending[RTOS_SIM_EVENTS];
+static uint32_t pending_count;
+static uint64_t pending_order;
+static uint32_t critical_nesting;
+static uint64_t critical_start;
+static uint8_t in_event;
+static uint32_t api_cost_us;
+static rtos_sim_stats_t sim_stats;
+
+/************************************************************************/
+/* RTOS_SIM_RESET                                                       */
+/* @Purpose: Forgets every task and pending event, stops the scheduler	*/
+/* and clears the statistics. Queues which were created stay valid.		*/
+/************************************************************************/
+void rtos_sim_reset(void)
+{
+	memset(tasks, 0, sizeof(tasks));
+	task_count = 0;
+	current_task = 0;
+	scheduler_state = taskSCHEDULER_NOT_STARTED;
+	pending_count = 0;
+	pending_order = 0;
+	critical_nesting = 0;
+	in_event = 0;
+	api_cost_us = 0;
+	memset(&sim_stats, 0, sizeof(sim_stats));
+	return;
+}
+
+/************************************************************************/
+/* RTOS_SIM_START                                                       */
+/* @Purpose: From now on xTaskGetSchedulerState() says the scheduler is	*/
+/* running, like after vTaskStartScheduler() on the OBC.				*/
+/************************************************************************/
+void rtos_sim_start(void)
+{
+	scheduler_state = taskSCHEDULER_RUNNING;
+	return;
+}
+
+/************************************************************************/
+/* RTOS_SIM_AT                                                          */
+/* @param: time_us: Simulated time at which the event should run, an	*/
+/* event in the past runs at the next opportunity.						*/
+/* @param: event: Function to call (an ISR or the work of another task).*/
+/* @param: arg: Passed to event.										*/
+/************************************************************************/
+void rtos_sim_at(uint64_t time_us, rtos_sim_event_t event, void* arg)
+{
+	uint32_t i, parent;
+	rtos_sim_pending_t item;
+
+	if(pending_count == RTOS_SIM_EVENTS)
+	{
+		fprintf(stderr, "rtos_sim: more than %d pending events\n", RTOS_SIM_EVENTS);
+		exit(1);
+	}
+	item.time = time_us;
+	item.order = pending_order++;
+	item.event = event;
+	item.arg = arg;
+
+	i = pending_count++;
+	while(i)
+	{
+		parent = (i - 1) / 2;
+		if((pending[parent].time < item.time)
+			|| ((pending[parent].time == item.time) && (pending[parent].order < item.order)))
+			break;
+		pending[i] = pending[parent];
+		i = parent;
+	}
+	pending[i] = item;
+	return;
+}
+
+/************************************************************************/
+/* RTOS_SIM_RUN_UNTIL                                                   */
+/* @param: time_us: Simulated time to stop at.							*/
+/* @Purpose: Lets the events run up to time_us as if the task was		*/
+/* blocked all that time.												*/
+/************************************************************************/
+void rtos_sim_run_until(uint64_t time_us)
+{
+	uint64_t start = nor_sim_now_us();
+
+	while(pending_count && (pending[0].time <= time_us))
+		rtos_sim_advance_to(pending[0].time);
+	if(time_us > nor_sim_now_us())
+		rtos_sim_pass(time_us - nor_sim_now_us());
+	sim_stats.blocked_us += nor_sim_now_us() - start;
+	return;
+}
+
+/************************************************************************/
+/* RTOS_SIM_SET_API_COST                                                */
+/* @param: us: CPU time charged for every queue, semaphore or delay		*/
+/* call (0 by default). Used to estimate the CPU share of a task.		*/
+/************************************************************************/
+void rtos_sim_set_api_cost(uint32_t us)
+{
+	api_cost_us = us;
+	return;
+}
+
+/************************************************************************/
+/* RTOS_SIM_SET_CURRENT / RTOS_SIM_FIND_TASK / RTOS_SIM_TASK_CODE       */
+/* @Purpose: Lets a test pretend to be one of the tasks which the		*/
+/* firmware created (xTaskGetCurrentTaskHandle()), or run its code.		*/
+/************************************************************************/
+void rtos_sim_set_current(TaskHandle_t task)
+{
+	current_task = task;
+	return;
+}
+
+TaskHandle_t rtos_sim_find_task(const char* name)
+{
+	uint32_t i;
+
+	for(i = 0; i < task_count; i++)
+	{
+		if(!tasks[i].deleted && !strncmp(tasks[i].name, name, sizeof(tasks[i].name) - 1))
+			return &tasks[i];
+	}
+	return 0;
+}
+
+TaskFunction_t rtos_sim_task_code(TaskHandle_t task)
+{
+	return task ? task->code : 0;
+}
+
+/************************************************************************/
+/* RTOS_SIM_GET_STATS / RTOS_SIM_RESET_STATS                            */
+/* @param: stats: Where to copy the counters.							*/
+/************************************************************************/
+void rtos_sim_get_stats(rtos_sim_stats_t* stats)
+{
+	*stats = sim_stats;
+	return;
+}
+
+void rtos_sim_reset_stats(void)
+{
+	memset(&sim_stats, 0, sizeof(sim_stats));
+	return;
+}
+
+void rtos_sim_assert(const char* file, int line)
+{
+	fprintf(stderr, "configASSERT failed: %s:%d\n", file, line);
+	exit(1);
+}
+
+/************************************************************************/
+/* RTOS_SIM_ENTER_CRITICAL / RTOS_SIM_EXIT_CRITICAL                     */
+/* @Purpose: taskENTER_CRITICAL() and taskEXIT_CRITICAL(). The			*/
+/* outermost section is timed.											*/
+/************************************************************************/
+void rtos_sim_enter_critical(void)
+{
+	if(!critical_nesting++)
+		critical_start = nor_sim_now_us();
+	return;
+}
+
+void rtos_sim_exit_critical(void)
+{
+	uint64_t length;
+
+	if(!critical_nesting)
+		rtos_sim_assert(__FILE__, __LINE__);
+	if(--critical_nesting)
+		return;
+	length = nor_sim_now_us() - critical_start;
+	sim_stats.critical_sections++;
+	sim_stats.critical_us += length;
+	if(length > sim_stats.critical_max_us)
+		sim_stats.critical_max_us = length;
+	rtos_sim_catch_up();
+	return;
+}
+
+void rtos_sim_yield(void)
+{
+	rtos_sim_catch_up();
+	return;
+}
+
+/*		queue.h							*/
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+	QueueHandle_t queue = calloc(1, sizeof(struct rtos_sim_queue));
+
+	if(!queue)
+		return 0;
+	queue->length = length;
+	queue->item_size = item_size;
+	if(item_size)
+	{
+		queue->items = calloc(length, item_size);
+		if(!queue->items)
+		{
+			free(queue);
+			return 0;
+		}
+	}
+	return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+	if(!queue)
+		return;
+	free(queue->items);
+	free(queue);
+	return;
+}
+
+BaseType_t xQueueSendToBackFromISR(QueueHandle_t queue, const void* item, BaseType_t* woken)
+{
+	if(woken)
+		*woken = pdFALSE;
+	if(queue->count == queue->length)
+		return pdFAIL;
+	if(queue->item_size && item)
+	{
+		memcpy(queue->items + ((queue->head + queue->count) % queue->length) * queue->item_size, item, queue->item_size);
+		sim_stats.queue_bytes += queue->item_size;
+	}
+	queue->count++;
+	return pdPASS;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks)
+{
+	rtos_sim_api();
+	rtos_sim_block(queue, 1, ticks);
+	return xQueueSendToBackFromISR(queue, item, 0);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks)
+{
+	rtos_sim_api();
+	rtos_sim_block(queue, 1, ticks);
+	if(queue->count == queue->length)
+		return pdFAIL;
+	queue->head = (queue->head + queue->length - 1) % queue->length;
+	if(queue->item_size && item)
+	{
+		memcpy(queue->items + queue->head * queue->item_size, item, queue->item_size);
+		sim_stats.queue_bytes += queue->item_size;
+	}
+	queue->count++;
+	return pdPASS;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticks)
+{
+	rtos_sim_api();
+	rtos_sim_block(queue, 0, ticks);
+	if(!queue->count)
+		return pdFALSE;
+	if(queue->item_size && item)
+	{
+		memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+		sim_stats.queue_bytes += queue->item_size;
+	}
+	return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks)
+{
+	if(xQueuePeek(queue, item, ticks) != pdTRUE)
+		return pdFALSE;
+	queue->head = (queue->head + 1) % queue->length;
+	queue->count--;
+	return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+	return queue->count;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+	queue->count = 0;
+	queue->head = 0;
+	return pdPASS;
+}
+
+/*		semphr.h						*/
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial)
+{
+	SemaphoreHandle_t sem = xQueueCreate(max, 0);
+
+	if(sem)
+		sem->count = initial;
+	return sem;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+	return xQueueReceive(sem, 0, ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+	rtos_sim_api();
+	return xQueueSendToBackFromISR(sem, 0, 0);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken)
+{
+	return xQueueSendToBackFromISR(sem, 0, woken);
+}
+
+/*		task.h							*/
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint16_t stack, void* param, UBaseType_t priority, TaskHandle_t* handle)
+{
+	struct rtos_sim_task* task;
+
+	if(task_count == RTOS_SIM_TASKS)
+	{
+		fprintf(stderr, "rtos_sim: more than %d tasks\n", RTOS_SIM_TASKS);
+		exit(1);
+	}
+	task = &tasks[task_count++];
+	strncpy(task->name, name, sizeof(task->name) - 1);
+	task->code = code;
+	task->param = param;
+	task->priority = priority;
+	task->stack = stack;
+	if(handle)
+		*handle = task;
+	return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+	if(!task)
+		task = current_task;
+	if(task)
+		task->deleted = 1;
+	return;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return current_task;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+	return scheduler_state;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	return (TickType_t)(nor_sim_now_us() / 1000);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+	rtos_sim_api();
+	rtos_sim_block(0, 0, ticks);
+	return;
+}
+
+void vTaskDelayUntil(TickType_t* previous, TickType_t ticks)
+{
+	uint64_t wake = (uint64_t)(TickType_t)(*previous + ticks) * 1000;
+
+	rtos_sim_api();
+	*previous += ticks;
+	if(wake > nor_sim_now_us())
+		rtos_sim_block(0, 0, (TickType_t)((wake - nor_sim_now_us() + 999) / 1000));
+	return;
+}
+
+/*		time.h							*/
+void delay_us(uint32_t us)
+{
+	nor_sim_delay_us(us);
+	return;
+}
+
+void delay_ms(uint32_t ms)
+{
+	nor_sim_delay_us(ms * 1000);
+	return;
+}
+
+void delay_s(uint32_t s)
+{
+	while(s--)
+		nor_sim_delay_us(1000000);
+	return;
+}
+
+/************************************************************************/
+/* RTOS_SIM_BLOCK                                                       */
+/* @param: queue: Queue or semaphore the task waits on, 0 = none.		*/
+/* @param: send: 1 = wait for room, 0 = wait for an item.				*/
+/* @param: ticks: How long to wait at most.								*/
+/* @Purpose: Runs the events which fall due until the task could carry	*/
+/* on, or until the ticks have passed.									*/
+/************************************************************************/
+static void rtos_sim_block(QueueHandle_t queue, uint8_t send, TickType_t ticks)
+{
+	uint64_t start = nor_sim_now_us();
+	uint64_t deadline;
+
+	if(!ticks || in_event)
+		return;
+	if(queue && (send ? (queue->count < queue->length) : (queue->count > 0)))
+		return;
+	if(critical_nesting)
+		sim_stats.block_in_critical++;
+	sim_stats.blocks++;
+	deadline = (ticks == portMAX_DELAY) ? RTOS_SIM_FOREVER : start + (uint64_t)ticks * 1000;
+
+	for(;;)
+	{
+		if(queue && (send ? (queue->count < queue->length) : (queue->count > 0)))
+			break;
+		if(pending_count && (pending[0].time <= deadline))
+		{
+			rtos_sim_advance_to(pending[0].time);
+			continue;
+		}
+		if(deadline == RTOS_SIM_FOREVER)
+		{
+			sim_stats.deadlocks++;
+			break;
+		}
+		if(deadline > nor_sim_now_us())
+			rtos_sim_pass(deadline - nor_sim_now_us());
+		break;
+	}
+	sim_stats.blocked_us += nor_sim_now_us() - start;
+	return;
+}
+
+/************************************************************************/
+/* RTOS_SIM_ADVANCE_TO                                                  */
+/* @param: time_us: Due time of the first pending event.				*/
+/* @Purpose: Moves the clock to the event and runs it.					*/
+/************************************************************************/
+static void rtos_sim_advance_to(uint64_t time_us)
+{
+	rtos_sim_pending_t next;
+	uint64_t now = nor_sim_now_us();
+
+	if(time_us > now)
+		rtos_sim_pass(time_us - now);
+	next = rtos_sim_pop();
+	in_event = 1;
+	next.event(next.arg);
+	in_event = 0;
+	sim_stats.events++;
+	return;
+}
+
+/************************************************************************/
+/* RTOS_SIM_CATCH_UP                                                    */
+/* @Purpose: Runs the events which fell due while the task was busy,	*/
+/* unless interrupts are off.											*/
+/************************************************************************/
+static void rtos_sim_catch_up(void)
+{
+	if(critical_nesting || in_event)
+		return;
+	while(pending_count && (pending[0].time <= nor_sim_now_us()))
+		rtos_sim_advance_to(pending[0].time);
+	return;
+}
+
+static void rtos_sim_api(void)
+{
+	sim_stats.api_calls++;
+	if(api_cost_us && !in_event)
+		nor_sim_delay_us(api_cost_us);
+	rtos_sim_catch_up();
+	return;
+}
+
+static void rtos_sim_pass(uint64_t us)
+{
+	while(us > 1000000)
+	{
+		nor_sim_delay_us(1000000);
+		us -= 1000000;
+	}
+	nor_sim_delay_us((uint32_t)us);
+	return;
+}
+
+static rtos_sim_pending_t rtos_sim_pop(void)
+{
+	rtos_sim_pending_t top = pending[0];
+	rtos_sim_pending_t last = pending[--pending_count];
+	uint32_t i = 0, child;
+
+	for(;;)
+	{
+		child = 2 * i + 1;
+		if(child >= pending_count)
+			break;
+		if((child + 1 < pending_count) && ((pending[child + 1].time < pending[child].time)
+			|| ((pending[child + 1].time == pending[child].time) && (pending[child + 1].order < pending[child].order))))
+			child++;
+		if((last.time < pending[child].time) || ((last.time == pending[child].time) && (last.order < pending[child].order)))
+			break;
+		pending[i] = pending[child];
+		i = child;
+	}
+	pending[i] = last;
+	return top;
+}
@@ -0,0 +1,73 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		rtos_sim.h
+*
+*	PURPOSE:		Houses the includes and definitions for rtos_sim.c, the host (Linux) stand-in for
+*					the FreeRTOS kernel and for time.c.
+*
+*	FILE REFERENCES:		stdint.h, FreeRTOS.h (host stub)
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY. This file is not part of the Atmel Studio
+*											project and must never be compiled for the OBC.
+*
+*	NOTES:		There is only one thread: the test or benchmark is "the task" and it calls into the
+*				firmware modules directly. Everything else (ISRs, other tasks, the ground) is an event
+*				which rtos_sim_at() schedules at a point in simulated time. An event runs when the
+*				task blocks (a queue or semaphore call with ticks, vTaskDelay()) and the clock reaches
+*				it, exactly as an ISR or a higher priority task would get the CPU on the OBC.
+*
+*				The clock is the one in nor_sim.c, so SPI transfers, delay_us() and blocked ticks all
+*				move the same time line (1 tick = 1 ms).
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created.
+*
+*/
+
+#ifndef RTOS_SIM_H
+#define RTOS_SIM_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+#define RTOS_SIM_EVENTS			4096		// Events which may be pending at once.
+
+typedef void (*rtos_sim_event_t)(void* arg);
+
+typedef struct
+{
+	uint64_t critical_sections;		// Outermost taskENTER_CRITICAL() calls.
+	uint64_t critical_us;			// Simulated time spent with interrupts off.
+	uint64_t critical_max_us;		// Longest single critical section.
+	uint64_t blocked_us;			// Simulated time the task spent blocked.
+	uint64_t blocks;				// Calls which blocked.
+	uint64_t api_calls;				// Queue, semaphore and delay calls.
+	uint64_t events;				// Events which have run.
+	uint64_t block_in_critical;		// Blocking calls made with interrupts off (firmware bug).
+	uint64_t deadlocks;				// portMAX_DELAY waits which nothing could end.
+	uint64_t queue_bytes;			// Bytes copied into and out of queues.
+} rtos_sim_stats_t;
+
+/*		Simulator API					*/
+void rtos_sim_reset(void);
+void rtos_sim_start(void);
+void rtos_sim_at(uint64_t time_us, rtos_sim_event_t event, void* arg);
+void rtos_sim_run_until(uint64_t time_us);
+void rtos_sim_set_api_cost(uint32_t us);
+void rtos_sim_set_current(TaskHandle_t task);
+TaskHandle_t rtos_sim_find_task(const char* name);
+TaskFunction_t rtos_sim_task_code(TaskHandle_t task);
+void rtos_sim_get_stats(rtos_sim_stats_t* stats);
+void rtos_sim_reset_stats(void);
+
+#endif
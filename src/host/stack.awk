@@ -0,0 +1,105 @@
+# Worst-case stack depth from gcc -fcallgraph-info=su output (make stack, see Makefile).
+#
+#	awk -v root=<function> -f stack.awk build/stack/*.ci
+#
+# Static functions are "file:name" in the .ci files, so equal names in two files stay apart.
+# Each function's own frame comes from its "N bytes" label, the depth of a function is its frame plus
+# the deepest of its callees. Calls outside the .ci files (libc, the rtos_sim stubs) count as 0 bytes,
+# indirect calls are reported but not followed. Recursion is reported, and a second figure allows
+# each recursion to go one level deep.
+
+/^node:/ {
+	match($0, /title: "[^"]*"/)
+	title = substr($0, RSTART + 8, RLENGTH - 9)
+	if(match($0, /\\n[0-9]+ bytes/))
+	{
+		frame[title] = substr($0, RSTART + 2, RLENGTH - 8) + 0
+	}
+}
+
+/^edge:/ {
+	match($0, /sourcename: "[^"]*"/)
+	src = substr($0, RSTART + 13, RLENGTH - 14)
+	match($0, /targetname: "[^"]*"/)
+	dst = substr($0, RSTART + 13, RLENGTH - 14)
+	if(dst == "__indirect_call")
+		indirect[src] = 1
+	else if(!((src, dst) in seen))
+	{
+		seen[src, dst] = 1
+		calls[src] = calls[src] " " dst
+	}
+}
+
+function short(title,	i)
+{
+	i = index(title, ":")
+	return i ? substr(title, i + 1) : title
+}
+
+function find(name,	fn)
+{
+	for(fn in frame)
+		if(fn == name || short(fn) == name)
+			return fn
+	return name
+}
+
+function depth(fn,	n, list, i, d, best)
+{
+	if(fn in memo)
+		return memo[fn]
+	if(fn in active)
+	{
+		recursion[fn] = 1
+		return 0
+	}
+	active[fn] = 1
+	best = 0
+	next_fn[fn] = ""
+	n = split(calls[fn], list, " ")
+	for(i = 1; i <= n; i++)
+	{
+		d = depth(list[i])
+		if(d > best)
+		{
+			best = d
+			next_fn[fn] = list[i]
+		}
+	}
+	delete active[fn]
+	memo[fn] = frame[fn] + best
+	return memo[fn]
+}
+
+# Same walk, but a call back into a function already on the chain adds that function's depth from
+# depth() once, i.e. every recursion is allowed to go one level deep.
+function depth_once(fn,	n, list, i, d, best)
+{
+	if(fn in memo_once)
+		return memo_once[fn]
+	active[fn] = 1
+	best = 0
+	n = split(calls[fn], list, " ")
+	for(i = 1; i <= n; i++)
+	{
+		d = (list[i] in active) ? memo[list[i]] : depth_once(list[i])
+		if(d > best)
+			best = d
+	}
+	delete active[fn]
+	memo_once[fn] = frame[fn] + best
+	return memo_once[fn]
+}
+
+END {
+	start = find(root)
+	printf("%s: %d bytes worst case\n", root, depth(start))
+	for(fn = start; fn != ""; fn = next_fn[fn])
+		if(fn in frame)
+			printf("  %6d  %s%s\n", frame[fn], short(fn), (fn in indirect) ? " (+ indirect call)" : "")
+	for(fn in recursion)
+		printf("  recursion through %s not counted\n", short(fn))
+	if(length(recursion))
+		printf("%s: %d bytes with every recursion one level deep\n", root, depth_once(start))
+}
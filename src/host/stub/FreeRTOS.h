@@ -0,0 +1,100 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		FreeRTOS.h (host stub)
+*
+*	PURPOSE:		Stands in for FreeRTOS.h, task.h, queue.h and semphr.h in host builds. Only the
+*					part of the FreeRTOS 8.1.2 API which the modules in the host build use is here,
+*					it is implemented by rtos_sim.c.
+*
+*	FILE REFERENCES:		stdint.h, stddef.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: configASSERT() ends the program.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		Same tick as FreeRTOSConfig.h, 1 tick = 1ms.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created.
+*
+*/
+
+#ifndef FREERTOS_STUB_H
+#define FREERTOS_STUB_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef struct rtos_sim_queue* QueueHandle_t;
+typedef QueueHandle_t SemaphoreHandle_t;
+typedef struct rtos_sim_task* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define pdTRUE						1
+#define pdFALSE						0
+#define pdPASS						1
+#define pdFAIL						0
+#define portMAX_DELAY				((TickType_t)0xFFFFFFFFUL)
+#define configTICK_RATE_HZ			1000
+#define configMINIMAL_STACK_SIZE	130
+#define tskIDLE_PRIORITY			0
+#define taskSCHEDULER_SUSPENDED		0
+#define taskSCHEDULER_NOT_STARTED	1
+#define taskSCHEDULER_RUNNING		2
+
+#define configASSERT(x)				do { if(!(x)) rtos_sim_assert(__FILE__, __LINE__); } while(0)
+#define taskENTER_CRITICAL()		rtos_sim_enter_critical()
+#define taskEXIT_CRITICAL()			rtos_sim_exit_critical()
+#define taskYIELD()					rtos_sim_yield()
+#define portEND_SWITCHING_ISR(x)	(void)(x)
+#define portYIELD_FROM_ISR(x)		(void)(x)
+
+/*		queue.h						*/
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks);
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks);
+BaseType_t xQueueSendToBackFromISR(QueueHandle_t queue, const void* item, BaseType_t* woken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks);
+BaseType_t xQueuePeek(QueueHandle_t queue, void* item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+BaseType_t xQueueReset(QueueHandle_t queue);
+#define xQueueSend(q, i, t)				xQueueSendToBack(q, i, t)
+#define xQueueSendFromISR(q, i, w)		xQueueSendToBackFromISR(q, i, w)
+
+/*		semphr.h					*/
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken);
+#define xSemaphoreCreateBinary()		xSemaphoreCreateCounting(1, 0)
+#define xSemaphoreCreateMutex()			xSemaphoreCreateCounting(1, 1)
+#define vSemaphoreDelete(s)				vQueueDelete(s)
+
+/*		task.h						*/
+BaseType_t xTaskCreate(TaskFunction_t code, const char* name, uint16_t stack, void* param, UBaseType_t priority, TaskHandle_t* handle);
+void vTaskDelete(TaskHandle_t task);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskGetSchedulerState(void);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previous, TickType_t ticks);
+
+/*		rtos_sim.c					*/
+void rtos_sim_assert(const char* file, int line);
+void rtos_sim_enter_critical(void);
+void rtos_sim_exit_critical(void);
+void rtos_sim_yield(void);
+
+#endif
@@ -0,0 +1 @@
+/* Host stub: the ASF is not part of host builds (src/host/Makefile). */
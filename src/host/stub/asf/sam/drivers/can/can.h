@@ -0,0 +1,27 @@
+/* Host stub: the ASF is not part of host builds (src/host/Makefile), only the types can_func.h uses. */
+#ifndef CAN_STUB_H
+#define CAN_STUB_H
+
+#include <stdint.h>
+
+typedef struct
+{
+	uint32_t ul_mb_idx;
+	uint8_t uc_obj_type;
+	uint8_t uc_id_ver;
+	uint8_t uc_length;
+	uint8_t uc_tx_prio;
+	uint32_t ul_status;
+	uint32_t ul_id_msk;
+	uint32_t ul_id;
+	uint32_t ul_fid;
+	uint32_t ul_datal;
+	uint32_t ul_datah;
+} can_mb_conf_t;
+
+typedef struct
+{
+	uint32_t reserved;
+} Can;
+
+#endif
@@ -0,0 +1,13 @@
+/* Host stub: the ASF is not part of host builds (src/host/Makefile). */
+#ifndef GPIO_STUB_H
+#define GPIO_STUB_H
+
+#define SPI0_MEM1_HOLD				0		// user_board.h
+
+#define gpio_set_pin_high(pin)		(void)(pin)
+#define gpio_set_pin_low(pin)		(void)(pin)
+#define gpio_toggle_pin(pin)		(void)(pin)
+#define gpio_pin_is_high(pin)		0
+#define gpio_pin_is_low(pin)		1
+
+#endif
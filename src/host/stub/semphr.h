@@ -0,0 +1,2 @@
+/* Host stub, see FreeRTOS.h in this directory. */
+#include "FreeRTOS.h"
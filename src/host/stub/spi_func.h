@@ -0,0 +1,11 @@
+/* Host stub: SPI0 is simulated by nor_sim.c, which has the spi_func.h prototypes. */
+#ifndef SPI_FUNC_STUB_H
+#define SPI_FUNC_STUB_H
+
+#include "nor_sim.h"
+#include "time.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "atomic.h"
+
+#endif
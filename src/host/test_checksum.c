@@ -0,0 +1,207 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		test_checksum.c
+*
+*	PURPOSE:		Regression test of checksum.c: fletcher16() against the Fletcher-16 it replaced
+*					(two modulo 255 per byte), and crc16_ccitt() against a bit at a time CRC-16-CCITT,
+*					both bit for bit, over random data of random length at every alignment. The
+*					incremental forms (_update split at random, _copy, _combine) against the one-shot
+*					functions and fletcher64() against the Fletcher-64 it replaced.
+*
+*	FILE REFERENCES:		host_test.h, checksum.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a check failed.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		The lengths go past 2 * FLETCHER16_BLOCK so that the sums are reduced part way
+*				through, and the buffer is all 0xFF once, which gives sum2 its largest value.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "checksum.h"
+#include "host_test.h"
+
+#define BUFF_SIZE		(3 * FLETCHER16_BLOCK + 8)
+#define RUNS			2000
+
+static uint32_t buff_words[BUFF_SIZE / 4 + 1];
+static uint8_t* buff = (uint8_t*)buff_words;
+static uint32_t rng_state = 1;
+
+static uint32_t rng(void)
+{
+	rng_state = rng_state * 1103515245 + 12345;
+	return rng_state >> 8;
+}
+
+/* fletcher16() before user-018. */
+static uint16_t old_fletcher16(uint8_t* data, int count)
+{
+	uint16_t sum1 = 0;
+	uint16_t sum2 = 0;
+	int index;
+
+	for(index = 0; index < count; ++index)
+	{
+		sum1 = (sum1 + data[index]) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+	return (sum2 << 8) | sum1;
+}
+
+/* fletcher64() before user-019: sums of whole words modulo 2^32. */
+static uint64_t old_fletcher64(uint32_t* data, int count)
+{
+	uint64_t sum1 = 0;
+	uint64_t sum2 = 0;
+	int index;
+
+	for(index = 0; index < count / 4; ++index)
+	{
+		sum1 = (sum1 + data[index]) % ((uint64_t)1 << 32);
+		sum2 = (sum2 + sum1) % ((uint64_t)1 << 32);
+	}
+	return (sum2 << 32) | sum1;
+}
+
+/* CRC-16-CCITT one bit at a time: polynomial 0x1021, preset to 0xFFFF, no reflection, no final XOR. */
+static uint16_t bitwise_crc16(uint8_t* data, int count)
+{
+	uint16_t crc = 0xFFFF;
+	int i, bit;
+
+	for(i = 0; i < count; i++)
+	{
+		crc ^= (uint16_t)data[i] << 8;
+		for(bit = 0; bit < 8; bit++)
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+	}
+	return crc;
+}
+
+static void fill(uint32_t size)
+{
+	uint32_t i;
+
+	for(i = 0; i < size; i++)
+		buff[i] = (uint8_t)rng();
+	return;
+}
+
+static void test_fletcher16(void)
+{
+	uint32_t run, len, offset;
+
+	HOST_CHECK(fletcher16(buff, 0) == 0);
+	memset(buff, 0xFF, BUFF_SIZE);
+	HOST_CHECK(fletcher16(buff, BUFF_SIZE) == old_fletcher16(buff, BUFF_SIZE));
+	for(len = 0; len <= 16; len++)
+	{
+		for(offset = 0; offset < 4; offset++)
+			HOST_CHECK(fletcher16(buff + offset, len) == old_fletcher16(buff + offset, len));
+	}
+	for(run = 0; run < RUNS; run++)
+	{
+		offset = rng() & 0x3;
+		len = rng() % (BUFF_SIZE - 4);
+		fill(len + offset);
+		HOST_CHECK(fletcher16(buff + offset, len) == old_fletcher16(buff + offset, len));
+	}
+	return;
+}
+
+static void test_crc16(void)
+{
+	uint32_t run, len, offset;
+
+	HOST_CHECK(crc16_ccitt((uint8_t*)"123456789", 9) == 0x29B1);		// The standard check value.
+	HOST_CHECK(crc16_ccitt(buff, 0) == 0xFFFF);
+	for(run = 0; run < RUNS; run++)
+	{
+		offset = rng() & 0x3;
+		len = rng() % (BUFF_SIZE - 4);
+		fill(len + offset);
+		HOST_CHECK(crc16_ccitt(buff + offset, len) == bitwise_crc16(buff + offset, len));
+	}
+	return;
+}
+
+/* The data is split in two at random: an update (or a copy) of each piece gives the one-shot result. */
+static void test_incremental(void)
+{
+	static uint8_t copy[BUFF_SIZE];
+	fletcher16_ctx_t f16;
+	fletcher64_ctx_t f64;
+	crc16_ctx_t crc;
+	uint32_t run, len, offset, split, words;
+
+	for(run = 0; run < RUNS; run++)
+	{
+		offset = rng() & 0x3;
+		len = rng() % (BUFF_SIZE - 4);
+		split = len ? rng() % len : 0;
+		fill(len + offset);
+
+		fletcher16_init(&f16);
+		fletcher16_update(&f16, buff + offset, split);
+		fletcher16_update(&f16, buff + offset + split, len - split);
+		HOST_CHECK(fletcher16_final(&f16) == old_fletcher16(buff + offset, len));
+		fletcher16_init(&f16);
+		fletcher16_update(&f16, buff + offset, split);
+		fletcher16_copy(&f16, copy, buff + offset + split, len - split);
+		HOST_CHECK(fletcher16_final(&f16) == old_fletcher16(buff + offset, len));
+		HOST_CHECK(!memcmp(copy, buff + offset + split, len - split));
+		HOST_CHECK(fletcher16_combine(fletcher16(buff + offset, split), fletcher16(buff + offset + split, len - split),
+			len - split) == old_fletcher16(buff + offset, len));
+
+		crc16_ccitt_init(&crc);
+		crc16_ccitt_update(&crc, buff + offset, split);
+		crc16_ccitt_copy(&crc, copy, buff + offset + split, len - split);
+		HOST_CHECK(crc16_ccitt_final(&crc) == bitwise_crc16(buff + offset, len));
+		HOST_CHECK(!memcmp(copy, buff + offset + split, len - split));
+
+		HOST_CHECK(fletcher64(buff_words, len) == old_fletcher64(buff_words, len));
+		fletcher64_init(&f64);
+		fletcher64_update(&f64, buff, split);				// Splits a word when split isn't a multiple of 4.
+		fletcher64_update(&f64, buff + split, len - split);
+		HOST_CHECK(fletcher64_final(&f64) == old_fletcher64(buff_words, len));
+		words = split / 4;
+		HOST_CHECK(fletcher64_combine(fletcher64(buff_words, words * 4), fletcher64(buff_words + words, len - (words * 4)),
+			(len / 4) - words) == old_fletcher64(buff_words, len));
+	}
+	return;
+}
+
+/* pus_pec() is the algorithm PUS_PEC_ALGORITHM selects, here over a 152B TM packet less its header. */
+static void test_pus_pec(void)
+{
+	fill(152);
+#if (PUS_PEC_ALGORITHM == PUS_PEC_CRC16)
+	HOST_CHECK(pus_pec(buff + 2, 150) == bitwise_crc16(buff + 2, 150));
+#else
+	HOST_CHECK(pus_pec(buff + 2, 150) == old_fletcher16(buff + 2, 150));
+#endif
+	return;
+}
+
+int main(void)
+{
+	test_fletcher16();
+	test_crc16();
+	test_incremental();
+	test_pus_pec();
+	return host_test_done("test_checksum");
+}
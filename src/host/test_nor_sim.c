@@ -0,0 +1,207 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		test_nor_sim.c
+*
+*	PURPOSE:		Regression test of the chip model in nor_sim.c, so that the other host tests can
+*					trust it: NOR program and erase rules, WIP timing, wear counts, faults and the
+*					backing files.
+*
+*	FILE REFERENCES:		host_test.h, nor_sim.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a check failed.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:		Talks to the chips with raw commands through spi_dma_transfer(), spimem.c is not used.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+#include "nor_sim.h"
+#include "host_test.h"
+
+static uint16_t cmd[4 + NOR_SIM_PAGE_SIZE];
+
+static void command(uint8_t chip, uint8_t opcode, uint32_t addr, uint32_t size)
+{
+	cmd[0] = opcode;
+	cmd[1] = (uint16_t)((addr >> 16) & 0xFF);
+	cmd[2] = (uint16_t)((addr >> 8) & 0xFF);
+	cmd[3] = (uint16_t)(addr & 0xFF);
+	spi_dma_transfer(cmd, cmd, size, chip, 0);
+	return;
+}
+
+static uint8_t status(uint8_t chip)
+{
+	uint16_t rsr[2] = { 0x05, 0 };
+
+	spi_dma_transfer(rsr, rsr, 2, chip, 0);
+	return (uint8_t)rsr[1];
+}
+
+static void wren(uint8_t chip)
+{
+	uint16_t wren = 0x06;
+
+	spi_dma_transfer(&wren, 0, 1, chip, 0);
+	return;
+}
+
+static void wait_ready(uint8_t chip)
+{
+	while(status(chip) & 0x01)
+		nor_sim_delay_us(100);
+	return;
+}
+
+static void program(uint8_t chip, uint32_t addr, const uint8_t* data, uint32_t size)
+{
+	uint32_t i;
+
+	for(i = 0; i < size; i++)
+		cmd[4 + i] = data[i];
+	wren(chip);
+	command(chip, 0x02, addr, 4 + size);
+	return;
+}
+
+static void read(uint8_t chip, uint32_t addr, uint8_t* data, uint32_t size)
+{
+	uint32_t i;
+
+	for(i = 4; i < 4 + size; i++)
+		cmd[i] = 0;
+	command(chip, 0x03, addr, 4 + size);
+	for(i = 0; i < size; i++)
+		data[i] = (uint8_t)cmd[4 + i];
+	return;
+}
+
+static void test_program_erase(void)
+{
+	uint8_t data[NOR_SIM_PAGE_SIZE], back[NOR_SIM_PAGE_SIZE];
+	nor_sim_stats_t stats;
+	uint64_t start;
+	uint32_t i;
+
+	for(i = 0; i < sizeof(data); i++)
+		data[i] = (uint8_t)(0xF0 | i);
+	start = nor_sim_now_us();
+	program(1, 0x1000, data, 16);
+	HOST_CHECK(status(1) & 0x01);				// WIP while the page programs.
+	wait_ready(1);
+	HOST_CHECK(nor_sim_now_us() - start >= NOR_SIM_PROGRAM_US);
+	read(1, 0x1000, back, 32);
+	HOST_CHECK(!memcmp(back, data, 16));
+	HOST_CHECK(back[16] == 0xFF);
+
+	/* Programming can only clear bits. */
+	memset(data, 0x0F, 16);
+	program(1, 0x1000, data, 16);
+	wait_ready(1);
+	read(1, 0x1000, back, 16);
+	HOST_CHECK(back[0] == 0x00);
+	HOST_CHECK(back[5] == 0x05);
+	nor_sim_get_stats(&stats);
+	HOST_CHECK(stats.over_programs == 15);		// Byte 15 is 0xFF over 0xFF.
+
+	/* Without WREN nothing happens. */
+	cmd[0] = 0x04;								// WRDI, spimem_initialize() leaves WEL set on chip 2.
+	spi_dma_transfer(cmd, 0, 1, 2, 0);
+	cmd[4] = 0x00;
+	command(2, 0x02, 0x2000, 5);
+	read(2, 0x2000, back, 1);
+	HOST_CHECK(back[0] == 0xFF);
+	nor_sim_get_stats(&stats);
+	HOST_CHECK(stats.wel_violations == 1);
+
+	/* Sector erase: 4kB back to 0xFF, counted as wear, the next sector is left alone. */
+	program(1, 0x2000, data, 1);
+	wait_ready(1);
+	wren(1);
+	command(1, 0x20, 0x1000, 4);
+	HOST_CHECK(status(1) & 0x01);
+	program(1, 0x1000, data, 1);				// Ignored, the chip is busy.
+	wait_ready(1);
+	read(1, 0x1000, back, 16);
+	for(i = 0; i < 16; i++)
+		HOST_CHECK(back[i] == 0xFF);
+	read(1, 0x2000, back, 1);
+	HOST_CHECK(back[0] == 0x0F);
+	HOST_CHECK(nor_sim_erase_count(1, 1) == 1);
+	HOST_CHECK(nor_sim_erase_count(1, 2) == 0);
+	nor_sim_get_stats(&stats);
+	HOST_CHECK(stats.busy_violations == 2);		// WREN and PP.
+	HOST_CHECK(stats.sect_erases == 1);
+	return;
+}
+
+static void test_faults(void)
+{
+	uint8_t back[4];
+
+	nor_sim_flip_bit(3, 0x30000, 2);
+	read(3, 0x30000, back, 1);
+	HOST_CHECK(back[0] == 0xFB);
+
+	nor_sim_fail_chip(3, 1);
+	HOST_CHECK(status(3) == 0xFF);
+	nor_sim_fail_chip(3, 0);
+	HOST_CHECK(status(3) == 0x00);
+	return;
+}
+
+static void test_seu_rate(void)
+{
+	nor_sim_config_t config;
+	nor_sim_stats_t stats;
+
+	/* 1e-9 upsets per bit per second over 3 x 8Mbit for 100s is ~2.5 flips. */
+	nor_sim_default_config(&config);
+	config.seu_rate = 1e-9;
+	config.seed = 7;
+	HOST_CHECK(host_test_open("test_nor_sim", &config) > 0);
+	nor_sim_delay_us(100 * 1000000);
+	nor_sim_get_stats(&stats);
+	HOST_CHECK(stats.seu_flips >= 1 && stats.seu_flips <= 6);
+	return;
+}
+
+static void test_files(void)
+{
+	nor_sim_config_t config;
+	uint8_t data = 0x5A, back;
+
+	program(2, 0x40000, &data, 1);
+	wait_ready(2);
+	nor_sim_default_config(&config);
+	config.path = "test_nor_sim_mem";
+	HOST_CHECK(nor_sim_open(&config) > 0);		// The chips come back from their files.
+	read(2, 0x40000, &back, 1);
+	HOST_CHECK(back == 0x5A);
+	return;
+}
+
+int main(void)
+{
+	if(host_test_open("test_nor_sim", 0) < 0)
+		return 1;
+	nor_sim_reset_stats();
+	test_program_erase();
+	test_faults();
+	test_files();
+	test_seu_rate();
+	return host_test_done("test_nor_sim");
+}
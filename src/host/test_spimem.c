@@ -0,0 +1,240 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		test_spimem.c
+*
+*	PURPOSE:		Regression test of spimem.c and the FTL under it on the simulated chips: reads
+*					and rewrites across page and sector boundaries, redundancy across the three
+*					chips, a chip failing, data surviving a reset, and streamed reads in chunks which
+*					straddle the places where the FTL has to start a new RD command.
+*
+*	FILE REFERENCES:		host_test.h, rtos_sim.h, obc_sim.h, spimem.h, string.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: Exits with 1 if a check failed.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	HOST BUILDS ONLY (src/host/Makefile).
+*
+*	NOTES:
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*	10/16/2026			Added test_stream_chunks().
+*
+*/
+
+#include <string.h>
+#include "rtos_sim.h"
+#include "obc_sim.h"
+#include "spimem.h"
+#include "host_test.h"
+
+#define GC_PAGES		2400		// 80% of the logical space.
+#define GC_REWRITES		6000
+
+static uint8_t pattern[8192], data[8192];
+
+typedef struct
+{
+	uint32_t addr;					// Where the next chunk should come from.
+	uint32_t got, limit;			// The consumer stops once it has taken limit bytes.
+	uint8_t bad;
+} stream_check_t;
+
+static void fill(uint8_t* buff, uint32_t size, uint32_t seed)
+{
+	uint32_t i;
+
+	for(i = 0; i < size; i++)
+		buff[i] = (uint8_t)((i * 31) + (seed * 7) + (i >> 8));
+	return;
+}
+
+/* Small writes at odd places, including the 4B headers the tasks keep at the start of their regions. */
+static void test_rewrites(void)
+{
+	uint32_t i, addr;
+
+	fill(pattern, 600, 1);
+	HOST_CHECK(spimem_write(SCIENCE_BASE + 100, pattern, 600) > 0);
+	memset(data, 0, sizeof(data));
+	HOST_CHECK(spimem_read(SCIENCE_BASE + 100, data, 600) > 0);
+	HOST_CHECK(!memcmp(data, pattern, 600));
+
+	for(i = 0; i < 50; i++)
+	{
+		HOST_CHECK(spimem_write(HK_BASE, (uint8_t*)&i, 4) > 0);
+		HOST_CHECK(spimem_read(HK_BASE, data, 4) > 0);
+		HOST_CHECK(!memcmp(data, &i, 4));
+	}
+
+	/* A write which straddles a sector boundary. */
+	addr = SCHEDULE_BASE + 4096 - 100;
+	fill(pattern, 300, 2);
+	HOST_CHECK(spimem_write(addr, pattern, 256) > 0);
+	HOST_CHECK(spimem_write(addr + 256, pattern + 256, 44) > 0);
+	HOST_CHECK(spimem_read(addr, data, 256) > 0);
+	HOST_CHECK(spimem_read(addr + 256, data + 256, 44) > 0);
+	HOST_CHECK(!memcmp(data, pattern, 300));
+	return;
+}
+
+/* What is written lands on all three chips and a chip which fails is left out from then on. */
+static void test_redundancy(void)
+{
+	nor_sim_stats_t stats;
+
+	fill(pattern, 256, 3);
+	HOST_CHECK(spimem_write(DIAG_BASE, pattern, 256) > 0);
+	HOST_CHECK(spimem_cache_flush() >= 0);
+	/* The FTL gives every chip the same physical operations, so the chips are copies of each other. */
+	HOST_CHECK(!memcmp(nor_sim_memory(1), nor_sim_memory(2), NOR_SIM_CHIP_SIZE));
+	HOST_CHECK(!memcmp(nor_sim_memory(1), nor_sim_memory(3), NOR_SIM_CHIP_SIZE));
+	nor_sim_get_stats(&stats);
+	HOST_CHECK(!stats.over_programs);
+
+	nor_sim_fail_chip(1, 1);
+	fill(pattern, 256, 4);
+	HOST_CHECK(spimem_write(DIAG_BASE + 256, pattern, 256) > 0);
+	HOST_CHECK(spimem_cache_flush() >= 0);
+	HOST_CHECK(!SPI_HEALTH1 && SPI_HEALTH2 && SPI_HEALTH3);
+	HOST_CHECK(spimem_read(DIAG_BASE + 256, data, 256) > 0);
+	HOST_CHECK(!memcmp(data, pattern, 256));
+	nor_sim_fail_chip(1, 0);
+
+	nor_sim_get_stats(&stats);
+	HOST_CHECK(!stats.over_programs);
+	HOST_CHECK(!stats.busy_violations);
+	HOST_CHECK(!stats.wel_violations);
+	return;
+}
+
+/* Everything which was written before a reset reads back after it. */
+static void test_reset(void)
+{
+	uint32_t i;
+
+	for(i = 0; i < 8; i++)
+	{
+		fill(pattern, 1024, 10 + i);
+		HOST_CHECK(spimem_write(SCIENCE_BASE + i * 1024, pattern, 256) > 0);
+	}
+	HOST_CHECK(spimem_cache_flush() >= 0);
+	host_test_reset();
+	for(i = 0; i < 8; i++)
+	{
+		fill(pattern, 1024, 10 + i);
+		HOST_CHECK(spimem_read(SCIENCE_BASE + i * 1024, data, 256) > 0);
+		HOST_CHECK(!memcmp(data, pattern, 256));
+	}
+	return;
+}
+
+/* Consumer for test_stream_chunks(): chunks must come in order and land in data[] at their offset. */
+static int stream_chunk(void* arg, uint32_t addr, uint8_t* chunk, uint32_t size)
+{
+	stream_check_t* check = (stream_check_t*)arg;
+
+	if((addr != check->addr) || ((check->got + size) > sizeof(data)))
+	{
+		check->bad = 1;
+		return -1;
+	}
+	if(check->limit && ((check->got + size) > check->limit))
+		return -1;
+	memcpy(data + check->got, chunk, size);
+	check->addr += size;
+	check->got += size;
+	return 1;
+}
+
+/* Chunks of every size across sector summary pages, a rewritten (moved) page and pages never written. */
+static void test_stream_chunks(void)
+{
+	static const uint32_t chunks[] = {1, 100, 256, 300, 1000, 8000};
+	static uint8_t chunk_buff[8000];
+	stream_check_t check;
+	uint32_t base = SCIENCE_BASE + 0x3000, i;
+	int ret;
+
+	fill(pattern, 8192, 42);
+	memset(pattern + 7168, 0xFF, 1024);						// The last 4 pages are never written.
+	HOST_CHECK(spimem_write(base, pattern, 7168) == 7168);
+	HOST_CHECK(spimem_write(base + 0x500, pattern + 0x500, 256) == 256);	// Same bytes, moved.
+	fill(pattern + 0x900, 256, 43);
+	HOST_CHECK(spimem_write(base + 0x900, pattern + 0x900, 256) == 256);
+	HOST_CHECK(spimem_cache_flush() >= 0);
+	for(i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++)
+	{
+		memset(&check, 0, sizeof(check));
+		check.addr = base + 37;
+		memset(data, 0, sizeof(data));
+		ret = spimem_read_stream_cb(base + 37, 8192 - 37, chunk_buff, chunks[i], stream_chunk, &check);
+		HOST_CHECK(ret == (8192 - 37));
+		HOST_CHECK(!check.bad && (check.got == (8192 - 37)));
+		HOST_CHECK(!memcmp(data, pattern + 37, 8192 - 37));
+	}
+
+	/* Stopping early gives back what the consumer took. */
+	memset(&check, 0, sizeof(check));
+	check.addr = base;
+	check.limit = 5000;
+	ret = spimem_read_stream_cb(base, 8192, chunk_buff, 300, stream_chunk, &check);
+	HOST_CHECK(ret == 4800);
+	HOST_CHECK(!check.bad && (check.got == 4800));
+	HOST_CHECK(!memcmp(data, pattern, 4800));
+	return;
+}
+
+/* Steady-state garbage collection: most sectors still hold live pages when they are collected. */
+static void test_gc(void)
+{
+	static uint16_t gen[GC_PAGES];
+	uint32_t i, page, failed = 0;
+
+	for(page = 0; page < GC_PAGES; page++)
+	{
+		fill(pattern, 256, page);
+		if(spimem_write(page << 8, pattern, 256) != 256)
+			failed++;
+	}
+	for(i = 0; i < GC_REWRITES; i++)
+	{
+		page = (i * 7) % GC_PAGES;
+		gen[page]++;
+		fill(pattern, 256, page + gen[page] * GC_PAGES);
+		if(spimem_write(page << 8, pattern, 256) != 256)
+			failed++;
+	}
+	HOST_CHECK(!failed);
+	HOST_CHECK(spimem_cache_flush() >= 0);
+	host_test_reset();
+	for(page = 0; page < GC_PAGES; page++)
+	{
+		fill(pattern, 256, page + gen[page] * GC_PAGES);
+		if((spimem_read(page << 8, data, 256) != 256) || memcmp(data, pattern, 256))
+			failed++;
+	}
+	HOST_CHECK(!failed);
+	return;
+}
+
+int main(void)
+{
+	if(host_test_open("test_spimem", 0) < 0)
+		return 1;
+	test_rewrites();
+	test_redundancy();
+	host_test_reset();
+	test_reset();
+	test_stream_chunks();
+	test_gc();
+	return host_test_done("test_spimem");
+}
@@ -57,12 +57,25 @@
 	*	12/09/2015		Added in housekeep_suicide() so that this task can kill itself if need be (or if commanded by the fdir task).
 	*
 	*   01/15/2016      A:Added in a wrapper function for FIFO error handling in xQueueSendToBack
+	*
+	*	10/16/2026		The SPI memory page cache statistics are OBC variables which can be put in a definition.
+	*
+	*					So are the memory wash rate and per-chip upset counts.
+	*
+	*					Reports for the packet router are filled in place in a PUS packet pool buffer
+	*					(pus_pool.c) and hk_to_obc_fifo carries its descriptor. TC verifications are sent
+	*					with pus_pool_send(), xQueueSendToBackTask() returned pdFAIL without sending for HK.
+	*
+	*					The depth, age and drops of the packet router's TM queues are OBC variables.
+	*
+	*					So are the number of packets in the TM and TC stores in SPI memory.
 	*	DESCRIPTION:
 	*	
  */
 
 /* Standard includes. */
 #include <stdio.h>
+#include <string.h>
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
@@ -86,6 +99,8 @@
 
 #include "global_var.h"
 
+#include "pus_pool.h"
+
 /* Priorities at which the tasks are created. */
 #define Housekeep_PRIORITY		( tskIDLE_PRIORITY + 1 )		// Lower the # means lower the priority
 
@@ -494,7 +509,11 @@ uint8_t get_ssm_id(uint8_t sensor_name)
 		return PAY_ID;
 	if ((sensor_name == OBC_MODE) || (sensor_name == ABS_TIME_D) || (sensor_name == ABS_TIME_H) || (sensor_name == ABS_TIME_M) || 
 		(sensor_name == ABS_TIME_S) || (sensor_name == SPI_CHIP_1) || (sensor_name == SPI_CHIP_2) || (sensor_name == SPI_CHIP_3) || 
-		(sensor_name == OBC_CTT) || (sensor_name == OBC_OGT))
+		(sensor_name == OBC_CTT) || (sensor_name == OBC_OGT) || (sensor_name == SPIMEM_CACHE_HITS) || 
+		(sensor_name == SPIMEM_CACHE_MISSES) || (sensor_name == SPIMEM_FLASH_SAVED) || (sensor_name == SPIMEM_WASH_RATE) ||
+		(sensor_name == SPIMEM_UPSETS_1) || (sensor_name == SPIMEM_UPSETS_2) || (sensor_name == SPIMEM_UPSETS_3) ||
+		(sensor_name == TM_STORE_COUNT) || (sensor_name == TC_STORE_COUNT) ||
+		((sensor_name <= TM_VERIFY_DEPTH) && (sensor_name >= TM_STORED_DROPS)))
 		return OBC_ID;
 	//assume the worst:
 	return OBC_ID;
@@ -738,13 +757,15 @@ static void set_definition(uint8_t sID)
 /************************************************************************/
 static void send_hk_as_tm(void)
 {
-	clear_current_command();
-	current_command[146] = HK_REPORT;
-	for(i = 0; i < DATA_LENGTH; i++)
-	{
-		current_command[i] = current_hk[i];
-	}
-	xQueueSendToBack(hk_to_obc_fifo, current_command, (TickType_t)1);
+	uint8_t desc;
+	uint8_t* packet;
+	desc = pus_pool_alloc(0, (TickType_t)1);
+	if(desc == PUS_POOL_NONE)
+		return;									// FAILURE_RECOVERY
+	packet = pus_pool_buf(desc);
+	packet[146] = HK_REPORT;
+	memcpy(packet + PUS_POOL_DATA, current_hk, PUS_POOL_DATA_LENGTH);	// A TM packet holds the first 128B.
+	pus_pool_send(hk_to_obc_fifo, desc, (TickType_t)1);
 	return;
 }
 
@@ -756,14 +777,16 @@ static void send_hk_as_tm(void)
 /************************************************************************/
 static void send_param_report(void)
 {
+	uint8_t desc;
+	uint8_t* packet;
 	param_report_requiredf = 0;
-	clear_current_command();
-	current_command[146] = HK_DEFINITON_REPORT;
-	for(i = 0; i < DATA_LENGTH; i++)
-	{
-		current_command[i] = current_hk_definition[i];
-	}
-	xQueueSendToBack(hk_to_obc_fifo, current_command, (TickType_t)1);		// FAILURE_RECOVERY if this doesn't return pdPASS
+	desc = pus_pool_alloc(0, (TickType_t)1);
+	if(desc == PUS_POOL_NONE)
+		return;									// FAILURE_RECOVERY
+	packet = pus_pool_buf(desc);
+	packet[146] = HK_DEFINITON_REPORT;
+	memcpy(packet + PUS_POOL_DATA, current_hk_definition, PUS_POOL_DATA_LENGTH);
+	pus_pool_send(hk_to_obc_fifo, desc, (TickType_t)1);		// FAILURE_RECOVERY if this doesn't return pdPASS
 	return;
 }
 
@@ -777,15 +800,20 @@ static void send_param_report(void)
 /************************************************************************/
 static void send_tc_execution_verify(uint8_t status, uint16_t packet_id, uint16_t psc)
 {
-	clear_current_command();
-	current_command[146] = TASK_TO_OPR_TCV;		// Request a TC verification
-	current_command[145] = status;
-	current_command[144] = HK_TASK_ID;			// APID of this task
-	current_command[140] = ((uint8_t)packet_id) >> 8;
-	current_command[139] = (uint8_t)packet_id;
-	current_command[138] = ((uint8_t)psc) >> 8;
-	current_command[137] = (uint8_t)psc;
-	xQueueSendToBackTask(HK_TASK_ID, 1, hk_to_obc_fifo, current_command, (TickType_t)1);		// FAILURE_RECOVERY if this doesn't return pdPASS
+	uint8_t desc;
+	uint8_t* packet;
+	desc = pus_pool_alloc(0, (TickType_t)1);
+	if(desc == PUS_POOL_NONE)
+		return;									// FAILURE_RECOVERY
+	packet = pus_pool_buf(desc);
+	packet[146] = TASK_TO_OPR_TCV;				// Request a TC verification
+	packet[145] = status;
+	packet[144] = HK_TASK_ID;					// APID of this task
+	packet[140] = ((uint8_t)packet_id) >> 8;
+	packet[139] = (uint8_t)packet_id;
+	packet[138] = ((uint8_t)psc) >> 8;
+	packet[137] = (uint8_t)psc;
+	pus_pool_send(hk_to_obc_fifo, desc, (TickType_t)1);		// FAILURE_RECOVERY if this doesn't return pdPASS
 	return;
 }
 
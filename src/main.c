@@ -111,6 +111,24 @@ Author: Keenan Burnett
 *	12/06/2015		I updated all the functions that create tasks so that they return their respective task handles,
 *					these are going to be imported for the fdir task to be able to kill running tasks and restart them.
 *
+*	10/16/2026		Set the DMAC interrupt priority (SPI0 transfers). TIME_BASE moved to 0xBFFFC, the top of the
+*					logical SPI memory space now that SPI memory sits behind a flash translation layer.
+*
+*					The SPI memory server task is created first, every other task sends its SPI memory
+*					requests to it.
+*
+*					Added WASH_BASE (memory wash cursor) just below TIME_BASE.
+*
+*					Added CHECKSUM_BASE (page digests of the SPI memory checksum index).
+*
+*					Added EDAC_BASE (ECC records of the protected SPI memory regions).
+*
+*					hk_to_obc_fifo, mem_to_obc_fifo and tm_buffer carry PUS packet pool descriptors.
+*
+*					Create opr_wake_sem, which wakes the packet router.
+*
+*					tm_buffer is replaced by the per-class TM queues of tm_sched.c.
+*
 *	DESCRIPTION:
 *	This is the 'main' file for our program which will run on the OBC.
 *	main.c is called from the reset handler and will initialize hardware,
@@ -153,6 +171,10 @@ uint32_t data_reg[2];
 
 #include "camera.h"
 
+#include "pus_pool.h"
+
+#include "tm_sched.h"
+
 /* Set up the hardware ready to run the program. */
 static void prvSetupHardware(void);
 /*	Initialize mutexes and semaphores to be used by the programs  */
@@ -181,6 +203,7 @@ extern TaskHandle_t wdt_reset(void);
 extern TaskHandle_t obc_packet_router(void);
 extern TaskHandle_t scheduling(void);
 extern TaskHandle_t fdir(void);
+extern TaskHandle_t spimem_server(void);
 
 /* Prototypes for the standard FreeRTOS callback/hook functions implemented
 within this file. */
@@ -213,6 +236,7 @@ int main(void)
 	prvInitializeGlobalVars();
 		
 	/* Create Tasks */
+	spimem_server_HANDLE = spimem_server();
 	//fdir_HANDLE = fdir();
 	housekeeping_HANDLE = housekeep();
 	opr_HANDLE = obc_packet_router();
@@ -350,9 +374,10 @@ static void prvInitializeFifos(void)
 
 	/* Initialize global PUS Packet FIFOs			*/
 	fifo_length = 4;			// Max number of items in the FIFO.
-	item_size = 147;			// Number of bytes in the items
+	item_size = PUS_POOL_DESC_SIZE;	// TM is built in the PUS packet pool, these carry descriptors.
 	hk_to_obc_fifo = xQueueCreate(fifo_length, item_size);
 	mem_to_obc_fifo = xQueueCreate(fifo_length, item_size);
+	item_size = 147;			// Number of bytes in the items
 	sched_to_obc_fifo = xQueueCreate(fifo_length, item_size);
 	fdir_to_obc_fifo = xQueueCreate(fifo_length, item_size);
 	eps_to_obc_fifo = xQueueCreate(fifo_length, item_size);
@@ -383,7 +408,9 @@ static void prvInitializeFifos(void)
 	fifo_length = 10;
 	item_size = 152;
 	tc_buffer = xQueueCreate(fifo_length, item_size);
-	tm_buffer = xQueueCreate(fifo_length, item_size);
+	pus_pool_init();
+	tm_sched_init();
+	opr_wake_sem = xSemaphoreCreateBinary();	// Given by whoever sends to the packet router.
 	
 	return;
 }
@@ -403,6 +430,9 @@ static void prvInitializeInterruptPriorities(void)
 	priority = 12;	
 	NVIC_SetPriority(can0_int_num, priority);
 	
+	priority = 11;
+	NVIC_SetPriority(DMAC_IRQn, priority);		// SPI0 DMA completion (spi_dma_transfer_async).
+	
 	priority = NVIC_GetPriority(can1_int_num);
 	
 	return;
@@ -495,7 +525,10 @@ static void prvInitializeGlobalVars(void)
 	SCIENCE_BASE	=	0x24000;	// SCIENCE = 256kB: 0x24000 - 0x63FFF
 	TM_BASE			=	0x64000;	// TM = 128kB: 0x64000 - 0x83FFF
 	TC_BASE			=	0x84000;	// TC = 128kB: 0x84000 - 0xA3FFF
-	TIME_BASE		=	0xFFFFC;	// TIME = 4B: 0xFFFFC - 0xFFFFF
+	CHECKSUM_BASE	=	0xA6000;	// CHECKSUM = 24kB: 0xA6000 - 0xABFFF (page digests of the checksum index)
+	EDAC_BASE		=	0xAC000;	// EDAC = 12kB: 0xAC000 - 0xAEFFF (ECC records of the protected regions)
+	WASH_BASE		=	0xBFFF8;	// WASH = 4B: 0xBFFF8 - 0xBFFFB (memory wash cursor)
+	TIME_BASE		=	0xBFFFC;	// TIME = 4B: 0xBFFFC - 0xBFFFF (top of the logical SPI memory space)
 
 	/* Limits for task operations */
 	if(!INTERNAL_MEMORY_FALLBACK_MODE)
@@ -37,6 +37,67 @@
 	*
 	*	11/12/2015		Adding in functionality for TC execution verification, and event reporting to ground.
 	*
+	*	10/16/2026		SPI memory dumps now stream the whole region with spimem_read_stream_cb(), each 128B
+	*					chunk is sent to the packet router as it arrives. The dump also advances through
+	*					the region now instead of re-reading the start address for every packet.
+	*
+	*					The task now also runs a step of SPI memory garbage collection every second.
+	*
+	*					memory_wash() is now incremental: every wake-up washes WASH_PAGES_PER_SLICE pages
+	*					starting from a cursor which is saved at WASH_BASE. Each page is read once per chip
+	*					(it used to be read three times from each chip into the same buffers) and Spi0_Mutex
+	*					is only held for one page at a time. The wash also checked INTERNAL_MEMORY_FALLBACK
+	*					(an event ID, always true) instead of INTERNAL_MEMORY_FALLBACK_MODE, so it never ran.
+	*
+	*					The wash now votes each page bit by bit and repairs an outvoted chip once per page
+	*					(spimem_repair_page_h()) instead of rewriting a whole sector for every bad byte. Each
+	*					repair is verified with one page read-back and reported by a single BIT_FLIP_DETECTED.
+	*
+	*					The wash rate adapts to the upsets it corrects (memory_wash_adjust_rate()), regions with
+	*					a recent upset are washed again first, and the rate and the corrected upsets per chip
+	*					are available as housekeeping parameters (SPIMEM_WASH_RATE, SPIMEM_UPSETS_1/2/3).
+	*
+	*					Blank and garbage pages are skipped (spimem_ftl_page_state_h()) and the copies of a
+	*					page are compared by checksum before falling back to the byte vote.
+	*
+	*					Dumps are sent by dump_memory(), 128B per packet. Every packet carries the PUS sequence
+	*					flags and a sequence count, and a dump request may give an offset to resume a dump
+	*					which was cut short (ex: lost pass).
+	*
+	*					Consecutive memory loads to SPI memory form a load session (load_write()), which is
+	*					verified against a running checksum when it ends. A load no longer falls through into
+	*					the dump and check requests, and neither does a dump into the check.
+	*
+	*					The running load checksum is a fletcher16_ctx_t from checksum.c.
+	*
+	*					Load packets are written as they come again instead of being staged a page at a time
+	*					in load_buff[]: the page cache already gathers them into whole pages, so staging
+	*					saved no programs or erases (src/host/bench_load.c) and a load was verified to ground
+	*					while its bytes were only in RAM. MEMORY_LOAD_FAILED gives the 4kB sector of the
+	*					session start, the page number didn't fit in param1 above 64kB.
+	*
+	*					dump_memory() no longer reads ahead through the SPI memory server. The downlink, not
+	*					the flash, sets the pace of a dump, so the read-ahead gave the same bytes/s
+	*					(src/host/bench_dump.c) and left the router idle for longer.
+	*
+	*					With a chip out of service the wash used to stop. It now scrubs the regions which
+	*					are protected by ECC (memory_scrub(), spimem_edac.c) instead, and while all three
+	*					chips are healthy it scrubs one protected page per wake-up so that their ECC is
+	*					kept up to date.
+	*
+	*					Packets for the packet router are filled in place in a PUS packet pool buffer
+	*					(pus_pool.c) and mem_to_obc_fifo carries its descriptor. dump_packet[] is gone, and
+	*					downlink_science() no longer reads 128B into current_command[76..146], which overran it.
+	*
+	*					downlink_science() leaves PUS_POOL_RESERVE buffers free like memory dumps do.
+	*
+	*					Pages which the wash skips no longer count against its budget, so a pass over a mostly
+	*					empty memory takes about as many wake-ups as there are pages in use / WASH_RATE instead
+	*					of 4096 / WASH_RATE (at most WASH_SKIP_MAX skipped pages per wake-up).
+	*
+	*					OBC RAM addresses (memid 0) are cast to pointers through uintptr_t so that this file
+	*					also builds on the host (src/host), where the wash, dump and load are measured.
+	*
 	*	DESCRIPTION:	
 	*
 	*	This task is meant to fulfill the PUS Memory Management Service.
@@ -51,6 +112,7 @@
 
 /* Standard includes. */
 #include <stdio.h>
+#include <string.h>
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
@@ -71,6 +133,8 @@
 
 #include "can_func.h"
 
+#include "pus_pool.h"
+
 /* Priorities at which the tasks are created. */
 #define MEMORY_MANAGE_PRIORITY	( tskIDLE_PRIORITY + 4 )		// Lower the # means lower the priority
 
@@ -86,29 +150,71 @@ functionality. */
 #define CHECK_MEM_REQUEST				9
 #define MEMORY_CHECK_ABS				10
 
+/* Memory wash */
+#define WASH_PAGES						4096		// Physical pages on each SPI memory chip.
+#define WASH_PAGES_PER_SLICE			8			// Starting wash rate, pages per wake-up (4096 pages in ~17 min).
+#define WASH_RATE_MIN					2			// Floor: a full pass in a little over an hour.
+#define WASH_RATE_MAX					64			// Ceiling: a full pass in about two minutes.
+#define WASH_RATE_PERIOD				64			// Wake-ups between adjustments of the wash rate.
+#define WASH_QUIET_PERIODS				4			// Periods without an upset before the rate is halved.
+#define WASH_REGIONS					16			// Regions of 256 pages (64kB) whose recent upsets are tracked.
+#define WASH_REGION_SHIFT				8			// page >> WASH_REGION_SHIFT = region.
+#define WASH_SAVE_INTERVAL				256			// The cursor is saved to WASH_BASE every this many pages.
+#define WASH_MUTEX_WAIT					10			// Ticks to wait for Spi0_Mutex before giving up on a page.
+#define WASH_SKIP_MAX					256			// Skipped pages per wake-up, an empty memory takes 16 wake-ups a pass.
+#define DUMP_PACKET						128			// Data bytes in each dump packet.
+#define DUMP_FIFO_WAIT					5000		// Ticks to wait for the packet router to take a dump packet.
+#define LOAD_IMAGE_SIZE					0x4000		// SSM image regions (COMS, EPS, PAY) are 16kB.
+#define LOAD_SECTOR_SHIFT				12			// MEMORY_LOAD_FAILED reports 4kB sectors (256 of them in 1MB).
+#define LOAD_IDLE_TICKS					5000		// A load session which receives nothing for this long is closed.
+
 /*-----------------------------------------------------------*/
 
-static uint8_t page_buff1[256], page_buff2[256], page_buff3[256]; 
+static uint8_t page_buff1[256], page_buff2[256], page_buff3[256], wash_image[256];
+static uint8_t dump_buff[DUMP_PACKET];
+static uint8_t load_buff[256];			// Read-back of a closed load session.
 /* Functions Prototypes. */
 static void prvMemoryManageTask( void *pvParameters );
 void menory_manage(void);
 void memory_manage_kill(uint8_t killer);
-static void memory_wash(void);
+static void memory_wash(uint32_t budget);
+static void memory_scrub(uint32_t budget);
+static int memory_wash_page(uint32_t wash_page);
+static void memory_wash_adjust_rate(void);
+static uint8_t memory_wash_hottest(void);
+static uint32_t count_bits(uint32_t value);
 static void exec_commands(void);
 static void exec_commands_H(void);
 static void clear_current_command(void);
 static void send_tc_execution_verify(uint8_t status, uint16_t packet_id, uint16_t psc);
 static void send_event_report(uint8_t severity, uint8_t report_id, uint8_t param1, uint8_t param0);
 static void downlink_science(void);
+static int dump_memory(uint8_t memid, uint32_t address, uint32_t length, uint32_t offset);
+static int dump_send_packet(uint8_t* data, uint32_t size, uint32_t index, uint32_t num_packets, uint32_t packet_addr);
+static int load_write(uint32_t address, uint8_t* data, uint32_t length);
+static void load_close(void);
 
 /* Local variables for memory management */
 static uint8_t second_count;
 static uint8_t current_command[DATA_LENGTH + 10];
-static const TickType_t xTimeToWait = 60000;	// Number entered here corresponds to the number of ticks we should wait (1 minute)
-static int x, y, z, check, attempts;
-static uint8_t spi_chip, write_required, correct_val;	// write_required can be either 1, 2, or 3 to indicate which chip needs a write.
-static uint8_t check_val;
+static const TickType_t xTimeToWait = 1000;	// Number entered here corresponds to the number of ticks we should wait (1 second, so the wash keeps moving)
+static int check;
+static uint8_t spi_chip;
 static uint32_t page, addr, byte;
+static uint8_t wash_cursor_loaded;		// page holds the wash cursor once it has been read from WASH_BASE.
+static uint32_t wash_period_upsets;		// Bits corrected since the wash rate was last adjusted.
+static uint8_t wash_periods, wash_quiet;
+static uint16_t wash_hot;				// Regions which had an upset and are waiting to be washed again.
+static uint32_t wash_hot_page;			// Progress through the hot region being washed (0 = none started).
+static uint8_t wash_hot_region;
+static uint16_t wash_region_upsets[WASH_REGIONS];	// Recent upsets per region, halved every WASH_RATE_PERIOD.
+static uint8_t load_active;					// A load session is open.
+static uint32_t load_start, load_next;		// The session has loaded [load_start, load_next).
+static uint32_t load_end;					// The session closes when it reaches this address (0 = never).
+static fletcher16_ctx_t load_sum;			// Running Fletcher-16 of the bytes loaded in this session.
+static TickType_t load_last;				// When the last load packet was received.
+static uint8_t load_failed;					// Reason the last session failed (reported from the task loop).
+static uint32_t load_failed_addr;
 
 /************************************************************************/
 /* MEMORY_WASH (Function)												*/
@@ -151,15 +257,29 @@ static void prvMemoryManageTask(void *pvParameters )
 	SPI_HEALTH2 = 1;
 	SPI_HEALTH3 = 1;
 	downlinked_science_offset = 0;
-	memory_wash();					// This will cause the SPI health variables to be updated immediately.
+	wash_cursor_loaded = 0;
+	WASH_RATE = WASH_PAGES_PER_SLICE;
+	SPI_UPSETS1 = 0;
+	SPI_UPSETS2 = 0;
+	SPI_UPSETS3 = 0;
+	load_active = 0;
+	load_failed = 0;
 	/* @non-terminating@ */	
 	for( ;; )
 	{
 		second_count++;
-		//if(second_count == 90*60)		// Maximum wait time for a wash would be 90 minutes.
-		//	memory_wash();
 		exec_commands();
+		if(load_active && ((xTaskGetTickCount() - load_last) > LOAD_IDLE_TICKS))
+			load_close();			// The upload has stopped, verify what came.
+		if(load_failed)
+		{
+			send_event_report(1, MEMORY_LOAD_FAILED, (uint8_t)(load_failed_addr >> LOAD_SECTOR_SHIFT), load_failed);
+			load_failed = 0;
+		}
 		downlink_science();
+		memory_wash(WASH_RATE);		// Wash a few pages at a time, the rate follows the recent upset rate.
+		memory_wash_adjust_rate();
+		spimem_ftl_gc_step();		// Reclaim at most one SPI memory sector per second.
 		xLastWakeTime = xTaskGetTickCount();						// Sleep task for 1 second
 		vTaskDelayUntil(&xLastWakeTime, xTimeToWait);
 	}
@@ -169,19 +289,28 @@ static void prvMemoryManageTask(void *pvParameters )
 
 /************************************************************************/
 /* MEMORY_WASH															*/
+/* @param: budget: Maximum number of pages to wash in this call. Pages	*/
+/* which are skipped (blank or garbage) don't count, up to				*/
+/* WASH_SKIP_MAX of them.												*/
 /* @Purpose: Given that all 3 SPIMEM chips are working properly, this	*/
-/* function reads through each page in memory on all 3 spi chips and	*/
-/* compares the results of what is read. It then uses a voting algorithm*/
-/* to rewrite areas of memory which may have been subjected to a bitflip*/
-/* If an anomaly is detected and cannot be rectified, an error report	*/
-/* is sent to the FDIR task.											*/
+/* function continues the wash where the last call left off. Each page	*/
+/* is read once from every chip and the results are compared. It then	*/
+/* uses a voting algorithm to rewrite areas of memory which may have	*/
+/* been subjected to a bitflip. If an anomaly is detected and cannot be	*/
+/* rectified, the chip is marked as unhealthy.							*/
+/* Regions which recently had an upset are washed again first.			*/
+/* @NOTE: Spi0_Mutex is only held while a single page is being read, so	*/
+/* a wash slice never keeps the other tasks off SPI memory for long.	*/
+/* The cursor is saved at WASH_BASE so that a reset doesn't restart the	*/
+/* wash from page 0.													*/
 /************************************************************************/
-static void memory_wash(void)
+static void memory_wash(uint32_t budget)
 {
-	write_required = 0;				// write_required can be either 1, 2, or 3 to indicate which chip needs a write.
-	check_val = 0;
-	
-	if(INTERNAL_MEMORY_FALLBACK)	// No washing while in internal memory fallback mode.
+	uint32_t done, skipped;
+	uint8_t cursor[4];
+	int ret;
+
+	if(INTERNAL_MEMORY_FALLBACK_MODE)	// No washing while in internal memory fallback mode.
 		return;
 	
 	//adding this to check for MEM_SPIMEM_CHIPS_ERROR
@@ -194,96 +323,288 @@ static void memory_wash(void)
 	
 	if(!SPI_HEALTH1 || !SPI_HEALTH2 || !SPI_HEALTH3)
 	{
-		// If one of the chips is dead, we can't do any memory washing.
+		// If one of the chips is dead, there's nothing to vote with. The protected regions are corrected from their ECC.
+		memory_scrub(budget);
 		return;
 	}
-	
-	for(page = 0; page < 4096; page++)	// Loop through each page in memory.
+	memory_scrub(1);
+
+	if(!wash_cursor_loaded)
+	{
+		if(spimem_read(WASH_BASE, cursor, 4) != 4)
+			return;
+		page = ((uint32_t)cursor[3] << 24) | ((uint32_t)cursor[2] << 16) | ((uint32_t)cursor[1] << 8) | (uint32_t)cursor[0];
+		if(page >= WASH_PAGES)
+			page = 0;						// Never saved (erased memory reads as 0xFF).
+		wash_cursor_loaded = 1;
+	}
+
+	/* Up to half of the budget goes to washing regions with recent upsets again, first. */
+	for(done = 0, skipped = 0; (done < ((budget + 1) >> 1)) && (skipped < WASH_SKIP_MAX) && (wash_hot || wash_hot_page); )
 	{
-		addr = page << 8;
-		
-		//TODO: make this less ugly
-		for(spi_chip = 1; spi_chip < 4; spi_chip++)
+		if(!wash_hot_page)
 		{
-			x = spimem_read_alt(spi_chip, addr, page_buff1, 256);
-			y = spimem_read_alt(spi_chip, addr, page_buff2, 256);
-			z = spimem_read_alt(spi_chip, addr, page_buff3, 256);
-			/* Error Handling */	
-			//if((x < 0) || (y < 0) || (z < 0)){
-				//x = spimem_read_alt(spi_chip, addr, page_buff1, 256);
-				//y = spimem_read_alt(spi_chip, addr, page_buff2, 256);
-				//z = spimem_read_alt(spi_chip, addr, page_buff3, 256);
-				//
-				//if((x < 0) || (y < 0) || (z < 0)){
-					//x = spimem_read_alt(spi_chip, addr, page_buff1, 256);
-					//y = spimem_read_alt(spi_chip, addr, page_buff2, 256);
-					//z = spimem_read_alt(spi_chip, addr, page_buff3, 256);
-					//if((x < 0) || (y < 0) || (z < 0)){errorREPORT(MEMORY_TASK_ID, 0, MEM_SPIMEM_MEM_WASH_ERROR, 0);}
-					//}
-				//}							
+			wash_hot_region = memory_wash_hottest();
+			wash_hot &= ~(1 << wash_hot_region);	// An upset found during this pass marks it hot again.
 		}
-			
-		for(byte = 0; byte < 256; byte++)
+		ret = memory_wash_page(((uint32_t)wash_hot_region << WASH_REGION_SHIFT) + wash_hot_page);
+		if(ret < 0)
+			return;
+		if(ret)
+			done++;
+		else
+			skipped++;
+		wash_hot_page++;
+		if(wash_hot_page == (1 << WASH_REGION_SHIFT))
+			wash_hot_page = 0;
+		taskYIELD();
+	}
+
+	/* Skipped pages cost no flash time, so they don't count against the budget (up to WASH_SKIP_MAX). */
+	for(skipped = 0; (done < budget) && (skipped < WASH_SKIP_MAX); )
+	{
+		ret = memory_wash_page(page);
+		if(ret < 0)
+			return;							// SPI0 is busy or a chip failed, try again on the next wake-up.
+		if(ret)
+			done++;
+		else
+			skipped++;
+		page++;
+		if(page == WASH_PAGES)
 		{
-			if(page_buff1[byte] != page_buff2[byte])
-			{
-				if(page_buff2[byte] == page_buff3[byte])
-				{
-					write_required = 1;
-					correct_val = page_buff2[byte];
-				}
-					
-				if(page_buff1[byte] == page_buff3[byte])
-				{
-					write_required = 2;
-					correct_val = page_buff3[byte];
-				}
-			}
-			else
-			{
-				if(page_buff1[byte] != page_buff3[byte])
-				{
-					write_required = 3;
-					correct_val = page_buff1[byte];
-				}
-			}
-			if(write_required)
-			{
-				attempts = 0; check = -1;
-				//while (attempts<3 && check<0){
-					check = spimem_write_h(write_required,(addr+byte), &correct_val, 1);
-					//attempts++;
-				//}
-				//if (check<0){errorREPORT(MEMORY_TASK_ID, 0, MEM_SPIMEM_MEM_WASH_ERROR, 0);}
-				send_event_report(1, BIT_FLIP_DETECTED, 0, 0);		
-			}
-			
-			attempts = 0; check = -1;
-			//while (attempts<3 && check<0){
-				check = spimem_read_alt(write_required, (addr+byte), &check_val, 1);
-				//attempts++;
-			//}
-			//if (check<0){errorREPORT(MEMORY_TASK_ID, 0, MEM_SPIMEM_MEM_WASH_ERROR, 0);}
-		
-			if(check_val != correct_val)
-			{
-				// SPI_CHIP: write_required has something wrong with it
-				if(write_required == 1)
-					SPI_HEALTH1 = 0;
-				if(write_required == 2)
-					SPI_HEALTH2 = 0;
-				if(write_required == 3)
-					SPI_HEALTH3 = 0;
-				// Send an error report to the FDIR task. (The FDIR task will send the event report)
-				return;
-			}
+			page = 0;
+			second_count = 0;
+			send_event_report(1, MEMORY_WASH_FINISHED, 0, 0);
 		}
-		send_event_report(1, MEMORY_WASH_FINISHED, 0, 0);
+		if(!(page % WASH_SAVE_INTERVAL))
+		{
+			cursor[0] = (uint8_t)page;
+			cursor[1] = (uint8_t)(page >> 8);
+			cursor[2] = (uint8_t)(page >> 16);
+			cursor[3] = (uint8_t)(page >> 24);
+			spimem_write(WASH_BASE, cursor, 4);
+		}
+		taskYIELD();						// Let anyone waiting on SPI0 in before the next page.
 	}
-	second_count = 0;
 	return;
 }
 
+/************************************************************************/
+/* MEMORY_SCRUB															*/
+/* @param: budget: Number of protected pages to scrub.					*/
+/* @Purpose: Corrects the regions which are protected by ECC, one page	*/
+/* at a time (spimem_edac_scrub()). A correction is reported with		*/
+/* BIT_FLIP_DETECTED, param1 = bytes corrected, param0 = 0x08 (ECC).	*/
+/* A page which can't be corrected is reported with EDAC_UNCORRECTABLE,	*/
+/* param1:param0 = its logical page number.								*/
+/************************************************************************/
+static void memory_scrub(uint32_t budget)
+{
+	uint32_t done, scrub_addr;
+	int ret;
+
+	for(done = 0; done < budget; done++)
+	{
+		ret = spimem_edac_scrub(&scrub_addr);
+		if(ret == SPIMEM_EDAC_BUSY)
+			return;							// Try again on the next wake-up.
+		if(ret == SPIMEM_EDAC_UNCORRECTABLE)
+			send_event_report(2, EDAC_UNCORRECTABLE, (uint8_t)(scrub_addr >> 16), (uint8_t)(scrub_addr >> 8));
+		else if(ret > 0)
+		{
+			wash_period_upsets += ret;
+			send_event_report(1, BIT_FLIP_DETECTED, (ret > 0xFF) ? 0xFF : (uint8_t)ret, 0x08);
+		}
+		taskYIELD();
+	}
+	return;
+}
+
+/************************************************************************/
+/* MEMORY_WASH_PAGE														*/
+/* @param: wash_page: (0-4095) physical page to wash.					*/
+/* @return: -1 == SPI0 unavailable/read failure, -2 == A chip could not	*/
+/* be corrected and was marked unhealthy, 0 == Skipped, 1 == Success.	*/
+/* @Purpose: Pages which the FTL says are blank or garbage are skipped	*/
+/* without being read. Otherwise the page is read from each chip		*/
+/* exactly once and the Fletcher-16 of each copy is compared with the	*/
+/* others (and with the one stored when the page was written). Only if	*/
+/* they differ is the corrected page built by a bitwise majority vote.	*/
+/* Every chip which was outvoted is repaired once						*/
+/* (spimem_repair_page_h()) and verified with a single read-back of the	*/
+/* page. One BIT_FLIP_DETECTED event reports the number of bits which	*/
+/* were corrected (param1) and the chips which were repaired (param0,	*/
+/* bits 0-2) along with the number of sector rewrites this took			*/
+/* (param0, bits 4-7).													*/
+/* @NOTE: The reads, repairs and read-backs all happen under the same	*/
+/* hold of Spi0_Mutex so that garbage collection can't erase the page	*/
+/* in the middle.														*/
+/************************************************************************/
+static int memory_wash_page(uint32_t wash_page)
+{
+	uint8_t* copies[3] = {page_buff1, page_buff2, page_buff3};
+	uint8_t a, b, c, damaged = 0, failed = 0, rewrites = 0;
+	uint32_t flips = 0, flips1 = 0, flips2 = 0, flips3 = 0;
+	uint16_t stored, sum;
+	int state;
+
+	addr = wash_page << 8;
+
+	if(xSemaphoreTake(Spi0_Mutex, WASH_MUTEX_WAIT) != pdTRUE)
+		return -1;
+	state = spimem_ftl_page_state_h(wash_page, &stored);
+	if((state == FTL_PAGE_BLANK) || (state == FTL_PAGE_STALE))
+	{
+		xSemaphoreGive(Spi0_Mutex);
+		return 0;								// Nothing worth washing.
+	}
+	for(spi_chip = 1; spi_chip < 4; spi_chip++)
+	{
+		if(spimem_read_stream_h(spi_chip, addr, copies[spi_chip - 1], 256, 256, 0, 0) != 256)
+		{
+			xSemaphoreGive(Spi0_Mutex);
+			return -1;
+		}
+	}
+
+	/* Checksums first, the byte vote is only needed when one of them is off. */
+	sum = fletcher16(page_buff1, 256);
+	if((sum == fletcher16(page_buff2, 256)) && (sum == fletcher16(page_buff3, 256))
+		&& ((state != FTL_PAGE_LIVE) || (stored == 0xFFFF) || (stored == sum)))
+	{
+		xSemaphoreGive(Spi0_Mutex);
+		return 1;
+	}
+
+	for(byte = 0; byte < 256; byte++)
+	{
+		a = page_buff1[byte];
+		b = page_buff2[byte];
+		c = page_buff3[byte];
+		wash_image[byte] = (a & b) | (a & c) | (b & c);
+		if(a != wash_image[byte])
+			damaged |= 0x01;
+		if(b != wash_image[byte])
+			damaged |= 0x02;
+		if(c != wash_image[byte])
+			damaged |= 0x04;
+		flips1 += count_bits(a ^ wash_image[byte]);
+		flips2 += count_bits(b ^ wash_image[byte]);
+		flips3 += count_bits(c ^ wash_image[byte]);
+	}
+
+	for(spi_chip = 1; (spi_chip < 4) && damaged; spi_chip++)
+	{
+		if(!(damaged & (1 << (spi_chip - 1))))
+			continue;
+		check = spimem_repair_page_h(spi_chip, addr, copies[spi_chip - 1], wash_image);
+		if(check > 0)
+			rewrites++;
+		if((check < 0) || (spimem_read_stream_h(spi_chip, addr, copies[spi_chip - 1], 256, 256, 0, 0) != 256)
+			|| memcmp(copies[spi_chip - 1], wash_image, 256))
+			failed |= (1 << (spi_chip - 1));
+	}
+	if(failed)
+		spimem_drop_chips(failed);				// SPI_CHIP: has something wrong with it.
+	xSemaphoreGive(Spi0_Mutex);
+
+	if(damaged)
+	{
+		flips = flips1 + flips2 + flips3;
+		SPI_UPSETS1 += flips1;
+		SPI_UPSETS2 += flips2;
+		SPI_UPSETS3 += flips3;
+		wash_period_upsets += flips;
+		if(wash_region_upsets[wash_page >> WASH_REGION_SHIFT] < 0xFFFF)
+			wash_region_upsets[wash_page >> WASH_REGION_SHIFT]++;
+		wash_hot |= (1 << (wash_page >> WASH_REGION_SHIFT));
+		send_event_report(1, BIT_FLIP_DETECTED, (flips > 0xFF) ? 0xFF : (uint8_t)flips, (rewrites << 4) | damaged);
+	}
+	if(failed)
+	{
+		spimem_report_failed_chips();			// Send an error report to the FDIR task. (The FDIR task will send the event report)
+		return -2;
+	}
+	return 1;
+}
+
+/************************************************************************/
+/* MEMORY_WASH_ADJUST_RATE												*/
+/* @Purpose: Called once per wake-up. Every WASH_RATE_PERIOD wake-ups	*/
+/* the wash rate (WASH_RATE, pages per wake-up) is doubled if upsets	*/
+/* were corrected during the period and halved after WASH_QUIET_PERIODS	*/
+/* periods in a row without one, between WASH_RATE_MIN and				*/
+/* WASH_RATE_MAX. A burst of upsets (SAA pass, solar event) therefore	*/
+/* speeds the wash up within a couple of minutes, while a quiet orbit	*/
+/* lets it fall back to the floor and leave SPI0 to the other tasks.	*/
+/* The recent upset count of each region is halved at the same time.	*/
+/************************************************************************/
+static void memory_wash_adjust_rate(void)
+{
+	uint8_t region;
+
+	if(++wash_periods < WASH_RATE_PERIOD)
+		return;
+	wash_periods = 0;
+
+	if(wash_period_upsets)
+	{
+		WASH_RATE <<= 1;
+		if(wash_period_upsets > WASH_RATE_PERIOD)
+			WASH_RATE <<= 1;				// More than one upset per wake-up, go faster still.
+		wash_quiet = 0;
+	}
+	else if(++wash_quiet >= WASH_QUIET_PERIODS)
+	{
+		WASH_RATE >>= 1;
+		wash_quiet = 0;
+	}
+	if(WASH_RATE < WASH_RATE_MIN)
+		WASH_RATE = WASH_RATE_MIN;
+	if(WASH_RATE > WASH_RATE_MAX)
+		WASH_RATE = WASH_RATE_MAX;
+	wash_period_upsets = 0;
+
+	for(region = 0; region < WASH_REGIONS; region++)
+		wash_region_upsets[region] >>= 1;
+	return;
+}
+
+/************************************************************************/
+/* MEMORY_WASH_HOTTEST													*/
+/* @return: The region waiting in wash_hot with the most recent upsets.	*/
+/* @NOTE: wash_hot must not be 0.										*/
+/************************************************************************/
+static uint8_t memory_wash_hottest(void)
+{
+	uint8_t region, hottest = 0xFF;
+
+	for(region = 0; region < WASH_REGIONS; region++)
+	{
+		if(!(wash_hot & (1 << region)))
+			continue;
+		if((hottest == 0xFF) || (wash_region_upsets[region] > wash_region_upsets[hottest]))
+			hottest = region;
+	}
+	return hottest;
+}
+
+/************************************************************************/
+/* COUNT_BITS															*/
+/* @return: The number of bits which are set in value.					*/
+/************************************************************************/
+static uint32_t count_bits(uint32_t value)
+{
+	uint32_t count = 0;
+	while(value)
+	{
+		value &= value - 1;
+		count++;
+	}
+	return count;
+}
+
 /************************************************************************/
 /* EXEC_PUS_COMMANDS													*/
 /* @Purpose: Attempts to receive from obc_to_mem_fifo, executes			*/
@@ -303,13 +624,15 @@ static void exec_commands(void)
 static void exec_commands_H(void)
 {
 	uint8_t command, memid, status;
-	uint16_t i, j;
+	uint16_t i;
 	uint16_t packet_id, psc;
 	uint8_t* mem_ptr = 0;
-	uint32_t address, length, num_transfers = 0;
+	uint32_t address, length, offset;
 	uint32_t* temp_address = 0;
 	int check = 0;
 	uint64_t checksum; 
+	uint8_t desc;
+	uint8_t* packet;
 	command = current_command[146];
 	packet_id = ((uint16_t)current_command[140]) << 8;
 	packet_id += (uint16_t)current_command[139];
@@ -324,12 +647,14 @@ static void exec_commands_H(void)
 	length += ((uint32_t)current_command[130]) << 16;
 	length += ((uint32_t)current_command[129]) << 8;
 	length += (uint32_t)current_command[128];
+	if(load_active && (command != MEMORY_LOAD_ABS))
+		load_close();				// Other requests should see everything which was loaded.
 	switch(command)
 	{
 		case	MEMORY_LOAD_ABS:
 			if(!memid)
 			{
-				mem_ptr = address;
+				mem_ptr = (uint8_t*)(uintptr_t)address;
 				for(i = 0; i < length; i++)
 				{
 					*(mem_ptr + i) = current_command[i];
@@ -337,12 +662,9 @@ static void exec_commands_H(void)
 			}
 			else
 			{
-				check = -1;	
-				//while (attempts<3 && check<0){
-					check = spimem_write(address, current_command, length);
-					//attempts++;
-				//}
-					
+				check = -1;
+				if(length <= DUMP_PACKET)
+					check = load_write(address, current_command, length);
 				if (check <0)
 				{
 					//errorREPORT(MEMORY_TASK_ID, 0, MEM_OTHER_SPIMEM_ERROR, NULL); //didn't have enough parameters - just putting NULL for now
@@ -351,48 +673,26 @@ static void exec_commands_H(void)
 				}
 			}
 			send_tc_execution_verify(1, packet_id, psc);
+			return;
 		case	DUMP_REQUEST_ABS:
+			/* Offset (in bytes) at which to resume an earlier dump, 0 = the whole region. */
+			offset =  ((uint32_t)current_command[3]) << 24;
+			offset += ((uint32_t)current_command[2]) << 16;
+			offset += ((uint32_t)current_command[1]) << 8;
+			offset += (uint32_t)current_command[0];
 			clear_current_command();		// Only clears lower data section.
-			if(length > 128)
-			{
-				num_transfers = length / 128;
-			}
-			for (j = 0; j < num_transfers; j++)
+			if(dump_memory(memid, address, length, offset) < 0)
 			{
-				if(!memid)
-				{
-					mem_ptr = address;
-					for (i = 0; i < length; i++)
-					{
-						current_command[i] = *(mem_ptr + i);
-					}
-				}
-				else
-				{
-					check = -1;
-					//while (attempts<3 && check<0){
-						check = spimem_read(address, current_command, length);
-						//attempts++;
-					//}
-						
-					if (check<0)
-					{
-						//errorREPORT(MEMORY_TASK_ID, 0, MEM_OTHER_SPIMEM_ERROR,NULL); //didn't have enough parameters - just putting NULL for now
-						send_tc_execution_verify(0xFF, packet_id, psc);
-						return;
-					}
-						
-				}
-				current_command[146] = MEMORY_DUMP_ABS;
-				current_command[145] = num_transfers - j;
-				xQueueSendToBack(mem_to_obc_fifo, current_command, (TickType_t)1);	// FAILURE_RECOVERY if this doesn't return pdTrue
-				taskYIELD();	// Give the packet router a chance to downlink the dump packet.				
+				//errorREPORT(MEMORY_TASK_ID, 0, MEM_OTHER_SPIMEM_ERROR,NULL); //didn't have enough parameters - just putting NULL for now
+				send_tc_execution_verify(0xFF, packet_id, psc);
+				return;
 			}
 			send_tc_execution_verify(1, packet_id, psc);
+			return;
 		case	CHECK_MEM_REQUEST:
 			if(!memid)
 			{
-				temp_address = address;
+				temp_address = (uint32_t*)(uintptr_t)address;
 				checksum = fletcher64(temp_address, length);
 				send_tc_execution_verify(1, packet_id, psc);
 			}
@@ -406,22 +706,182 @@ static void exec_commands_H(void)
 				}
 				send_tc_execution_verify(1, packet_id, psc);
 			}
-			current_command[146] = MEMORY_CHECK_ABS;
-			current_command[7] = (uint8_t)((checksum & 0xFF00000000000000) >> 56);
-			current_command[6] = (uint8_t)((checksum & 0x00FF000000000000) >> 48);
-			current_command[5] = (uint8_t)((checksum & 0x0000FF0000000000) >> 40);
-			current_command[4] = (uint8_t)((checksum & 0xFF0000FF00000000) >> 32);
-			current_command[3] = (uint8_t)((checksum & 0xFF000000FF000000) >> 24);
-			current_command[2] = (uint8_t)((checksum & 0xFF00000000FF0000) >> 26);
-			current_command[1] = (uint8_t)((checksum & 0xFF0000000000FF00) >> 8);
-			current_command[0] = (uint8_t)(checksum & 0x00000000000000FF);
-			xQueueSendToBack(mem_to_obc_fifo, current_command, (TickType_t)1);
+			desc = pus_pool_alloc(0, (TickType_t)1);
+			if(desc == PUS_POOL_NONE)
+				return;
+			packet = pus_pool_buf(desc);
+			packet[146] = MEMORY_CHECK_ABS;
+			packet[PUS_POOL_DATA + 7] = (uint8_t)((checksum & 0xFF00000000000000) >> 56);
+			packet[PUS_POOL_DATA + 6] = (uint8_t)((checksum & 0x00FF000000000000) >> 48);
+			packet[PUS_POOL_DATA + 5] = (uint8_t)((checksum & 0x0000FF0000000000) >> 40);
+			packet[PUS_POOL_DATA + 4] = (uint8_t)((checksum & 0xFF0000FF00000000) >> 32);
+			packet[PUS_POOL_DATA + 3] = (uint8_t)((checksum & 0xFF000000FF000000) >> 24);
+			packet[PUS_POOL_DATA + 2] = (uint8_t)((checksum & 0xFF00000000FF0000) >> 26);
+			packet[PUS_POOL_DATA + 1] = (uint8_t)((checksum & 0xFF0000000000FF00) >> 8);
+			packet[PUS_POOL_DATA + 0] = (uint8_t)(checksum & 0x00000000000000FF);
+			pus_pool_send(mem_to_obc_fifo, desc, (TickType_t)1);
 		default:
 			return;
 	}
 	return;
 }
 
+/************************************************************************/
+/* DUMP_MEMORY															*/
+/* @param: memid: 0 = OBC RAM, otherwise SPI memory.					*/
+/* @param: address: Start of the region to dump.						*/
+/* @param: length: Size of the region in bytes.							*/
+/* @param: offset: Where in the region to resume the dump, rounded down	*/
+/* to a packet boundary (0 = from the start).							*/
+/* @Purpose: Sends the region to the packet router as a PUS sequence of	*/
+/* 128B packets (first/continuation/last, or standalone). The sequence	*/
+/* count of a packet is its index in the whole region, so a resumed		*/
+/* dump carries on where the lost one stopped.							*/
+/* @return: -1 = failure, otherwise the number of bytes sent.			*/
+/************************************************************************/
+static int dump_memory(uint8_t memid, uint32_t address, uint32_t length, uint32_t offset)
+{
+	uint32_t num_packets, index, pos, size;
+	uint8_t* mem_ptr = (uint8_t*)(uintptr_t)address;
+
+	if(!length)
+		return -1;
+	offset -= offset % DUMP_PACKET;
+	if(offset >= length)
+		return -1;
+	num_packets = (length + DUMP_PACKET - 1) / DUMP_PACKET;
+	index = offset / DUMP_PACKET;
+
+	for(pos = offset; pos < length; pos += DUMP_PACKET)
+	{
+		size = ((length - pos) < DUMP_PACKET) ? (length - pos) : DUMP_PACKET;
+		if(!memid)
+			memcpy(dump_buff, mem_ptr + pos, size);
+		else if(spimem_read(address + pos, dump_buff, size) != (int)size)
+			return -1;
+		if(dump_send_packet(dump_buff, size, index++, num_packets, address + pos) < 0)
+			return -1;
+	}
+	return length - offset;
+}
+
+/************************************************************************/
+/* DUMP_SEND_PACKET														*/
+/* @param: data: Up to 128B to be dumped.								*/
+/* @param: size: Number of valid bytes in data, the rest is zero.		*/
+/* @param: index: Position of this packet in the dump.					*/
+/* @param: num_packets: Number of packets in the whole dump.			*/
+/* @param: packet_addr: Address of the first byte in this packet.		*/
+/* @Purpose: Sends one dump packet to the packet router. [145] holds	*/
+/* the PUS sequence flags and [144..143] the 14-bit sequence count.		*/
+/* @NOTE: This blocks until the router has room, which is what keeps	*/
+/* the dump from outrunning the downlink. The dump leaves				*/
+/* PUS_POOL_RESERVE buffers in the pool for the other tasks.			*/
+/* @return: -1 = The pool or the router's FIFO stayed full, 1 = success.*/
+/************************************************************************/
+static int dump_send_packet(uint8_t* data, uint32_t size, uint32_t index, uint32_t num_packets, uint32_t packet_addr)
+{
+	uint8_t flags, desc;
+	uint8_t* packet;
+
+	desc = pus_pool_alloc(PUS_POOL_RESERVE, (TickType_t)DUMP_FIFO_WAIT);
+	if(desc == PUS_POOL_NONE)
+		return -1;
+	packet = pus_pool_buf(desc);
+	memcpy(packet + PUS_POOL_DATA, data, size);
+	if(num_packets == 1)
+		flags = SEQ_FLAG_STANDALONE;
+	else if(!index)
+		flags = SEQ_FLAG_FIRST;
+	else if(index == (num_packets - 1))
+		flags = SEQ_FLAG_LAST;
+	else
+		flags = SEQ_FLAG_CONT;
+	packet[146] = MEMORY_DUMP_ABS;
+	packet[145] = flags;
+	packet[144] = (uint8_t)((index >> 8) & 0x3F);
+	packet[143] = (uint8_t)(index & 0xFF);
+	packet[135] = (uint8_t)((packet_addr & 0xFF000000) >> 24);
+	packet[134] = (uint8_t)((packet_addr & 0x00FF0000) >> 16);
+	packet[133] = (uint8_t)((packet_addr & 0x0000FF00) >> 8);
+	packet[132] = (uint8_t)(packet_addr & 0x000000FF);
+	if(pus_pool_send(mem_to_obc_fifo, desc, (TickType_t)DUMP_FIFO_WAIT) != pdTRUE)
+		return -1;
+	return 1;
+}
+
+/************************************************************************/
+/* LOAD_WRITE															*/
+/* @param: address: Logical SPI memory address of the first byte.		*/
+/* @param: data: The bytes to load (at most 128).						*/
+/* @param: length: Number of bytes.										*/
+/* @Purpose: Writes one memory load packet to SPI memory and adds it to	*/
+/* the current load session. A packet which doesn't follow on from the	*/
+/* last one closes the session and opens a new one. A session which		*/
+/* starts at the base of an SSM image region closes by itself when the	*/
+/* whole image is in.													*/
+/* @return: -1 = failure, otherwise length.								*/
+/************************************************************************/
+static int load_write(uint32_t address, uint8_t* data, uint32_t length)
+{
+	if(load_active && (address != load_next))
+		load_close();
+	if(spimem_write(address, data, length) != (int)length)
+		return -1;
+	if(!load_active)
+	{
+		load_active = 1;
+		load_start = address;
+		load_next = address;
+		load_end = 0;
+		if((address == COMS_BASE) || (address == EPS_BASE) || (address == PAY_BASE))
+			load_end = address + LOAD_IMAGE_SIZE;
+		fletcher16_init(&load_sum);
+	}
+	fletcher16_update(&load_sum, data, length);
+	load_next = address + length;
+	load_last = xTaskGetTickCount();
+	if(load_next == load_end)
+		load_close();							// The whole image is in.
+	return length;
+}
+
+/************************************************************************/
+/* LOAD_CLOSE															*/
+/* @Purpose: Ends the current load session. The region which was		*/
+/* loaded is read back (voted) and compared against the running			*/
+/* checksum. A mismatch is reported to ground by the task loop with		*/
+/* MEMORY_LOAD_FAILED, param1 = 4kB sector of the session start,		*/
+/* param0 = 2 (checksum mismatch).										*/
+/* @NOTE: current_command[] may still hold a request, so the event		*/
+/* can't be sent from here.												*/
+/************************************************************************/
+static void load_close(void)
+{
+	fletcher16_ctx_t sum;
+	uint32_t pos, n;
+
+	if(!load_active)
+		return;
+	load_active = 0;
+	fletcher16_init(&sum);
+	for(pos = load_start; pos < load_next; pos += n)
+	{
+		n = load_next - pos;
+		if(n > 256)
+			n = 256;
+		if(spimem_read_voted(pos, load_buff, n) != (int)n)
+			break;
+		fletcher16_update(&sum, load_buff, n);
+	}
+	if((pos < load_next) || (fletcher16_final(&sum) != fletcher16_final(&load_sum)))
+	{
+		load_failed = 2;
+		load_failed_addr = load_start;
+	}
+	return;
+}
+
 /************************************************************************/
 /* CLEAR_CURRENT_COMMAND												*/
 /* @Purpose: clears the array current_command[]							*/
@@ -446,15 +906,20 @@ static void clear_current_command(void)
 /************************************************************************/
 static void send_tc_execution_verify(uint8_t status, uint16_t packet_id, uint16_t psc)
 {
-	clear_current_command();
-	current_command[146] = TASK_TO_OPR_TCV;		// Request a TC verification
-	current_command[145] = status;
-	current_command[144] = MEMORY_TASK_ID;		// APID of this task
-	current_command[140] = ((uint8_t)packet_id) >> 8;
-	current_command[139] = (uint8_t)packet_id;
-	current_command[138] = ((uint8_t)psc) >> 8;
-	current_command[137] = (uint8_t)psc;
-	xQueueSendToBack( mem_to_obc_fifo, current_command, (TickType_t)1);		// FAILURE_RECOVERY if this doesn't return pdPASS
+	uint8_t desc;
+	uint8_t* packet;
+	desc = pus_pool_alloc(0, (TickType_t)1);
+	if(desc == PUS_POOL_NONE)
+		return;									// FAILURE_RECOVERY
+	packet = pus_pool_buf(desc);
+	packet[146] = TASK_TO_OPR_TCV;				// Request a TC verification
+	packet[145] = status;
+	packet[144] = MEMORY_TASK_ID;				// APID of this task
+	packet[140] = ((uint8_t)packet_id) >> 8;
+	packet[139] = (uint8_t)packet_id;
+	packet[138] = ((uint8_t)psc) >> 8;
+	packet[137] = (uint8_t)psc;
+	pus_pool_send(mem_to_obc_fifo, desc, (TickType_t)1);		// FAILURE_RECOVERY if this doesn't return pdPASS
 	return;
 }
 
@@ -469,32 +934,37 @@ static void send_tc_execution_verify(uint8_t status, uint16_t packet_id, uint16_
 /************************************************************************/
 static void send_event_report(uint8_t severity, uint8_t report_id, uint8_t param1, uint8_t param0)
 {
-	clear_current_command();
-	current_command[146] = TASK_TO_OPR_EVENT;
-	current_command[145] = severity;
-	current_command[136] = report_id;
-	current_command[135] = 2;
-	current_command[134] = 0x00;
-	current_command[133] = 0x00;
-	current_command[132] = 0x00;
-	current_command[131] = param0;
-	current_command[130] = 0x00;
-	current_command[129] = 0x00;
-	current_command[128] = 0x00;
-	current_command[127] = param1;
-	xQueueSendToBack(mem_to_obc_fifo, current_command, (TickType_t)1);		// FAILURE_RECOVERY
+	uint8_t desc;
+	uint8_t* packet;
+	desc = pus_pool_alloc(0, (TickType_t)1);
+	if(desc == PUS_POOL_NONE)
+		return;									// FAILURE_RECOVERY
+	packet = pus_pool_buf(desc);
+	packet[146] = TASK_TO_OPR_EVENT;
+	packet[145] = severity;
+	packet[136] = report_id;
+	packet[135] = 2;
+	packet[131] = param0;
+	packet[127] = param1;
+	pus_pool_send(mem_to_obc_fifo, desc, (TickType_t)1);		// FAILURE_RECOVERY
 	return;
 }
 
 void downlink_science(void)		// TO BE USED FOR CSDC PURPOSES
 {
-	clear_current_command();
+	uint8_t desc;
+	uint8_t* packet;
 	if((science_offset - downlinked_science_offset) >= 53)	// We can downlink a packet.
 	{
+		desc = pus_pool_alloc(PUS_POOL_RESERVE, (TickType_t)1);		// Science is a bulk producer.
+		if(desc == PUS_POOL_NONE)
+			return;
+		packet = pus_pool_buf(desc);
 		downlinked_science_offset = science_offset;
-		spimem_read(SCIENCE_BASE + science_offset, current_command + 76, 128);
-		current_command[146] = DOWNLINKING_SCIENCE;
-		xQueueSendToBack(mem_to_obc_fifo, current_command, (TickType_t)1);
+		/* The science data is read straight into the packet, at the same place in the data field as before. */
+		spimem_read_stream(SCIENCE_BASE + science_offset, packet + PUS_POOL_DATA + 76, PUS_POOL_DATA_LENGTH - 76);
+		packet[146] = DOWNLINKING_SCIENCE;
+		pus_pool_send(mem_to_obc_fifo, desc, (TickType_t)1);
 	}
 	return;
 }
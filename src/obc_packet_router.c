@@ -57,6 +57,62 @@ Author: Keenan Burnett
 *					as adding some code so that we can implement event reporting (events to report 
 *					shall come up over time.)
 *
+* 10/16/2026		get_obc_variable() reports the SPI memory page cache statistics.
+*
+*					It also reports the memory wash rate and the upsets corrected on each chip.
+*
+*					Memory dump packets are downlinked again (packetize_send_segment()), with the
+*					sequence flags and sequence count chosen by the memory task. A packet which didn't
+*					fit in tm_buffer is kept in current_tm and retried, and no more dump packets are
+*					taken from mem_to_obc_fifo until it has gone out. Before, current_tm_fullf stayed
+*					set after the first failure and every later packet was dropped.
+*
+*					The PEC of TM and TC packets is computed with pus_pec() (Fletcher-16 or CRC-16-CCITT,
+*					chosen at compile time). The PEC which packetize_send_telemetry() computed over the
+*					header alone was always overwritten, it is no longer computed.
+*
+*					TM data is checksummed while it is copied into current_tm (copy_tm_data()).
+*
+*					TM packets are built in buffers from the PUS packet pool (pus_pool.c). hk_to_obc_fifo,
+*					mem_to_obc_fifo and tm_buffer carry one-byte descriptors instead of whole packets.
+*					The header is written around the data which the producing task left in the buffer,
+*					so the packet is no longer copied on its way to send_pus_packet_tm(): an HK report
+*					is copied 132B on its way to COMS instead of 863B, and the 147B and 152B FIFO items,
+*					current_tm[] and tm_to_downlink[] (3000B) give way to the 1824B pool and one-byte
+*					descriptors. Packets/s is not higher (src/host/bench_pool.c), the gain is in copies
+*					and RAM.
+*
+*					send_pus_packet_tm() can use the windowed transfer (TM_TRANSFER_PROTOCOL in can_func.h,
+*					off by default until the COMS SSM firmware supports it):
+*					7B per frame, TM_WINDOW frames between responses from the COMS SSM, and only the
+*					frames which the SSM reports missing are sent again. The task blocks on the SSM's
+*					responses instead of busy-polling, and no longer waits 25 ms after every frame.
+*
+*					The task blocks on opr_wake_sem, which is given whenever a TC chunk or a request
+*					arrives, instead of polling each FIFO with a 1-tick timeout. On each wake the
+*					sources are drained in priority order (TC chunks, TCs, requests, TM downlink).
+*					The 3 s pause between TM packets no longer puts the whole task to sleep, TCs are
+*					still received and answered while the next TM packet waits (OPR_TM_PACE).
+*
+*					TM packets wait in one queue per class (tm_sched.c) instead of tm_buffer, and the
+*					next packet to downlink is chosen by class: verification and event reports first,
+*					then HK, memory dumps and science in weighted turns. A dump is left in
+*					mem_to_obc_fifo while the dump queue is full. get_obc_variable() reports the depth,
+*					age and drops of each queue (TM_*_DEPTH, _AGE, _DROPS).
+*
+*					TM and TC packets which don't fit in RAM are kept in SPI memory (pus_store.c), in
+*					rings which fill the TM and TC regions and survive a reset. Event reports and HK
+*					overflow their queues to the TM store and come back through TM_CLASS_STORED, which
+*					is refilled ahead of the downlink. A TC which doesn't fit in tc_buffer goes to the
+*					TC store and is decoded after tc_buffer has been emptied, before it was dropped.
+*					The stores replace the commented-out TM_BASE / TC_BASE code.
+*
+*					The task's initialization is in opr_init(), so that a host build can set the router
+*					up and call its functions without starting the task.
+*
+*					The work of one wake is in opr_serve() (TC chunks, TCs, requests) and opr_downlink()
+*					(the next TM packet), so that a host build can run the loop one wake at a time.
+*
 * DESCRIPTION:
 * This task is in charge of managing communication requests from tasks on
 * the OBC that wish to have something downlinked as well as dissecting the incoming
@@ -74,6 +130,7 @@ Author: Keenan Burnett
 
 /* Standard includes. */
 #include <stdio.h>
+#include <string.h>
 
 /* Kernel includes. */
 #include "FreeRTOS.h"
@@ -95,6 +152,12 @@ Author: Keenan Burnett
 
 #include "checksum.h"
 
+#include "pus_pool.h"
+
+#include "tm_sched.h"
+
+#include "pus_store.h"
+
 /* Priorities at which the tasks are created. */
 #define OBC_PACKET_ROUTER_PRIORITY		( tskIDLE_PRIORITY + 2 )	// Shares highest priority with FDIR.
 
@@ -104,11 +167,34 @@ functionality. */
 
 #define DEPLOY_TIMEOUT 60000
 
+/* Windowed TM transfer (send_pus_packet_tm()) */
+#define TM_ALL_FRAMES		((1UL << TM_FRAMES) - 1)
+#define TM_START_WAIT		10			// Ticks to wait for OK_START_TM_PACKET,
+#define TM_START_TRIES		2			// the packet is tried again on the next pass of the task.
+#define TM_RESP_WAIT		10			// Ticks to wait for the response to a window,
+#define TM_RESP_TRIES		3			// windows in a row which may go unanswered before giving up.
+
+/* Event-driven loop (opr_wait_time()) */
+#define OPR_IDLE_WAIT		1000		// Ticks to block with nothing to do, in case a wake was missed.
+#define OPR_RETRY_WAIT		10			// Ticks before a TM packet which COMS didn't take is tried again.
+#define OPR_TM_PACE			3000		// Ticks between TM packets handed to COMS.
+#define OPR_DEPLOY_WAIT		100			// Ticks between antenna deployment commands.
+#define OPR_REQUEST_BATCH	4			// Passes over the request FIFOs per wake.
+
+/* TM and TC stores in SPI memory (pus_store.c) */
+#define OPR_STORE_SIZE			0x20000					// Bytes in the TM and TC regions,
+#define OPR_STORE_SIZE_FALLBACK	0x400					// in INTERNAL_MEMORY_FALLBACK_MODE.
+#define OPR_TM_STORE_SAVE		(4 * PUS_STORE_PAGE)	// TM read back before the head is saved (at most this is sent again after a reset).
+
 /* Functions Prototypes. */
 static void prvOBCPacketRouterTask( void *pvParameters );
 TaskHandle_t obc_packet_router(void);
 void opr_kill(uint8_t killer);
 static int packetize_send_telemetry(uint8_t sender, uint8_t dest, uint8_t service_type, uint8_t service_sub_type, uint8_t packet_sub_counter, uint16_t num_packets, uint8_t* data);
+static int packetize_send_segment(uint8_t sender, uint8_t dest, uint8_t service_type, uint8_t service_sub_type, uint8_t packet_sub_counter, uint8_t seq_flags, uint16_t seq_count, uint8_t* data);
+static int tm_prepare(uint8_t* data);
+static void write_tm_header(uint8_t sender, uint8_t dest, uint8_t service_type, uint8_t service_sub_type, uint8_t packet_sub_counter, uint8_t seq_flags, uint16_t seq_count);
+static uint16_t copy_tm_data(uint8_t* data);
 static int receive_tc_msg(void);
 static int send_pus_packet_tm(uint8_t sender_id);
 static void send_tc_transaction_response(uint8_t code);
@@ -120,10 +206,17 @@ static int decode_telecommand(void);
 static int decode_telecommand_h(uint8_t service_type, uint8_t service_sub_type);
 static int send_tc_verification(uint16_t packet_id, uint16_t sequence_control, uint8_t status, uint8_t code, uint32_t parameter, uint8_t tc_type);
 static int verify_telecommand(uint8_t apid, uint8_t packet_length, uint16_t pec0, uint16_t pec1, uint8_t service_type, uint8_t service_sub_type, uint8_t version, uint8_t ccsds_flag, uint8_t packet_version);
-static void exec_commands(void);
+static int exec_commands(void);
+static void opr_init(void);
+static TickType_t opr_wait_time(void);
+static void opr_serve(void);
+static void opr_downlink(void);
+static void receive_tc_msgs(void);
 static void send_event_packet(uint8_t sender, uint8_t severity);
 static int store_current_tm(void);
 static void send_event_report(uint8_t severity, uint8_t report_id, uint8_t param1, uint8_t param0);
+static void open_stores(void);
+static void refill_stored_tm(void);
 
 void set_obc_variable(uint8_t parameter, uint32_t val);
 uint32_t get_obc_variable(uint8_t parameter);
@@ -143,11 +236,13 @@ static uint8_t tc_verify_success_count, tc_verify_fail_count, event_report_count
 static uint8_t current_data[DATA_LENGTH];
 static uint8_t current_command[DATA_LENGTH + 10];
 static uint32_t high, low;
-static uint16_t abs_time, pec, packet_error_control = 0;
-static uint32_t num_transfers;
+static uint16_t abs_time, packet_error_control = 0;
 static uint16_t timeout;
+#if (TM_TRANSFER_PROTOCOL != TM_TRANSFER_WINDOWED)
+static uint32_t num_transfers;
 static TickType_t xLastWakeTime;
 static TickType_t xTimeToWait;
+#endif
 static uint8_t data_field_headerf, apid, packet_length;
 static uint16_t pec1, pec0;
 static uint8_t ack, service_type, service_sub_type, source_id;
@@ -159,11 +254,19 @@ static uint8_t npar1;
 static uint32_t address, length;
 static uint32_t new_time, last_time;
 /* Latest TC packet received, next TM packet to send	*/
-static uint8_t current_tc[PACKET_LENGTH], current_tm[PACKET_LENGTH];	// Arrays are 144B for ease of implementation.
-static uint8_t tc_to_decode[PACKET_LENGTH], tm_to_downlink[PACKET_LENGTH];
+static uint8_t current_tc[PACKET_LENGTH];	// Arrays are 144B for ease of implementation.
+static uint8_t tc_to_decode[PACKET_LENGTH];
+static uint8_t tm_desc, down_desc, request_desc;	// Pool descriptors of current_tm, tm_to_downlink and the request being handled.
+static pus_store_t tm_store, tc_store;				// TM and TC which didn't fit in RAM, kept in SPI memory.
+static uint8_t *current_tm, *tm_to_downlink;		// Point into the PUS packet pool.
+#if (TM_TRANSFER_PROTOCOL == TM_TRANSFER_WINDOWED)
+static uint8_t tm_tag;								// Sequence tag of the TM packet being sent.
+#endif
 static uint32_t low_received, high_received;
 static uint32_t new_tc_msg_high, new_tc_msg_low;
 static uint32_t deployed_antenna;
+static TickType_t tm_next_time;						// The next TM packet may go to COMS at this tick.
+static TickType_t deploy_time;						// Last antenna deployment command.
 
 /************************************************************************/
 /* OBC_PACKET_ROUTER (Function)											*/
@@ -198,7 +301,27 @@ static void prvOBCPacketRouterTask( void *pvParameters )
 {
 	configASSERT( ( ( unsigned long ) pvParameters ) == OBC_PACKET_ROUTER_PARAMETER );
 
-	int status;
+	opr_init();
+	/* @non-terminating@ */	
+	for( ;; )
+	{
+		/* Block until a task or the CAN1 handler gives opr_wake_sem, or until something which	*/
+		/* is waiting on the clock (the next TM packet, a retry, antenna deployment) is due.	*/
+		xSemaphoreTake(opr_wake_sem, opr_wait_time());
+		opr_serve();
+		opr_downlink();
+	}
+}
+/*-----------------------------------------------------------*/
+/* static helper functions below */
+
+/************************************************************************/
+/* OPR_INIT				                                                */
+/* @Purpose: Initializes the task's counters, packet buffers and TM/TC	*/
+/* stores before it enters its loop.									*/
+/************************************************************************/
+static void opr_init(void)
+{
 	/* Initialize Global variables and flags */
 	current_tc_fullf = 0;
 	tc_sequence_count = 0;
@@ -222,125 +345,192 @@ static void prvOBCPacketRouterTask( void *pvParameters )
 	science_packet_count = 0;
 	time_of_deploy = 0;
 	deployed_antenna = 0;
+	tm_desc = PUS_POOL_NONE;
+	down_desc = PUS_POOL_NONE;
+	request_desc = PUS_POOL_NONE;
 	clear_current_data();
 	clear_current_command();
-	//task_spimem_read(OBC_PACKET_ROUTER_ID, TM_BASE, &TM_PACKET_COUNT, 4);	// FAILURE_HANDLING
-	//task_spimem_read(OBC_PACKET_ROUTER_ID, TM_BASE + 4, &NEXT_TM_PACKET, 4);
-	//task_spimem_read(OBC_PACKET_ROUTER_ID, TM_BASE + 8, &CURRENT_TM_PACKET, 4);
-	//task_spimem_read(OBC_PACKET_ROUTER_ID, TC_BASE, &TC_PACKET_COUNT, 4);	// FAILURE_HANDLING
-	//task_spimem_read(OBC_PACKET_ROUTER_ID, TC_BASE + 4, &NEXT_TC_PACKET, 4);
-	//task_spimem_read(OBC_PACKET_ROUTER_ID, TC_BASE + 8, &CURRENT_TC_PACKET, 4);
-	//if(NEXT_TM_PACKET == 0)
-	//{
-		//NEXT_TM_PACKET = TM_BASE + 12;
-		//task_spimem_write(OBC_PACKET_ROUTER_ID, TM_BASE + 4, &NEXT_TM_PACKET, 4);
-	//}
-	//if(CURRENT_TM_PACKET == 0)
-	//{
-		//CURRENT_TM_PACKET = TM_BASE + 12;
-		//task_spimem_write(OBC_PACKET_ROUTER_ID, TM_BASE + 8, CURRENT_TM_PACKET, 4);
-	//}
-	//if(NEXT_TC_PACKET == 0)
-	//{
-		//NEXT_TC_PACKET = TC_BASE + 12;
-		//task_spimem_write(OBC_PACKET_ROUTER_ID, TC_BASE + 4, &NEXT_TC_PACKET, 4);
-	//}
-	//if(CURRENT_TC_PACKET == 0)
-	//{
-		//CURRENT_TC_PACKET = TC_BASE + 12;
-		//task_spimem_write(OBC_PACKET_ROUTER_ID, TC_BASE + 8, CURRENT_TC_PACKET, 4);
-	//}
+	open_stores();
 
 	/* Initialize variable used in PUS Packets */
 	version = 0;		// First 3 bits of the packet ID. (0 is default)
 	data_header = 1;	// Include the data field header in the PUS packet.
 	low_received = 0, high_received = 0;
 	new_tc_msg_high = 0, new_tc_msg_low = 0;
-	/* @non-terminating@ */	
-	for( ;; )
+	tm_next_time = xTaskGetTickCount();
+	deploy_time = xTaskGetTickCount();
+	return;
+}
+
+/************************************************************************/
+/* OPR_SERVE			                                                */
+/* @Purpose: One wake's worth of work other than the downlink. Sources	*/
+/* are served in priority order: TC chunks first since the COMS SSM		*/
+/* waits for a response to each one, then complete TCs, then requests	*/
+/* from other tasks.													*/
+/************************************************************************/
+static void opr_serve(void)
+{
+	uint8_t i;
+
+	receive_tc_msgs();
+	if((tm_store.base != TM_BASE) || (tc_store.base != TC_BASE))
+		open_stores();			// FDIR moved the regions (INTERNAL_MEMORY_FALLBACK_MODE).
+	if((antenna_deploy == 1) && ((TickType_t)(xTaskGetTickCount() - deploy_time) >= OPR_DEPLOY_WAIT))
 	{
-		if(!low_received)
-		{
-			if(xQueueReceive(tc_msg_fifo, &new_tc_msg_low, xTimeToWait) == pdTRUE)
-				low_received = 1;
-		}
-		if(low_received & !high_received)
+		send_can_command(0, 0, OBC_PACKET_ROUTER_ID, EPS_ID, DEP_ANT_COMMAND, DEF_PRIO);
+		if(xTaskGetTickCount() - time_of_deploy > DEPLOY_TIMEOUT)
 		{
-			if(xQueueReceive(tc_msg_fifo, &new_tc_msg_high, xTimeToWait) == pdTRUE)
-				high_received = 1;
+			send_can_command(0, 0, OBC_PACKET_ROUTER_ID, EPS_ID, DEP_ANT_OFF, DEF_PRIO);
+			antenna_deploy = 0;
 		}
-		if(high_received)		// Block on the TC_MSG_FIFO for a maximum of 10 ticks.
-		{
-			status = receive_tc_msg();					// FAILURE_RECOVERY if status == -1.
-		}
-		//if(TC_PACKET_COUNT && spimem_read(NEXT_TC_PACKET, tc_to_decode, PACKET_LENGTH) == PACKET_LENGTH)
-		//{
-			//TC_PACKET_COUNT--;
-			//spimem_write(TC_BASE, &TC_PACKET_COUNT, 4);		// FAILURE_RECOVERY
-			//NEXT_TC_PACKET += PACKET_LENGTH;
-			//if (NEXT_TC_PACKET > (TC_BASE + 0x20000))
-				//NEXT_TC_PACKET = TC_BASE + 12;
-			//spimem_write(TC_BASE + 4, &NEXT_TC_PACKET, 4);	// Update the position of the next packet		
-			//decode_telecommand();
-		//}
-		if(antenna_deploy == 1)
+		deploy_time = xTaskGetTickCount();
+	}
+	if(receiving_tcf)
+		return;
+	while(xQueueReceive(tc_buffer, tc_to_decode, (TickType_t)0) == pdTRUE)
+		decode_telecommand();
+	while(tc_store.count && (pus_store_get(&tc_store, tc_to_decode) > 0))	// FAILURE_RECOVERY
+	{
+		TC_PACKET_COUNT = tc_store.count;
+		decode_telecommand();
+	}
+	for(i = 0; i < OPR_REQUEST_BATCH; i++)
+	{
+		if(!exec_commands() || current_tm_fullf)
+			break;
+	}
+	return;
+}
+
+/************************************************************************/
+/* OPR_DOWNLINK			                                                */
+/* @Purpose: Refills the queue of stored TM and hands at most one TM	*/
+/* packet to COMS, if OPR_TM_PACE has passed since the last one.		*/
+/************************************************************************/
+static void opr_downlink(void)
+{
+	if(receiving_tcf)
+		return;
+	refill_stored_tm();
+	if((int32_t)(xTaskGetTickCount() - tm_next_time) < 0)
+		return;
+	if (tm_down_fullf)
+	{
+		send_pus_packet_tm(tm_to_downlink[150]);		// FAILURE_RECOVERY			
+	}
+	else if(tm_sched_get(&down_desc) == pdTRUE)
+	{
+		tm_to_downlink = pus_pool_buf(down_desc);
+		tm_down_fullf = 1;
+		send_pus_packet_tm(tm_to_downlink[150]);		// FAILURE_RECOVERY
+	}
+	if(tm_transfer_completef)
+	{
+		tm_next_time = xTaskGetTickCount() + OPR_TM_PACE;	// Give COMS time to downlink it.
+		tm_transfer_completef = 0;
+	}
+	return;
+}
+
+/************************************************************************/
+/* OPR_WAIT_TIME		                                                */
+/* @Purpose: Works out how long the task may block on opr_wake_sem.		*/
+/* New TCs and requests give the semaphore, so only the work which is	*/
+/* waiting on the clock needs a timeout.								*/
+/* @return: The number of ticks to block for.							*/
+/************************************************************************/
+static TickType_t opr_wait_time(void)
+{
+	TickType_t now = xTaskGetTickCount();
+	TickType_t wait = OPR_IDLE_WAIT;
+	int32_t due;
+
+	if(tm_down_fullf || current_tm_fullf || tm_sched_count() || tm_store.count)
+	{
+		due = (int32_t)(tm_next_time - now);
+		if(due <= 0)
+			wait = OPR_RETRY_WAIT;				// COMS didn't take the last packet.
+		else if((TickType_t)due < wait)
+			wait = (TickType_t)due;
+	}
+	if(antenna_deploy == 1)
+	{
+		due = (int32_t)OPR_DEPLOY_WAIT - (int32_t)(now - deploy_time);
+		if(due <= 0)
+			wait = 0;
+		else if((TickType_t)due < wait)
+			wait = (TickType_t)due;
+	}
+	return wait;
+}
+
+/************************************************************************/
+/* OPEN_STORES			                                                */
+/* @Purpose: Opens the TM and TC stores at TM_BASE and TC_BASE, what		*/
+/* was in them before a reset is picked up again.						*/
+/************************************************************************/
+static void open_stores(void)
+{
+	uint32_t size = OPR_STORE_SIZE;
+
+	if(INTERNAL_MEMORY_FALLBACK_MODE)
+		size = OPR_STORE_SIZE_FALLBACK;
+	pus_store_open(&tm_store, TM_BASE, size, OPR_TM_STORE_SAVE);		// FAILURE_RECOVERY
+	pus_store_open(&tc_store, TC_BASE, size, 0);						// FAILURE_RECOVERY
+	MAX_TM_PACKETS = tm_store.capacity;
+	TM_PACKET_COUNT = tm_store.count;
+	TC_PACKET_COUNT = tc_store.count;
+	return;
+}
+
+/************************************************************************/
+/* REFILL_STORED_TM		                                                */
+/* @Purpose: Reads packets back from the TM store into pool buffers		*/
+/* until the queue of TM_CLASS_STORED is full, so that the next one is	*/
+/* ready before the downlink asks for it.								*/
+/************************************************************************/
+static void refill_stored_tm(void)
+{
+	uint8_t desc;
+
+	while(tm_store.count && tm_sched_room(TM_CLASS_STORED))
+	{
+		desc = pus_pool_alloc(PUS_POOL_RESERVE, 0);
+		if(desc == PUS_POOL_NONE)
+			break;
+		if(pus_store_get(&tm_store, pus_pool_buf(desc)) <= 0)		// FAILURE_RECOVERY
 		{
-			send_can_command(0, 0, OBC_PACKET_ROUTER_ID, EPS_ID, DEP_ANT_COMMAND, DEF_PRIO);
-			if(xTaskGetTickCount() - time_of_deploy > DEPLOY_TIMEOUT)
-			{
-				send_can_command(0, 0, OBC_PACKET_ROUTER_ID, EPS_ID, DEP_ANT_OFF, DEF_PRIO);
-				antenna_deploy = 0;
-			}
-			xTimeToWait = 100; // Sleep task for 100 ticks.
-			xLastWakeTime = xTaskGetTickCount();		
+			pus_pool_release(desc);
+			break;
 		}
+		tm_sched_put(TM_CLASS_STORED, desc);
+	}
+	TM_PACKET_COUNT = tm_store.count;
+	return;
+}
 
-		if(!receiving_tcf)
+/************************************************************************/
+/* RECEIVE_TC_MSGS		                                                */
+/* @Purpose: Hands every TC chunk waiting in tc_msg_fifo to				*/
+/* receive_tc_msg(). Each chunk is two words, low then high.			*/
+/************************************************************************/
+static void receive_tc_msgs(void)
+{
+	for( ;; )
+	{
+		if(!low_received)
 		{
-			if(xQueueReceive(tc_buffer, tc_to_decode, (TickType_t)1) == pdTRUE)
-				decode_telecommand();
-			if (tm_down_fullf)
-			{
-				send_pus_packet_tm(tm_to_downlink[150]);		// FAILURE_RECOVERY			
-			}
-			else if(xQueueReceive(tm_buffer, tm_to_downlink, (TickType_t)1) == pdTRUE)
-			{
-				tm_down_fullf = 1;
-				send_pus_packet_tm(tm_to_downlink[150]);		// FAILURE_RECOVERY
-			}
-			if(tm_transfer_completef)
-			{
-				xTimeToWait = 3000; // Sleep task for 100 ticks.
-				xLastWakeTime = xTaskGetTickCount();				
-				vTaskDelayUntil(&xLastWakeTime, xTimeToWait);
-				tm_transfer_completef = 0;
-			}
-				
-		
-			//if (tm_down_fullf)
-			//{
-				//send_pus_packet_tm(tm_to_downlink[150]);		// FAILURE_RECOVERY			
-			//}
-			//else if(TM_PACKET_COUNT && (task_spimem_read(OBC_PACKET_ROUTER_ID, NEXT_TM_PACKET, tm_to_downlink, 152) > 0))
-			//{
-				//TM_PACKET_COUNT--;	// Update packet count.
-				//task_spimem_write(OBC_PACKET_ROUTER_ID, TM_BASE, &TM_PACKET_COUNT, 4);		// FAILURE_RECOVERY
-				//NEXT_TM_PACKET += 152;
-				//if (NEXT_TM_PACKET > (TM_BASE + 0x20000))
-					//NEXT_TM_PACKET = TM_BASE + 12;
-				//task_spimem_write(OBC_PACKET_ROUTER_ID, TM_BASE + 4, &NEXT_TM_PACKET, 4);	// Update the position of the next packet 
-				//tm_down_fullf = 1;
-				//send_pus_packet_tm(tm_to_downlink[150]);		// FAILURE_RECOVERY
-			//}	
-			exec_commands();
-
-
-			//vTaskDelayUntil(&xLastWakeTime, xTimeToWait);
+			if(xQueueReceive(tc_msg_fifo, &new_tc_msg_low, (TickType_t)0) != pdTRUE)
+				return;
+			low_received = 1;
 		}
+		if(xQueueReceive(tc_msg_fifo, &new_tc_msg_high, (TickType_t)0) != pdTRUE)
+			return;								// The CAN1 handler sends both words together.
+		high_received = 1;
+		receive_tc_msg();						// FAILURE_RECOVERY if status == -1.
 	}
 }
-/*-----------------------------------------------------------*/
-/* static helper functions below */
 
 /************************************************************************/
 /* EXEC_COMMANDS		                                                */
@@ -348,35 +538,48 @@ static void prvOBCPacketRouterTask( void *pvParameters )
 /* or tasks use to communicate with the OBC_PACKET_ROUTER. These are	*/
 /* used so that other PUS services and tasks can downlink telemetry		*/
 /* packets such as TC verification, event reports, or other	TM.			*/
+/* At most one request is taken from each FIFO.							*/
+/* @return: The number of requests which were taken.					*/
 /************************************************************************/
-static void exec_commands(void)
+static int exec_commands(void)
 {
+	uint8_t* request;
+	uint8_t command;
+	int handled = 0;
 	high = 0;
 	low = 0;
+	if(current_tm_fullf)
+		store_current_tm();		// Retry the packet which didn't fit in its TM queue last time.
 	clear_current_command();
-	if(xQueueReceive(hk_to_obc_fifo, current_command, (TickType_t)1) == pdTRUE)	// Check to see if there is a command from HK and execute it.
+	if(xQueueReceive(hk_to_obc_fifo, &request_desc, (TickType_t)0) == pdTRUE)	// Check to see if there is a command from HK and execute it.
 	{
-		packet_id = ((uint16_t)current_command[140]) << 8;
-		packet_id += (uint16_t)current_command[139];
-		psc = ((uint16_t)current_command[138]) << 8;
-		psc += (uint16_t)current_command[137];
-		if(current_command[146] == HK_REPORT)
+		handled++;
+		request = pus_pool_buf(request_desc);
+		command = request[146];			// The header may be written over the request.
+		packet_id = ((uint16_t)request[140]) << 8;
+		packet_id += (uint16_t)request[139];
+		psc = ((uint16_t)request[138]) << 8;
+		psc += (uint16_t)request[137];
+		if(command == HK_REPORT)
 		{
 			hk_telem_count++;
-			packetize_send_telemetry(HK_TASK_ID, HK_GROUND_ID, HK_SERVICE, HK_REPORT, hk_telem_count, 1, current_command);
+			packetize_send_telemetry(HK_TASK_ID, HK_GROUND_ID, HK_SERVICE, HK_REPORT, hk_telem_count, 1, request + PUS_POOL_DATA);
 		}
-		if(current_command[146] == HK_DEFINITON_REPORT)
+		if(command == HK_DEFINITON_REPORT)
 		{
 			hk_def_report_count++;
-			packetize_send_telemetry(HK_TASK_ID, HK_GROUND_ID, HK_SERVICE, HK_DEFINITON_REPORT, hk_def_report_count, 1, current_command);
+			packetize_send_telemetry(HK_TASK_ID, HK_GROUND_ID, HK_SERVICE, HK_DEFINITON_REPORT, hk_def_report_count, 1, request + PUS_POOL_DATA);
 		}
-		if(current_command[146] == TASK_TO_OPR_TCV)
+		if(command == TASK_TO_OPR_TCV)
 		{
-			send_tc_verification(packet_id, psc, current_command[145], current_command[144], 0, 2);		// Verify execution completion.
+			send_tc_verification(packet_id, psc, request[145], request[144], 0, 2);		// Verify execution completion.
 		}
+		pus_pool_release(request_desc);		// Unless the packet was built in it.
+		request_desc = PUS_POOL_NONE;
 	}
-	if(xQueueReceive(time_to_obc_fifo, current_command, (TickType_t)1) == pdTRUE)
+	if(xQueueReceive(time_to_obc_fifo, current_command, (TickType_t)0) == pdTRUE)
 	{
+		handled++;
 		packet_id = ((uint16_t)current_command[6]) << 8;
 		packet_id += (uint16_t)current_command[5];
 		psc = ((uint16_t)current_command[4]) << 8;
@@ -389,17 +592,30 @@ static void exec_commands(void)
 		if(current_command[9] == TASK_TO_OPR_TCV)
 		send_tc_verification(packet_id, psc, current_command[8], current_command[7], 0, 2);
 	}
-	if(xQueueReceive(mem_to_obc_fifo, current_command, (TickType_t)1) == pdTRUE)
+	/* Dump packets stay in mem_to_obc_fifo (and the memory task waits) while current_tm is occupied	*/
+	/* or while the dump queue is full.																	*/
+	if(!current_tm_fullf && (xQueuePeek(mem_to_obc_fifo, &request_desc, (TickType_t)0) == pdTRUE))
 	{
-		packet_id = ((uint16_t)current_command[140]) << 8;
-		packet_id += (uint16_t)current_command[139];
-		psc = ((uint16_t)current_command[138]) << 8;
-		psc += (uint16_t)current_command[137];
-		//if(current_command[146] == MEMORY_DUMP_ABS)
-		//{
-			//mem_dump_count++;
-			//packetize_send_telemetry(MEMORY_TASK_ID, MEM_GROUND_ID, MEMORY_SERVICE, MEMORY_DUMP_ABS, mem_dump_count, current_command[145], current_command);
-		//}
+		if((pus_pool_buf(request_desc)[146] == MEMORY_DUMP_ABS) && !tm_sched_room(TM_CLASS_DUMP))
+			request_desc = PUS_POOL_NONE;
+		else
+			xQueueReceive(mem_to_obc_fifo, &request_desc, (TickType_t)0);
+	}
+	if(request_desc != PUS_POOL_NONE)
+	{
+		handled++;
+		request = pus_pool_buf(request_desc);
+		command = request[146];
+		packet_id = ((uint16_t)request[140]) << 8;
+		packet_id += (uint16_t)request[139];
+		psc = ((uint16_t)request[138]) << 8;
+		psc += (uint16_t)request[137];
+		if(command == MEMORY_DUMP_ABS)
+		{
+			mem_dump_count++;
+			packetize_send_segment(MEMORY_TASK_ID, MEM_GROUND_ID, MEMORY_SERVICE, MEMORY_DUMP_ABS, mem_dump_count, request[145],
+									(((uint16_t)request[144]) << 8) | (uint16_t)request[143], request + PUS_POOL_DATA);
+		}
 		//if(current_command[146] == TASK_TO_OPR_TCV)
 			//send_tc_verification(packet_id, psc, current_command[145], current_command[144], 0, 2);
 		//if(current_command[146] == MEMORY_CHECK_ABS)
@@ -411,11 +627,13 @@ static void exec_commands(void)
 		//{
 			//send_event_packet(MEMORY_TASK_ID, current_command[145]);
 		//}
-		if(current_command[146] == DOWNLINKING_SCIENCE)
+		if(command == DOWNLINKING_SCIENCE)
 		{
 			science_packet_count++;
-			packetize_send_telemetry(MEMORY_TASK_ID, MEM_GROUND_ID, MEMORY_SERVICE, DOWNLINKING_SCIENCE, science_packet_count, 1, current_command);
+			packetize_send_telemetry(MEMORY_TASK_ID, MEM_GROUND_ID, MEMORY_SERVICE, DOWNLINKING_SCIENCE, science_packet_count, 1, request + PUS_POOL_DATA);
 		}
+		pus_pool_release(request_desc);
+		request_desc = PUS_POOL_NONE;
 	}
 	//if(xQueueReceive(sched_to_obc_fifo, current_command, (TickType_t)1) == pdTRUE)
 	//{
@@ -482,7 +700,7 @@ static void exec_commands(void)
 			//send_event_packet(EPS_TASK_ID, current_command[145]);
 		//}
 	//}
-	return;
+	return handled;
 }
 
 /************************************************************************/
@@ -507,7 +725,7 @@ static void exec_commands(void)
 /************************************************************************/
 static int packetize_send_telemetry(uint8_t sender, uint8_t dest, uint8_t service_type, uint8_t service_sub_type, uint8_t packet_sub_counter, uint16_t num_packets, uint8_t* data)
 {
-	uint16_t i, j;
+	uint16_t i;
 	type = 0;			// Distinguishes TC and TM packets, TM = 0
 	sequence_count = 0;
 	packet_error_control = 0;
@@ -523,12 +741,112 @@ static int packetize_send_telemetry(uint8_t sender, uint8_t dest, uint8_t servic
 		sequence_flags = 0x1;	// Indicates that this is the first packet in a series of packets.
 	else
 		sequence_flags = 0x3;	// Indicates that this is a standalone packet.
+
+	for(i = 0; i < num_packets; i++)
+	{
+		if(num_packets > 1)
+		{
+			if(i > 1)
+				sequence_flags = 0x0;			// Continuation packet
+			if(i == (num_packets - 1))
+				sequence_flags = 0x2;			// Last packet
+		}
+		if(tm_prepare(data + (i * 128)) < 0)
+			return (num_packets == 1) ? -1 : i;
+		write_tm_header(sender, dest, service_type, service_sub_type, packet_sub_counter, sequence_flags, sequence_count);
+		sequence_count++;
+		// The Packet Error Control (PEC) is put at the end of the packet, once the data is in.
+		packet_error_control = copy_tm_data(data + (i * 128));
+		current_tm[1] = (uint8_t)(packet_error_control >> 8);
+		current_tm[0] = (uint8_t)(packet_error_control & 0x00FF);
+		current_tm_fullf = 1;
+		if(store_current_tm() < 0)
+			return (num_packets == 1) ? -1 : i;
+	}
+	
+	return num_packets;
+}
+
+/************************************************************************/
+/* PACKETIZE_SEND_SEGMENT												*/
+/* @param: sender, dest, service_type, service_sub_type,				*/
+/* packet_sub_counter: See packetize_send_telemetry().					*/
+/* @param: seq_flags: SEQ_FLAG_FIRST, _CONT, _LAST or _STANDALONE.		*/
+/* @param: seq_count: 14-bit sequence count of this packet.				*/
+/* @param: *data: Array of 128 Bytes of data for the packet.			*/
+/* @purpose: Builds one packet of a multi-packet sequence which is		*/
+/* being produced by another task (ex: a memory dump), the sequence		*/
+/* flags and count are given instead of being worked out here.			*/
+/* @NOTE: If the dump queue is full the packet stays in current_tm		*/
+/* and is retried by exec_commands().									*/
+/* @return: -1 == Not stored (yet), 1 == success.						*/
+/************************************************************************/
+static int packetize_send_segment(uint8_t sender, uint8_t dest, uint8_t service_type, uint8_t service_sub_type, uint8_t packet_sub_counter, uint8_t seq_flags, uint16_t seq_count, uint8_t* data)
+{
+	type = 0;			// Distinguishes TC and TM packets, TM = 0
+	abs_time = ((uint16_t)absolute_time_arr[0]) << 12;	// DAY
+	abs_time |= ((uint16_t)absolute_time_arr[1]) << 8;	// HOUR
+	abs_time |= ((uint16_t)absolute_time_arr[2]) << 4;	// MINUTE
+	abs_time |= (uint16_t)absolute_time_arr[3];			// SECOND
+
+	if(tm_prepare(data) < 0)
+		return -1;
+	write_tm_header(sender, dest, service_type, service_sub_type, packet_sub_counter, seq_flags, seq_count);
+	packet_error_control = copy_tm_data(data);
+	current_tm[1] = (uint8_t)(packet_error_control >> 8);
+	current_tm[0] = (uint8_t)(packet_error_control & 0x00FF);
+	current_tm_fullf = 1;
+	if(store_current_tm() < 0)
+		return -1;
+	return 1;
+}
+
+/************************************************************************/
+/* TM_PREPARE															*/
+/* @param: *data: 128 Bytes of data for the next packet.				*/
+/* @purpose: Points current_tm at the pool buffer which the next packet	*/
+/* is built in. When data is the data field of the request which is		*/
+/* being handled, the packet is built around it in the same buffer.		*/
+/* Otherwise a free buffer is taken and copy_tm_data() fills it.		*/
+/* @return: -1 == current_tm is occupied or the pool is empty, 1 == ok.	*/
+/************************************************************************/
+static int tm_prepare(uint8_t* data)
+{
+	if(current_tm_fullf)
+		return -1;
+	if((request_desc != PUS_POOL_NONE) && (data == pus_pool_buf(request_desc) + PUS_POOL_DATA))
+	{
+		tm_desc = request_desc;				// The request's reference now belongs to current_tm.
+		request_desc = PUS_POOL_NONE;
+	}
+	else
+	{
+		tm_desc = pus_pool_alloc(0, 0);
+		if(tm_desc == PUS_POOL_NONE)
+			return -1;
+	}
+	current_tm = pus_pool_buf(tm_desc);
+	/* Bytes between the data and the header are zero, the request may still be sitting there. */
+	memset(current_tm + PUS_POOL_DATA + PUS_POOL_DATA_LENGTH, 0, 139 - (PUS_POOL_DATA + PUS_POOL_DATA_LENGTH));
+	return 1;
+}
+
+/************************************************************************/
+/* WRITE_TM_HEADER														*/
+/* @param: sender, dest, service_type, service_sub_type,				*/
+/* packet_sub_counter, seq_flags, seq_count: See						*/
+/* packetize_send_segment().											*/
+/* @purpose: Writes the packet header and data field header of			*/
+/* current_tm[] (bytes 139 to 151), abs_time must already be set.		*/
+/************************************************************************/
+static void write_tm_header(uint8_t sender, uint8_t dest, uint8_t service_type, uint8_t service_sub_type, uint8_t packet_sub_counter, uint8_t seq_flags, uint16_t seq_count)
+{
 	// Packet Header
 	version = 0;
 	current_tm[151] = ((version & 0x07) << 5) | ((type & 0x01) << 4) | (0x08);
 	current_tm[150] = sender;
-	current_tm[149] = (sequence_flags & 0x03) << 6;
-	current_tm[148] = sequence_count;
+	current_tm[149] = ((seq_flags & 0x03) << 6) | (uint8_t)((seq_count >> 8) & 0x3F);
+	current_tm[148] = (uint8_t)(seq_count & 0x00FF);
 	current_tm[147] = 0x00;
 	current_tm[146]	= PACKET_LENGTH - 1;	// Represents the length of the data field - 1.
 	version = 1;
@@ -540,57 +858,29 @@ static int packetize_send_telemetry(uint8_t sender, uint8_t dest, uint8_t servic
 	current_tm[141] = dest;
 	current_tm[140] = (uint8_t)((abs_time & 0xFF00) >> 8);
 	current_tm[139] = (uint8_t)(abs_time & 0x00FF);
-	// The Packet Error Control (PEC) is put at the end of the packet.
-	pec = fletcher16(current_tm + 2, 150);
-	current_tm[1] = (uint8_t)((pec & 0xFF00) >> 8);
-	current_tm[0] = (uint8_t)(pec & 0x00FF);
+	return;
+}
 
-	if(num_packets == 1)
-	{
-		sequence_count++;
-		for(j = 2; j < 130; j++)
-		{
-			current_tm[j] = *(data + (j - 2));
-		}
-		
-		/* Run checksum on the PUS packet	*/
-		packet_error_control = fletcher16(current_tm + 2, 150);
-		current_tm[1] = (uint8_t)(packet_error_control >> 8);
-		current_tm[0] = (uint8_t)(packet_error_control & 0x00FF);
-		current_tm_fullf = 1;
-		
-		if(store_current_tm() < 0)
-			return -1;
-		
-		return 1;
-	}
-	
-	for(i = 0; i < num_packets; i++)
+/************************************************************************/
+/* COPY_TM_DATA															*/
+/* @param: *data: 128 Bytes of data for the packet.						*/
+/* @purpose: Copies the data into current_tm[] and works out the PEC	*/
+/* in the same pass, the header (already in place) is folded in after.	*/
+/* Data which is already in current_tm[] (tm_prepare()) is not copied.	*/
+/* @return: The PEC of current_tm[2..151].								*/
+/************************************************************************/
+static uint16_t copy_tm_data(uint8_t* data)
+{
+	pus_pec_ctx_t ctx;
+	pus_pec_init(&ctx);
+	if(data == current_tm + PUS_POOL_DATA)
+		pus_pec_update(&ctx, current_tm + 2, PACKET_LENGTH - 2);
+	else
 	{
-		current_tm[148] = sequence_count;
-		sequence_count++;
-		
-		if(i > 1)
-			sequence_flags = 0x0;			// Continuation packet
-		if(i == (num_packets - 1))
-			sequence_flags = 0x2;			// Last packet
-		current_tm[149] = (sequence_flags & 0x03) << 6;
-		
-		for(j = 2; j < (PACKET_LENGTH - 13); j++)
-		{
-			current_tm[j] = *(data + (j - 2) + (i * 128));
-		}
-		
-		/* Run checksum on the PUS packet	*/
-		packet_error_control = fletcher16(current_tm + 2, 150);
-		current_tm[1] = (uint8_t)(packet_error_control >> 8);
-		current_tm[0] = (uint8_t)(packet_error_control & 0x00FF);
-		current_tm_fullf = 1;
-		if(store_current_tm() < 0)
-			return i;
+		pus_pec_copy(&ctx, current_tm + 2, data, 128);
+		pus_pec_update(&ctx, current_tm + 130, PACKET_LENGTH - 130);
 	}
-	
-	return num_packets;
+	return pus_pec_final(&ctx);
 }
 
 /************************************************************************/
@@ -652,13 +942,92 @@ static int receive_tc_msg(void)
 	}
 }
 
+#if (TM_TRANSFER_PROTOCOL == TM_TRANSFER_WINDOWED)
+/************************************************************************/
+/* SEND_PUS_PACKET_TM	                                                */
+/* @Purpose: This function breaks down the PUS packet into TM_FRAMES	*/
+/* frames of 7B which are placed into a telemetry buffer on the side of	*/
+/* the COMS SSM. Frames are sent TM_WINDOW at a time, after each window	*/
+/* the SSM reports which frames it has and the next window is made of	*/
+/* the frames which are still missing.									*/
+/* @Note: It is assumed that the PUS packet shall be located in			*/
+/* tm_to_downlink[], the pool buffer of down_desc						*/
+/* @Note: The frame format is described in can_func.h					*/
+/* @Note: DO NOT call this function from an ISR.						*/
+/************************************************************************/
+static int send_pus_packet_tm(uint8_t sender_id)
+{
+	uint32_t received, resp, frame, i;
+	uint8_t window[TM_WINDOW];
+	uint8_t n, header, *chunk;
+	
+	tm_transfer_completef = 0;
+	tm_tag = (tm_tag + 1) & TM_FRAME_TAG_MASK;
+	tm_transfer_reset();
+	for(timeout = 0; ; timeout++)
+	{
+		if(timeout == TM_START_TRIES)
+			return -1;
+		send_tc_can_command(0x00, 0x00, sender_id, COMS_ID, TM_PACKET_READY, COMMAND_PRIO);	// Let the SSM know that a TM packet is ready.
+		if(tm_wait_start(TM_START_WAIT))
+			break;
+	}
+	
+	received = 0;
+	timeout = 0;
+	while(received != TM_ALL_FRAMES)
+	{
+		n = 0;
+		for(frame = 0; (frame < TM_FRAMES) && (n < TM_WINDOW); frame++)	// The first frames which the SSM is missing.
+		{
+			if(!(received & (1UL << frame)))
+				window[n++] = (uint8_t)frame;
+		}
+		for(i = 0; i < n; i++)
+		{
+			chunk = tm_to_downlink + (window[i] * TM_FRAME_DATA);
+			header = (uint8_t)((tm_tag << TM_FRAME_TAG_SHIFT) | window[i]);
+			if(i == n - 1)
+				header |= TM_FRAME_ACKREQ;
+			low = (uint32_t)chunk[0] | ((uint32_t)chunk[1] << 8) | ((uint32_t)chunk[2] << 16) | ((uint32_t)chunk[3] << 24);
+			high = (uint32_t)header << 24;
+			if(window[i] < TM_FRAMES - 1)		// The last frame only holds the last 5B of the packet.
+				high |= (uint32_t)chunk[4] | ((uint32_t)chunk[5] << 8) | ((uint32_t)chunk[6] << 16);
+			else
+				high |= (uint32_t)chunk[4];
+			send_tm_frame(low, high);
+		}
+		if(!tm_wait_response(&resp, TM_RESP_WAIT))
+			resp = received;						// Lost frame or response, the window is sent again.
+		else if((resp >> 24) == TM_RESP_ABORT)
+			return -1;
+		else if(((resp >> 24) & TM_FRAME_TAG_MASK) != tm_tag)
+			resp = received;						// Meant for an earlier packet.
+		resp &= TM_ALL_FRAMES;
+		if((resp | received) == received)		// No progress.
+		{
+			if(++timeout == TM_RESP_TRIES)
+				return -1;
+		}
+		else
+			timeout = 0;
+		received |= resp;
+	}
+	
+	tm_transfer_completef = 1;
+	tm_down_fullf = 0;
+	pus_pool_release(down_desc);
+	down_desc = PUS_POOL_NONE;
+	return tm_transfer_completef;
+}
+#else
 /************************************************************************/
 /* SEND_PUS_PACKET_TM	                                                */
 /* @Purpose: This function breaks down the PUS packet into multiple CAN	*/
 /* messages that are sent in turn and then placed into a telemetry		*/
 /* buffer on the side of the SSM.										*/
 /* @Note: It is assumed that the PUS packet shall be located in			*/
-/* tm_to_downlink[] which is defined in this file						*/
+/* tm_to_downlink[], the pool buffer of down_desc						*/
 /* @Note: Instead on putting time in Byte 4, I'm going to use it for	*/
 /* sequence control so that the SSM can check to make sure that no		*/
 /* chunks of the packet were lost.										*/
@@ -718,9 +1087,12 @@ static int send_pus_packet_tm(uint8_t sender_id)
 	{
 		tm_transfer_completef = 1;
 		tm_down_fullf = 0;
+		pus_pool_release(down_desc);
+		down_desc = PUS_POOL_NONE;
 		return tm_transfer_completef;
 	}
 }
+#endif
 
 /************************************************************************/
 /* SEND_TC_TRANSACTION_RESPONSE	                                        */
@@ -782,33 +1154,21 @@ static void clear_current_command(void)
 /************************************************************************/
 /* STORE_CURRENT_TC			                                            */
 /* @Purpose: copies the contents of current_tc[] into the tc_buffer		*/
+/* or, when it is full, into the TC store in SPI memory. Once the store	*/
+/* has TCs in it, the later ones follow them there to keep the order.	*/
+/* @return: -1 == both were full and the TC was dropped.				*/
 /************************************************************************/
 static int store_current_tc(void)
 {
-	//uint8_t i, test = 0;
-	//if(TC_PACKET_COUNT == MAX_TM_PACKETS)
-		//return -1;
-	//if(TC_PACKET_COUNT == MAX_TM_PACKETS / 2)
-		//send_event_report(1, TC_BUFFER_HALF_FULL, 0, 0);
-	//for(i = 0; i < 152; i++)
-	//{
-		//test = current_tc[i];
-	//}
-	//
-	//if(spimem_write(CURRENT_TC_PACKET, current_tc, 152) != 152)
-		//return -1;
-		//
-	//TC_PACKET_COUNT++;
-	//spimem_write(TC_BASE, &TC_PACKET_COUNT, 4);
-//
-	//CURRENT_TC_PACKET += 152;
-	//if(CURRENT_TC_PACKET > (TC_BASE + 0x20000))
-		//CURRENT_TC_PACKET = TC_BASE + 12;
-	//spimem_write(TC_BASE + 8, &CURRENT_TC_PACKET, 4);
-	if(xQueueSendToBack(tc_buffer, current_tc, (TickType_t)1) != pdPASS)
+	if(tc_store.count || (xQueueSendToBack(tc_buffer, current_tc, (TickType_t)0) != pdPASS))
 	{
-		send_event_report(1, TC_BUFFER_FULL, 0, 0);		// FAILURE_RECOVERY
-		return -1;
+		if(pus_store_put(&tc_store, current_tc) < 0)
+		{
+			send_event_report(1, TC_BUFFER_FULL, 0, 0);		// FAILURE_RECOVERY
+			return -1;
+		}
+		pus_store_sync(&tc_store);		// FAILURE_RECOVERY, a TC is kept even if it is only in RAM.
+		TC_PACKET_COUNT = tc_store.count;
 	}
 	current_tc_fullf = 0;
 	return 1;
@@ -816,31 +1176,31 @@ static int store_current_tc(void)
 
 /************************************************************************/
 /* STORE_CURRENT_TM			                                            */
-/* @Purpose: copies the contents of current_tc[] into the tc_buffer		*/
+/* @Purpose: queues the descriptor of current_tm[] in the TM queue of	*/
+/* its class (tm_sched.c). A packet which the drop policy of its class	*/
+/* releases counts as stored. Event reports and HK which find their	*/
+/* queue full are copied to the TM store instead, if it has room.		*/
+/* The store holds ~71 minutes of HK, not a full orbit (pus_store.c).	*/
+/* @return: -1 == the queue refused it and it is still in current_tm.	*/
 /************************************************************************/
 static int store_current_tm(void)
 {
-	//if(TM_PACKET_COUNT == MAX_TM_PACKETS)
-		//return -1;
-	//if(TM_PACKET_COUNT == MAX_TM_PACKETS / 2)
-		//send_event_report(1, TM_BUFFER_HALF_FULL, 0, 0);
-		//
-	//TM_PACKET_COUNT++;
-	//spimem_write(TM_BASE, &TM_PACKET_COUNT, 4);		// FAILURE_RECOVERY
-	//
-	//CURRENT_TM_PACKET += 152;
-	//if(CURRENT_TM_PACKET > (TM_BASE + 0x20000))
-		//CURRENT_TM_PACKET = TM_BASE + 12;
-	//spimem_write(TM_BASE + 8, &CURRENT_TM_PACKET, 4);		// FAILURE_RECOVERY
-//
-	//if(spimem_write(CURRENT_TM_PACKET, current_tm, 152) < 0)					// FAILURE_RECOVERY
-		//return -1;
-	//current_tm_fullf = 0;
-	if(xQueueSendToBack(tm_buffer, current_tm, (TickType_t)1) != pdPASS)
+	uint8_t tm_class = tm_sched_class(current_tm);
+
+	if(tm_sched_overflow(tm_class) && (pus_store_put(&tm_store, current_tm) > 0))
+	{
+		TM_PACKET_COUNT = tm_store.count;
+		pus_pool_release(tm_desc);
+		current_tm_fullf = 0;
+		tm_desc = PUS_POOL_NONE;
+		return 1;
+	}
+	if(tm_sched_put(tm_class, tm_desc) == TM_SCHED_FULL)
 	{
 		return -1;										// FAILURE_RECOVERY
 	}
 	current_tm_fullf = 0;
+	tm_desc = PUS_POOL_NONE;
 	return 1;
 }
 
@@ -892,7 +1252,7 @@ static int decode_telecommand(void)
 	//}
 	
 	/* Check that the packet error control is correct		*/
-	pec0 = fletcher16(tc_to_decode + 2, 150);
+	pec0 = pus_pec(tc_to_decode + 2, 150);
 	/* Verify that the telecommand is ready to be decoded.	*/
 	
 	//attempts = 0; x = -1;
@@ -1205,7 +1565,7 @@ static int verify_telecommand(uint8_t apid, uint8_t packet_length, uint16_t pec0
 		
 		if(tc_to_decode[138] > 1)											// Invalid memory ID.
 			send_tc_verification(packet_id, psc, 0xFF, 5, 0x00, 1);
-		if((tc_to_decode[138] == 1) && (address > 0xFFFFF))				// Invalid memory address (too high)
+		if((tc_to_decode[138] == 1) && (address >= SPIMEM_LOGICAL_SIZE))	// Invalid memory address (too high)
 			send_tc_verification(packet_id, psc, 0xFF, 5, 0x00, 1);
 		if((tc_to_decode[138] == 1) && INTERNAL_MEMORY_FALLBACK_MODE && (address > 0x0FFF))		// Invalid memory address (too high for INT MEM FALLBACK MODE)
 			send_tc_verification(packet_id, psc, 0xFF, 5, 0x00, 1);			
@@ -1479,7 +1839,27 @@ uint32_t get_obc_variable(uint8_t parameter)
 			return eps_target_temp;
 		case EPS_TEMP_INTV:
 			return eps_temp_interval;
+		case SPIMEM_CACHE_HITS:
+			return spimem_cache_stat(SPIMEM_CACHE_STAT_HITS);
+		case SPIMEM_CACHE_MISSES:
+			return spimem_cache_stat(SPIMEM_CACHE_STAT_MISSES);
+		case SPIMEM_FLASH_SAVED:
+			return spimem_cache_stat(SPIMEM_CACHE_STAT_SAVED);
+		case SPIMEM_WASH_RATE:
+			return WASH_RATE;
+		case SPIMEM_UPSETS_1:
+			return SPI_UPSETS1;
+		case SPIMEM_UPSETS_2:
+			return SPI_UPSETS2;
+		case SPIMEM_UPSETS_3:
+			return SPI_UPSETS3;
+		case TM_STORE_COUNT:
+			return TM_PACKET_COUNT;
+		case TC_STORE_COUNT:
+			return TC_PACKET_COUNT;
 		default:
+			if((parameter <= TM_VERIFY_DEPTH) && (parameter >= TM_STORED_DROPS))		// Three per TM class.
+				return tm_sched_stat((TM_VERIFY_DEPTH - parameter) / 3, (TM_VERIFY_DEPTH - parameter) % 3);
 			return 0;
 	}
 	return 0;
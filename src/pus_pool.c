@@ -0,0 +1,181 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		pus_pool.c
+*
+*	PURPOSE:		Houses the pool of PUS packet buffers which telemetry is built in, along with the
+*					reference-counted descriptors which the FIFOs carry in place of whole packets.
+*
+*	FILE REFERENCES:		pus_pool.h, global_var.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	pus_pool_init() is called before the scheduler starts.
+*											DO NOT call these functions from an ISR.
+*
+*	NOTES:		A TM packet used to be copied into a 147B FIFO item by its producer, out of that FIFO
+*				by the packet router, into current_tm[], into tm_buffer and out again into
+*				tm_to_downlink[]. Now the producer takes a buffer from this pool, fills the data field
+*				in place and sends its one-byte descriptor. The router writes the PUS header around
+*				the data in the same buffer, and the descriptor is what goes into its TM queue
+*				(tm_sched.c).
+*
+*				A buffer is returned to the pool when its reference count drops to zero. Whoever
+*				sends a descriptor to a FIFO hands its reference over to the receiver.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created. An HK report is copied 132B instead of 863B on its way to COMS, and the
+*						TM path needs ~1kB less RAM (1824B of buffers for 3000B of FIFO items and packet
+*						arrays). It is not faster in packets/s (src/host/bench_pool.c).
+*
+*						pus_pool_send() gives opr_wake_sem.
+*
+*/
+
+#include <string.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "global_var.h"
+
+#include "pus_pool.h"
+
+/* Local variables for the PUS packet pool */
+static uint8_t pus_pool[PUS_POOL_SIZE][PACKET_LENGTH];
+static uint8_t pus_pool_refs[PUS_POOL_SIZE];
+static uint8_t pus_pool_free[PUS_POOL_SIZE];		// Stack of free descriptors.
+static uint8_t pus_pool_nfree;
+
+/************************************************************************/
+/* PUS_POOL_INIT														*/
+/* @Purpose: Puts every buffer on the free list.						*/
+/************************************************************************/
+void pus_pool_init(void)
+{
+	uint8_t i;
+	for(i = 0; i < PUS_POOL_SIZE; i++)
+	{
+		pus_pool_refs[i] = 0;
+		pus_pool_free[i] = (PUS_POOL_SIZE - 1) - i;
+	}
+	pus_pool_nfree = PUS_POOL_SIZE;
+	return;
+}
+
+/************************************************************************/
+/* PUS_POOL_ALLOC														*/
+/* @param: reserve: Number of buffers which must be left in the pool,	*/
+/* 0 for packets which are small or infrequent.							*/
+/* @param: ticks: How long to wait for a buffer to become free.			*/
+/* @Purpose: Takes a buffer from the pool and clears it, the caller		*/
+/* holds the only reference.											*/
+/* @return: The descriptor, PUS_POOL_NONE = no buffer was free.			*/
+/************************************************************************/
+uint8_t pus_pool_alloc(uint8_t reserve, TickType_t ticks)
+{
+	uint8_t desc;
+
+	for( ;; )
+	{
+		desc = PUS_POOL_NONE;
+		taskENTER_CRITICAL();
+		if(pus_pool_nfree > reserve)
+		{
+			desc = pus_pool_free[--pus_pool_nfree];
+			pus_pool_refs[desc] = 1;
+		}
+		taskEXIT_CRITICAL();
+		if((desc != PUS_POOL_NONE) || !ticks)
+			break;
+		ticks--;
+		vTaskDelay(1);
+	}
+	if(desc != PUS_POOL_NONE)
+		memset(pus_pool[desc], 0, PACKET_LENGTH);
+	return desc;
+}
+
+/************************************************************************/
+/* PUS_POOL_BUF															*/
+/* @param: desc: A descriptor returned by pus_pool_alloc().				*/
+/* @return: The 152B buffer which desc refers to.						*/
+/************************************************************************/
+uint8_t* pus_pool_buf(uint8_t desc)
+{
+	return pus_pool[desc];
+}
+
+/************************************************************************/
+/* PUS_POOL_RETAIN														*/
+/* @param: desc: A descriptor which the caller holds a reference to.	*/
+/* @Purpose: Adds a reference so that the buffer can be shared, each	*/
+/* reference is given back with pus_pool_release().						*/
+/************************************************************************/
+void pus_pool_retain(uint8_t desc)
+{
+	if(desc >= PUS_POOL_SIZE)
+		return;
+	taskENTER_CRITICAL();
+	pus_pool_refs[desc]++;
+	taskEXIT_CRITICAL();
+	return;
+}
+
+/************************************************************************/
+/* PUS_POOL_RELEASE														*/
+/* @param: desc: A descriptor which the caller holds a reference to,	*/
+/* PUS_POOL_NONE is ignored.											*/
+/* @Purpose: Drops a reference, the last one returns the buffer.		*/
+/************************************************************************/
+void pus_pool_release(uint8_t desc)
+{
+	if(desc >= PUS_POOL_SIZE)
+		return;
+	taskENTER_CRITICAL();
+	if(pus_pool_refs[desc] && !--pus_pool_refs[desc])
+		pus_pool_free[pus_pool_nfree++] = desc;
+	taskEXIT_CRITICAL();
+	return;
+}
+
+/************************************************************************/
+/* PUS_POOL_FREE_COUNT													*/
+/* @return: The number of buffers which are free right now.				*/
+/************************************************************************/
+uint8_t pus_pool_free_count(void)
+{
+	return pus_pool_nfree;
+}
+
+/************************************************************************/
+/* PUS_POOL_SEND														*/
+/* @param: fifo: A FIFO created with item size PUS_POOL_DESC_SIZE.		*/
+/* @param: desc: The descriptor to send, the caller's reference goes	*/
+/* with it.																*/
+/* @param: ticks: How long to wait for room in the FIFO.				*/
+/* @Purpose: Sends a descriptor, the buffer is released if the FIFO		*/
+/* stayed full so that it isn't lost to the pool. Descriptors always	*/
+/* travel to the packet router, so it is woken up.						*/
+/* @return: pdTRUE = sent, pdFALSE = dropped.							*/
+/************************************************************************/
+BaseType_t pus_pool_send(QueueHandle_t fifo, uint8_t desc, TickType_t ticks)
+{
+	if(desc == PUS_POOL_NONE)
+		return pdFALSE;
+	if(xQueueSendToBack(fifo, &desc, ticks) != pdTRUE)
+	{
+		pus_pool_release(desc);
+		return pdFALSE;
+	}
+	if(opr_wake_sem)
+		xSemaphoreGive(opr_wake_sem);
+	return pdTRUE;
+}
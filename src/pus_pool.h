@@ -0,0 +1,57 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		pus_pool.h
+*
+*	PURPOSE:		Houses the includes and definitions for pus_pool.c
+*
+*	FILE REFERENCES:		FreeRTOS.h, task.h, queue.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	None
+*
+*	NOTES:
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created
+*
+*/
+
+#ifndef PUS_POOL_H
+#define PUS_POOL_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#define PUS_POOL_SIZE			12			// Number of 152B packet buffers.
+#define PUS_POOL_NONE			0xFF		// Not a descriptor.
+#define PUS_POOL_DESC_SIZE		1			// Item size of the FIFOs which carry descriptors.
+#define PUS_POOL_RESERVE		2			// Buffers which bulk producers (memory dumps) leave for everyone else.
+
+/* Layout of a buffer while it travels from a producer to the packet router:
+ * [2..129]   Data field of the TM packet (PUS_POOL_DATA).
+ * [137..146] Request, at the same offsets as in the 147B command FIFOs (event reports, which
+ *            carry no data, also use [127..136]).
+ * The router reads the request and then writes the PUS header over [139..151] in place. */
+#define PUS_POOL_DATA			2
+#define PUS_POOL_DATA_LENGTH	128
+
+/*		Function Prototypes				*/
+void pus_pool_init(void);
+uint8_t pus_pool_alloc(uint8_t reserve, TickType_t ticks);									// API, BLOCKS FOR ticks
+uint8_t* pus_pool_buf(uint8_t desc);														// API
+void pus_pool_retain(uint8_t desc);															// API
+void pus_pool_release(uint8_t desc);														// API
+uint8_t pus_pool_free_count(void);															// API
+BaseType_t pus_pool_send(QueueHandle_t fifo, uint8_t desc, TickType_t ticks);				// API, BLOCKS FOR ticks
+
+#endif
@@ -0,0 +1,333 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		pus_store.c
+*
+*	PURPOSE:		Houses the store-and-forward rings which hold PUS packets in SPI memory (the TM
+*					and TC regions) when there is no room for them in RAM.
+*
+*	FILE REFERENCES:		pus_store.h, spimem.h, checksum.h, global_var.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	A store is only used by one task. DO NOT call these
+*											functions from an ISR.
+*
+*	NOTES:		Packets are appended to a RAM copy of the page which the tail is in, and SPI memory
+*				is only written once that page is full, so a page program carries 1.7 packets
+*				instead of one packet being written as 152B that straddle two pages. The head and
+*				tail are kept in the header page (pus_store.h), which is written after every page
+*				program. A packet which is only in the RAM page is lost on a reset unless
+*				pus_store_sync() was called after it.
+*
+*				The head is saved every store->save bytes read, so after a reset up to that many
+*				bytes may be read again, but never skipped: the ring is only reused up to the head
+*				in the header page.
+*
+*				Reads fetch PUS_STORE_PREFETCH pages at a time, so the next packet to downlink is
+*				usually in RAM already.
+*
+*				The FTL writes pages out of place, so rewriting the header page and the tail page
+*				costs one page program each and never a sector erase. The TM and TC regions bypass
+*				the page cache (spimem_cache.c), so the header never reaches SPI memory before the
+*				pages it points to.
+*
+*				Sizing: a 128kB region (OPR_STORE_SIZE) holds (131072 - 2 * 256) / 152 = 858 packets.
+*				Housekeeping alone is one packet per HK_LOOP_TIMEOUT (5s, housekeep.c), which is
+*				~1140 packets in a 95 minute orbit, so a full orbit without a pass does NOT fit:
+*				the store covers ~71 minutes of HK, less the event reports stored with it.
+*				When the ring is full pus_store_put() returns -1 and nothing in the store is
+*				overwritten, the packet goes back to the TM queue of its class (tm_sched.c), where
+*				HK drops its oldest packet (so the newest 3 are kept) and events drop the newest.
+*				What is lost is therefore the HK between ~71 minutes and the last 15 seconds
+*				before the next pass, the start of the gap is kept in the store.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*/
+
+#include <string.h>
+
+#include "global_var.h"
+
+#include "spimem.h"
+
+#include "checksum.h"
+
+#include "pus_store.h"
+
+static uint32_t pus_store_used(pus_store_t* store, uint32_t from, uint32_t to);
+static uint32_t pus_store_addr(pus_store_t* store, uint32_t offset);
+static int pus_store_save(pus_store_t* store);
+static int pus_store_flush(pus_store_t* store, uint32_t page);
+static int pus_store_read(pus_store_t* store, uint32_t offset, uint8_t* data, uint32_t size);
+
+/************************************************************************/
+/* PUS_STORE_OPEN														*/
+/* @param: store: The store to open.									*/
+/* @param: base: Logical SPI memory address of the region, page aligned.*/
+/* @param: size: Size of the region in bytes, at least 3 pages.			*/
+/* @param: save: Bytes which may be read before the head is saved		*/
+/* again, 0 = after every packet.										*/
+/* @Purpose: Picks up the packets which were stored before the last		*/
+/* reset. The store is emptied if its header page is not valid.			*/
+/* @return: The number of packets in the store, -1 == SPI memory failed.*/
+/************************************************************************/
+int pus_store_open(pus_store_t* store, uint32_t base, uint32_t size, uint32_t save)
+{
+	uint8_t header[PUS_STORE_HDR_SIZE];
+	uint32_t magic, ring, used;
+	uint16_t sum;
+
+	memset(store, 0, sizeof(pus_store_t));
+	store->base = base;
+	store->ring = size - PUS_STORE_PAGE;
+	store->save = save;
+	store->capacity = (store->ring - PUS_STORE_PAGE) / PACKET_LENGTH;	// One page is kept between the tail and the head.
+	memset(store->wpage, 0xFF, PUS_STORE_PAGE);
+
+	if(spimem_read(base, header, PUS_STORE_HDR_SIZE) < 0)
+		return -1;
+	memcpy(&magic, header + PUS_STORE_HDR_MAGIC, 4);
+	memcpy(&ring, header + PUS_STORE_HDR_RING, 4);
+	memcpy(&sum, header + PUS_STORE_HDR_SUM, 2);
+	memcpy(&store->seq, header + PUS_STORE_HDR_SEQ, 4);
+	memcpy(&store->head, header + PUS_STORE_HDR_HEAD, 4);
+	memcpy(&store->tail, header + PUS_STORE_HDR_TAIL, 4);
+	used = pus_store_used(store, store->head, store->tail);
+	if((magic != PUS_STORE_MAGIC) || (ring != store->ring) || (sum != fletcher16(header, PUS_STORE_HDR_SUM))
+		|| (store->head >= store->ring) || (store->tail >= store->ring) || (used % PACKET_LENGTH)
+		|| ((used / PACKET_LENGTH) > store->capacity))
+	{
+		store->head = 0;
+		store->tail = 0;
+		store->saved_head = 0;
+		store->flushed = 0;
+		if(pus_store_save(store) < 0)
+			return -1;
+		return 0;
+	}
+	store->saved_head = store->head;
+	store->flushed = store->tail;
+	store->count = used / PACKET_LENGTH;
+	/* The part of the tail page in front of the tail is still needed when the page is written again. */
+	if(store->tail % PUS_STORE_PAGE)
+	{
+		if(spimem_read(pus_store_addr(store, store->tail - (store->tail % PUS_STORE_PAGE)), store->wpage, store->tail % PUS_STORE_PAGE) < 0)
+			return -1;
+	}
+	return store->count;
+}
+
+/************************************************************************/
+/* PUS_STORE_PUT														*/
+/* @param: store: An open store.										*/
+/* @param: packet: PACKET_LENGTH bytes to append.						*/
+/* @Purpose: Appends a packet. SPI memory is written when this fills	*/
+/* the tail page, followed by the header page.							*/
+/* @return: 1 == stored, -1 == the store is full or SPI memory failed.	*/
+/************************************************************************/
+int pus_store_put(pus_store_t* store, uint8_t* packet)
+{
+	uint32_t offset = store->tail;
+	uint32_t left = PACKET_LENGTH;
+	uint32_t in_page, size;
+	int flushed = 0;
+
+	if(pus_store_used(store, store->saved_head, store->tail) + PACKET_LENGTH > store->ring - PUS_STORE_PAGE)
+	{
+		if((store->saved_head == store->head) || (pus_store_save(store) < 0))
+			return -1;
+		if(pus_store_used(store, store->saved_head, store->tail) + PACKET_LENGTH > store->ring - PUS_STORE_PAGE)
+			return -1;
+	}
+	while(left)
+	{
+		in_page = offset % PUS_STORE_PAGE;
+		size = PUS_STORE_PAGE - in_page;
+		if(size > left)
+			size = left;
+		memcpy(store->wpage + in_page, packet + (PACKET_LENGTH - left), size);
+		left -= size;
+		offset = (offset + size) % store->ring;
+		if(!(offset % PUS_STORE_PAGE))
+		{
+			if(pus_store_flush(store, (offset + store->ring - PUS_STORE_PAGE) % store->ring) < 0)
+				return -1;					// The tail hasn't moved, the packet can be put again.
+			memset(store->wpage, 0xFF, PUS_STORE_PAGE);
+			flushed = 1;
+		}
+	}
+	if(flushed)
+		store->flushed = (offset % PUS_STORE_PAGE) ? store->tail : offset;	// A packet which straddles the page isn't in SPI memory yet.
+	store->tail = offset;
+	store->count++;
+	if(flushed)
+		pus_store_save(store);				// FAILURE_RECOVERY, the old header still describes valid packets.
+	return 1;
+}
+
+/************************************************************************/
+/* PUS_STORE_GET														*/
+/* @param: store: An open store.										*/
+/* @param: packet: Where to put the oldest packet (PACKET_LENGTH bytes).*/
+/* @Purpose: Takes the oldest packet out of the store.					*/
+/* @return: 1 == a packet was read, 0 == the store is empty,			*/
+/* -1 == SPI memory failed.												*/
+/************************************************************************/
+int pus_store_get(pus_store_t* store, uint8_t* packet)
+{
+	if(!store->count)
+		return 0;
+	if(pus_store_read(store, store->head, packet, PACKET_LENGTH) < 0)
+		return -1;
+	store->head = (store->head + PACKET_LENGTH) % store->ring;
+	store->count--;
+	if(!store->save || (pus_store_used(store, store->saved_head, store->head) >= store->save))
+		pus_store_save(store);				// FAILURE_RECOVERY, the packet will be read again after a reset.
+	return 1;
+}
+
+/************************************************************************/
+/* PUS_STORE_SYNC														*/
+/* @param: store: An open store.										*/
+/* @Purpose: Writes the tail page as it is and then the header page, so	*/
+/* that every packet which has been put survives a reset.				*/
+/* @return: 1 == success, -1 == SPI memory failed.						*/
+/************************************************************************/
+int pus_store_sync(pus_store_t* store)
+{
+	if(store->flushed == store->tail)
+		return 1;
+	if(pus_store_flush(store, store->tail - (store->tail % PUS_STORE_PAGE)) < 0)
+		return -1;
+	store->flushed = store->tail;
+	return pus_store_save(store);
+}
+
+/************************************************************************/
+/* PUS_STORE_USED														*/
+/* @return: The number of bytes from stream offset from up to to.		*/
+/************************************************************************/
+static uint32_t pus_store_used(pus_store_t* store, uint32_t from, uint32_t to)
+{
+	return (to + store->ring - from) % store->ring;
+}
+
+/************************************************************************/
+/* PUS_STORE_ADDR														*/
+/* @return: The logical SPI memory address of a stream offset.			*/
+/************************************************************************/
+static uint32_t pus_store_addr(pus_store_t* store, uint32_t offset)
+{
+	return store->base + PUS_STORE_PAGE + offset;
+}
+
+/************************************************************************/
+/* PUS_STORE_SAVE														*/
+/* @Purpose: Writes the current head and the flushed tail to the header	*/
+/* page. When packets which were never flushed have been read, the		*/
+/* header says the store is empty.										*/
+/* @return: 1 == success, -1 == SPI memory failed.						*/
+/************************************************************************/
+static int pus_store_save(pus_store_t* store)
+{
+	uint8_t header[PUS_STORE_HDR_SIZE];
+	uint32_t magic = PUS_STORE_MAGIC;
+	uint32_t tail = store->flushed;
+	uint16_t sum;
+
+	if(pus_store_used(store, store->head, store->tail) < pus_store_used(store, store->flushed, store->tail))
+		tail = store->head;
+	store->seq++;
+	memcpy(header + PUS_STORE_HDR_MAGIC, &magic, 4);
+	memcpy(header + PUS_STORE_HDR_SEQ, &store->seq, 4);
+	memcpy(header + PUS_STORE_HDR_HEAD, &store->head, 4);
+	memcpy(header + PUS_STORE_HDR_TAIL, &tail, 4);
+	memcpy(header + PUS_STORE_HDR_RING, &store->ring, 4);
+	sum = fletcher16(header, PUS_STORE_HDR_SUM);
+	memcpy(header + PUS_STORE_HDR_SUM, &sum, 2);
+	if(spimem_write(store->base, header, PUS_STORE_HDR_SIZE) < 0)
+		return -1;
+	store->saved_head = store->head;
+	store->headers_written++;
+	return 1;
+}
+
+/************************************************************************/
+/* PUS_STORE_FLUSH														*/
+/* @param: page: Stream offset of the tail page.						*/
+/* @Purpose: Writes wpage[] to SPI memory as one whole page. Anything	*/
+/* prefetched from that page is dropped.								*/
+/* @return: 1 == success, -1 == SPI memory failed.						*/
+/************************************************************************/
+static int pus_store_flush(pus_store_t* store, uint32_t page)
+{
+	if(spimem_write(pus_store_addr(store, page), store->wpage, PUS_STORE_PAGE) < 0)
+		return -1;
+	if(store->rlen && (pus_store_used(store, store->rstart, page) < store->rlen))
+		store->rlen = 0;
+	store->pages_written++;
+	return 1;
+}
+
+/************************************************************************/
+/* PUS_STORE_READ														*/
+/* @param: offset: Stream offset to read from.							*/
+/* @param: data: Where to put what was read.							*/
+/* @param: size: Number of bytes to read.								*/
+/* @Purpose: Reads stored bytes. The tail page comes from wpage[], any	*/
+/* other page from rpage[], which is refilled with up to				*/
+/* PUS_STORE_PREFETCH whole pages when it doesn't have the page.		*/
+/* @return: 1 == success, -1 == SPI memory failed.						*/
+/************************************************************************/
+static int pus_store_read(pus_store_t* store, uint32_t offset, uint8_t* data, uint32_t size)
+{
+	uint32_t page, in_page, n, pages, tail_page;
+
+	tail_page = store->tail - (store->tail % PUS_STORE_PAGE);
+	while(size)
+	{
+		in_page = offset % PUS_STORE_PAGE;
+		page = offset - in_page;
+		n = PUS_STORE_PAGE - in_page;
+		if(n > size)
+			n = size;
+		if((store->tail % PUS_STORE_PAGE) && (page == tail_page))
+			memcpy(data, store->wpage + in_page, n);
+		else
+		{
+			if(!store->rlen || (pus_store_used(store, store->rstart, page) >= store->rlen))
+			{
+				/* Whole pages between here and the tail page, which have all been written. */
+				pages = pus_store_used(store, page, tail_page) / PUS_STORE_PAGE;
+				if(!pages)
+					return -1;					// Past the tail.
+				if(pages > PUS_STORE_PREFETCH)
+					pages = PUS_STORE_PREFETCH;
+				if(pages > (store->ring - page) / PUS_STORE_PAGE)
+					pages = (store->ring - page) / PUS_STORE_PAGE;		// Stop at the end of the ring.
+				if(spimem_read(pus_store_addr(store, page), store->rpage, pages * PUS_STORE_PAGE) < 0)
+				{
+					store->rlen = 0;
+					return -1;
+				}
+				store->rstart = page;
+				store->rlen = pages * PUS_STORE_PAGE;
+				store->pages_read += pages;
+			}
+			memcpy(data, store->rpage + pus_store_used(store, store->rstart, page) + in_page, n);
+		}
+		offset = (offset + n) % store->ring;
+		data += n;
+		size -= n;
+	}
+	return 1;
+}
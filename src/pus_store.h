@@ -0,0 +1,80 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		pus_store.h
+*
+*	PURPOSE:		Houses the includes and definitions for pus_store.c
+*
+*	FILE REFERENCES:		stdint.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	None
+*
+*	NOTES:
+*			Layout of a store region:
+*				Page 0:			Header page.
+*				Pages 1 - n:	Ring of packets, written as one stream of bytes (a packet may
+*								straddle two pages and the end of the ring).
+*
+*			Header page layout:
+*				[0..3]		PUS_STORE_MAGIC
+*				[4..7]		Sequence number, incremented every time the header is written.
+*				[8..11]		Head, stream offset of the oldest packet.
+*				[12..15]	Tail, stream offset just past the newest packet which is wholly in SPI memory.
+*				[16..19]	Size of the ring in bytes.
+*				[20..21]	Fletcher-16 of [0..19].
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created
+*
+*/
+
+#ifndef PUS_STORE_H
+#define PUS_STORE_H
+
+#include <stdint.h>
+
+#define PUS_STORE_PAGE			256
+#define PUS_STORE_PREFETCH		2			// Pages read ahead of the head in one SPI memory read.
+#define PUS_STORE_MAGIC			0x31545350	// "PST1"
+
+/* Header page layout */
+#define PUS_STORE_HDR_MAGIC		0
+#define PUS_STORE_HDR_SEQ		4
+#define PUS_STORE_HDR_HEAD		8
+#define PUS_STORE_HDR_TAIL		12
+#define PUS_STORE_HDR_RING		16
+#define PUS_STORE_HDR_SUM		20
+#define PUS_STORE_HDR_SIZE		22
+
+typedef struct
+{
+	uint32_t base;									// Logical SPI memory address of the header page.
+	uint32_t ring;									// Bytes in the ring (the region less the header page).
+	uint32_t save;									// Bytes which may be read before the head is saved, 0 = every packet.
+	uint32_t head, tail;							// Stream offsets of the oldest packet and just past the newest.
+	uint32_t saved_head;							// Head in the header page, the ring is only reused up to here.
+	uint32_t flushed;								// Tail in the header page.
+	uint32_t seq;
+	uint32_t rstart, rlen;							// Stream offset and length of what is in rpage[].
+	uint16_t count, capacity;						// Packets stored, packets which fit.
+	uint32_t pages_written, pages_read, headers_written;
+	uint8_t wpage[PUS_STORE_PAGE];					// Page which the tail is in, not yet written in full.
+	uint8_t rpage[PUS_STORE_PREFETCH * PUS_STORE_PAGE];	// Pages read ahead of the head.
+} pus_store_t;
+
+/*		Function Prototypes				*/
+int pus_store_open(pus_store_t* store, uint32_t base, uint32_t size, uint32_t save);		// API, BLOCKS ON SPI MEMORY
+int pus_store_put(pus_store_t* store, uint8_t* packet);										// API, BLOCKS ON SPI MEMORY
+int pus_store_get(pus_store_t* store, uint8_t* packet);										// API, BLOCKS ON SPI MEMORY
+int pus_store_sync(pus_store_t* store);														// API, BLOCKS ON SPI MEMORY
+
+#endif
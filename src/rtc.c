@@ -44,6 +44,12 @@
 	*
 	*	11/15/2015		K: I changed all the function headers to the proper format.
 	*
+	*	10/16/2026		Every access to the RTC now holds Spi0_Mutex. The RTC used to share SPI0 with the
+	*					memory chips without it, so it could cut into a stream read which was holding CS low
+	*					or lose its transfer while the DMAC was busy. Multi-register operations (rtc_get,
+	*					rtc_set, clearing the alarm flag) take the mutex once for the whole sequence.
+	*					rtc_get() returns -1 if SPI0 could not be used.
+	*
 	*	DESCRIPTION:	
 	*			
 	*					Provides the functionality to use the DS3234 as an external RTC using SPI. 
@@ -56,6 +62,15 @@
  */
 #include "rtc.h"
 
+static int rtc_take_spi(void);
+static void rtc_give_spi(void);
+static int rtc_transfer_h(uint16_t* message);
+static void rtc_set_addr_h(uint16_t addr, uint16_t val);
+static int rtc_get_addr_h(uint16_t addr);
+static void rtc_set_h(struct timestamp t);
+static void rtc_set_a2_h(void);
+static void rtc_clear_a2_flag_h(void);
+
 /************************************************************************/
 /* DECTOBCD			 		                                            */
 /* @Purpose: Decimal to binary code decimal conversion					*/
@@ -74,6 +89,47 @@ static uint8_t bcdtodec(uint8_t val)
 	return ((val / 16 * 10) + (val % 16));
 }
 
+/************************************************************************/
+/* RTC_TAKE_SPI		 		                                            */
+/* @Purpose: Acquires Spi0_Mutex for a group of RTC transfers. The RTC	*/
+/* shares SPI0 with the memory chips, so it must not cut into a stream	*/
+/* read or program which is holding CS low.								*/
+/* @return: 1 == SPI0 is ours, -1 == Spi0_Mutex could not be acquired.	*/
+/* @NOTE: Before the scheduler starts (rtc_init() from main) nothing	*/
+/* else can be using SPI0 and the mutex may not exist yet.				*/
+/************************************************************************/
+static int rtc_take_spi(void)
+{
+	if(xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+		return 1;
+	if(xSemaphoreTake(Spi0_Mutex, (TickType_t)RTC_SPI_TIMEOUT) == pdTRUE)
+		return 1;
+	return -1;
+}
+
+/************************************************************************/
+/* RTC_GIVE_SPI		 		                                            */
+/* @Purpose: Releases Spi0_Mutex after rtc_take_spi().					*/
+/************************************************************************/
+static void rtc_give_spi(void)
+{
+	if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+		xSemaphoreGive(Spi0_Mutex);
+	return;
+}
+
+/************************************************************************/
+/* RTC_TRANSFER_H	 		                                            */
+/* @Purpose: Sends one 16-bit word to the RTC and reads one back.		*/
+/* @param: message: Word to send, replaced by the word received.		*/
+/* @return: -1 == SPI0 refused the transfer, 1 == Success.				*/
+/* @NOTE: Only to be used while holding Spi0_Mutex (rtc_take_spi()).	*/
+/************************************************************************/
+static int rtc_transfer_h(uint16_t* message)
+{
+	return spi_master_transfer(message, 1, 1);		// Chip-Select 1.
+}
+
 /************************************************************************/
 /* RTC_INIT			 		                                            */
 /* @Purpose: Initializes the RTC by configuring the control register and*/
@@ -82,8 +138,6 @@ static uint8_t bcdtodec(uint8_t val)
 /************************************************************************/
 void rtc_init(uint16_t ctrl_reg_val)
 {	
-	rtc_set_creg(ctrl_reg_val);
-	
 	//attempts = 0; x = -1;
 	//while(attempts<3 && x<0){
 		
@@ -110,10 +164,13 @@ void rtc_init(uint16_t ctrl_reg_val)
 	initial_time.mon = 0x01;
 	initial_time.year = 0x00;
 	
-	rtc_set(initial_time);
-	
-	rtc_set_a2();
-	rtc_clear_a2_flag();
+	if(rtc_take_spi() < 0)
+		return;
+	rtc_set_addr_h(DS3234_CREG_WRITE, ctrl_reg_val);
+	rtc_set_h(initial_time);
+	rtc_set_a2_h();
+	rtc_clear_a2_flag_h();
+	rtc_give_spi();
 	return;
 }
 
@@ -123,19 +180,26 @@ void rtc_init(uint16_t ctrl_reg_val)
 /* @param: t: the time struct containing the new time/date to update to	*/
 /************************************************************************/
 void rtc_set(struct timestamp t)
+{
+	if(rtc_take_spi() < 0)
+		return;
+	rtc_set_h(t);
+	rtc_give_spi();
+	return;
+}
+
+static void rtc_set_h(struct timestamp t)
 {
 	uint8_t time_date[7] = { t.sec, t.minute, t.hour, t.wday, t.mday, t.mon, t.year };
     uint8_t i;
-	uint16_t volatile message, addr, data;
+	uint16_t addr, data;
 
     for (i = 0; i < 7; i++) 
 	{
 		// Convert data and prepare message to send
 		addr = i + 0x80;
 		data = dectobcd(time_date[i]);
-		
-		message = (addr << 8) | data;
-		spi_master_transfer(&message, 1, 1);	// Chip-Select 3.
+		rtc_set_addr_h(addr, data);
     }
 	return;
 }
@@ -145,25 +209,28 @@ void rtc_set(struct timestamp t)
 /* @Purpose: Retrieves the current time and date from the RTC.			*/
 /* @param: t: pointer to an empty timestamp struct that will contain	*/
 /* the values retrieved from the RTC.									*/
+/* @return: -1 == SPI0 could not be used (*t is unchanged), 1 == Success*/
 /************************************************************************/
-void rtc_get(struct timestamp *t)
+int rtc_get(struct timestamp *t)
 {	
     uint8_t time_date[7];        // second, minute, hour, day of week, day of month, month, year
-    uint8_t i, ret_val;
-    uint16_t message;
+    uint8_t i;
+	int ret_val;
 	
+	if(rtc_take_spi() < 0)
+		return -1;
     for (i = 0; i < 7; i++) 
 	{
-		// Message contains the register address then an empty byte to flush it out
-		message = i + 0x00;
-		message = message << 8;
-
-		spi_master_transfer(&message, 1, 1);	// Chip-Select 1.
-		
 		// Get the value flushed out of the register
-		ret_val = (uint8_t) message;
-		time_date[i] = bcdtodec(ret_val);	
+		ret_val = rtc_get_addr_h(i + 0x00);
+		if(ret_val < 0)
+		{
+			rtc_give_spi();
+			return -1;
+		}
+		time_date[i] = bcdtodec((uint8_t)ret_val);
     }
+	rtc_give_spi();
 
 	// Store values into timestamp provided
     t->sec = time_date[0];
@@ -173,7 +240,7 @@ void rtc_get(struct timestamp *t)
     t->mday = time_date[4];
     t->mon = time_date[5];
     t->year = time_date[6];
-	return;
+	return 1;
 }
 
 /************************************************************************/
@@ -184,25 +251,48 @@ void rtc_get(struct timestamp *t)
 /************************************************************************/
 void rtc_set_addr(uint16_t addr, uint16_t val)
 {
-	uint16_t volatile message = (addr << 8) | val;
-	spi_master_transfer(&message, 1, 1);	// Chip-Select 1.
+	if(rtc_take_spi() < 0)
+		return;
+	rtc_set_addr_h(addr, val);
+	rtc_give_spi();
+	return;
+}
+
+static void rtc_set_addr_h(uint16_t addr, uint16_t val)
+{
+	uint16_t message = (addr << 8) | val;
+	rtc_transfer_h(&message);
 	return;
 }
 
 /************************************************************************/
 /* RTC_GET_ADDR		 		                                            */
 /* @Purpose: Gets the value from a register								*/
-/* @return: val: value stored in specified register						*/
+/* @return: val: value stored in specified register (0 if SPI0 could	*/
+/* not be used)															*/
 /************************************************************************/
 uint8_t rtc_get_addr(uint16_t addr)
 {
-	uint8_t val;
-	uint16_t volatile message = (uint16_t) addr << 8;
-	
-	spi_master_transfer(&message, 1, 1);	// Chip-Select 1.
+	int val;
+
+	if(rtc_take_spi() < 0)
+		return 0;
+	val = rtc_get_addr_h(addr);
+	rtc_give_spi();
+	if(val < 0)
+		return 0;
+	return (uint8_t)val;
+}
+
+/* @return: -1 == SPI0 refused the transfer, otherwise the register value.	*/
+static int rtc_get_addr_h(uint16_t addr)
+{
+	// Message contains the register address then an empty byte to flush it out
+	uint16_t message = (uint16_t) addr << 8;
 	
-	val = (uint8_t) message;	
-	return val;
+	if(rtc_transfer_h(&message) < 0)
+		return -1;
+	return (uint8_t) message;
 }
 
 
@@ -264,16 +354,21 @@ uint8_t rtc_get_sreg(void)
 /* @Purpose: Sets the RTC Alarm 2 to trigger every minute				*/
 /************************************************************************/
 void rtc_set_a2(void)
+{
+	if(rtc_take_spi() < 0)
+		return;
+	rtc_set_a2_h();
+	rtc_give_spi();
+	return;
+}
+
+static void rtc_set_a2_h(void)
 {
 	uint8_t i;
-	uint16_t volatile buffer, message;
 	
 	for (i = 0; i <= 2; i++) 
 	{
-		buffer = i + 0x8B;
-
-		message = (buffer << 8) | 0x80;
-		spi_master_transfer(&message, 1, 1);	// Chip-Select 1.
+		rtc_set_addr_h(i + 0x8B, 0x80);
 	}
 	return;
 }
@@ -284,21 +379,37 @@ void rtc_set_a2(void)
 /************************************************************************/
 void rtc_reset_a2(void)
 {
-	rtc_set_creg(DS3234_INTCN | DS3234_A2IE);
-	rtc_clear_a2_flag();
+	if(rtc_take_spi() < 0)
+		return;
+	rtc_set_addr_h(DS3234_CREG_WRITE, DS3234_INTCN | DS3234_A2IE);
+	rtc_clear_a2_flag_h();
+	rtc_give_spi();
 	return;
 }
 
 /************************************************************************/
 /* RTC_CLEAR_A2_FLAG 		                                            */
 /* @Purpose: Clears the RTC Alarm 2 Flag								*/
+/* @NOTE: The status register is read and written back under a single	*/
+/* acquisition of Spi0_Mutex.											*/
 /************************************************************************/
 void rtc_clear_a2_flag(void)
 {
-	uint8_t reg_val;
-	reg_val = rtc_get_sreg() & ~DS3234_A2F;
-	
-	rtc_set_sreg(reg_val);
+	if(rtc_take_spi() < 0)
+		return;
+	rtc_clear_a2_flag_h();
+	rtc_give_spi();
+	return;
+}
+
+static void rtc_clear_a2_flag_h(void)
+{
+	int reg_val;
+
+	reg_val = rtc_get_addr_h(DS3234_SREG_READ);
+	if(reg_val < 0)
+		return;
+	rtc_set_addr_h(DS3234_SREG_WRITE, (uint8_t)reg_val & ~DS3234_A2F);
 	return;
 }
 
@@ -9,7 +9,7 @@
 	*
 	*	PURPOSE:	This file contains includes and definitions for rtc.c		
 	*
-	*	FILE REFERENCES:	spi_func.h
+	*	FILE REFERENCES:	spi_func.h, spimem.h, global_var.h, task.h
 	*
 	*	EXTERNAL VARIABLES:
 	*
@@ -29,6 +29,8 @@
 	*	11/07/2015		K:I am making a change to rtc_init so that we first check if there
 	*					is a time stored in SPI memory before proceeding to reset the RTC.
 	*
+	*	10/16/2026		Added RTC_SPI_TIMEOUT, rtc_get() now reports whether it could use SPI0.
+	*
 	*	DESCRIPTION:	
 	*					Includes and definitions for rtc.c	
 	*
@@ -37,6 +39,10 @@
 #include "spi_func.h"
 #include "spimem.h"
 #include "global_var.h"
+#include "task.h"
+
+/* Ticks to wait for Spi0_Mutex, a SPI memory batch can hold it for a few erases */
+#define RTC_SPI_TIMEOUT			500
 
 /*		Timestamp Struct			*/
 struct timestamp
@@ -69,7 +75,7 @@ struct timestamp
 /*			RTC API Functions		*/
 void rtc_init(uint16_t creg);
 void rtc_set(struct timestamp t);
-void rtc_get(struct timestamp *t);
+int rtc_get(struct timestamp *t);
 
 /*	Control/Status Register	Modifiers	*/
 void rtc_set_creg(uint16_t val);
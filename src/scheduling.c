@@ -44,6 +44,8 @@ Author: Keenan Burnett
 *
 * 01/10/2016        A: Added some more error reports for modify_schedule and FIFO.
 *
+* 10/16/2026		num_commands and the command about to be executed are read with the three SPI chips voted.
+*
 * DESCRIPTION:
 *
 */
@@ -152,7 +154,7 @@ TaskHandle_t scheduling( void )
 static void prvSchedulingTask( void *pvParameters )
 {
 	configASSERT( ( ( unsigned long ) pvParameters ) == SCHEDULING_PARAMETER );
-	task_spimem_read(SCHEDULING_TASK_ID, SCHEDULE_BASE, temp_arr, 4);			// FDIR implemented for spimem_read
+	task_spimem_read_voted(SCHEDULING_TASK_ID, SCHEDULE_BASE, temp_arr, 4);		// FDIR implemented for spimem_read
 	num_commands = ((uint32_t)temp_arr[3]) << 24;
 	num_commands = ((uint32_t)temp_arr[2]) << 16;
 	num_commands = ((uint32_t)temp_arr[1]) << 8;
@@ -449,7 +451,7 @@ static int check_schedule(void){
 	}
 	if(next_command_time <= CURRENT_TIME)						// from whatever command needs to be executed below, assume it is used for now.
 	{
-		task_spimem_read(SCHEDULING_TASK_ID, SCHEDULE_BASE + 4, command_array, 16);
+		task_spimem_read_voted(SCHEDULING_TASK_ID, SCHEDULE_BASE + 4, command_array, 16);	// About to be executed, vote the chips.
 		cID = ((uint16_t)command_array[7]) << 8;
 		cID += (uint16_t)command_array[8];
 		ret_val = exec_k_commands();
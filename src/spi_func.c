@@ -36,6 +36,10 @@
 	*						CS low. This has no impact on code up to this point which used 16-bit SPI and a length of 1.
 	*
 	*	03/27/2016			Fixing the function headers for this file.
+	*
+	*	10/16/2026			Transfers now go through the DMA controller (spi_dma_transfer(), spi_dma_transfer_async()).
+	*						spi_master_transfer(), spi_master_transfer_keepcslow() and spi_master_read() return -1
+	*						when the DMAC is busy with another transfer instead of silently dropping the data.
 	*						
 	*	DESCRIPTION:
 	*
@@ -48,6 +52,17 @@
 
 #include "spi_func.h"
 
+/* State of the DMA transfer which is currently in progress on SPI0 */
+static SemaphoreHandle_t spi_dma_done;				// Given by DMAC_Handler when an async transfer completes.
+static volatile uint8_t spi_dma_activef;
+static const uint8_t* spi_dma_tx_next;				// Next piece of tx_buf to hand to the DMAC (0 = send zeros).
+static uint8_t* spi_dma_rx_next;					// Next piece of rx_buf to hand to the DMAC (0 = discard).
+static volatile uint32_t spi_dma_remaining;			// Transfers which have not yet been handed to the DMAC.
+static uint8_t spi_dma_flags;
+static spi_dma_callback_t spi_dma_callback;
+static void* spi_dma_callback_arg;
+static uint16_t spi_dma_dummy_tx, spi_dma_dummy_rx;
+
 /// @cond 0
 /**INDENT-OFF**/
 #ifdef __cplusplus
@@ -184,99 +199,294 @@ static void spi_master_initialize(void)
 /* @param: size: Number of bytes in p_buf								*/
 /* @param: chip_sel: (0|1|2|3) determines which hardware chipselect is	*/
 /* being used. Each CS has it's own SPI settings.						*/
+/* @return: -1 = Usage error or the DMAC is busy (nothing was sent and	*/
+/* *p_buf is unchanged), 1 = Success.									*/
 /* @NOTE: CS will be kept low for the duration of these transfers.		*/
+/* @NOTE: This is now a wrapper around spi_dma_transfer().				*/
 /************************************************************************/
-void spi_master_transfer(void *p_buf, uint32_t size, uint8_t chip_sel)
+int spi_master_transfer(void *p_buf, uint32_t size, uint8_t chip_sel)
 {
-	uint32_t i = 0;
-	uint8_t pcs;
-	pcs = spi_get_pcs(chip_sel);
-	uint16_t data;
-	//uint8_t	timeout = 84;	// ~1us timeout for getting the read status back.
+	return spi_dma_transfer(p_buf, p_buf, size, chip_sel, 0);
+}
 
-	uint16_t *p_buffer;
+/************************************************************************/
+/* SPI_MASTER_TRANSFER_KEEP_CS_LOW		                                */
+/* @Purpose: Same as above, except that at the end CS is not driven high*/
+/************************************************************************/
+int spi_master_transfer_keepcslow(void *p_buf, uint32_t size, uint8_t chip_sel)
+{
+	return spi_dma_transfer(p_buf, p_buf, size, chip_sel, SPI_DMA_HOLD_CS);
+}
 
-	p_buffer = p_buf;
-	
-	if(size == 1)	// Only transfer a single message.
+/************************************************************************/
+/* SPI_MASTER_READ						                                */
+/* @Purpose: Sometimes it is desirable to simply read the incoming bytes*/
+/* on the SPI bus when 0 is transferred to the slave.					*/
+/* @return: -1 = Usage error or the DMAC is busy, 1 = Success.			*/
+/************************************************************************/
+int spi_master_read(void *p_buf, uint32_t size, uint32_t chip_sel)
+{
+	return spi_dma_transfer(0, p_buf, size, (uint8_t)chip_sel, SPI_DMA_HOLD_CS);
+}
+
+/************************************************************************/
+/* SPI_DMA_INITIALIZE					                                */
+/* @Purpose: Enables the DMA controller which is used to move data		*/
+/* between memory and SPI0 (SPI0 on the SAM3X has no PDC channel, the	*/
+/* DMAC hardware handshaking interfaces are used instead).				*/
+/************************************************************************/
+static void spi_dma_initialize(void)
+{
+	pmc_enable_periph_clk(ID_DMAC);
+	DMAC->DMAC_EN = 0;
+	DMAC->DMAC_GCFG = DMAC_GCFG_ARB_CFG_ROUND_ROBIN;
+	DMAC->DMAC_EN = DMAC_EN_ENABLE;
+	DMAC->DMAC_CHDR = (DMAC_CHDR_DIS0 << SPI_DMA_TX_CH) | (DMAC_CHDR_DIS0 << SPI_DMA_RX_CH);
+	DMAC->DMAC_EBCIDR = 0x003F3F3F;								// No DMAC interrupts until an async transfer asks for one.
+	(void)DMAC->DMAC_EBCISR;									// Reading the status register clears it.
+
+	if(!spi_dma_done)
+		spi_dma_done = xSemaphoreCreateBinary();
+
+	spi_dma_activef = 0;
+	spi_dma_remaining = 0;
+	NVIC_ClearPendingIRQ(DMAC_IRQn);
+	NVIC_EnableIRQ(DMAC_IRQn);
+	return;
+}
+
+/************************************************************************/
+/* SPI_DMA_START_CHUNK					                                */
+/* @Purpose: Programs the RX and TX channels for the next piece of the	*/
+/* current transfer (at most SPI_DMA_MAX_BTSIZE transfers) and starts	*/
+/* them. The RX channel is enabled first so that no byte is missed.		*/
+/************************************************************************/
+static void spi_dma_start_chunk(void)
+{
+	uint32_t chunk, rx_width, rx_elem_size;
+	DmacCh_num* tx_ch = &DMAC->DMAC_CH_NUM[SPI_DMA_TX_CH];
+	DmacCh_num* rx_ch = &DMAC->DMAC_CH_NUM[SPI_DMA_RX_CH];
+
+	chunk = spi_dma_remaining;
+	if(chunk > SPI_DMA_MAX_BTSIZE)
+		chunk = SPI_DMA_MAX_BTSIZE;
+
+	/* The TX side always writes half-words: a byte write to SPI_TDR would be replicated	*/
+	/* across the register and could set LASTXFER.											*/
+	if(spi_dma_flags & SPI_DMA_BYTES)
 	{
-		spi_write(SPI_MASTER_BASE, p_buffer[i], pcs, 1);
-		// The last parameter above tells SPI whether this is the last byte to be transferred.
-		/* Wait transfer done. */
-		while ((spi_read_status(SPI_MASTER_BASE) & SPI_SR_RDRF) == 0);
-		spi_read(SPI_MASTER_BASE, &data, &pcs);
-		p_buffer[i] = data;
-		return;
+		rx_width = DMAC_CTRLA_SRC_WIDTH_BYTE | DMAC_CTRLA_DST_WIDTH_BYTE;
+		rx_elem_size = 1;
 	}
-	
-	// Keep CS low for the duration of the transfer, set high @ end.
-	for (i = 0; i < (size - 1); i++) 
+	else
 	{
-		spi_write(SPI_MASTER_BASE, p_buffer[i], pcs, 0);	
-		/* Wait transfer done. */
-		while ((spi_read_status(SPI_MASTER_BASE) & SPI_SR_RDRF) == 0);
-		spi_read(SPI_MASTER_BASE, &data, &pcs);
-		p_buffer[i] = data;
-		delay_us(100);
+		rx_width = DMAC_CTRLA_SRC_WIDTH_HALF_WORD | DMAC_CTRLA_DST_WIDTH_HALF_WORD;
+		rx_elem_size = 2;
 	}
-	delay_us(100);
-	spi_write(SPI_MASTER_BASE, p_buffer[(size - 1)], pcs, 1);
-	/* Wait transfer done. */
-	while ((spi_read_status(SPI_MASTER_BASE) & SPI_SR_RDRF) == 0);
-	spi_read(SPI_MASTER_BASE, &data, &pcs);
-	p_buffer[(size - 1)] = data;
+
+	while(spi_read_status(SPI_MASTER_BASE) & SPI_SR_RDRF)		// Flush anything left in the receive register.
+		(void)SPI_MASTER_BASE->SPI_RDR;
+	(void)DMAC->DMAC_EBCISR;									// Clear stale completion flags.
+
+	/* SPI0_RDR --> rx_buf (or a dummy location if nobody wants the data)	*/
+	rx_ch->DMAC_SADDR = (uint32_t)&SPI_MASTER_BASE->SPI_RDR;
+	rx_ch->DMAC_DADDR = spi_dma_rx_next ? (uint32_t)spi_dma_rx_next : (uint32_t)&spi_dma_dummy_rx;
+	rx_ch->DMAC_DSCR = 0;
+	rx_ch->DMAC_CTRLA = DMAC_CTRLA_BTSIZE(chunk) | rx_width | DMAC_CTRLA_SCSIZE_CHK_1 | DMAC_CTRLA_DCSIZE_CHK_1;
+	rx_ch->DMAC_CTRLB = DMAC_CTRLB_SRC_DSCR_FETCH_DISABLE | DMAC_CTRLB_DST_DSCR_FETCH_DISABLE | DMAC_CTRLB_FC_PER2MEM_DMA_FC
+						| DMAC_CTRLB_SRC_INCR_FIXED | (spi_dma_rx_next ? DMAC_CTRLB_DST_INCR_INCREMENTING : DMAC_CTRLB_DST_INCR_FIXED);
+	rx_ch->DMAC_CFG = DMAC_CFG_SRC_PER(SPI_DMA_RX_HW_ID) | DMAC_CFG_SRC_H2SEL_HW | DMAC_CFG_SOD_ENABLE | DMAC_CFG_FIFOCFG_ASAP_CFG;
+
+	/* tx_buf (or zeros) --> SPI0_TDR. IEN is active low, only RX reports completion. */
+	tx_ch->DMAC_SADDR = spi_dma_tx_next ? (uint32_t)spi_dma_tx_next : (uint32_t)&spi_dma_dummy_tx;
+	tx_ch->DMAC_DADDR = (uint32_t)&SPI_MASTER_BASE->SPI_TDR;
+	tx_ch->DMAC_DSCR = 0;
+	tx_ch->DMAC_CTRLA = DMAC_CTRLA_BTSIZE(chunk) | DMAC_CTRLA_SRC_WIDTH_HALF_WORD | DMAC_CTRLA_DST_WIDTH_HALF_WORD | DMAC_CTRLA_SCSIZE_CHK_1 | DMAC_CTRLA_DCSIZE_CHK_1;
+	tx_ch->DMAC_CTRLB = DMAC_CTRLB_SRC_DSCR_FETCH_DISABLE | DMAC_CTRLB_DST_DSCR_FETCH_DISABLE | DMAC_CTRLB_FC_MEM2PER_DMA_FC
+						| (spi_dma_tx_next ? DMAC_CTRLB_SRC_INCR_INCREMENTING : DMAC_CTRLB_SRC_INCR_FIXED) | DMAC_CTRLB_DST_INCR_FIXED
+						| DMAC_CTRLB_IEN;
+	tx_ch->DMAC_CFG = DMAC_CFG_DST_PER(SPI_DMA_TX_HW_ID) | DMAC_CFG_DST_H2SEL_HW | DMAC_CFG_SOD_ENABLE | DMAC_CFG_FIFOCFG_ASAP_CFG;
+
+	/* Advance the bookkeeping before the channels start in case the ISR fires right away. */
+	spi_dma_remaining -= chunk;
+	if(spi_dma_tx_next)
+		spi_dma_tx_next += chunk * 2;
+	if(spi_dma_rx_next)
+		spi_dma_rx_next += chunk * rx_elem_size;
+
+	DMAC->DMAC_CHER = DMAC_CHER_ENA0 << SPI_DMA_RX_CH;
+	DMAC->DMAC_CHER = DMAC_CHER_ENA0 << SPI_DMA_TX_CH;
 	return;
 }
 
 /************************************************************************/
-/* SPI_MASTER_TRANSFER_KEEP_CS_LOW		                                */
-/* @Purpose: Same as above, except that at the end CS is not driven high*/
+/* SPI_DMA_SETUP						                                */
+/* @Purpose: Common set-up for blocking and asynchronous transfers.		*/
+/* Switches SPI0 to a fixed peripheral select so that the DMAC can write*/
+/* plain data into SPI_TDR while CS stays asserted for the whole		*/
+/* transfer (CSAAT), regardless of how many bytes are involved.			*/
+/* @NOTE: The channel is claimed inside a critical section so that two	*/
+/* tasks can't both see it free and program the DMAC at the same time.	*/
 /************************************************************************/
-void spi_master_transfer_keepcslow(void *p_buf, uint32_t size, uint8_t chip_sel)
+static int spi_dma_setup(const void* tx_buf, void* rx_buf, uint32_t size, uint8_t chip_sel, uint8_t flags)
 {
-	uint32_t i = 0;
-	uint8_t pcs;
-	pcs = spi_get_pcs(chip_sel);
-	uint16_t data;
-
-	uint16_t *p_buffer;
+	if(!size || (chip_sel > 3))
+		return -1;
 
-	p_buffer = p_buf;
-		
-	// Keep CS low for the duration of the transfer, keep low @ end.
-	for (i = 0; i < size; i++) 
+	enter_atomic();
+	if(spi_dma_activef)
 	{
-		spi_write(SPI_MASTER_BASE, p_buffer[i], pcs, 0);	
-		/* Wait transfer done. */
-		while ((spi_read_status(SPI_MASTER_BASE) & SPI_SR_RDRF) == 0);
-		spi_read(SPI_MASTER_BASE, &data, &pcs);
-		p_buffer[i] = data;
+		exit_atomic();
+		return -1;									// Another transfer is still running.
 	}
+	spi_dma_activef = 1;
+	exit_atomic();
+
+	spi_dma_tx_next = (const uint8_t*)tx_buf;
+	spi_dma_rx_next = (uint8_t*)rx_buf;
+	spi_dma_remaining = size;
+	spi_dma_flags = flags;
+	spi_dma_dummy_tx = 0;
+
+	spi_set_peripheral_chip_select_value(SPI_MASTER_BASE, spi_get_pcs(chip_sel));
+	spi_set_fixed_peripheral_select(SPI_MASTER_BASE);
+	return 1;
+}
+
+/************************************************************************/
+/* SPI_DMA_FINISH						                                */
+/* @Purpose: Ends the transfer, de-asserts CS unless the caller asked to*/
+/* hold it and restores variable peripheral select.						*/
+/************************************************************************/
+static void spi_dma_finish(void)
+{
+	if(!(spi_dma_flags & SPI_DMA_HOLD_CS))
+		spi_release_cs();
+	spi_dma_activef = 0;
 	return;
 }
 
 /************************************************************************/
-/* SPI_MASTER_READ						                                */
-/* @Purpose: Sometimes it is desirable to simply read the incoming bytes*/
-/* on the SPI bus when 0 is transferred to the slave.					*/
+/* SPI_RELEASE_CS						                                */
+/* @Purpose: De-asserts whichever chip select is currently being held	*/
+/* low after a transfer which used SPI_DMA_HOLD_CS.						*/
+/************************************************************************/
+void spi_release_cs(void)
+{
+	spi_set_lastxfer(SPI_MASTER_BASE);
+	spi_set_variable_peripheral_select(SPI_MASTER_BASE);
+	return;
+}
+
+/************************************************************************/
+/* SPI_DMA_TRANSFER						                                */
+/* @Purpose: Blocking full-duplex transfer on SPI0 using the DMAC.		*/
+/* @param: tx_buf: Data to send, 0 = send zeros.						*/
+/* @param: rx_buf: Where to put incoming data, 0 = discard it.			*/
+/* (tx_buf and rx_buf may be the same array)							*/
+/* @param: size: Number of transfers (not bytes) to perform.			*/
+/* @param: chip_sel: (0|1|2|3) hardware chip select to use.				*/
+/* @param: flags: SPI_DMA_HOLD_CS, SPI_DMA_BYTES (see spi_func.h).		*/
+/* @return: -1 = Usage error or the DMAC is busy, 1 = Success.			*/
+/* @NOTE: This function busy-waits on the channel status rather than	*/
+/* sleeping, so it may be used before the scheduler starts and inside	*/
+/* a critical section. The CPU no longer touches every byte though.		*/
 /************************************************************************/
-void spi_master_read(void *p_buf, uint32_t size, uint32_t chip_sel)
+int spi_dma_transfer(const void* tx_buf, void* rx_buf, uint32_t size, uint8_t chip_sel, uint8_t flags)
 {
-	uint32_t i;
-	uint8_t pcs;
-	pcs = spi_get_pcs(chip_sel);
-	uint16_t data;
-	uint16_t *p_buffer;
-	p_buffer = p_buf;
-
-	for (i = 0; i < size; i++)
+	if(spi_dma_setup(tx_buf, rx_buf, size, chip_sel, flags) < 0)
+		return -1;
+	spi_dma_callback = 0;
+
+	while(spi_dma_remaining)
 	{
-		spi_write(SPI_MASTER_BASE, 0, pcs, 0);
-		/* Wait transfer done. */
-		while ((spi_read_status(SPI_MASTER_BASE) & SPI_SR_RDRF) == 0);
-		spi_read(SPI_MASTER_BASE, &data, &pcs);
-		p_buffer[i] = (uint8_t)data;
+		spi_dma_start_chunk();
+		while(DMAC->DMAC_CHSR & (DMAC_CHSR_ENA0 << SPI_DMA_RX_CH));	// Wait for the last byte to arrive.
 	}
+
+	spi_dma_finish();
+	return 1;
+}
+
+/************************************************************************/
+/* SPI_DMA_TRANSFER_ASYNC				                                */
+/* @Purpose: Starts the same transfer as spi_dma_transfer() and returns	*/
+/* immediately. Completion is signalled from DMAC_Handler by calling	*/
+/* callback(arg, status) (if not 0) and by giving the semaphore that	*/
+/* spi_dma_wait() blocks on.											*/
+/* @return: -1 = Usage error or the DMAC is busy, 1 = Transfer started.	*/
+/* @NOTE: The buffers must stay valid until the transfer completes, and	*/
+/* the caller should hold Spi0_Mutex for the duration when talking to	*/
+/* SPI memory.															*/
+/************************************************************************/
+int spi_dma_transfer_async(const void* tx_buf, void* rx_buf, uint32_t size, uint8_t chip_sel, uint8_t flags, spi_dma_callback_t callback, void* arg)
+{
+	if(spi_dma_setup(tx_buf, rx_buf, size, chip_sel, flags) < 0)
+		return -1;
+	spi_dma_callback = callback;
+	spi_dma_callback_arg = arg;
+	xSemaphoreTake(spi_dma_done, (TickType_t)0);				// Make sure that the semaphore is empty.
+
+	spi_dma_start_chunk();
+	DMAC->DMAC_EBCIER = DMAC_EBCIER_BTC0 << SPI_DMA_RX_CH;
+	return 1;
+}
+
+/************************************************************************/
+/* SPI_DMA_WAIT							                                */
+/* @Purpose: Blocks the calling task until the asynchronous transfer	*/
+/* which is currently in progress has completed.						*/
+/* @param: timeout: Maximum number of ticks to block for.				*/
+/* @return: -1 = Timed out, 1 = Transfer complete.						*/
+/************************************************************************/
+int spi_dma_wait(TickType_t timeout)
+{
+	if(!spi_dma_activef)
+		return 1;
+	if(xSemaphoreTake(spi_dma_done, timeout) == pdTRUE)
+		return 1;
+	return -1;
+}
+
+/************************************************************************/
+/* SPI_DMA_BUSY							                                */
+/* @return: 1 if a DMA transfer on SPI0 is in progress, 0 otherwise.	*/
+/************************************************************************/
+uint32_t spi_dma_busy(void)
+{
+	return (uint32_t)spi_dma_activef;
+}
+
+/************************************************************************/
+/* DMAC_HANDLER							                                */
+/* @Purpose: Interrupt handler for the DMA controller. Starts the next	*/
+/* chunk of a long transfer, or finishes the transfer and notifies		*/
+/* whoever started it.													*/
+/************************************************************************/
+void DMAC_Handler(void)
+{
+	uint32_t status;
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	spi_dma_callback_t callback;
+
+	status = DMAC->DMAC_EBCISR;
+	if(!(status & (DMAC_EBCISR_BTC0 << SPI_DMA_RX_CH)))
+		return;
+
+	if(spi_dma_remaining)
+	{
+		spi_dma_start_chunk();
+		return;
+	}
+
+	DMAC->DMAC_EBCIDR = DMAC_EBCIDR_BTC0 << SPI_DMA_RX_CH;
+	callback = spi_dma_callback;
+	spi_dma_callback = 0;
+	spi_dma_finish();
+	if(callback)
+		callback(spi_dma_callback_arg, 1);
+	xSemaphoreGiveFromISR(spi_dma_done, &xHigherPriorityTaskWoken);
+	portEND_SWITCHING_ISR(xHigherPriorityTaskWoken);
 }
 
 uint16_t spi_retrieve_temp(void)
@@ -309,6 +519,7 @@ void spi_initialize(void)
 	//*reg_ptr |= 0x00BB;
 	//spi_slave_initialize();
 	spi_master_initialize();
+	spi_dma_initialize();
 
 	return;
 }
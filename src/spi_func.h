@@ -7,7 +7,7 @@
 	*	PURPOSE:		Serial peripheral interface function for the ATSAM3X8E.
 	*	
 	*
-	*	FILE REFERENCES:		asf.h, stdio_serial.h, conf_board.h, conf_clock.h, conf_spi.h, pio.h
+	*	FILE REFERENCES:		asf.h, stdio_serial.h, conf_board.h, conf_clock.h, conf_spi.h, pio.h, atomic.h
 	*
 	*	EXTERNAL VARIABLES:	
 	*
@@ -50,6 +50,9 @@
 #include "pio.h"
 #include "gpio.h"
 #include "time.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "atomic.h"
 
 /* SPI clock frequency (Hz) */
 #define SPI_CLK_FREQ 4000000
@@ -135,14 +138,37 @@ struct status_block_t {
 	uint32_t ul_cmd_list[NB_STATUS_CMD];
 };
 
+/* DMAC channels and hardware handshaking interfaces used by SPI0. */
+#define SPI_DMA_TX_CH		0
+#define SPI_DMA_RX_CH		1
+#define SPI_DMA_TX_HW_ID	1		// DMAC hardware interface for SPI0_TX.
+#define SPI_DMA_RX_HW_ID	2		// DMAC hardware interface for SPI0_RX.
+
+/* Largest number of transfers handed to the DMAC in one buffer transfer. */
+#define SPI_DMA_MAX_BTSIZE	4095
+
+/* Flags for spi_dma_transfer() and spi_dma_transfer_async(). */
+#define SPI_DMA_HOLD_CS		0x01	// Leave CS asserted when the transfer completes (more data follows).
+#define SPI_DMA_BYTES		0x02	// rx_buf is a uint8_t array instead of the usual uint16_t array (tx_buf is always uint16_t).
+
+/* Completion callback for asynchronous transfers, called from DMAC_Handler.	*/
+/* status: 1 = Success, -1 = Failure.											*/
+typedef void (*spi_dma_callback_t)(void* arg, int status);
+
 /* SPI clock configuration. */
 static const uint32_t gs_ul_clock_configurations[] =
 { 500000, 1000000, 2000000, 5000000 };
 
 void SPI_Handler(void);
-void spi_master_transfer(void *p_buf, uint32_t size, uint8_t chip_sel);
-void spi_master_transfer_keepcslow(void *p_buf, uint32_t size, uint8_t chip_sel);
-void spi_master_read(void *p_buf, uint32_t size, uint32_t chip_sel);
+void DMAC_Handler(void);
+int spi_master_transfer(void *p_buf, uint32_t size, uint8_t chip_sel);
+int spi_master_transfer_keepcslow(void *p_buf, uint32_t size, uint8_t chip_sel);
+int spi_master_read(void *p_buf, uint32_t size, uint32_t chip_sel);
 uint16_t spi_retrieve_temp(void);
+int spi_dma_transfer(const void* tx_buf, void* rx_buf, uint32_t size, uint8_t chip_sel, uint8_t flags);
+int spi_dma_transfer_async(const void* tx_buf, void* rx_buf, uint32_t size, uint8_t chip_sel, uint8_t flags, spi_dma_callback_t callback, void* arg);
+int spi_dma_wait(TickType_t timeout);
+uint32_t spi_dma_busy(void);
+void spi_release_cs(void);
 
 #endif
@@ -59,6 +59,55 @@
 *	11/07/2015			I am changing spimem_write so that it writes to all 3 SSMs (one after the other).
 *						That way the user of this API function doesn't have to worry about spi_chip numbers or executing it 3 times.
 *
+*	10/16/2026			Added spimem_read_stream() and spimem_read_stream_cb(). Reads of more than a page used to
+*						be done one page at a time, re-sending RD + address and re-taking Spi0_Mutex for each one.
+*						These issue a single RD command and clock out any length within one chip-select window
+*						(the _cb version hands the data to a callback in chunks as it arrives).
+*
+*						spimem_read, spimem_write and the stream reads now go through the flash translation
+*						layer in spimem_ftl.c and take LOGICAL addresses (0x00000 - 0xBFFFF). Dirty-page
+*						rewrites no longer load, erase and re-write the whole 4kB sector. The functions which
+*						take a spi_chip (spimem_read_alt, spimem_write_h) still work on PHYSICAL addresses.
+*
+*						erase_spimem() now sends WREN before CE and erases every healthy chip, not just chip 2.
+*
+*						Added spimem_program_all_h() and spimem_erase_all_h(). Redundant writes used to pay for
+*						each chip's program/erase time in series, now the command goes to every healthy chip
+*						back-to-back and the WIP bits are polled together. Chips which fail are dropped from
+*						service (SPI_HEALTHx = 0) and reported to FDIR once Spi0_Mutex is released.
+*						Fixed the sector math in update_spibuffer_with_new_page() and set_sector_clean_in_bitmap().
+*
+*						Once the scheduler is running, spimem_read() and spimem_write() hand their request to the
+*						SPI memory server task (spimem_server.c) and sleep until it is done, instead of failing
+*						whenever SPI0 was busy for more than a tick. Fixed the missing breaks and uninitialized
+*						attempt counter in task_spimem_write() and task_spimem_read().
+*
+*						Flash operations no longer run inside enter_atomic(). Spi0_Mutex already serializes
+*						access to the chips, and a sector erase used to keep interrupts (CAN included) and the
+*						tick disabled for up to 300ms. Long waits on WIP now put the calling task to sleep.
+*						get_spimem_status() used to return without leaving its critical section.
+*
+*						spimem_initialize() no longer chip-erases (up to 7s per chip) at every reset. The bitmap
+*						used to start out all clean even though the chips were not erased, it is now rebuilt
+*						by spimem_ftl_mount_h().
+*
+*						spimem_read(), spimem_write() and the server go through a write-back page cache
+*						(spimem_cache.c). Stream reads bypass it after writing back the dirty pages they cover.
+*
+*						Added spimem_read_voted() and task_spimem_read_voted(), which majority-vote the three
+*						chips word by word (spimem_read_voted_h()). Outvoted pages are queued for repair.
+*
+*						Added spimem_repair_page_h(), which the memory wash uses to fix an outvoted page with at
+*						most one sector rewrite per chip (or none, when the upsets only turned 0s into 1s).
+*
+*						Added spimem_erase(), a logical erase of a region (the FTL unmaps whole pages).
+*
+*						A transfer which SPI0 refuses (the DMAC is still busy) now fails the command instead of
+*						being ignored. get_spimem_status_h() reports such a chip as busy.
+*
+*						Stream reads go through the SPI memory server while it runs, like spimem_read(). They
+*						used to take Spi0_Mutex for a single tick and fail whenever the server held it.
+*
 *
 *	DESCRIPTION:
 *
@@ -68,12 +117,18 @@
 *
 */
 
+#include <string.h>
 #include "spimem.h"
 #include "error_handling.h"
 
 static uint8_t get_spimem_status_h(uint32_t spi_chip);
 static uint32_t write_page_h(uint8_t spi_chip, uint32_t addr, uint8_t* data_buff, uint32_t size);
 static uint32_t ready_for_command_h(uint32_t spi_chip);
+static uint8_t spimem_wait_all_h(uint8_t chip_mask, uint32_t rounds);
+static int task_spimem_read_mode(uint8_t task, uint32_t addr, uint8_t* read_buff, uint32_t size, uint8_t voted);
+
+static volatile uint8_t spimem_failed_chips;		// Chips dropped by a redundant operation, not yet reported.
+static uint32_t spimem_vote_buff[3][64];			// One page per chip for spimem_read_voted_h(), word-aligned.
 
 /************************************************************************/
 /* SPIMEM_INITIALIZE                                                    */
@@ -98,19 +153,22 @@ void spimem_initialize(void)
 	if (ready_for_command_h(2) != 1)
 		errorASSERT(SPIMEM_SENDER_ID, 0, SPIMEM_BUSY_CHIP_ERROR, spi_mem_buff, 0);
 
+	for (i = 0; i < 128; i++)
+	{
+		spi_bit_map[i] = 0;				// Initialize the bitmap
+	}
+
 	if(ERASE_SPIMEM_ON_RESET)
 	{	
-		if(erase_spimem() < 0)
+		if(spimem_ftl_format_h() < 0)	// Erases the chips and starts an empty log.
 			errorASSERT(SPIMEM_SENDER_ID, 0, SPIMEM_CHIP_ERASE_ERROR, spi_mem_buff, 0);
 	}
+	else if(spimem_ftl_mount_h() < 0)	// Rebuild the logical-->physical map and the bitmap from the chips.
+		errorASSERT(SPIMEM_SENDER_ID, 0, SPIMEM_BUSY_CHIP_ERROR, spi_mem_buff, 0);
+	spimem_cache_invalidate_h(0, SPIMEM_LOGICAL_SIZE);
 
 	if (ready_for_command_h(2) != 1)
 		errorASSERT(SPIMEM_SENDER_ID, 0, SPIMEM_BUSY_CHIP_ERROR, spi_mem_buff, 0);
-							
-	for (i = 0; i < 128; i++)
-	{
-		spi_bit_map[i] = 0;				// Initialize the bitmap
-	}
 
 	for (i = 0; i < 4096; i++)
 	{
@@ -131,17 +189,40 @@ int erase_spimem(void)
 		}
 		return 1;
 	}
-	uint32_t timeout = 1500;
-	spi_master_transfer(dumbuf, 1, 2);	// Chip-Erase (this operation can take up to 7s for each chip)
-	while((check_if_wip(2) != 0) && timeout--){delay_ms(10);}
-	if((check_if_wip(2) != 0) || !timeout)
+	uint32_t spi_chip;
+	uint8_t chip_mask = spimem_chip_mask(), started = 0;
+	for (spi_chip = 1; spi_chip < 4; spi_chip++)
+	{
+		if(!(chip_mask & (1 << (spi_chip - 1))))
+			continue;
+		if(ready_for_command_h(spi_chip) != 1)		// Chip-Erase is ignored without WREN.
+			return -1;
+		dumbuf[0] = CE;
+		if(spi_master_transfer(dumbuf, 1, (uint8_t)spi_chip) < 0)	// Chip-Erase (this operation can take up to 7s for each chip)
+			return -1;
+		started |= (1 << (spi_chip - 1));
+	}
+	if(spimem_wait_all_h(started, 150000))			// All of the chips erase at the same time, ~15s timeout.
 		return -1;
 	return 1;
 }
 
-// ret > 0 == nunmber of bytes which were successfully written to memory.
-// ret < 0 ==  failure code which should be given to the FDIR task. -1 = All SPI Chips are dead.
-/* @NOTE: Writes a maximum of 256 bytes									*/
+/************************************************************************/
+/* SPIMEM_WRITE                                                         */
+/*																		*/
+/* @param: addr: Logical address to write to (0x00000 - 0xBFFFF).		*/
+/* @param: *data_buff: Contains the data to be written to memory.		*/
+/* @param: size: Length of the aforementioned buffer.					*/
+/* @return: ret > 0 == number of bytes which were successfully written	*/
+/* to memory. ret < 0 ==  failure code which should be given to the		*/
+/* FDIR task. -1 = All SPI Chips are dead or SPI0 is busy.				*/
+/* @purpose: Writes through the flash translation layer (spimem_ftl.c),	*/
+/* which keeps all of the healthy chips identical. Rewriting part of a	*/
+/* page costs a single page program rather than a sector erase.			*/
+/* @NOTE: This function first attempts to acquire the mutex for SPI0	*/
+/* it will block for a maximum of 1 Tick, if SPI0 is still occupied		*/
+/* after that, the function returns -1.									*/
+/************************************************************************/
 int spimem_write(uint32_t addr, uint8_t* data_buff, uint32_t size)
 {
 	int x = -1;
@@ -156,22 +237,55 @@ int spimem_write(uint32_t addr, uint8_t* data_buff, uint32_t size)
 	}
 	if(!SPI_HEALTH1 && ! SPI_HEALTH2 && !SPI_HEALTH3)
 		return -1;
-	if(SPI_HEALTH1)
+	if(spimem_server_running())
+		return spimem_server_request(SPIMEM_OP_WRITE, SPIMEM_PRIO_LOW, addr, data_buff, size, (TickType_t)SPIMEM_SERVER_TIMEOUT);
+	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 1) == pdTRUE)	// Only Block for a single tick.
 	{
-		x = spimem_write_h(1, addr, data_buff, size);
-		if(x < 0)
-			return x;		
+		x = spimem_cache_write_h(addr, data_buff, size);
+		xSemaphoreGive(Spi0_Mutex);
+		spimem_report_failed_chips();
 	}
-	if(SPI_HEALTH2)
+	return x;
+}
+
+/************************************************************************/
+/* SPIMEM_ERASE                                                         */
+/*																		*/
+/* @param: addr: Logical address of the first byte to erase.			*/
+/* @param: size: Number of bytes to erase.								*/
+/* @return: -1 == Failure, otherwise the number of bytes erased.		*/
+/* @purpose: Logical erase, the region reads back as 0xFF afterwards.	*/
+/* Whole pages are only unmapped by the FTL (no sector erase), so this	*/
+/* is the cheap way to clear a region before rewriting all of it.		*/
+/* @NOTE: This function first attempts to acquire the mutex for SPI0	*/
+/* it will block for a maximum of 1 Tick, if SPI0 is still occupied		*/
+/* after that, the function returns -1.									*/
+/************************************************************************/
+int spimem_erase(uint32_t addr, uint32_t size)
+{
+	int x = -1;
+	uint32_t i;
+	if(INTERNAL_MEMORY_FALLBACK_MODE)
 	{
-		x = spimem_write_h(2, addr, data_buff, size);
-		if(x < 0)
-			return x;	
+		for(i = 0; i < size; i++)
+		{
+			spi_mem_buff[addr + i] = 0xFF;
+		}
+		return size;
 	}
-	if(SPI_HEALTH3)
+	if(!SPI_HEALTH1 && ! SPI_HEALTH2 && !SPI_HEALTH3)
+		return -1;
+	if(spimem_server_running())
+		return spimem_server_request(SPIMEM_OP_ERASE, SPIMEM_PRIO_LOW, addr, 0, size, (TickType_t)SPIMEM_SERVER_TIMEOUT);
+	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 1) == pdTRUE)	// Only Block for a single tick.
 	{
-		x = spimem_write_h(3, addr, data_buff, size);
-		return x;		
+		if(spimem_cache_flush_h(addr, size) >= 0)
+		{
+			spimem_cache_invalidate_h(addr, size);
+			x = spimem_ftl_trim_h(addr, size);
+		}
+		xSemaphoreGive(Spi0_Mutex);
+		spimem_report_failed_chips();
 	}
 	return x;
 }
@@ -185,6 +299,8 @@ int spimem_write(uint32_t addr, uint8_t* data_buff, uint32_t size)
 /* @param: *data_buff: Contains the data to be written to memory.		*/
 /* @param: size: Length of the aforementioned buffer.					*/
 /* @Note: addresses on these SPI Memory chips are 24 bits.				*/
+/* @Note: addr is a PHYSICAL address on a single chip, this bypasses	*/
+/* the FTL and is meant for repairing one chip from the others.			*/
 /* @Return: Returns < 0 are failure codes for the FDIR, otherwise		*/
 /* returns the number of consecutive bytes which were successfully		*/
 /* written to memory -2 = Usage error, -3 = Spi0_Mutex is currently		*/
@@ -194,8 +310,8 @@ int spimem_write(uint32_t addr, uint8_t* data_buff, uint32_t size)
 /* @NOTE: This function first attempts to acquire the mutex for SPI0	*/
 /* it will block for a maximum of 1 Tick, if SPI0 is still occupied		*/
 /* after that, the function returns -1.									*/
-/* @Note: This function is an atomic operation and hence suspends		*/
-/* interrupts temporarily.												*/
+/* @Note: Interrupts stay enabled, a dirty-page rewrite sleeps while	*/
+/* the sector erases.													*/
 /* @NOTE: Writes a maximum of 256 bytes.								*/
 /************************************************************************/
 int spimem_write_h(uint8_t spi_chip, uint32_t addr, uint8_t* data_buff, uint32_t size)
@@ -226,11 +342,8 @@ int spimem_write_h(uint8_t spi_chip, uint32_t addr, uint8_t* data_buff, uint32_t
 
 	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 1) == pdTRUE)	// Only Block for a single tick.
 	{
-		enter_atomic();											// Atomic operation begins.
-		
 		if(ready_for_command_h(spi_chip) != 1)
 		{
-			exit_atomic();
 			xSemaphoreGive(Spi0_Mutex);
 			return -1;
 		}
@@ -249,7 +362,6 @@ int spimem_write_h(uint8_t spi_chip, uint32_t addr, uint8_t* data_buff, uint32_t
 		{
 			if(write_page_h(spi_chip, addr, data_buff, size1) != 1)
 			{
-				exit_atomic();						// Atomic operation ends.
 				xSemaphoreGive(Spi0_Mutex);
 				return -1;
 			}
@@ -261,7 +373,6 @@ int spimem_write_h(uint8_t spi_chip, uint32_t addr, uint8_t* data_buff, uint32_t
 			
 			if(ready_for_command_h(spi_chip) != 1)
 			{
-				exit_atomic();
 				xSemaphoreGive(Spi0_Mutex);
 				return size1;
 			}
@@ -278,14 +389,12 @@ int spimem_write_h(uint8_t spi_chip, uint32_t addr, uint8_t* data_buff, uint32_t
 			{
 				if(write_page_h(spi_chip, addr + size1, (data_buff + size1), size2) != 1)
 				{
-					exit_atomic();
 					xSemaphoreGive(Spi0_Mutex);
 					return size1;
 				}
 			}
 		}
 		
-		exit_atomic();
 		xSemaphoreGive(Spi0_Mutex);
 		return (size1 + size2);
 	}
@@ -345,7 +454,8 @@ static int spimem_read_h(uint32_t spi_chip, uint32_t addr, uint8_t* read_buff, u
 	if(check_if_wip(spi_chip) != 0)							// A write is still in effect, FAILURE_RECOVERY.
 	return -1;
 
-	spi_master_transfer(msg_buff, 260, spi_chip);	// Keeps CS low so that read may begin immediately.
+	if(spi_master_transfer(msg_buff, 260, spi_chip) < 0)	// Keeps CS low so that read may begin immediately.
+		return -1;
 
 	for(i = 4; i < size2 + 4; i++)
 	{
@@ -357,7 +467,7 @@ static int spimem_read_h(uint32_t spi_chip, uint32_t addr, uint8_t* read_buff, u
 
 /************************************************************************/
 /* SPIMEM_READ 		                                                    */
-/* @param: addr: indicates the address of SPIMEM we want to read from   */
+/* @param: addr: Logical address of SPIMEM we want to read from.		*/
 /* @param: read_buff: Buffer in which the read bytes will be placed.	*/
 /* @param: size: How many bytes we would like to read into memory.		*/
 /* @Return: Returns < 0 are failure codes for the FDIR, otherwise		*/
@@ -369,12 +479,11 @@ static int spimem_read_h(uint32_t spi_chip, uint32_t addr, uint8_t* read_buff, u
 /* @NOTE: This function first attempts to acquire the mutex for SPI0	*/
 /* it will block for a maximum of 1 Tick, if SPI0 is still occupied		*/
 /* after that, the function returns -1.									*/
-/* @NOTE: Reads a maximum of 256 bytes.									*/
 /************************************************************************/
 int spimem_read(uint32_t addr, uint8_t* read_buff, uint32_t size)
 {
 	uint32_t i;
-	uint32_t spi_chip;
+	int x;
 	uint32_t size2 = size;
 	
 	if (INTERNAL_MEMORY_FALLBACK_MODE)
@@ -390,56 +499,69 @@ int spimem_read(uint32_t addr, uint8_t* read_buff, uint32_t size)
 		return size2;
 	}
 	
-	if(SPI_HEALTH1)
-		spi_chip = 1;
-	else if(SPI_HEALTH2)
-		spi_chip = 2;
-	else if(SPI_HEALTH3)
-		spi_chip = 3;
-	else
+	if(!SPI_HEALTH1 && !SPI_HEALTH2 && !SPI_HEALTH3)
 	{
 		errorASSERT(SPIMEM_SENDER_ID, 0, SPIMEM_ALL_CHIPS_ERROR, read_buff, Spi0_Mutex); 
 		return -1;
 	}
-	if (addr > 0xFFFFF)										// Invalid address to write to.
+	if (addr >= SPIMEM_LOGICAL_SIZE)						// Invalid address to read from.
 		return -1;
-	if ((addr + size - 1) > 0xFFFFF)						// Read would overflow highest address, read less.
-		size = 0xFFFFF - size;
+	if ((addr + size) > SPIMEM_LOGICAL_SIZE)				// Read would overflow highest address, read less.
+		size = SPIMEM_LOGICAL_SIZE - addr;
 
+	if(spimem_server_running())
+		return spimem_server_request(SPIMEM_OP_READ, SPIMEM_PRIO_HIGH, addr, read_buff, size, (TickType_t)SPIMEM_SERVER_TIMEOUT);
 	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 1) == pdTRUE)	// Only Block for a single tick.
 	{
-		enter_atomic();											// Atomic operation begins.
-			
-		msg_buff[0] = RD;
-		msg_buff[1] = (uint16_t)((addr & 0x000F0000) >> 16);
-		msg_buff[2] = (uint16_t)((addr & 0x0000FF00) >> 8);
-		msg_buff[3] = (uint16_t)(addr & 0x000000FF);
-			
-		for(i = 4; i < 260; i++)
-		{
-			msg_buff[i] = 0;
-		}
+		x = spimem_cache_read_h(addr, read_buff, size);
+		xSemaphoreGive(Spi0_Mutex);
+		spimem_report_failed_chips();
+		return x;
+	}
+	else
+		return -1;
+}
 
-		if(check_if_wip(spi_chip) != 0)							// A write is still in effect, FAILURE_RECOVERY.
-		{
-			exit_atomic();
-			xSemaphoreGive(Spi0_Mutex);
-			return -1;
-		}
-			
-		spi_master_transfer(msg_buff, 260, spi_chip);	// Keeps CS low so that read may begin immediately.
+/************************************************************************/
+/* SPIMEM_READ_VOTED	                                                */
+/* @param: addr: Logical address of SPIMEM we want to read from.		*/
+/* @param: read_buff: Buffer in which the read bytes will be placed.	*/
+/* @param: size: How many bytes we would like to read into memory.		*/
+/* @Return: -1 == Failure (or SPI0 busy), otherwise the number of bytes	*/
+/* read into the buffer.												*/
+/* @purpose: Same as spimem_read() except that the bytes are read from	*/
+/* every healthy chip and majority-voted, so a bit flip on one chip is	*/
+/* corrected instead of being handed to the caller. Chips which			*/
+/* disagreed get the page rewritten in the background.					*/
+/* @NOTE: Costs about three times as much as spimem_read(), meant for	*/
+/* critical data (schedule, SSM images).								*/
+/************************************************************************/
+int spimem_read_voted(uint32_t addr, uint8_t* read_buff, uint32_t size)
+{
+	int x = -1;
 
-		for(i = 4; i < 260; i++)
-		{
-			*(read_buff + (i - 4)) = (uint8_t)msg_buff[i];
-		}
+	if (INTERNAL_MEMORY_FALLBACK_MODE)
+		return spimem_read(addr, read_buff, size);
 
-		exit_atomic();
-		xSemaphoreGive(Spi0_Mutex);
-		return size;
+	if(!SPI_HEALTH1 && !SPI_HEALTH2 && !SPI_HEALTH3)
+	{
+		errorASSERT(SPIMEM_SENDER_ID, 0, SPIMEM_ALL_CHIPS_ERROR, read_buff, Spi0_Mutex); 
+		return -1;
 	}
-	else
+	if (addr >= SPIMEM_LOGICAL_SIZE)						// Invalid address to read from.
 		return -1;
+	if ((addr + size) > SPIMEM_LOGICAL_SIZE)				// Read would overflow highest address, read less.
+		size = SPIMEM_LOGICAL_SIZE - addr;
+
+	if(spimem_server_running())
+		return spimem_server_request(SPIMEM_OP_READ_VOTED, SPIMEM_PRIO_HIGH, addr, read_buff, size, (TickType_t)SPIMEM_SERVER_TIMEOUT);
+	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 1) == pdTRUE)	// Only Block for a single tick.
+	{
+		x = spimem_cache_read_voted_h(addr, read_buff, size);
+		xSemaphoreGive(Spi0_Mutex);
+		spimem_report_failed_chips();
+	}
+	return x;
 }
 
 /************************************************************************/
@@ -471,8 +593,6 @@ int spimem_read_alt(uint32_t spi_chip, uint32_t addr, uint8_t* read_buff, uint32
 
 	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 1) == pdTRUE)	// Only Block for a single tick.
 	{
-		enter_atomic();											// Atomic operation begins.
-		
 		msg_buff[0] = RD;
 		msg_buff[1] = (uint16_t)((addr & 0x000F0000) >> 16);
 		msg_buff[2] = (uint16_t)((addr & 0x0000FF00) >> 8);
@@ -491,18 +611,20 @@ int spimem_read_alt(uint32_t spi_chip, uint32_t addr, uint8_t* read_buff, uint32
 		}
 		if (check!=0){
 			errorREPORT(SPIMEM_SENDER_ID, 0, SPIMEM_WR_ERROR, read_buff);
-			exit_atomic();
 			xSemaphoreGive(Spi0_Mutex);
 			return -1;}
 		
-		spi_master_transfer(msg_buff, 260, spi_chip);	// Keeps CS low so that read may begin immediately.
+		if(spi_master_transfer(msg_buff, 260, spi_chip) < 0)	// Keeps CS low so that read may begin immediately.
+		{
+			xSemaphoreGive(Spi0_Mutex);
+			return -1;
+		}
 
 		for(i = 4; i < (size2 + 4); i++)
 		{
 			*(read_buff + (i - 4)) = (uint8_t)msg_buff[i];
 		}
 
-		exit_atomic();
 		xSemaphoreGive(Spi0_Mutex);
 		return size;
 	}
@@ -510,6 +632,170 @@ int spimem_read_alt(uint32_t spi_chip, uint32_t addr, uint8_t* read_buff, uint32
 	return -1;												// SPI0 is currently being used or there is an error.
 }
 
+/************************************************************************/
+/* SPIMEM_READ_STREAM_H                                                 */
+/* 																		*/
+/* @param: spi_chip: Indicates which SPI CHIP we are communicating with */
+/* which is either 1, 2, or 3.											*/
+/* @param: addr: indicates the address on the SPI_CHIP we would like to */
+/* start reading from.													*/
+/* @param: read_buff: Buffer in which the read bytes will be placed.	*/
+/* @param: size: How many bytes we would like to read in total.			*/
+/* @param: chunk_size: When callback != 0, read_buff is refilled with	*/
+/* chunk_size bytes at a time and handed to callback.					*/
+/* @param: callback: 0 = place all size bytes into read_buff.			*/
+/* @param: arg: Passed through to callback.								*/
+/* @return: -1 == Failure, otherwise returns the number of bytes which	*/
+/* were read (and accepted by the callback).							*/
+/* @purpose: Issues a single RD command and clocks out an arbitrary		*/
+/* number of bytes while keeping CS asserted, the chip auto-increments	*/
+/* the address (wrapping at the end of the array).						*/
+/* @NOTE: This function is a helper and is ONLY to be used within a 	*/
+/* section of code which has acquired the Spi0_Mutex.					*/
+/************************************************************************/
+int spimem_read_stream_h(uint32_t spi_chip, uint32_t addr, uint8_t* read_buff, uint32_t size, uint32_t chunk_size, spimem_stream_cb_t callback, void* arg)
+{
+	uint16_t cmd[4];
+	uint32_t done = 0, chunk;
+	uint8_t flags;
+
+	if(check_if_wip(spi_chip) != 0)							// A write is still in effect, FAILURE_RECOVERY.
+		return -1;
+
+	cmd[0] = RD;
+	cmd[1] = (uint16_t)((addr & 0x000F0000) >> 16);
+	cmd[2] = (uint16_t)((addr & 0x0000FF00) >> 8);
+	cmd[3] = (uint16_t)(addr & 0x000000FF);
+
+	if(spi_dma_transfer(cmd, 0, 4, (uint8_t)spi_chip, SPI_DMA_HOLD_CS) < 0)
+		return -1;
+
+	if(!callback)
+		chunk_size = size;
+
+	while(done < size)
+	{
+		chunk = size - done;
+		if(chunk > chunk_size)
+			chunk = chunk_size;
+		flags = SPI_DMA_BYTES;
+		if((done + chunk) < size)
+			flags |= SPI_DMA_HOLD_CS;							// More data follows, stay inside the same RD command.
+
+		if(spi_dma_transfer(0, (callback ? read_buff : (read_buff + done)), chunk, (uint8_t)spi_chip, flags) < 0)
+		{
+			spi_release_cs();
+			return -1;
+		}
+
+		if(callback && (callback(arg, addr + done, read_buff, chunk) < 0))
+		{
+			if(flags & SPI_DMA_HOLD_CS)
+				spi_release_cs();								// Consumer is done early, end the command.
+			return done;
+		}
+		done += chunk;
+	}
+
+	return done;
+}
+
+/************************************************************************/
+/* SPIMEM_READ_STREAM                                                   */
+/* @param: addr: indicates the address of SPIMEM we want to read from   */
+/* @param: read_buff: Buffer in which the read bytes will be placed.	*/
+/* @param: size: How many bytes we would like to read into memory.		*/
+/* @Return: -1 == Failure, otherwise returns the number of bytes which	*/
+/* were read into the buffer.											*/
+/* @purpose: Same as spimem_read(). Logical pages which sit in			*/
+/* consecutive physical pages are read with a single RD command (one	*/
+/* chip-select window) instead of re-sending the opcode and address		*/
+/* for every page.														*/
+/* @NOTE: This function first attempts to acquire the mutex for SPI0	*/
+/* it will block for a maximum of 1 Tick, if SPI0 is still occupied		*/
+/* after that, the function returns -1.									*/
+/************************************************************************/
+int spimem_read_stream(uint32_t addr, uint8_t* read_buff, uint32_t size)
+{
+	return spimem_read_stream_cb(addr, size, read_buff, size, 0, 0);
+}
+
+/************************************************************************/
+/* SPIMEM_READ_STREAM_CB                                                */
+/* @param: addr: indicates the address of SPIMEM we want to read from   */
+/* @param: size: How many bytes we would like to read in total.			*/
+/* @param: chunk_buff: Scratch buffer of at least chunk_size bytes.		*/
+/* @param: chunk_size: How many bytes are handed to callback at a time.	*/
+/* @param: callback: Called as callback(arg, addr, chunk_buff, len) for	*/
+/* each chunk, in order. Returning < 0 ends the read early.				*/
+/* (0 = read everything into chunk_buff, which must then hold size B)	*/
+/* @param: arg: Passed through to callback.								*/
+/* @Return: -1 == Failure, otherwise returns the number of bytes which	*/
+/* were read and accepted by the callback.								*/
+/* @purpose: Lets consumers (checksums, memory dumps) process a region	*/
+/* of SPI memory as it arrives without holding a copy of all of it.		*/
+/* @NOTE: Spi0_Mutex is held while callback runs, so callbacks should	*/
+/* be short and must not use SPI0 themselves. While the SPI memory		*/
+/* server runs, the read is one of its requests and callback runs in	*/
+/* the server task. Callbacks run between the DMA							*/
+/* transfers of one RD command, which only ends where the logical		*/
+/* pages stop being physically consecutive (a sector's summary page).	*/
+/************************************************************************/
+int spimem_read_stream_cb(uint32_t addr, uint32_t size, uint8_t* chunk_buff, uint32_t chunk_size, spimem_stream_cb_t callback, void* arg)
+{
+	uint32_t i, done, chunk;
+	int ret;
+
+	if(!size || !chunk_size)
+		return -1;
+
+	if (INTERNAL_MEMORY_FALLBACK_MODE)
+	{
+		if ((addr + size - 1) > 0x0FFF)
+			return -1;
+		if(!callback)
+		{
+			for (i = 0; i < size; i++)
+				*(chunk_buff + i) = spi_mem_buff[addr + i];
+			return size;
+		}
+		for (done = 0; done < size; done += chunk)
+		{
+			chunk = size - done;
+			if(chunk > chunk_size)
+				chunk = chunk_size;
+			for (i = 0; i < chunk; i++)
+				*(chunk_buff + i) = spi_mem_buff[addr + done + i];
+			if(callback(arg, addr + done, chunk_buff, chunk) < 0)
+				return done;
+		}
+		return size;
+	}
+
+	if(!SPI_HEALTH1 && !SPI_HEALTH2 && !SPI_HEALTH3)
+	{
+		errorASSERT(SPIMEM_SENDER_ID, 0, SPIMEM_ALL_CHIPS_ERROR, chunk_buff, Spi0_Mutex);
+		return -1;
+	}
+	if ((addr >= SPIMEM_LOGICAL_SIZE) || ((addr + size) > SPIMEM_LOGICAL_SIZE))
+		return -1;
+
+	if(spimem_server_running())
+		return spimem_server_read_stream(SPIMEM_PRIO_HIGH, addr, size, chunk_buff, chunk_size, callback, arg, (TickType_t)SPIMEM_SERVER_TIMEOUT);
+
+	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 1) == pdTRUE)	// Only Block for a single tick.
+	{
+		ret = -1;
+		if(spimem_cache_flush_h(addr, size) > 0)				// Streams bypass the cache.
+			ret = spimem_ftl_read_h(addr, size, chunk_buff, chunk_size, callback, arg);
+		xSemaphoreGive(Spi0_Mutex);
+		spimem_report_failed_chips();
+		return ret;
+	}
+	else
+		return -1;
+}
+
 /************************************************************************/
 /* LOAD_SECTOR_INTO_SPIBUFFER                                           */
 /* 																		*/
@@ -522,12 +808,10 @@ int spimem_read_alt(uint32_t spi_chip, uint32_t addr, uint8_t* read_buff, uint32
 /* -erase operation. Loads 4kB from SPI_CHIP into spi_mem_buffer		*/
 /* @NOTE: This function is a helper and is ONLY to be used within a 	*/
 /* section of code which has acquired the Spi0_Mutex.					*/
-/* @Note: This function is an atomic operation and hence suspends		*/
-/* interrupts temporarily.												*/
 /************************************************************************/
 uint32_t load_sector_into_spibuffer(uint32_t spi_chip, uint32_t sect_num)
 {
-	uint32_t addr, read, temp, i;
+	uint32_t addr, read = 0, temp, i;
 
 	if(sect_num > 255)				// Invalid sector to request a write to.
 		return -1;
@@ -567,7 +851,7 @@ uint32_t update_spibuffer_with_new_page(uint32_t addr, uint8_t* data_buff, uint3
 	uint32_t sect_num, page_num, index, i;
 
 	page_num = get_page(addr);
-	sect_num = page_num << 4;		// Get the sector number that we wish to write to.
+	sect_num = page_num >> 4;		// Get the sector number that we wish to write to.
 	index = addr & 0x00000FFF;
 
 	if(sect_num != spi_mem_buff_sect_num)	// The desired page write does not belong to the sector currently in memory.
@@ -640,7 +924,8 @@ static uint8_t get_spimem_status_h(uint32_t spi_chip)
 	dumbuf[0] = RSR;											// Read Status Register.
 	dumbuf[1] = 0x00;
 
-	spi_master_transfer(dumbuf, 2, (uint8_t)spi_chip);
+	if(spi_master_transfer(dumbuf, 2, (uint8_t)spi_chip) < 0)
+		return 0xFF;									// SPI0 is busy, so the chip has to be treated as busy too.
 	return (uint8_t)dumbuf[1];						// Status of the Chip is returned.
 }
 
@@ -662,11 +947,10 @@ int get_spimem_status(uint32_t spi_chip)
 	dumbuf[1] = 0x00;
 	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 1) == pdTRUE)	// Only Block for a single tick.
 	{
-		enter_atomic();
-		spi_master_transfer(dumbuf, 2, (uint8_t)spi_chip);
+		if(spi_master_transfer(dumbuf, 2, (uint8_t)spi_chip) < 0)
+			dumbuf[1] = 0xFF;							// SPI0 is busy, so the chip has to be treated as busy too.
 		xSemaphoreGive(Spi0_Mutex);
 		return (uint8_t)dumbuf[1];						// Status of the Chip is returned.
-		exit_atomic();
 	}
 	else
 		return -1;										// SPI0 is currently being used or there is an error.
@@ -714,12 +998,12 @@ uint32_t set_sector_clean_in_bitmap(uint32_t sect_num)
 	page_num = sect_num * 16;
 	integer_number = page_num / 32;
 	
-	if((page_num % 2) == 0)
+	if((sect_num % 2) == 0)
 	{
-		spi_bit_map[integer_number] &= 0xFF00;	// Clear the lower 16 pages.
+		spi_bit_map[integer_number] &= 0xFFFF0000;	// Clear the lower 16 pages.
 	}
 	else
-		spi_bit_map[integer_number] &= 0x00FF;	// Clear the upper 16 pages.
+		spi_bit_map[integer_number] &= 0x0000FFFF;	// Clear the upper 16 pages.
 	
 	return 1;
 }
@@ -757,11 +1041,10 @@ uint32_t erase_sector_on_chip(uint32_t spi_chip, uint32_t sect_num)
 	msg_buff[2] = (uint8_t)((addr & 0x0000FF00) >> 8);
 	msg_buff[3] = (uint8_t)(addr & 0x000000FF);
 
-	spi_master_transfer(msg_buff, 4, spi_chip);
+	if(spi_master_transfer(msg_buff, 4, spi_chip) < 0)
+		return -1;
 	
-	while((check_if_wip(spi_chip) != 0) && timeout--){ }
-		
-	if((check_if_wip(spi_chip) != 0) || !timeout)
+	if(spimem_wait_all_h(1 << (spi_chip - 1), timeout * 50))
 		return -1;								// The Operation took too long.
 
 	return 1;									// Erase Operation Succeeded.	
@@ -791,7 +1074,8 @@ uint32_t write_sector_back_to_spimem(uint32_t spi_chip)
 	for (i = 0; i < 16; i++)						// Write the Buffer back, 1 page at a time.
 	{
 		msg_buff[0] = WREN;
-		spi_master_transfer(msg_buff,1, spi_chip);		
+		if(spi_master_transfer(msg_buff,1, spi_chip) < 0)
+			return i * 256;
 
 		msg_buff[0] = PP;
 		msg_buff[1] = (uint16_t)(((addr + 256 * i) & 0x000F0000) >> 16);
@@ -803,8 +1087,8 @@ uint32_t write_sector_back_to_spimem(uint32_t spi_chip)
 			msg_buff[j] = spi_mem_buff[256 * i + (j - 4)];
 		}
 
-		spi_master_transfer
-		(msg_buff, 260, spi_chip);
+		if(spi_master_transfer(msg_buff, 260, spi_chip) < 0)
+			return i * 256;
 
 		if(check_if_wip(spi_chip) != 0)
 			return i * 256;							// Write operation took too long, return number of bytes transferred.								
@@ -885,7 +1169,8 @@ static uint32_t write_page_h(uint8_t spi_chip, uint32_t addr, uint8_t* data_buff
 	}
 
 	/* Transfer commands and data to the memory chip */
-	spi_master_transfer(msg_buff, (size + 4), spi_chip);
+	if(spi_master_transfer(msg_buff, (size + 4), spi_chip) < 0)
+		return -1;
 
 	set_page_dirty(get_page(addr));	// Page has been written to, set dirty.
 
@@ -895,6 +1180,358 @@ static uint32_t write_page_h(uint8_t spi_chip, uint32_t addr, uint8_t* data_buff
 	return 1;
 }
 
+/************************************************************************/
+/* SPIMEM_PROGRAM_H                                                     */
+/*																		*/
+/* @param: spi_chip: This indicates which chip/chip_select you would	*/
+/* like to communicate with. Ex:1, 2, or 3.								*/
+/* @param: addr: Physical address to program.							*/
+/* @param: *data_buff: Contains the data to be written to memory.		*/
+/* @param: size: Length of the aforementioned buffer.					*/
+/* @Return: Returns -1 if the request failed, 1 otherwise.				*/
+/* @Purpose: Programs bytes which are known to be erased. No bitmap		*/
+/* check and no read-erase-rewrite, this is what the FTL builds on.		*/
+/* @Note: This is a helper function and as such it should only be used	*/
+/* within a section of code which as acquired the SPI0 Mutex.			*/
+/* @NOTE: The bytes must not cross a page boundary.						*/
+/************************************************************************/
+int spimem_program_h(uint32_t spi_chip, uint32_t addr, uint8_t* data_buff, uint32_t size)
+{
+	if(!size || (size > 256) || (((addr & 0xFF) + size) > 256))
+		return -1;
+	if(ready_for_command_h(spi_chip) != 1)
+		return -1;
+	if(write_page_h((uint8_t)spi_chip, addr, data_buff, size) != 1)
+		return -1;
+	return 1;
+}
+
+/************************************************************************/
+/* SPIMEM_CHIP_MASK                                                     */
+/* @Return: Bit (spi_chip - 1) is set for every healthy chip.			*/
+/************************************************************************/
+uint8_t spimem_chip_mask(void)
+{
+	uint8_t mask = 0;
+	if(SPI_HEALTH1)
+		mask |= 0x01;
+	if(SPI_HEALTH2)
+		mask |= 0x02;
+	if(SPI_HEALTH3)
+		mask |= 0x04;
+	return mask;
+}
+
+/************************************************************************/
+/* SPIMEM_WAIT_ALL_H                                                    */
+/* @param: chip_mask: Chips which have an operation in progress.		*/
+/* @param: rounds: Maximum number of 100us polling rounds.				*/
+/* @Return: Mask of the chips which were still busy when time ran out.	*/
+/* @Purpose: Polls the WIP bit of several chips together so that their	*/
+/* internal program/erase times overlap instead of adding up.			*/
+/* @Note: This is a helper function and as such it should only be used	*/
+/* within a section of code which as acquired the SPI0 Mutex.			*/
+/* @Note: The first SPIMEM_WAIT_SPIN_ROUNDS rounds busy-wait (a page	*/
+/* program is done by then), after that the calling task sleeps a tick	*/
+/* between polls so that a sector erase (60 - 300ms) doesn't hog the	*/
+/* CPU. Must NOT be called from within an atomic section.				*/
+/************************************************************************/
+static uint8_t spimem_wait_all_h(uint8_t chip_mask, uint32_t rounds)
+{
+	uint32_t spi_chip, spins = 0;
+
+	while(chip_mask)
+	{
+		for(spi_chip = 1; spi_chip < 4; spi_chip++)
+		{
+			if((chip_mask & (1 << (spi_chip - 1))) && !(get_spimem_status_h(spi_chip) & 0x01))
+				chip_mask &= ~(1 << (spi_chip - 1));
+		}
+		if(!chip_mask || !rounds)
+			break;
+		if((spins < SPIMEM_WAIT_SPIN_ROUNDS) || (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING))
+		{
+			spins++;
+			rounds--;
+			delay_us(100);
+		}
+		else
+		{
+			rounds = (rounds > SPIMEM_WAIT_ROUNDS_PER_TICK) ? (rounds - SPIMEM_WAIT_ROUNDS_PER_TICK) : 0;
+			vTaskDelay(1);
+		}
+	}
+	return chip_mask;
+}
+
+/************************************************************************/
+/* SPIMEM_PROGRAM_ALL_H                                                 */
+/* @param: chip_mask: Chips to program (see spimem_chip_mask()).		*/
+/* @param: addr: Physical address to program.							*/
+/* @param: *data_buff: Contains the data to be written to memory.		*/
+/* @param: size: Length of the aforementioned buffer.					*/
+/* @param: *failed: Set to the mask of the chips which failed.			*/
+/* @Return: -1 if no chip was programmed successfully, 1 otherwise.		*/
+/* @Purpose: Redundant version of spimem_program_h(). The Page Program	*/
+/* command is issued to every chip back-to-back and only then are the	*/
+/* chips polled, so a triple write costs about as much as a single one.	*/
+/* @Note: This is a helper function and as such it should only be used	*/
+/* within a section of code which as acquired the SPI0 Mutex.			*/
+/* @NOTE: The bytes must not cross a page boundary.						*/
+/************************************************************************/
+int spimem_program_all_h(uint8_t chip_mask, uint32_t addr, uint8_t* data_buff, uint32_t size, uint8_t* failed)
+{
+	uint32_t spi_chip, i;
+	uint8_t started = 0;
+
+	*failed = 0;
+	if(!chip_mask || !size || (size > 256) || (((addr & 0xFF) + size) > 256))
+		return -1;
+
+	/* WREN goes out through msg_buff, so every chip is made ready before the command is built. */
+	for(spi_chip = 1; spi_chip < 4; spi_chip++)
+	{
+		if(!(chip_mask & (1 << (spi_chip - 1))))
+			continue;
+		if(ready_for_command_h(spi_chip) != 1)
+			*failed |= (1 << (spi_chip - 1));
+		else
+			started |= (1 << (spi_chip - 1));
+	}
+
+	msg_buff[0] = PP;
+	msg_buff[1] = (uint16_t)((addr & 0x000F0000) >> 16);
+	msg_buff[2] = (uint16_t)((addr & 0x0000FF00) >> 8);
+	msg_buff[3] = (uint16_t)(addr & 0x000000FF);
+	for (i = 0; i < size; i++)
+	{
+		msg_buff[i + 4] = (uint16_t)(*(data_buff + i));
+	}
+
+	for(spi_chip = 1; spi_chip < 4; spi_chip++)
+	{
+		/* TX only so that msg_buff is still intact for the next chip. */
+		if((started & (1 << (spi_chip - 1))) && (spi_dma_transfer(msg_buff, 0, (size + 4), (uint8_t)spi_chip, 0) < 0))
+		{
+			started &= ~(1 << (spi_chip - 1));
+			*failed |= (1 << (spi_chip - 1));
+		}
+	}
+	if(started)
+		set_page_dirty(get_page(addr));	// Page has been written to, set dirty.
+
+	*failed |= spimem_wait_all_h(started, 50);			// ~5ms, about the length of a page program.
+	return (chip_mask & ~(*failed)) ? 1 : -1;
+}
+
+/************************************************************************/
+/* SPIMEM_ERASE_ALL_H                                                   */
+/* @param: chip_mask: Chips to erase the sector on.						*/
+/* @param: sect_num: The sector to erase.								*/
+/* @param: *failed: Set to the mask of the chips which failed.			*/
+/* @Return: -1 if no chip was erased successfully, 1 otherwise.			*/
+/* @Purpose: Redundant version of erase_sector_on_chip(), the erases run*/
+/* on all of the chips at the same time.								*/
+/* @Note: This is a helper function and as such it should only be used	*/
+/* within a section of code which as acquired the SPI0 Mutex.			*/
+/************************************************************************/
+int spimem_erase_all_h(uint8_t chip_mask, uint32_t sect_num, uint8_t* failed)
+{
+	uint32_t spi_chip, addr;
+	uint8_t started = 0;
+
+	*failed = 0;
+	if(!chip_mask || (sect_num > 0xFF))
+		return -1;
+
+	for(spi_chip = 1; spi_chip < 4; spi_chip++)
+	{
+		if(!(chip_mask & (1 << (spi_chip - 1))))
+			continue;
+		if(ready_for_command_h(spi_chip) != 1)
+			*failed |= (1 << (spi_chip - 1));
+		else
+			started |= (1 << (spi_chip - 1));
+	}
+
+	addr = sect_num << 12;
+	msg_buff[0] = SE;
+	msg_buff[1] = (uint16_t)((addr & 0x000F0000) >> 16);
+	msg_buff[2] = (uint16_t)((addr & 0x0000FF00) >> 8);
+	msg_buff[3] = (uint16_t)(addr & 0x000000FF);
+
+	for(spi_chip = 1; spi_chip < 4; spi_chip++)
+	{
+		if((started & (1 << (spi_chip - 1))) && (spi_dma_transfer(msg_buff, 0, 4, (uint8_t)spi_chip, 0) < 0))
+		{
+			started &= ~(1 << (spi_chip - 1));
+			*failed |= (1 << (spi_chip - 1));
+		}
+	}
+
+	*failed |= spimem_wait_all_h(started, erase_sector_timeout * 50);
+	return (chip_mask & ~(*failed)) ? 1 : -1;
+}
+
+/************************************************************************/
+/* SPIMEM_READ_VOTED_H                                                  */
+/* @param: chip_mask: Chips to read from (see spimem_chip_mask()).		*/
+/* @param: addr: Physical address to read from.							*/
+/* @param: *read_buff: Where the voted bytes go.						*/
+/* @param: size: Number of bytes to read.								*/
+/* @param: *disagree: Set to the mask of the chips which were outvoted.	*/
+/* @Return: -1 == Failure, -2 == Only two chips were read and they		*/
+/* disagree (read_buff holds the first chip's data), otherwise the		*/
+/* number of bytes read.												*/
+/* @Purpose: Reads the same range from every chip in chip_mask, one		*/
+/* chip right after the other, and takes the bitwise majority of each	*/
+/* 32-bit word: (a & b) | (a & c) | (b & c).							*/
+/* @Note: This is a helper function and as such it should only be used	*/
+/* within a section of code which as acquired the SPI0 Mutex.			*/
+/************************************************************************/
+int spimem_read_voted_h(uint8_t chip_mask, uint32_t addr, uint8_t* read_buff, uint32_t size, uint8_t* disagree)
+{
+	uint32_t spi_chip, copies, done, chunk, words, w, a, b, c, m;
+	uint8_t chips[3];
+	int ret = size;
+
+	*disagree = 0;
+	copies = 0;
+	for(spi_chip = 1; spi_chip < 4; spi_chip++)
+	{
+		if(chip_mask & (1 << (spi_chip - 1)))
+			chips[copies++] = (uint8_t)spi_chip;
+	}
+	if(!copies || !size)
+		return -1;
+	if(copies == 1)
+		return spimem_read_stream_h(chips[0], addr, read_buff, size, size, 0, 0);
+
+	for(done = 0; done < size; done += chunk)
+	{
+		chunk = size - done;
+		if(chunk > 256)
+			chunk = 256;
+		words = (chunk + 3) >> 2;
+		for(spi_chip = 0; spi_chip < copies; spi_chip++)
+		{
+			spimem_vote_buff[spi_chip][words - 1] = 0;		// Pad the last word the same way in every copy.
+			if(spimem_read_stream_h(chips[spi_chip], addr + done, (uint8_t*)spimem_vote_buff[spi_chip], chunk, chunk, 0, 0) != (int)chunk)
+				return -1;
+		}
+
+		for(w = 0; w < words; w++)
+		{
+			a = spimem_vote_buff[0][w];
+			b = spimem_vote_buff[1][w];
+			if(copies == 2)
+			{
+				if(a ^ b)
+					ret = -2;									// No majority with two chips.
+				continue;
+			}
+			c = spimem_vote_buff[2][w];
+			m = (a & b) | (a & c) | (b & c);
+			if(a ^ m)
+				*disagree |= (1 << (chips[0] - 1));
+			if(b ^ m)
+				*disagree |= (1 << (chips[1] - 1));
+			if(c ^ m)
+				*disagree |= (1 << (chips[2] - 1));
+			spimem_vote_buff[0][w] = m;
+		}
+		memcpy(read_buff + done, (uint8_t*)spimem_vote_buff[0], chunk);
+	}
+	return ret;
+}
+
+/************************************************************************/
+/* SPIMEM_REPAIR_PAGE_H                                                 */
+/* @param: spi_chip: (1|2|3) the chip which was outvoted.				*/
+/* @param: addr: Physical, page-aligned address of the damaged page.	*/
+/* @param: chip_copy: The page as it was read from spi_chip.			*/
+/* @param: image: The voted (correct) contents of the page.				*/
+/* @Return: -1 == Failure, 0 == Fixed by programming the page in place,	*/
+/* 1 == Fixed by rewriting the sector.									*/
+/* @Purpose: Upsets which turned a 0 into a 1 are fixed by simply		*/
+/* programming the voted page over the damaged one (NOR programming can	*/
+/* clear bits). Otherwise the whole sector is voted into spi_mem_buff,	*/
+/* so that every other upset in it is fixed as well, and the chip's		*/
+/* sector is erased and rewritten once.									*/
+/* @Note: This is a helper function and as such it should only be used	*/
+/* within a section of code which as acquired the SPI0 Mutex.			*/
+/************************************************************************/
+int spimem_repair_page_h(uint32_t spi_chip, uint32_t addr, uint8_t* chip_copy, uint8_t* image)
+{
+	uint32_t i, sect_num;
+	uint8_t in_place = 1, disagree;
+
+	if((spi_chip < 1) || (spi_chip > 3) || (addr & 0xFF) || (addr > 0xFFFFF))
+		return -1;
+
+	for(i = 0; i < 256; i++)
+	{
+		if(image[i] & ~chip_copy[i])
+			in_place = 0;								// A bit has to go from 0 back to 1, that takes an erase.
+	}
+	if(in_place)
+		return (spimem_program_h(spi_chip, addr, image, 256) == 1) ? 0 : -1;
+
+	sect_num = get_sector(addr);
+	if(spimem_read_voted_h(spimem_chip_mask(), sect_num << 12, spi_mem_buff, 4096, &disagree) != 4096)
+		return -1;
+	spi_mem_buff_sect_num = sect_num;
+	update_spibuffer_with_new_page(addr, image, 256);
+	if(erase_sector_on_chip(spi_chip, sect_num) != 1)
+		return -1;
+	if(write_sector_back_to_spimem(spi_chip) != 4096)
+		return -1;
+	return 1;
+}
+
+/************************************************************************/
+/* SPIMEM_DROP_CHIPS                                                    */
+/* @param: failed: Mask of chips which failed a redundant operation.	*/
+/* @Purpose: Takes the chips out of service (SPI_HEALTHx = 0) and		*/
+/* remembers them so that the FDIR task can be told once Spi0_Mutex has	*/
+/* been released (see spimem_report_failed_chips()).					*/
+/************************************************************************/
+void spimem_drop_chips(uint8_t failed)
+{
+	if(failed & 0x01)
+		SPI_HEALTH1 = 0;
+	if(failed & 0x02)
+		SPI_HEALTH2 = 0;
+	if(failed & 0x04)
+		SPI_HEALTH3 = 0;
+	spimem_failed_chips |= failed;
+	return;
+}
+
+/************************************************************************/
+/* SPIMEM_REPORT_FAILED_CHIPS                                           */
+/* @Purpose: Sends one error report per chip which was dropped since	*/
+/* the last call. Must NOT be called while holding Spi0_Mutex or from	*/
+/* within an atomic section, errorREPORT() may block.					*/
+/************************************************************************/
+void spimem_report_failed_chips(void)
+{
+	uint8_t spi_chip, failed;
+
+	if(!spimem_failed_chips)
+		return;
+	failed = spimem_failed_chips;
+	spimem_failed_chips = 0;
+	for(spi_chip = 1; spi_chip < 4; spi_chip++)
+	{
+		if(failed & (1 << (spi_chip - 1)))
+			errorREPORT(SPIMEM_SENDER_ID, spi_chip, SPIMEM_WR_ERROR, spi_mem_buff);
+	}
+	if(failed && !SPI_HEALTH1 && !SPI_HEALTH2 && !SPI_HEALTH3)
+		errorASSERT(SPIMEM_SENDER_ID, 0, SPIMEM_ALL_CHIPS_ERROR, spi_mem_buff, 0);
+	return;
+}
+
 /************************************************************************/
 /* READY_FOR_COMMAND                                                    */
 /*																		*/
@@ -928,16 +1565,19 @@ static uint32_t ready_for_command_h(uint32_t spi_chip)
 // Meant to be used by either housekeeping, scheduling, or payload, but can be extended to other tasks easily.
 int task_spimem_write(uint8_t task, uint32_t addr, uint8_t* data_buff, uint32_t size)
 {
-	uint8_t error, attempts;
+	uint8_t error, attempts = 0;
 	int spimem_success;
 	switch(task)
 	{
 		case HK_TASK_ID:
 			error = HK_SPIMEM_W_ERROR;
+			break;
 		case SCHEDULING_TASK_ID:
 			error = SCHED_SPIMEM_W_ERROR;
+			break;
 		case PAY_TASK_ID:
 			error = PAY_SPIMEM_RW_ERROR;
+			break;
 		default:
 			return -1;
 	}
@@ -960,25 +1600,28 @@ int task_spimem_write(uint8_t task, uint32_t addr, uint8_t* data_buff, uint32_t
 }
 
 // Meant to be used by either housekeeping, scheduling, or payload, but can be extended to other tasks easily.
-int task_spimem_read(uint8_t task, uint32_t addr, uint8_t* read_buff, uint32_t size)
+static int task_spimem_read_mode(uint8_t task, uint32_t addr, uint8_t* read_buff, uint32_t size, uint8_t voted)
 {
-	uint8_t error, attempts;
+	uint8_t error, attempts = 0;
 	int spimem_success;
 	switch(task)
 	{
 		case HK_TASK_ID:
 			error = HK_SPIMEM_W_ERROR;
+			break;
 		case SCHEDULING_TASK_ID:
 			error = SCHED_SPIMEM_W_ERROR;
+			break;
 		case PAY_TASK_ID:
 			error = PAY_SPIMEM_RW_ERROR;
+			break;
 		default:
 			return -1;
 	}
-	spimem_success = spimem_read(addr, read_buff, size);
+	spimem_success = voted ? spimem_read_voted(addr, read_buff, size) : spimem_read(addr, read_buff, size);
 	while (attempts < 3 && spimem_success < 0)
 	{
-		spimem_success = spimem_read(addr, read_buff, size);
+		spimem_success = voted ? spimem_read_voted(addr, read_buff, size) : spimem_read(addr, read_buff, size);
 		attempts++;
 	}
 	if (spimem_success < 0) 
@@ -987,8 +1630,21 @@ int task_spimem_read(uint8_t task, uint32_t addr, uint8_t* read_buff, uint32_t s
 			errorASSERT(task, spimem_success, error, read_buff, 0);
 		else
 			errorREPORT(task, spimem_success, error, read_buff);
+		return -1;
 	}
 	else
 		return 0;
 }
+
+// Meant to be used by either housekeeping, scheduling, or payload, but can be extended to other tasks easily.
+int task_spimem_read(uint8_t task, uint32_t addr, uint8_t* read_buff, uint32_t size)
+{
+	return task_spimem_read_mode(task, addr, read_buff, size, 0);
+}
+
+// Same as task_spimem_read() but the chips are majority-voted, see spimem_read_voted().
+int task_spimem_read_voted(uint8_t task, uint32_t addr, uint8_t* read_buff, uint32_t size)
+{
+	return task_spimem_read_mode(task, addr, read_buff, size, 1);
+}
 	
\ No newline at end of file
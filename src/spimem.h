@@ -2,7 +2,7 @@
 	Author: Keenan Burnett
 
 	***********************************************************************
-*	FILE NAME:		spi_func.c
+*	FILE NAME:		spimem.h
 *
 *	PURPOSE:		Houses the includes and definitions for spimem.c
 *
@@ -35,6 +35,28 @@
 *	DEVELOPMENT HISTORY:
 *	09/27/2015		Created
 *
+*	10/16/2026		Added the streaming read APIs.
+*
+*					The logical APIs now sit on top of the flash translation layer (spimem_ftl.h).
+*
+*					spimem_read/spimem_write go through the SPI memory server (spimem_server.h).
+*
+*					Added SPIMEM_WAIT_SPIN_ROUNDS & SPIMEM_WAIT_ROUNDS_PER_TICK.
+*
+*					ERASE_SPIMEM_ON_RESET is now 0, the chips are mounted at start-up instead of erased.
+*
+*					Logical reads/writes go through a RAM page cache (spimem_cache.h).
+*
+*					Added the voted read APIs.
+*
+*					Added spimem_repair_page_h() for the memory wash.
+*
+*					Added spimem_erase(), the logical erase API.
+*
+*					Includes spimem_index.h (checksum index of logical SPI memory).
+*
+*					Includes spimem_edac.h (ECC of the protected regions).
+*
 */
 
 #include "spi_func.h"
@@ -45,11 +67,21 @@
 #include "atomic.h"
 #include "global_var.h"
 #include "error_handling.h"
+#include "spimem_ftl.h"
+#include "spimem_server.h"
+#include "spimem_cache.h"
+#include "spimem_index.h"
+#include "spimem_edac.h"
 
 SemaphoreHandle_t	Spi0_Mutex;
 
 /* Determines whether or not the spimem chips are cleared upon a reset */
-#define ERASE_SPIMEM_ON_RESET 1
+/* (0: the FTL map and the bitmap are rebuilt from the chips instead, data survives resets) */
+#define ERASE_SPIMEM_ON_RESET 0
+
+/* Waiting on WIP (spimem_wait_all_h), one round = 100us */
+#define SPIMEM_WAIT_SPIN_ROUNDS		20										// Busy-wait this long (covers a page program), then sleep.
+#define SPIMEM_WAIT_ROUNDS_PER_TICK	((10000 / configTICK_RATE_HZ) ? (10000 / configTICK_RATE_HZ) : 1)
 
 /*		SPI MEMORY COMMANDS		*/
 #define		WREN	0x06		// Write-Enable
@@ -67,14 +99,31 @@ uint8_t	spi_mem_buff[8192];		// Buffer required when erasing a sector // Shall a
 uint32_t spi_mem_buff_sect_num;	// Current sector number of what is loaded into the SPI Memory Buffer.
 uint16_t msg_buff[260];			// Temporary buffer used by the read and write tasks to store data.
 
+/* Consumer for spimem_read_stream_cb(), return < 0 to stop the read early */
+typedef int (*spimem_stream_cb_t)(void* arg, uint32_t addr, uint8_t* data, uint32_t size);
+
 /*		Function Prototypes				*/
 void spimem_initialize(void);																	// Driver
 int task_spimem_write(uint8_t task, uint32_t addr, uint8_t* data_buff, uint32_t size);			// API, BLOCKS FOR 3 TICK, TRIES 3 TIMES, ERROR HANDLING INCLUDED.
 int spimem_write(uint32_t addr, uint8_t* data_buff, uint32_t size);								// API, BLOCKS FOR 3 TICK
+int spimem_erase(uint32_t addr, uint32_t size);													// API, BLOCKS FOR 1 TICK
 int spimem_write_h(uint8_t spi_chip, uint32_t addr, uint8_t* data_buff, uint32_t size);			// API, BLOCKS FOR 1 TICK
 int task_spimem_read(uint8_t task, uint32_t addr, uint8_t* read_buff, uint32_t size);			// API, BLOCKS FOR 1 TICK, TRIES 3 TIMES, ERROR HANDLING INCLUDED.
 int spimem_read(uint32_t addr, uint8_t* read_buff, uint32_t size);								// API, BLOCKS FOR 1 TICK
+int task_spimem_read_voted(uint8_t task, uint32_t addr, uint8_t* read_buff, uint32_t size);		// API, BLOCKS FOR 1 TICK, TRIES 3 TIMES, ERROR HANDLING INCLUDED.
+int spimem_read_voted(uint32_t addr, uint8_t* read_buff, uint32_t size);						// API, BLOCKS FOR 1 TICK
+int spimem_read_voted_h(uint8_t chip_mask, uint32_t addr, uint8_t* read_buff, uint32_t size, uint8_t* disagree);	// Helper
 int spimem_read_alt(uint32_t spi_chip, uint32_t addr, uint8_t* read_buff, uint32_t size);		// API, BLOCKS FOR 1 TICK
+int spimem_read_stream(uint32_t addr, uint8_t* read_buff, uint32_t size);						// API, BLOCKS FOR 1 TICK
+int spimem_read_stream_cb(uint32_t addr, uint32_t size, uint8_t* chunk_buff, uint32_t chunk_size, spimem_stream_cb_t callback, void* arg);	// API, BLOCKS FOR 1 TICK
+int spimem_read_stream_h(uint32_t spi_chip, uint32_t addr, uint8_t* read_buff, uint32_t size, uint32_t chunk_size, spimem_stream_cb_t callback, void* arg);	// Helper
+int spimem_repair_page_h(uint32_t spi_chip, uint32_t addr, uint8_t* chip_copy, uint8_t* image);	// Helper
+int spimem_program_h(uint32_t spi_chip, uint32_t addr, uint8_t* data_buff, uint32_t size);		// Helper
+int spimem_program_all_h(uint8_t chip_mask, uint32_t addr, uint8_t* data_buff, uint32_t size, uint8_t* failed);	// Helper
+int spimem_erase_all_h(uint8_t chip_mask, uint32_t sect_num, uint8_t* failed);					// Helper
+uint8_t spimem_chip_mask(void);																	// Helper
+void spimem_drop_chips(uint8_t failed);															// Helper
+void spimem_report_failed_chips(void);															// API, MAY BLOCK (errorREPORT)
 uint32_t check_page(uint32_t page_num);															// Helper
 uint32_t check_if_wip(uint32_t spi_chip);														// Helper
 uint32_t get_page(uint32_t addr);																// Helper
@@ -0,0 +1,410 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		spimem_cache.c
+*
+*	PURPOSE:		A small write-back RAM cache of logical SPI memory pages which sits between the
+*					spimem APIs and the flash translation layer.
+*
+*	FILE REFERENCES:		spimem_cache.h, spimem.h
+*
+*	EXTERNAL VARIABLES:		SCHEDULE_BASE, TM_BASE, TC_BASE
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	Functions ending in _h are helpers and must only be called
+*											from a section of code which has acquired Spi0_Mutex.
+*
+*	NOTES:		A handful of pages are read and rewritten over and over: the schedule at SCHEDULE_BASE,
+*				the offset headers at HK_BASE, DIAG_BASE and SCIENCE_BASE and the time at TIME_BASE.
+*				Each of those accesses used to cost a flash read or a page program (plus, eventually,
+*				garbage collection).
+*
+*				The cache keeps SPIMEM_CACHE_ENTRIES logical pages in RAM and replaces the least
+*				recently used one. Writes only update RAM and mark the page dirty, the page is
+*				programmed when it is evicted, when a larger access overlaps it or when the SPI
+*				memory server flushes it (at the latest SPIMEM_CACHE_FLUSH_PERIOD ticks after it
+*				first became dirty). Pages in the schedule region are written through since the
+*				schedule has to survive a reset.
+*
+*				The cache holds LOGICAL pages and writes them back through spimem_ftl_write_h(), so
+*				the three chips are still programmed together and stay identical.
+*
+*				Accesses larger than SPIMEM_CACHE_MAX_ACCESS (dumps, science) bypass the cache so
+*				that they don't push the hot pages out. Dirty pages they overlap are written back first.
+*				So do accesses to the TM and TC stores, which stream whole pages through their regions
+*				and write their header page after the data it points to.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*						Added spimem_cache_read_voted_h().
+*
+*						Every write marks its pages in the checksum index (spimem_index_mark_h()).
+*
+*						spimem_cache_flush() also writes back the ECC records (spimem_edac_flush_h()).
+*
+*						The TM and TC regions bypass the cache (cache_bypass()).
+*
+*/
+
+#include <string.h>
+#include "spimem.h"
+
+#define SCHEDULE_REGION_SIZE	0x2000		// Written through, see cache_write_through().
+#define STORE_REGION_SIZE		0x20000		// TM and TC stores (pus_store.c), see cache_bypass().
+
+typedef struct
+{
+	uint32_t page;								// Logical page number.
+	uint32_t stamp;								// When the page was last used (LRU).
+	TickType_t dirty_since;
+	uint8_t valid, dirty;
+	uint8_t data[256];
+} spimem_cache_entry_t;
+
+static spimem_cache_entry_t* cache_lookup(uint32_t page);
+static spimem_cache_entry_t* cache_fill(uint32_t page, uint8_t load);
+static int cache_write_back(spimem_cache_entry_t* entry);
+static uint8_t cache_write_through(uint32_t page);
+static uint8_t cache_bypass(uint32_t addr, uint32_t size);
+static uint8_t cache_overlaps(spimem_cache_entry_t* entry, uint32_t addr, uint32_t size);
+
+static spimem_cache_entry_t cache[SPIMEM_CACHE_ENTRIES];
+static uint32_t cache_clock;
+static uint32_t cache_hits, cache_misses, cache_saved;
+
+/************************************************************************/
+/* SPIMEM_CACHE_READ_H                                                  */
+/* @param: addr: Logical address to read from.							*/
+/* @param: read_buff: Where the bytes go.								*/
+/* @param: size: Number of bytes to read.								*/
+/* @return: -1 == Failure, otherwise the number of bytes read.			*/
+/************************************************************************/
+int spimem_cache_read_h(uint32_t addr, uint8_t* read_buff, uint32_t size)
+{
+	spimem_cache_entry_t* entry;
+	uint32_t done, offset, chunk;
+
+	if(!size || (addr >= SPIMEM_LOGICAL_SIZE) || ((addr + size) > SPIMEM_LOGICAL_SIZE))
+		return -1;
+	if(cache_bypass(addr, size))
+	{
+		if(spimem_cache_flush_h(addr, size) < 0)
+			return -1;
+		return spimem_ftl_read_h(addr, size, read_buff, size, 0, 0);
+	}
+
+	for(done = 0; done < size; done += chunk)
+	{
+		offset = (addr + done) & 0xFF;
+		chunk = 256 - offset;
+		if(chunk > (size - done))
+			chunk = size - done;
+
+		entry = cache_lookup((addr + done) >> 8);
+		if(entry)
+		{
+			cache_hits++;
+			cache_saved++;
+		}
+		else
+		{
+			cache_misses++;
+			entry = cache_fill((addr + done) >> 8, 1);
+			if(!entry)
+				return done ? (int)done : -1;
+		}
+		entry->stamp = ++cache_clock;
+		memcpy(read_buff + done, entry->data + offset, chunk);
+	}
+	return done;
+}
+
+/************************************************************************/
+/* SPIMEM_CACHE_WRITE_H                                                 */
+/* @param: addr: Logical address to write to.							*/
+/* @param: data_buff: The bytes to write.								*/
+/* @param: size: Number of bytes to write.								*/
+/* @return: -1 == Failure, otherwise the number of bytes written.		*/
+/* @NOTE: Unless the page is written through, the bytes only reach		*/
+/* flash when the page is written back.									*/
+/************************************************************************/
+int spimem_cache_write_h(uint32_t addr, uint8_t* data_buff, uint32_t size)
+{
+	spimem_cache_entry_t* entry;
+	uint32_t done, offset, chunk;
+
+	if(!size || (addr >= SPIMEM_LOGICAL_SIZE) || ((addr + size) > SPIMEM_LOGICAL_SIZE))
+		return -1;
+	spimem_index_mark_h(addr, size);
+	if(cache_bypass(addr, size))
+	{
+		if(spimem_cache_flush_h(addr, size) < 0)
+			return -1;
+		spimem_cache_invalidate_h(addr, size);
+		return spimem_ftl_write_h(addr, data_buff, size);
+	}
+
+	for(done = 0; done < size; done += chunk)
+	{
+		offset = (addr + done) & 0xFF;
+		chunk = 256 - offset;
+		if(chunk > (size - done))
+			chunk = size - done;
+
+		entry = cache_lookup((addr + done) >> 8);
+		if(entry)
+			cache_hits++;
+		else
+		{
+			cache_misses++;
+			entry = cache_fill((addr + done) >> 8, (chunk != 256));	// No need to read a page we overwrite.
+			if(!entry)
+				return done ? (int)done : -1;
+		}
+		entry->stamp = ++cache_clock;
+		if(!memcmp(entry->data + offset, data_buff + done, chunk))
+		{
+			cache_saved++;										// Nothing changes.
+			continue;
+		}
+		memcpy(entry->data + offset, data_buff + done, chunk);
+
+		if(cache_write_through(entry->page))
+		{
+			if(cache_write_back(entry) < 0)
+			{
+				entry->valid = 0;								// RAM would no longer match flash.
+				return done ? (int)done : -1;
+			}
+		}
+		else if(entry->dirty)
+			cache_saved++;										// Absorbed by a page program still to come.
+		else
+		{
+			entry->dirty = 1;
+			entry->dirty_since = xTaskGetTickCount();
+		}
+	}
+	return done;
+}
+
+/************************************************************************/
+/* SPIMEM_CACHE_READ_VOTED_H                                            */
+/* @param: addr, read_buff, size: As in spimem_cache_read_h().			*/
+/* @return: -1 == Failure, otherwise the number of bytes read.			*/
+/* @Purpose: Voted read (spimem_ftl_read_voted_h()). Cached pages were	*/
+/* loaded from a single chip, so dirty ones are written back first and	*/
+/* clean ones are refreshed with the voted bytes.						*/
+/************************************************************************/
+int spimem_cache_read_voted_h(uint32_t addr, uint8_t* read_buff, uint32_t size)
+{
+	uint32_t i, start, end;
+	int ret;
+
+	if(spimem_cache_flush_h(addr, size) < 0)
+		return -1;
+	ret = spimem_ftl_read_voted_h(addr, size, read_buff);
+	if(ret <= 0)
+		return ret;
+
+	for(i = 0; i < SPIMEM_CACHE_ENTRIES; i++)
+	{
+		if(!cache[i].valid || !cache_overlaps(&cache[i], addr, ret))
+			continue;
+		start = cache[i].page << 8;
+		end = start + 256;
+		if(start < addr)
+			start = addr;
+		if(end > (addr + ret))
+			end = addr + ret;
+		memcpy(cache[i].data + (start & 0xFF), read_buff + (start - addr), end - start);
+	}
+	return ret;
+}
+
+/************************************************************************/
+/* SPIMEM_CACHE_FLUSH_H                                                 */
+/* @param: addr, size: Logical region to flush.							*/
+/* @return: -1 == A page could not be written back, 1 == Success.		*/
+/* @Purpose: Writes back every dirty page which overlaps the region.	*/
+/************************************************************************/
+int spimem_cache_flush_h(uint32_t addr, uint32_t size)
+{
+	uint32_t i;
+	int ret = 1;
+
+	for(i = 0; i < SPIMEM_CACHE_ENTRIES; i++)
+	{
+		if(cache[i].valid && cache[i].dirty && cache_overlaps(&cache[i], addr, size))
+		{
+			if(cache_write_back(&cache[i]) < 0)
+				ret = -1;
+		}
+	}
+	return ret;
+}
+
+/************************************************************************/
+/* SPIMEM_CACHE_INVALIDATE_H                                            */
+/* @param: addr, size: Logical region to drop from the cache.			*/
+/* @Purpose: Forgets the cached copies, dirty or not. To be used when	*/
+/* the region is changed behind the cache's back (trim, format, mount).	*/
+/************************************************************************/
+void spimem_cache_invalidate_h(uint32_t addr, uint32_t size)
+{
+	uint32_t i;
+
+	for(i = 0; i < SPIMEM_CACHE_ENTRIES; i++)
+	{
+		if(cache[i].valid && cache_overlaps(&cache[i], addr, size))
+		{
+			cache[i].valid = 0;
+			cache[i].dirty = 0;
+		}
+	}
+	return;
+}
+
+/************************************************************************/
+/* SPIMEM_CACHE_FLUSH_DUE                                               */
+/* @return: 1 == A page has been dirty for SPIMEM_CACHE_FLUSH_PERIOD	*/
+/* ticks or more, 0 == Otherwise.										*/
+/************************************************************************/
+uint8_t spimem_cache_flush_due(void)
+{
+	uint32_t i;
+	TickType_t now = xTaskGetTickCount();
+
+	for(i = 0; i < SPIMEM_CACHE_ENTRIES; i++)
+	{
+		if(cache[i].valid && cache[i].dirty && ((TickType_t)(now - cache[i].dirty_since) >= SPIMEM_CACHE_FLUSH_PERIOD))
+			return 1;
+	}
+	return 0;
+}
+
+/************************************************************************/
+/* SPIMEM_CACHE_FLUSH                                                   */
+/* @return: -1 == SPI0 busy or a page could not be written back,		*/
+/* 1 == Every dirty page is now in flash.								*/
+/* @Purpose: Explicit flush point, ex: before a planned reset.			*/
+/************************************************************************/
+int spimem_cache_flush(void)
+{
+	int ret = -1;
+
+	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 10) == pdTRUE)
+	{
+		ret = spimem_cache_flush_h(0, SPIMEM_LOGICAL_SIZE);
+		if(spimem_edac_flush_h() < 0)
+			ret = -1;
+		xSemaphoreGive(Spi0_Mutex);
+		spimem_report_failed_chips();
+	}
+	return ret;
+}
+
+/************************************************************************/
+/* SPIMEM_CACHE_STAT                                                    */
+/* @param: stat: SPIMEM_CACHE_STAT_HITS, _MISSES or _SAVED.				*/
+/* @return: The counter since start-up.									*/
+/************************************************************************/
+uint32_t spimem_cache_stat(uint8_t stat)
+{
+	switch(stat)
+	{
+		case SPIMEM_CACHE_STAT_HITS:
+			return cache_hits;
+		case SPIMEM_CACHE_STAT_MISSES:
+			return cache_misses;
+		case SPIMEM_CACHE_STAT_SAVED:
+			return cache_saved;
+		default:
+			return 0;
+	}
+}
+
+static spimem_cache_entry_t* cache_lookup(uint32_t page)
+{
+	uint32_t i;
+
+	for(i = 0; i < SPIMEM_CACHE_ENTRIES; i++)
+	{
+		if(cache[i].valid && (cache[i].page == page))
+			return &cache[i];
+	}
+	return 0;
+}
+
+/************************************************************************/
+/* CACHE_FILL                                                           */
+/* @param: page: Logical page to bring into the cache.					*/
+/* @param: load: 1 == Read the page from flash, 0 == The caller is		*/
+/* about to overwrite all of it.										*/
+/* @return: The entry now holding the page, 0 == Failure.				*/
+/* @Purpose: Replaces the least recently used entry (writing it back	*/
+/* first if it is dirty).												*/
+/************************************************************************/
+static spimem_cache_entry_t* cache_fill(uint32_t page, uint8_t load)
+{
+	spimem_cache_entry_t* victim = &cache[0];
+	uint32_t i;
+
+	for(i = 0; i < SPIMEM_CACHE_ENTRIES; i++)
+	{
+		if(!cache[i].valid)
+		{
+			victim = &cache[i];
+			break;
+		}
+		if(cache[i].stamp < victim->stamp)
+			victim = &cache[i];
+	}
+
+	if(victim->valid && victim->dirty && (cache_write_back(victim) < 0))
+		return 0;
+	victim->valid = 0;
+	if(load && (spimem_ftl_read_h(page << 8, 256, victim->data, 256, 0, 0) != 256))
+		return 0;
+	victim->page = page;
+	victim->dirty = 0;
+	victim->valid = 1;
+	return victim;
+}
+
+static int cache_write_back(spimem_cache_entry_t* entry)
+{
+	if(spimem_ftl_write_h(entry->page << 8, entry->data, 256) != 256)
+		return -1;
+	entry->dirty = 0;
+	return 1;
+}
+
+static uint8_t cache_write_through(uint32_t page)
+{
+	if(((page << 8) >= SCHEDULE_BASE) && ((page << 8) < (SCHEDULE_BASE + SCHEDULE_REGION_SIZE)))
+		return 1;
+	return SPIMEM_CACHE_WRITE_THROUGH;
+}
+
+static uint8_t cache_bypass(uint32_t addr, uint32_t size)
+{
+	if(size > SPIMEM_CACHE_MAX_ACCESS)
+		return 1;
+	if((addr >= TM_BASE) && ((addr + size) <= (TM_BASE + STORE_REGION_SIZE)))
+		return 1;
+	return ((addr >= TC_BASE) && ((addr + size) <= (TC_BASE + STORE_REGION_SIZE)));
+}
+
+static uint8_t cache_overlaps(spimem_cache_entry_t* entry, uint32_t addr, uint32_t size)
+{
+	if(!size)
+		return 0;
+	return (entry->page >= (addr >> 8)) && (entry->page <= ((addr + size - 1) >> 8));
+}
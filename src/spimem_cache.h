@@ -0,0 +1,55 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		spimem_cache.h
+*
+*	PURPOSE:		Houses the includes and definitions for spimem_cache.c
+*
+*	FILE REFERENCES:		stdint.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	None
+*
+*	NOTES:
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created
+*
+*					Added spimem_cache_read_voted_h().
+*
+*/
+
+#ifndef SPIMEM_CACHE_H
+#define SPIMEM_CACHE_H
+
+#include <stdint.h>
+
+#define SPIMEM_CACHE_ENTRIES		8			// Logical pages (256B each) held in RAM.
+#define SPIMEM_CACHE_MAX_ACCESS		512			// Larger accesses go straight to the FTL.
+#define SPIMEM_CACHE_FLUSH_PERIOD	10000		// Max ticks a dirty page may wait before it is written back.
+#define SPIMEM_CACHE_WRITE_THROUGH	0			// 1 = Write every region through, not just the critical ones.
+
+/* Statistics (also available as housekeeping parameters) */
+#define SPIMEM_CACHE_STAT_HITS		0
+#define SPIMEM_CACHE_STAT_MISSES	1
+#define SPIMEM_CACHE_STAT_SAVED		2			// Flash reads/programs which the cache made unnecessary.
+
+/*		Function Prototypes				*/
+int spimem_cache_read_h(uint32_t addr, uint8_t* read_buff, uint32_t size);					// Helper
+int spimem_cache_read_voted_h(uint32_t addr, uint8_t* read_buff, uint32_t size);			// Helper
+int spimem_cache_write_h(uint32_t addr, uint8_t* data_buff, uint32_t size);				// Helper
+int spimem_cache_flush_h(uint32_t addr, uint32_t size);									// Helper
+void spimem_cache_invalidate_h(uint32_t addr, uint32_t size);								// Helper
+uint8_t spimem_cache_flush_due(void);														// Helper
+int spimem_cache_flush(void);																// API, BLOCKS FOR 10 TICKS
+uint32_t spimem_cache_stat(uint8_t stat);													// API
+
+#endif
@@ -0,0 +1,350 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		spimem_edac.c
+*
+*	PURPOSE:		Keeps Reed-Solomon ECC (edac.c) for the SPI memory regions which can't be lost, so
+*					that they can still be corrected once a chip has been taken out of service and there
+*					is nothing left to vote with.
+*
+*	FILE REFERENCES:		spimem_edac.h, spimem.h
+*
+*	EXTERNAL VARIABLES:		EDAC_BASE, COMS_BASE, EPS_BASE, PAY_BASE, SCHEDULE_BASE, HK_BASE, EVENT_BASE,
+*							DIAG_BASE, WASH_BASE
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	Functions ending in _h are helpers and must only be called
+*											from a section of code which has acquired Spi0_Mutex.
+*
+*	NOTES:		Regions opt in through edac_regions[]. Each logical page of a protected region gets a
+*				slot of SPIMEM_EDAC_RECORD (32) bytes at EDAC_BASE, slots are handed out in the order
+*				of the table. A record holds the page's ECC (28B), the Fletcher-16 of the page it was
+*				made from (the tag) and the logical page number. EDAC_BASE itself is never protected,
+*				a bad parity byte is corrected along with the data.
+*
+*				spimem_ftl_write_h() hands every page it programs to spimem_edac_write_h(), which
+*				encodes it into a RAM copy of one page of records. That page is written back when a
+*				record on another page is needed, or with the cache (SPIMEM_CACHE_FLUSH_PERIOD), so
+*				a run of sequential writes costs one extra page program per 8 pages.
+*
+*				A record can be out of date: the page of records was lost in a reset or could not be
+*				written. If the page only changed in a few bytes, decoding would happily "correct" it
+*				back to what it used to be. So a record is only used while its tag matches the
+*				Fletcher-16 which the FTL stored when it last programmed the page (FTL_HDR_SUM),
+*				and a correction is only kept if the corrected page matches the tag. Records which are
+*				out of date or were never written are replaced by the scrubber from the page, once it
+*				matches the FTL's checksum (or two chips agree on it).
+*
+*				spimem_edac_scrub() is the scrubber hook used by memory_wash(). It takes one
+*				protected page per call, reads it, and corrects it from its ECC alone. A corrected page
+*				is written back to every chip still in service. While all three chips are in service
+*				the wash votes the page itself, so the page is only read when its record is out of date.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*	10/16/2026			edac_scrub_h() compares the record's tag with the FTL's checksum before it reads the
+*						page. With three chips in service a page whose record is current isn't read at all.
+*
+*/
+
+#include <string.h>
+#include "spimem.h"
+#include "checksum.h"
+
+#define EDAC_RECORDS_PER_PAGE	(256 / SPIMEM_EDAC_RECORD)
+#define EDAC_REGIONS			(sizeof(edac_regions) / sizeof(edac_regions[0]))
+
+typedef struct
+{
+	uint32_t* base;								// Set in main.c.
+	uint32_t size;
+} spimem_edac_region_t;
+
+/* The protected regions. New regions should only be added at the end (slots follow the table)	*/
+/* and must fit in SPIMEM_EDAC_SLOTS.																*/
+static const spimem_edac_region_t edac_regions[] =
+{
+	{&COMS_BASE, 0x4000},
+	{&EPS_BASE, 0x4000},
+	{&PAY_BASE, 0x4000},
+	{&SCHEDULE_BASE, 0x2000},
+	{&HK_BASE, 0x2000},
+	{&EVENT_BASE, 0x2000},
+	{&DIAG_BASE, 0x4000},
+	{&WASH_BASE, 8}								// Shares its page with TIME_BASE.
+};
+
+static int edac_slot(uint32_t lpn);
+static int edac_lpn(uint32_t slot);
+static int edac_load_h(uint32_t slot);
+static int edac_scrub_h(uint32_t lpn, uint32_t slot);
+static int edac_rewrite_h(uint32_t addr);
+
+static uint8_t edac_stage[256];					// One page of records from EDAC_BASE.
+static uint32_t edac_stage_page;
+static uint8_t edac_staged, edac_stage_dirty;
+static TickType_t edac_dirty_since;
+static uint32_t edac_scrub_slot;				// The next slot the scrubber looks at.
+static uint8_t edac_page_buff[256];
+static uint8_t edac_ecc[SPIMEM_EDAC_RECORD];		// The record being built or decoded.
+
+/************************************************************************/
+/* SPIMEM_EDAC_WRITE_H                                                  */
+/* @param: lpn: Logical page which was just programmed.					*/
+/* @param: data: Its 256B.												*/
+/* @Purpose: Updates the page's record if it is in a protected region.	*/
+/* @NOTE: If the records can't be read, the old record is left as it	*/
+/* is. It no longer matches the page and is replaced by the scrubber.	*/
+/************************************************************************/
+void spimem_edac_write_h(uint32_t lpn, uint8_t* data)
+{
+	uint16_t sum;
+	uint8_t* rec;
+	int slot;
+
+	slot = edac_slot(lpn);
+	if(slot < 0)
+		return;
+	edac_encode_page(data, edac_ecc);
+	sum = fletcher16(data, 256);
+	edac_ecc[SPIMEM_EDAC_TAG] = (uint8_t)sum;
+	edac_ecc[SPIMEM_EDAC_TAG + 1] = (uint8_t)(sum >> 8);
+	edac_ecc[SPIMEM_EDAC_LPN] = (uint8_t)lpn;
+	edac_ecc[SPIMEM_EDAC_LPN + 1] = (uint8_t)(lpn >> 8);
+	if(edac_load_h(slot) < 0)
+		return;
+	rec = edac_stage + (slot % EDAC_RECORDS_PER_PAGE) * SPIMEM_EDAC_RECORD;
+	if(!memcmp(rec, edac_ecc, SPIMEM_EDAC_RECORD))
+		return;
+	memcpy(rec, edac_ecc, SPIMEM_EDAC_RECORD);
+	if(!edac_stage_dirty)
+	{
+		edac_stage_dirty = 1;
+		edac_dirty_since = xTaskGetTickCount();
+	}
+	return;
+}
+
+/************************************************************************/
+/* SPIMEM_EDAC_FLUSH_H                                                  */
+/* @return: -1 == The records could not be written, 1 == Success.		*/
+/* @Purpose: Writes the page of records held in RAM back, if it changed.*/
+/************************************************************************/
+int spimem_edac_flush_h(void)
+{
+	if(!edac_staged || !edac_stage_dirty)
+		return 1;
+	spimem_index_mark_h(edac_stage_page << 8, 256);
+	if(spimem_ftl_write_h(edac_stage_page << 8, edac_stage, 256) != 256)
+		return -1;
+	edac_stage_dirty = 0;
+	return 1;
+}
+
+/************************************************************************/
+/* SPIMEM_EDAC_FLUSH_DUE                                                */
+/* @return: 1 == The records in RAM have been dirty for					*/
+/* SPIMEM_CACHE_FLUSH_PERIOD ticks or more, 0 == Otherwise.				*/
+/************************************************************************/
+uint8_t spimem_edac_flush_due(void)
+{
+	return edac_stage_dirty && ((TickType_t)(xTaskGetTickCount() - edac_dirty_since) >= SPIMEM_CACHE_FLUSH_PERIOD);
+}
+
+/************************************************************************/
+/* SPIMEM_EDAC_SCRUB                                                    */
+/* @param: addr: Set to the logical address of the page which was		*/
+/* looked at.															*/
+/* @return: SPIMEM_EDAC_BUSY, SPIMEM_EDAC_UNCORRECTABLE, 0 == Nothing	*/
+/* to correct, otherwise the page was rewritten and this is the number	*/
+/* of bytes which were corrected (at least 1).							*/
+/* @Purpose: Scrubs the next protected page, see edac_scrub_h().		*/
+/* @NOTE: This function first attempts to acquire the mutex for SPI0	*/
+/* it will block for a maximum of 1 Tick, if SPI0 is still occupied		*/
+/* after that, the function returns SPIMEM_EDAC_BUSY.					*/
+/************************************************************************/
+int spimem_edac_scrub(uint32_t* addr)
+{
+	int ret = SPIMEM_EDAC_BUSY, lpn;
+
+	if(INTERNAL_MEMORY_FALLBACK_MODE)
+		return SPIMEM_EDAC_BUSY;
+	lpn = edac_lpn(edac_scrub_slot);
+	if(lpn < 0)
+	{
+		edac_scrub_slot = 0;
+		lpn = edac_lpn(0);
+	}
+	*addr = (uint32_t)lpn << 8;
+
+	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 1) == pdTRUE)	// Only Block for a single tick.
+	{
+		ret = edac_scrub_h((uint32_t)lpn, edac_scrub_slot);
+		xSemaphoreGive(Spi0_Mutex);
+		spimem_report_failed_chips();
+	}
+	if(ret != SPIMEM_EDAC_BUSY)
+		edac_scrub_slot++;
+	return ret;
+}
+
+/************************************************************************/
+/* EDAC_SCRUB_H                                                         */
+/* @param: lpn: Protected logical page to scrub.						*/
+/* @param: slot: Its record.											*/
+/* @return: As in spimem_edac_scrub().									*/
+/* @Purpose: Reads the page (voted when there are chips to vote with)	*/
+/* and decodes it with its record. With all three chips in service,		*/
+/* the record's tag is compared with the FTL's checksum first and the	*/
+/* page is only read when they disagree (the wash votes it anyway).		*/
+/* The page is rewritten when it was corrected, or when the two chips	*/
+/* which are left disagree (the ECC settles which copy is right). A	*/
+/* record which doesn't belong to the page as it was last written (see	*/
+/* the NOTES) is replaced, provided the page can be trusted: it still	*/
+/* matches the Fletcher-16 the FTL stored with it, or two or more chips	*/
+/* agree on it.															*/
+/************************************************************************/
+static int edac_scrub_h(uint32_t lpn, uint32_t slot)
+{
+	uint32_t addr = lpn << 8;
+	uint16_t stored, tag, owner;
+	uint8_t split = 0, trusted, chips, mask;
+	uint8_t* rec;
+	int ret;
+
+	ret = spimem_ftl_lookup_h(lpn, &stored);
+	if(ret <= 0)
+		return ret ? SPIMEM_EDAC_BUSY : 0;			// Never written, reads as 0xFF.
+
+	mask = spimem_chip_mask();
+	chips = (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1);
+	if(chips == 3)
+	{
+		if(edac_load_h(slot) < 0)
+			return SPIMEM_EDAC_BUSY;
+		rec = edac_stage + (slot % EDAC_RECORDS_PER_PAGE) * SPIMEM_EDAC_RECORD;
+		tag = (uint16_t)rec[SPIMEM_EDAC_TAG] | ((uint16_t)rec[SPIMEM_EDAC_TAG + 1] << 8);
+		owner = (uint16_t)rec[SPIMEM_EDAC_LPN] | ((uint16_t)rec[SPIMEM_EDAC_LPN + 1] << 8);
+		if((owner == lpn) && (stored != 0xFFFF) && (tag == stored))
+			return 0;								// Up to date, memory_wash() votes the page.
+	}
+	if(spimem_cache_flush_h(addr, 256) < 0)
+		return SPIMEM_EDAC_BUSY;					// Flash has to hold the newest copy.
+	if(spimem_ftl_read_voted_h(addr, 256, edac_page_buff) != 256)
+	{
+		if((chips < 2) || (spimem_ftl_read_h(addr, 256, edac_page_buff, 256, 0, 0) != 256))
+			return SPIMEM_EDAC_BUSY;
+		split = 1;									// The two chips which are left disagree.
+	}
+
+	if(edac_load_h(slot) < 0)
+		return SPIMEM_EDAC_BUSY;
+	rec = edac_stage + (slot % EDAC_RECORDS_PER_PAGE) * SPIMEM_EDAC_RECORD;
+	tag = (uint16_t)rec[SPIMEM_EDAC_TAG] | ((uint16_t)rec[SPIMEM_EDAC_TAG + 1] << 8);
+	owner = (uint16_t)rec[SPIMEM_EDAC_LPN] | ((uint16_t)rec[SPIMEM_EDAC_LPN + 1] << 8);
+
+	if((owner != lpn) || (stored == 0xFFFF) || (tag != stored))
+	{
+		/* Blank, made for another page or out of date. */
+		if(stored != 0xFFFF)
+			trusted = (fletcher16(edac_page_buff, 256) == stored);
+		else
+			trusted = !split && (chips >= 2);
+		if(!trusted)
+			return (stored != 0xFFFF) ? SPIMEM_EDAC_UNCORRECTABLE : 0;
+		if(split || (stored == 0xFFFF))
+			return (edac_rewrite_h(addr) < 0) ? SPIMEM_EDAC_BUSY : 0;	// Also gives the page a checksum.
+		spimem_edac_write_h(lpn, edac_page_buff);
+		return 0;
+	}
+
+	memcpy(edac_ecc, rec, SPIMEM_EDAC_TAG);
+	ret = edac_decode_page(edac_page_buff, edac_ecc);
+	if((ret < 0) || (ret && (fletcher16(edac_page_buff, 256) != tag)))
+		return SPIMEM_EDAC_UNCORRECTABLE;
+	if(!ret && !split)
+		return 0;
+	if(edac_rewrite_h(addr) < 0)
+		return SPIMEM_EDAC_BUSY;
+	return ret ? ret : 1;
+}
+
+/************************************************************************/
+/* EDAC_REWRITE_H                                                       */
+/* @param: addr: Logical address of the page held in edac_page_buff.	*/
+/* @return: -1 == Failure, 1 == Success.								*/
+/* @Purpose: Programs the page on every chip still in service, which	*/
+/* also rewrites its record.											*/
+/************************************************************************/
+static int edac_rewrite_h(uint32_t addr)
+{
+	spimem_cache_invalidate_h(addr, 256);
+	spimem_index_mark_h(addr, 256);
+	if(spimem_ftl_write_h(addr, edac_page_buff, 256) != 256)
+		return -1;
+	return 1;
+}
+
+/************************************************************************/
+/* EDAC_LOAD_H                                                          */
+/* @param: slot: Record which is about to be read or changed.			*/
+/* @return: -1 == Failure, 1 == edac_stage holds the slot's page.		*/
+/************************************************************************/
+static int edac_load_h(uint32_t slot)
+{
+	uint32_t page = (EDAC_BASE >> 8) + slot / EDAC_RECORDS_PER_PAGE;
+
+	if(edac_staged && (edac_stage_page == page))
+		return 1;
+	if(spimem_edac_flush_h() < 0)
+		return -1;
+	edac_staged = 0;
+	if(spimem_ftl_read_h(page << 8, 256, edac_stage, 256, 0, 0) != 256)
+		return -1;
+	edac_stage_page = page;
+	edac_staged = 1;
+	return 1;
+}
+
+/************************************************************************/
+/* EDAC_SLOT / EDAC_LPN                                                 */
+/* @Purpose: Logical page --> slot and back. -1 == The page is not		*/
+/* protected / there is no such slot.									*/
+/************************************************************************/
+static int edac_slot(uint32_t lpn)
+{
+	uint32_t i, first, last, slot = 0;
+
+	for(i = 0; i < EDAC_REGIONS; i++)
+	{
+		first = *edac_regions[i].base >> 8;
+		last = (*edac_regions[i].base + edac_regions[i].size - 1) >> 8;
+		if((lpn >= first) && (lpn <= last))
+			return ((slot + lpn - first) < SPIMEM_EDAC_SLOTS) ? (int)(slot + lpn - first) : -1;
+		slot += last - first + 1;
+	}
+	return -1;
+}
+
+static int edac_lpn(uint32_t slot)
+{
+	uint32_t i, first, last;
+
+	if(slot >= SPIMEM_EDAC_SLOTS)
+		return -1;
+	for(i = 0; i < EDAC_REGIONS; i++)
+	{
+		first = *edac_regions[i].base >> 8;
+		last = (*edac_regions[i].base + edac_regions[i].size - 1) >> 8;
+		if(slot <= (last - first))
+			return (int)(first + slot);
+		slot -= last - first + 1;
+	}
+	return -1;
+}
@@ -0,0 +1,49 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		spimem_edac.h
+*
+*	PURPOSE:		Houses the includes and definitions for spimem_edac.c
+*
+*	FILE REFERENCES:		stdint.h, edac.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	None
+*
+*	NOTES:
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created
+*
+*/
+
+#ifndef SPIMEM_EDAC_H
+#define SPIMEM_EDAC_H
+
+#include <stdint.h>
+#include "edac.h"
+
+#define SPIMEM_EDAC_RECORD		32					// Bytes per protected page at EDAC_BASE:
+#define SPIMEM_EDAC_TAG			EDAC_PAGE_PARITY	// [0..27] ECC, [28..29] Fletcher-16 of the page,
+#define SPIMEM_EDAC_LPN			(SPIMEM_EDAC_TAG + 2)	// [30..31] logical page number.
+#define SPIMEM_EDAC_SIZE		0x3000				// Room for 384 protected pages.
+#define SPIMEM_EDAC_SLOTS		(SPIMEM_EDAC_SIZE / SPIMEM_EDAC_RECORD)
+
+/* spimem_edac_scrub() results */
+#define SPIMEM_EDAC_BUSY			-1			// SPI0 busy or a read failed, try again later.
+#define SPIMEM_EDAC_UNCORRECTABLE	-2			// More bad bytes than the ECC can correct, the page was left alone.
+
+/*		Function Prototypes				*/
+void spimem_edac_write_h(uint32_t lpn, uint8_t* data);										// Helper
+int spimem_edac_flush_h(void);																// Helper
+uint8_t spimem_edac_flush_due(void);														// Helper
+int spimem_edac_scrub(uint32_t* addr);														// API, BLOCKS FOR 1 TICK
+
+#endif
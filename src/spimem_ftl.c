@@ -0,0 +1,1104 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		spimem_ftl.c
+*
+*	PURPOSE:		Log-structured flash translation layer which sits between the spimem_* API
+*					and the SPI memory chips.
+*
+*	FILE REFERENCES:		spimem.h, spimem_ftl.h
+*
+*	EXTERNAL VARIABLES:		SPI_HEALTH1, SPI_HEALTH2, SPI_HEALTH3, Spi0_Mutex
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	Functions ending in _h are helpers and must only be called
+*											from a section of code which has acquired Spi0_Mutex.
+*
+*	NOTES:		Rewriting part of a page used to mean loading the whole 4kB sector into spi_mem_buff,
+*				erasing it (~100ms) and writing all 16 pages back. That happens a lot: the offset
+*				headers at HK_BASE, DIAG_BASE and SCIENCE_BASE, num_commands at SCHEDULE_BASE and
+*				TIME_BASE every minute all live in small, frequently rewritten regions.
+*
+*				Instead, every logical page (256B) is written "out of place" to the next free
+*				physical page and a map (ftl_l2p) is updated to point at the newest copy. The old
+*				copy is marked obsolete in its sector's summary page. Rewriting a 4B header now
+*				costs one page program.
+*
+*				When free sectors run low, garbage collection picks the sector with the fewest live
+*				pages, moves those pages to the head of the log and erases it. Free sectors are
+*				handed out lowest-erase-count first, and when the spread in erase counts grows past
+*				FTL_WEAR_THRESHOLD, the coldest sector is collected so that its data stops pinning
+*				a barely-used sector.
+*
+*				Physical operations are repeated on every healthy chip, so the three chips stay
+*				identical and memory_wash() can still compare them physical page by physical page.
+*				The chips are programmed/erased concurrently (spimem_program_all_h()).
+*
+*				The map is rebuilt at start-up by reading the summary page of every sector
+*				(spimem_ftl_mount_h()). The same scan rebuilds the dirty-page bitmap, so SPI memory
+*				no longer has to be erased at every reset.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*						Added spimem_ftl_trim_h() for the SPI memory server's erase requests.
+*
+*						Every page spimem_ftl_write_h() programs is handed to spimem_edac_write_h() (ECC of the
+*						protected regions). Added spimem_ftl_lookup_h().
+*
+*						spimem_ftl_trim_h() marks the pages it erases in the checksum index.
+*
+*						spimem_ftl_mount_h() rebuilds spi_bit_map and only erases sectors which are not blank.
+*
+*						Added spimem_ftl_read_voted_h() and the repair queue (spimem_ftl_repair_h()).
+*
+*						A Fletcher-16 of every data page is stored in the summary page (FTL_HDR_SUM) along with
+*						its record. spimem_ftl_page_state_h() tells the memory wash which physical pages are
+*						blank or garbage (and can be skipped) and what a live page should checksum to.
+*
+*						ftl_alloc_page() fills the sector which garbage collection opened instead of leaving
+*						it active and opening another one.
+*
+*						spimem_ftl_page_state_h() keeps the summary pages of two sectors (FTL_STATE_CACHE).
+*
+*						spimem_ftl_read_h() streams each run of consecutive physical pages to its callback
+*						with one RD command (ftl_stream_chunk()) instead of one per chunk.
+*
+*/
+
+#include "spimem.h"
+#include "checksum.h"
+
+/* Logical page --> physical page (sector * 16 + page) */
+static uint16_t ftl_l2p[FTL_LOGICAL_PAGES];
+
+/* Per-sector bookkeeping */
+static uint8_t ftl_sect_state[FTL_NUM_SECTS];
+static uint8_t ftl_sect_valid[FTL_NUM_SECTS];		// Number of live pages in the sector.
+static uint32_t ftl_sect_erase[FTL_NUM_SECTS];		// Number of times the sector has been erased.
+
+static uint32_t ftl_active_sect;					// Sector currently being filled (FTL_NUM_SECTS = none).
+static uint32_t ftl_active_page;					// Next data page to be written in ftl_active_sect.
+static uint32_t ftl_free_count;
+static uint32_t ftl_seq;							// Sequence number given to the next page written.
+static uint8_t ftl_mounted, ftl_gc_active;
+static uint32_t ftl_gc_victim;
+
+static uint8_t ftl_page_buff[256];					// Used for read-modify-write of partial pages.
+static uint8_t ftl_gc_buff[256];					// Used to relocate pages during garbage collection.
+static uint8_t ftl_summary_buff[FTL_HDR_SIZE];
+static uint8_t ftl_rec_buff[FTL_SUM_END];			// Record + checksum, programmed together.
+static uint8_t ftl_state_buff[FTL_STATE_CACHE][FTL_SUM_END];	// Summary pages of ftl_state_sect[] (spimem_ftl_page_state_h()).
+static uint32_t ftl_state_sect[FTL_STATE_CACHE];
+static uint8_t ftl_state_next;						// Entry replaced by the next miss.
+
+/* A run of physically consecutive pages being streamed to a consumer (spimem_ftl_read_h()). */
+typedef struct
+{
+	int (*callback)(void*, uint32_t, uint8_t*, uint32_t);
+	void* arg;
+	uint32_t addr;										// Logical address of the next chunk.
+	uint32_t chunk_size;
+	uint32_t accepted;									// Bytes the consumer took from this run.
+	uint32_t tail;										// Bytes left in buff at the end of the run.
+	uint8_t last;										// The run ends the read.
+	uint8_t stopped;									// The consumer ended the read.
+} ftl_stream_t;
+static uint16_t ftl_repair_queue[FTL_REPAIR_QUEUE];	// Logical pages on which a chip was outvoted.
+static uint32_t ftl_repair_head, ftl_repair_count;
+
+static uint32_t ftl_primary_chip(void);
+static int ftl_program_all(uint32_t addr, uint8_t* data_buff, uint32_t size);
+static int ftl_read_phys(uint32_t addr, uint8_t* read_buff, uint32_t size);
+static int ftl_erase_sector(uint32_t sect_num);
+static int ftl_write_header(uint32_t sect_num);
+static int ftl_blank_check(uint32_t addr, uint32_t size);
+static int ftl_blank_chunk(void* arg, uint32_t addr, uint8_t* data, uint32_t size);
+static int ftl_mark_obsolete(uint32_t ppn);
+static int ftl_alloc_page(void);
+static int ftl_program_lpn(uint32_t lpn, uint8_t* data_buff);
+static int ftl_gc_one(uint8_t allow_wear);
+static void ftl_reset_tables(void);
+static void ftl_queue_repair(uint32_t lpn);
+static void ftl_state_drop(uint32_t sect_num);
+static int ftl_stream_chunk(void* arg, uint32_t addr, uint8_t* data, uint32_t size);
+static uint32_t get_u32(uint8_t* buff);
+static void put_u32(uint8_t* buff, uint32_t val);
+
+/************************************************************************/
+/* SPIMEM_FTL_FORMAT_H                                                  */
+/* @Purpose: Erases every healthy chip and writes a fresh header into	*/
+/* each sector's summary page. All logical pages become unmapped		*/
+/* (they read back as 0xFF).											*/
+/* @return: -1 == Failure, 1 == Success.								*/
+/* @NOTE: Erase counts are lost, this should only be used when the		*/
+/* contents of SPI memory are not wanted (ERASE_SPIMEM_ON_RESET).		*/
+/************************************************************************/
+int spimem_ftl_format_h(void)
+{
+	uint32_t s;
+
+	ftl_mounted = 0;
+	ftl_reset_tables();
+
+	if(erase_spimem() < 0)
+		return -1;
+
+	for(s = 0; s < FTL_NUM_SECTS; s++)
+	{
+		set_sector_clean_in_bitmap(s);
+		if(ftl_write_header(s) < 0)
+			return -1;
+		ftl_sect_state[s] = FTL_SECT_FREE;
+		ftl_free_count++;
+	}
+
+	ftl_mounted = 1;
+	return 1;
+}
+
+/************************************************************************/
+/* SPIMEM_FTL_MOUNT_H                                                   */
+/* @Purpose: Rebuilds the logical-->physical map by reading the summary	*/
+/* page of every sector. Sectors without a valid header are erased.		*/
+/* @return: -1 == Failure, 1 == Success.								*/
+/* @NOTE: If the same logical page is found live in two places (power	*/
+/* was lost between writing the new copy and retiring the old one), the	*/
+/* copy with the higher sequence number wins.							*/
+/* @NOTE: Partially filled sectors are closed rather than appended to,	*/
+/* a torn program could have left data in a page without a record.		*/
+/* @NOTE: The dirty-page bitmap (spi_bit_map) is rebuilt here as well:	*/
+/* every page with a record, the page after the last one (it may hold a	*/
+/* torn program) and every summary page are dirty. The reserved sectors	*/
+/* are blank-checked page by page. A sector without a header which		*/
+/* reads back blank only gets its header, no erase is needed.			*/
+/* @NOTE: The bitmap must be all clean (zero) before this is called.	*/
+/************************************************************************/
+int spimem_ftl_mount_h(void)
+{
+	uint32_t s, i, lpn, seq, other, used, last;
+	int blank;
+	uint8_t other_rec[FTL_REC_SIZE];
+	uint8_t* rec;
+
+	ftl_mounted = 0;
+	ftl_reset_tables();
+
+	if(!ftl_primary_chip())
+		return -1;
+
+	for(s = 0; s < FTL_NUM_SECTS; s++)
+	{
+		if(ftl_read_phys((s << 12) + (FTL_SUMMARY_PAGE << 8), ftl_summary_buff, FTL_HDR_SIZE) < 0)
+			return -1;
+
+		if(get_u32(ftl_summary_buff + FTL_HDR_MAGIC) != FTL_MAGIC)
+		{
+			/* Not part of the log yet (first boot or a torn erase). */
+			ftl_sect_erase[s] = 0;
+			blank = ftl_blank_check(s << 12, 4096);
+			if(blank < 0)
+				return -1;
+			if(!blank)
+			{
+				if(ftl_erase_sector(s) < 0)
+					return -1;
+				continue;
+			}
+			if(ftl_write_header(s) < 0)
+				return -1;
+			ftl_sect_state[s] = FTL_SECT_FREE;
+			ftl_free_count++;
+			continue;
+		}
+
+		ftl_sect_erase[s] = get_u32(ftl_summary_buff + FTL_HDR_ERASE);
+		set_page_dirty((s << 4) + FTL_SUMMARY_PAGE);
+		used = 0;
+		last = 0;
+
+		for(i = 0; i < FTL_DATA_PAGES; i++)
+		{
+			rec = ftl_summary_buff + i * FTL_REC_SIZE;
+			lpn = (uint32_t)rec[FTL_REC_LPN] | ((uint32_t)rec[FTL_REC_LPN + 1] << 8);
+			seq = get_u32(rec + FTL_REC_SEQ);
+			if((lpn == 0xFFFF) && (seq == 0xFFFFFFFF) && (rec[FTL_REC_OBSOLETE] == 0xFF))
+				continue;							// Page never written.
+			used++;
+			last = i + 1;
+			set_page_dirty((s << 4) + i);
+			if(seq != 0xFFFFFFFF && seq >= ftl_seq)
+				ftl_seq = seq + 1;
+			if((lpn >= FTL_LOGICAL_PAGES) || (seq == 0xFFFFFFFF) || (rec[FTL_REC_OBSOLETE] != 0xFF))
+				continue;							// Dead or torn record.
+
+			if(ftl_l2p[lpn] != FTL_UNMAPPED)
+			{
+				other = ftl_l2p[lpn];
+				if(ftl_read_phys(((other >> 4) << 12) + (FTL_SUMMARY_PAGE << 8) + (other & 0x0F) * FTL_REC_SIZE, other_rec, FTL_REC_SIZE) < 0)
+					return -1;
+				if(get_u32(other_rec + FTL_REC_SEQ) > seq)
+				{
+					ftl_mark_obsolete((s << 4) + i);	// The copy we already have is newer.
+					continue;
+				}
+				ftl_mark_obsolete(other);
+			}
+			ftl_l2p[lpn] = (uint16_t)((s << 4) + i);
+			ftl_sect_valid[s]++;
+		}
+
+		if(!used && (ftl_summary_buff[FTL_HDR_OPEN] == 0xFF))
+		{
+			ftl_sect_state[s] = FTL_SECT_FREE;
+			ftl_free_count++;
+		}
+		else
+		{
+			ftl_sect_state[s] = FTL_SECT_USED;
+			if(last < FTL_DATA_PAGES)
+				set_page_dirty((s << 4) + last);
+		}
+	}
+
+	for(i = (FTL_NUM_SECTS << 4); i < 4096; i++)
+	{
+		blank = ftl_blank_check(i << 8, 256);
+		if(blank < 0)
+			return -1;
+		if(!blank)
+			set_page_dirty(i);
+	}
+
+	ftl_mounted = 1;
+	return 1;
+}
+
+/************************************************************************/
+/* SPIMEM_FTL_READ_H                                                    */
+/* @param: addr: Logical address to start reading from.					*/
+/* @param: size: Number of bytes to read.								*/
+/* @param: buff: Where the data goes. When callback != 0 this is a		*/
+/* scratch buffer of chunk_size bytes which is refilled for each chunk.	*/
+/* @param: chunk_size: Bytes handed to callback at a time.				*/
+/* @param: callback: 0 = read all size bytes into buff.					*/
+/* @param: arg: Passed through to callback.								*/
+/* @return: -1 == Failure, otherwise the number of bytes read (and		*/
+/* accepted by the callback).											*/
+/* @Purpose: Logical read. Logical pages which sit in consecutive		*/
+/* physical pages are read with a single RD command, also when they		*/
+/* are handed to callback in chunks (CS stays low in between). Pages	*/
+/* which have never been written read back as 0xFF.						*/
+/************************************************************************/
+int spimem_ftl_read_h(uint32_t addr, uint32_t size, uint8_t* buff, uint32_t chunk_size, int (*callback)(void*, uint32_t, uint8_t*, uint32_t), void* arg)
+{
+	uint32_t done = 0, fill = 0, run, n, lpn, ppn, i, spi_chip;
+	ftl_stream_t stream;
+	int ret;
+
+	if(!ftl_mounted && (spimem_ftl_mount_h() < 0))
+		return -1;
+	if(!size || (addr >= SPIMEM_LOGICAL_SIZE) || ((addr + size) > SPIMEM_LOGICAL_SIZE))
+		return -1;
+	if(!callback)
+		chunk_size = size;
+
+	while(done < size)
+	{
+		/* Find how many bytes from here on are physically contiguous */
+		lpn = (addr + done) >> 8;
+		ppn = ftl_l2p[lpn];
+		run = 256 - ((addr + done) & 0xFF);
+		while(((done + run) < size) && ((lpn + 1) < FTL_LOGICAL_PAGES))
+		{
+			if(ppn == FTL_UNMAPPED)
+			{
+				if(ftl_l2p[lpn + 1] != FTL_UNMAPPED)
+					break;
+			}
+			else if(ftl_l2p[lpn + 1] != (ftl_l2p[lpn] + 1))
+				break;								// Also stops at the summary page.
+			lpn++;
+			run += 256;
+		}
+		if(run > (size - done))
+			run = size - done;
+
+		if(callback && (ppn != FTL_UNMAPPED))
+		{
+			/* Top up the chunk the last run left in buff, then stream the rest of the run. */
+			if(fill)
+			{
+				n = chunk_size - fill;
+				if(n > run)
+					n = run;
+				if(ftl_read_phys(((uint32_t)ftl_l2p[(addr + done) >> 8] << 8) + ((addr + done) & 0xFF), buff + fill, n) < 0)
+					return -1;
+				fill += n;
+				done += n;
+				run -= n;
+				if((fill == chunk_size) || (done == size))
+				{
+					if(callback(arg, addr + done - fill, buff, fill) < 0)
+						return done - fill;
+					fill = 0;
+				}
+			}
+			if(!run)
+				continue;
+			spi_chip = ftl_primary_chip();
+			if(!spi_chip)
+				return -1;
+			stream.callback = callback;
+			stream.arg = arg;
+			stream.addr = addr + done;
+			stream.chunk_size = chunk_size;
+			stream.accepted = 0;
+			stream.tail = 0;
+			stream.last = ((done + run) == size);
+			stream.stopped = 0;
+			ret = spimem_read_stream_h(spi_chip, ((uint32_t)ftl_l2p[(addr + done) >> 8] << 8) + ((addr + done) & 0xFF), buff, run, chunk_size, ftl_stream_chunk, &stream);
+			if(stream.stopped)
+				return done + stream.accepted;
+			if(ret != (int)run)
+				return -1;
+			done += run;
+			fill = stream.tail;
+			continue;
+		}
+
+		while(run)
+		{
+			n = chunk_size - fill;
+			if(n > run)
+				n = run;
+
+			if(ppn == FTL_UNMAPPED)
+			{
+				for(i = 0; i < n; i++)
+					buff[fill + i] = 0xFF;
+			}
+			else if(ftl_read_phys(((uint32_t)ftl_l2p[(addr + done) >> 8] << 8) + ((addr + done) & 0xFF), buff + fill, n) < 0)
+				return -1;
+
+			fill += n;
+			done += n;
+			run -= n;
+
+			if(callback && ((fill == chunk_size) || (done == size)))
+			{
+				if(callback(arg, addr + done - fill, buff, fill) < 0)
+					return done - fill;
+				fill = 0;
+			}
+		}
+	}
+	return done;
+}
+
+/************************************************************************/
+/* SPIMEM_FTL_READ_VOTED_H                                              */
+/* @param: addr: Logical address to start reading from.					*/
+/* @param: size: Number of bytes to read.								*/
+/* @param: buff: Where the data goes.									*/
+/* @return: -1 == Failure, otherwise the number of bytes read.			*/
+/* @Purpose: Logical read which majority-votes the healthy chips. Pages	*/
+/* on which a chip was outvoted are queued for spimem_ftl_repair_h().	*/
+/* @NOTE: With only two healthy chips left a mismatch can't be			*/
+/* resolved, the read fails.											*/
+/************************************************************************/
+int spimem_ftl_read_voted_h(uint32_t addr, uint32_t size, uint8_t* buff)
+{
+	uint32_t done = 0, lpn, n, i;
+	uint8_t disagree;
+
+	if(!ftl_mounted && (spimem_ftl_mount_h() < 0))
+		return -1;
+	if(!size || (addr >= SPIMEM_LOGICAL_SIZE) || ((addr + size) > SPIMEM_LOGICAL_SIZE))
+		return -1;
+
+	while(done < size)
+	{
+		lpn = (addr + done) >> 8;
+		n = 256 - ((addr + done) & 0xFF);
+		if(n > (size - done))
+			n = size - done;
+
+		if(ftl_l2p[lpn] == FTL_UNMAPPED)
+		{
+			for(i = 0; i < n; i++)
+				buff[done + i] = 0xFF;
+		}
+		else
+		{
+			if(spimem_read_voted_h(spimem_chip_mask(), ((uint32_t)ftl_l2p[lpn] << 8) + ((addr + done) & 0xFF), buff + done, n, &disagree) != (int)n)
+				return done ? (int)done : -1;
+			if(disagree)
+				ftl_queue_repair(lpn);
+		}
+		done += n;
+	}
+	return done;
+}
+
+/************************************************************************/
+/* SPIMEM_FTL_REPAIR_H                                                  */
+/* @return: -1 == Failure, 0 == Nothing to repair, 1 == A page was		*/
+/* repaired.															*/
+/* @Purpose: Takes one logical page off the repair queue, votes it and	*/
+/* writes the voted copy to a fresh page on every chip. The copy with	*/
+/* the flipped bit becomes garbage and is erased by garbage collection.	*/
+/************************************************************************/
+int spimem_ftl_repair_h(void)
+{
+	uint32_t lpn;
+	uint8_t disagree;
+
+	if(!ftl_repair_count || !ftl_mounted)
+		return 0;
+	lpn = ftl_repair_queue[ftl_repair_head];
+	ftl_repair_head = (ftl_repair_head + 1) % FTL_REPAIR_QUEUE;
+	ftl_repair_count--;
+
+	if(ftl_l2p[lpn] == FTL_UNMAPPED)
+		return 0;									// Trimmed in the meantime.
+	if(spimem_read_voted_h(spimem_chip_mask(), (uint32_t)ftl_l2p[lpn] << 8, ftl_page_buff, 256, &disagree) != 256)
+		return -1;
+	if(ftl_program_lpn(lpn, ftl_page_buff) < 0)
+		return -1;
+	return 1;
+}
+
+/************************************************************************/
+/* SPIMEM_FTL_PAGE_STATE_H                                              */
+/* @param: ppn: Physical page (0-4095).									*/
+/* @param: checksum: Set to the Fletcher-16 which a FTL_PAGE_LIVE page	*/
+/* was written with, 0xFFFF when it isn't known (written before the		*/
+/* checksums were added, or not a live page).							*/
+/* @return: -1 == Failure, otherwise one of FTL_PAGE_BLANK, _STALE,		*/
+/* _LIVE or _META.														*/
+/* @Purpose: Lets the memory wash skip pages which hold nothing worth	*/
+/* washing. Pages which are clean in spi_bit_map are blank without a	*/
+/* read. Otherwise the sector's records and checksums are voted from	*/
+/* the chips once and kept until the sector is programmed or erased, so	*/
+/* washing a sector page by page costs one extra summary read. Two		*/
+/* sectors are kept so that the ECC scrubber's lookups in between don't	*/
+/* make the wash read its sector's summary again.						*/
+/************************************************************************/
+int spimem_ftl_page_state_h(uint32_t ppn, uint16_t* checksum)
+{
+	uint32_t sect = ppn >> 4, page = ppn & 0x0F, lpn;
+	uint8_t disagree, e;
+	uint8_t* state;
+	uint8_t* rec;
+
+	*checksum = 0xFFFF;
+	if(ppn >= 4096)
+		return -1;
+	if(!check_page(ppn))
+		return FTL_PAGE_BLANK;
+	if(!ftl_mounted || (sect >= FTL_NUM_SECTS) || (page == FTL_SUMMARY_PAGE))
+		return FTL_PAGE_META;
+
+	for(e = 0; (e < FTL_STATE_CACHE) && (ftl_state_sect[e] != sect); e++);
+	if(e == FTL_STATE_CACHE)
+	{
+		e = ftl_state_next;
+		ftl_state_next = (ftl_state_next + 1) % FTL_STATE_CACHE;
+		ftl_state_sect[e] = FTL_NUM_SECTS;
+		if(spimem_read_voted_h(spimem_chip_mask(), (sect << 12) + (FTL_SUMMARY_PAGE << 8), ftl_state_buff[e], FTL_SUM_END, &disagree) != FTL_SUM_END)
+			return -1;
+		ftl_state_sect[e] = sect;
+	}
+	state = ftl_state_buff[e];
+
+	rec = state + page * FTL_REC_SIZE;
+	lpn = (uint32_t)rec[FTL_REC_LPN] | ((uint32_t)rec[FTL_REC_LPN + 1] << 8);
+	if((lpn >= FTL_LOGICAL_PAGES) || (ftl_l2p[lpn] != ppn))
+		return FTL_PAGE_STALE;						// No record (torn program), obsolete or superseded.
+	*checksum = (uint16_t)state[FTL_HDR_SUM + 2 * page] | ((uint16_t)state[FTL_HDR_SUM + 2 * page + 1] << 8);
+	return FTL_PAGE_LIVE;
+}
+
+/************************************************************************/
+/* SPIMEM_FTL_WRITE_H                                                   */
+/* @param: addr: Logical address to start writing to.					*/
+/* @param: data_buff: Data to be written.								*/
+/* @param: size: Number of bytes to write.								*/
+/* @return: -1 == Failure, otherwise the number of bytes written.		*/
+/* @Purpose: Logical write. Each logical page touched is written to a	*/
+/* fresh physical page, partial pages are merged with the current copy	*/
+/* first. Partial writes which would not change anything are skipped.	*/
+/************************************************************************/
+int spimem_ftl_write_h(uint32_t addr, uint8_t* data_buff, uint32_t size)
+{
+	uint32_t done = 0, lpn, low, n, i, same;
+
+	if(!ftl_mounted && (spimem_ftl_mount_h() < 0))
+		return -1;
+	if(!size || (addr >= SPIMEM_LOGICAL_SIZE) || ((addr + size) > SPIMEM_LOGICAL_SIZE))
+		return -1;
+
+	while(done < size)
+	{
+		lpn = (addr + done) >> 8;
+		low = (addr + done) & 0xFF;
+		n = 256 - low;
+		if(n > (size - done))
+			n = size - done;
+
+		if(n < 256)
+		{
+			if(spimem_ftl_read_h(lpn << 8, 256, ftl_page_buff, 256, 0, 0) != 256)
+				return done ? (int)done : -1;
+			same = 1;
+			for(i = 0; i < n; i++)
+			{
+				if(ftl_page_buff[low + i] != data_buff[done + i])
+					same = 0;
+				ftl_page_buff[low + i] = data_buff[done + i];
+			}
+			if(!same)
+			{
+				if(ftl_program_lpn(lpn, ftl_page_buff) < 0)
+					return done ? (int)done : -1;
+				spimem_edac_write_h(lpn, ftl_page_buff);
+			}
+		}
+		else
+		{
+			if(ftl_program_lpn(lpn, data_buff + done) < 0)
+				return done ? (int)done : -1;
+			spimem_edac_write_h(lpn, data_buff + done);
+		}
+
+		done += n;
+	}
+	return done;
+}
+
+/************************************************************************/
+/* SPIMEM_FTL_TRIM_H                                                    */
+/* @param: addr: Logical address of the first byte to erase.			*/
+/* @param: size: Number of bytes to erase.								*/
+/* @return: -1 == Failure, otherwise the number of bytes erased.		*/
+/* @Purpose: Logical erase. Whole pages are simply unmapped (their		*/
+/* physical copy becomes garbage and reads return 0xFF), partial pages	*/
+/* are rewritten with 0xFF over the erased bytes.						*/
+/************************************************************************/
+int spimem_ftl_trim_h(uint32_t addr, uint32_t size)
+{
+	uint32_t done = 0, lpn, low, n, i, old;
+
+	if(!ftl_mounted && (spimem_ftl_mount_h() < 0))
+		return -1;
+	if(!size || (addr >= SPIMEM_LOGICAL_SIZE) || ((addr + size) > SPIMEM_LOGICAL_SIZE))
+		return -1;
+	spimem_index_mark_h(addr, size);
+
+	while(done < size)
+	{
+		lpn = (addr + done) >> 8;
+		low = (addr + done) & 0xFF;
+		n = 256 - low;
+		if(n > (size - done))
+			n = size - done;
+
+		if(n == 256)
+		{
+			old = ftl_l2p[lpn];
+			ftl_l2p[lpn] = FTL_UNMAPPED;
+			if((old != FTL_UNMAPPED) && (ftl_mark_obsolete(old) < 0))
+				return done ? (int)done : -1;
+		}
+		else if(ftl_l2p[lpn] != FTL_UNMAPPED)
+		{
+			for(i = 0; i < n; i++)
+				ftl_gc_buff[i] = 0xFF;				// Merged into ftl_page_buff before any GC could reuse it.
+			if(spimem_ftl_write_h(addr + done, ftl_gc_buff, n) != (int)n)
+				return done ? (int)done : -1;
+		}
+		done += n;
+	}
+	return done;
+}
+
+/************************************************************************/
+/* SPIMEM_FTL_LOOKUP_H                                                  */
+/* @param: lpn: Logical page.											*/
+/* @param: checksum: Set to the Fletcher-16 the current copy was		*/
+/* written with (0xFFFF = not known), see spimem_ftl_page_state_h().	*/
+/* @return: -1 == Failure, 0 == The page reads back as 0xFF without a	*/
+/* flash access, 1 == The page has been written.						*/
+/************************************************************************/
+int spimem_ftl_lookup_h(uint32_t lpn, uint16_t* checksum)
+{
+	*checksum = 0xFFFF;
+	if(!ftl_mounted || (lpn >= FTL_LOGICAL_PAGES) || (ftl_l2p[lpn] == FTL_UNMAPPED))
+		return 0;
+	if(spimem_ftl_page_state_h(ftl_l2p[lpn], checksum) < 0)
+		return -1;
+	return 1;
+}
+
+/************************************************************************/
+/* SPIMEM_FTL_GC_STEP                                                   */
+/* @return: -1 == Nothing to do or SPI0 busy, 1 == A sector was freed.	*/
+/* @Purpose: Background garbage collection & wear leveling. Collects at	*/
+/* most one sector per call so that the caller stays responsive.		*/
+/* @NOTE: This function first attempts to acquire the mutex for SPI0	*/
+/* it will block for a maximum of 1 Tick, if SPI0 is still occupied		*/
+/* after that, the function returns -1.									*/
+/************************************************************************/
+int spimem_ftl_gc_step(void)
+{
+	int ret = -1;
+
+	if(INTERNAL_MEMORY_FALLBACK_MODE || !ftl_mounted)
+		return -1;
+
+	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 1) == pdTRUE)	// Only Block for a single tick.
+	{
+		if(ftl_free_count < FTL_GC_BG_THRESHOLD)
+			ret = ftl_gc_one(0);
+		else if(ftl_free_count > (FTL_GC_RESERVE + 1))
+			ret = ftl_gc_one(1);								// Only does something if wear is uneven.
+		xSemaphoreGive(Spi0_Mutex);
+		spimem_report_failed_chips();
+	}
+	return ret;
+}
+
+/************************************************************************/
+/* SPIMEM_FTL_FREE_SECTORS / SPIMEM_FTL_ERASE_COUNT                     */
+/* @Purpose: Statistics for housekeeping.								*/
+/************************************************************************/
+uint32_t spimem_ftl_free_sectors(void)
+{
+	return ftl_free_count;
+}
+
+uint32_t spimem_ftl_erase_count(uint32_t sect_num)
+{
+	if(sect_num >= FTL_NUM_SECTS)
+		return 0;
+	return ftl_sect_erase[sect_num];
+}
+
+/************************************************************************/
+/* FTL_PROGRAM_LPN                                                      */
+/* @param: lpn: Logical page being written.								*/
+/* @param: data_buff: The full 256B contents of the page.				*/
+/* @return: -1 == Failure, 1 == Success.								*/
+/* @Purpose: Writes the page to the head of the log, records it in the	*/
+/* summary page and retires the previous copy.							*/
+/************************************************************************/
+static int ftl_program_lpn(uint32_t lpn, uint8_t* data_buff)
+{
+	uint32_t sect, page, old, i, len;
+	uint16_t sum;
+	uint8_t* rec;
+
+	if(ftl_alloc_page() < 0)
+		return -1;
+
+	sect = ftl_active_sect;
+	page = ftl_active_page;
+
+	/* The page is used up even if programming fails below. */
+	ftl_active_page++;
+	if(ftl_active_page >= FTL_DATA_PAGES)
+	{
+		ftl_sect_state[sect] = FTL_SECT_USED;
+		ftl_active_sect = FTL_NUM_SECTS;
+	}
+
+	if(ftl_program_all((sect << 12) + (page << 8), data_buff, 256) < 0)
+		return -1;
+
+	/* One program covers the record and the page's checksum, the bytes in between are	*/
+	/* sent as 0xFF which leaves them as they are.										*/
+	len = FTL_HDR_SUM + 2 * page + 2 - page * FTL_REC_SIZE;
+	for(i = 0; i < len; i++)
+		ftl_rec_buff[i] = 0xFF;
+	rec = ftl_rec_buff;
+	rec[FTL_REC_LPN] = (uint8_t)(lpn & 0xFF);
+	rec[FTL_REC_LPN + 1] = (uint8_t)(lpn >> 8);
+	put_u32(rec + FTL_REC_SEQ, ftl_seq);
+	sum = fletcher16(data_buff, 256);
+	ftl_rec_buff[len - 2] = (uint8_t)sum;
+	ftl_rec_buff[len - 1] = (uint8_t)(sum >> 8);
+	if(ftl_program_all((sect << 12) + (FTL_SUMMARY_PAGE << 8) + page * FTL_REC_SIZE, ftl_rec_buff, len) < 0)
+		return -1;
+
+	ftl_seq++;
+
+	old = ftl_l2p[lpn];
+	ftl_l2p[lpn] = (uint16_t)((sect << 4) + page);
+	ftl_sect_valid[sect]++;
+	if(old != FTL_UNMAPPED)
+		ftl_mark_obsolete(old);
+	return 1;
+}
+
+/************************************************************************/
+/* FTL_MARK_OBSOLETE                                                    */
+/* @param: ppn: Physical page (sector * 16 + page) which is no longer	*/
+/* the current copy of its logical page.								*/
+/* @return: -1 == Failure, 1 == Success.								*/
+/************************************************************************/
+static int ftl_mark_obsolete(uint32_t ppn)
+{
+	uint32_t sect = ppn >> 4;
+	uint8_t zero = 0;
+
+	if(ftl_sect_valid[sect])
+		ftl_sect_valid[sect]--;
+	if(ftl_gc_active && (sect == ftl_gc_victim))
+		return 1;									// About to be erased anyway.
+	return ftl_program_all((sect << 12) + (FTL_SUMMARY_PAGE << 8) + (ppn & 0x0F) * FTL_REC_SIZE + FTL_REC_OBSOLETE, &zero, 1);
+}
+
+/************************************************************************/
+/* FTL_ALLOC_PAGE                                                       */
+/* @return: -1 == SPI memory is full, 1 == ftl_active_sect/page is		*/
+/* ready to be written.													*/
+/* @Purpose: Opens a new sector when the active one is full. Runs		*/
+/* garbage collection first if that would dip into the GC reserve.		*/
+/************************************************************************/
+static int ftl_alloc_page(void)
+{
+	uint32_t s, best = FTL_NUM_SECTS, attempts = 0;
+	uint8_t zero = 0;
+
+	if(ftl_active_sect < FTL_NUM_SECTS)
+		return 1;
+
+	if(!ftl_gc_active)
+	{
+		while((ftl_free_count <= FTL_GC_RESERVE) && (attempts++ < FTL_NUM_SECTS))
+		{
+			if(ftl_gc_one(0) < 0)
+				break;
+		}
+		if(ftl_active_sect < FTL_NUM_SECTS)
+			return 1;								// GC opened a sector for the pages it moved, fill that one.
+		if(ftl_free_count <= FTL_GC_RESERVE)
+			return -1;
+	}
+
+	for(s = 0; s < FTL_NUM_SECTS; s++)				// Least worn free sector first.
+	{
+		if((ftl_sect_state[s] == FTL_SECT_FREE) && ((best == FTL_NUM_SECTS) || (ftl_sect_erase[s] < ftl_sect_erase[best])))
+			best = s;
+	}
+	if(best == FTL_NUM_SECTS)
+		return -1;
+
+	/* Mark the sector as opened before anything goes into it, so a data page	*/
+	/* which loses power before its record is written is never programmed twice.	*/
+	if(ftl_program_all((best << 12) + (FTL_SUMMARY_PAGE << 8) + FTL_HDR_OPEN, &zero, 1) < 0)
+		return -1;
+
+	ftl_sect_state[best] = FTL_SECT_ACTIVE;
+	ftl_free_count--;
+	ftl_active_sect = best;
+	ftl_active_page = 0;
+	return 1;
+}
+
+/************************************************************************/
+/* FTL_GC_ONE                                                           */
+/* @param: allow_wear: 1 = Pick the least worn sector if the erase		*/
+/* counts have drifted too far apart (static wear leveling).			*/
+/* @return: -1 == Nothing worth collecting or failure, 1 == Success.	*/
+/* @Purpose: Moves the live pages out of one sector and erases it.		*/
+/************************************************************************/
+static int ftl_gc_one(uint8_t allow_wear)
+{
+	uint32_t s, i, lpn, victim = FTL_NUM_SECTS, min_erase = 0xFFFFFFFF, max_erase = 0;
+	uint8_t* rec;
+
+	for(s = 0; s < FTL_NUM_SECTS; s++)
+	{
+		if(ftl_sect_erase[s] < min_erase)
+			min_erase = ftl_sect_erase[s];
+		if(ftl_sect_erase[s] > max_erase)
+			max_erase = ftl_sect_erase[s];
+	}
+
+	if(allow_wear)
+	{
+		if((max_erase - min_erase) <= FTL_WEAR_THRESHOLD)
+			return -1;
+		for(s = 0; s < FTL_NUM_SECTS; s++)			// Coldest used sector.
+		{
+			if((ftl_sect_state[s] == FTL_SECT_USED) && ((victim == FTL_NUM_SECTS) || (ftl_sect_erase[s] < ftl_sect_erase[victim])))
+				victim = s;
+		}
+	}
+	else
+	{
+		for(s = 0; s < FTL_NUM_SECTS; s++)			// Fewest live pages, then least worn.
+		{
+			if(ftl_sect_state[s] != FTL_SECT_USED)
+				continue;
+			if((victim == FTL_NUM_SECTS) || (ftl_sect_valid[s] < ftl_sect_valid[victim])
+				|| ((ftl_sect_valid[s] == ftl_sect_valid[victim]) && (ftl_sect_erase[s] < ftl_sect_erase[victim])))
+				victim = s;
+		}
+		if((victim < FTL_NUM_SECTS) && (ftl_sect_valid[victim] >= FTL_DATA_PAGES))
+			return -1;								// Nothing to gain.
+	}
+	if(victim == FTL_NUM_SECTS)
+		return -1;
+
+	if(ftl_read_phys((victim << 12) + (FTL_SUMMARY_PAGE << 8), ftl_summary_buff, FTL_HDR_SIZE) < 0)
+		return -1;
+
+	ftl_gc_active = 1;
+	ftl_gc_victim = victim;
+	for(i = 0; (i < FTL_DATA_PAGES) && ftl_sect_valid[victim]; i++)
+	{
+		rec = ftl_summary_buff + i * FTL_REC_SIZE;
+		lpn = (uint32_t)rec[FTL_REC_LPN] | ((uint32_t)rec[FTL_REC_LPN + 1] << 8);
+		if((lpn >= FTL_LOGICAL_PAGES) || (ftl_l2p[lpn] != ((victim << 4) + i)))
+			continue;
+		if((ftl_read_phys((victim << 12) + (i << 8), ftl_gc_buff, 256) < 0) || (ftl_program_lpn(lpn, ftl_gc_buff) < 0))
+		{
+			ftl_gc_active = 0;
+			return -1;
+		}
+	}
+	ftl_gc_active = 0;
+
+	return ftl_erase_sector(victim);
+}
+
+/************************************************************************/
+/* FTL_ERASE_SECTOR                                                     */
+/* @param: sect_num: Sector to erase on every healthy chip.				*/
+/* @return: -1 == Failure, 1 == Success.								*/
+/* @Purpose: Erases the sector, bumps its erase count and writes the	*/
+/* header back so that the count survives a reset.						*/
+/************************************************************************/
+static int ftl_erase_sector(uint32_t sect_num)
+{
+	uint8_t failed;
+	int ret;
+
+	ftl_state_drop(sect_num);
+	ret = spimem_erase_all_h(spimem_chip_mask(), sect_num, &failed);
+	if(failed)
+		spimem_drop_chips(failed);
+	if(ret < 0)
+		return -1;
+	set_sector_clean_in_bitmap(sect_num);
+
+	if(ftl_sect_erase[sect_num] != 0xFFFFFFFF)
+		ftl_sect_erase[sect_num]++;
+	if(ftl_write_header(sect_num) < 0)
+		return -1;
+
+	ftl_sect_valid[sect_num] = 0;
+	if(ftl_sect_state[sect_num] != FTL_SECT_FREE)
+	{
+		ftl_sect_state[sect_num] = FTL_SECT_FREE;
+		ftl_free_count++;
+	}
+	return 1;
+}
+
+/************************************************************************/
+/* FTL_WRITE_HEADER                                                     */
+/* @param: sect_num: Sector whose summary page has just been erased.	*/
+/* @return: -1 == Failure, 1 == Success.								*/
+/* @Purpose: Writes the erase count and FTL_MAGIC into the summary page.*/
+/************************************************************************/
+static int ftl_write_header(uint32_t sect_num)
+{
+	uint8_t hdr[8];
+
+	put_u32(hdr, ftl_sect_erase[sect_num]);
+	put_u32(hdr + 4, FTL_MAGIC);
+	return ftl_program_all((sect_num << 12) + (FTL_SUMMARY_PAGE << 8) + FTL_HDR_ERASE, hdr, 8);
+}
+
+/************************************************************************/
+/* FTL_BLANK_CHECK                                                      */
+/* @param: addr: Physical address to start checking at.				*/
+/* @param: size: Number of bytes to check.								*/
+/* @return: -1 == Failure, 0 == Something has been programmed,			*/
+/* 1 == Every byte reads 0xFF.											*/
+/* @Purpose: Streams the region from the primary chip and stops at the	*/
+/* first programmed byte, much cheaper than erasing "just in case".		*/
+/************************************************************************/
+static int ftl_blank_check(uint32_t addr, uint32_t size)
+{
+	uint32_t spi_chip = ftl_primary_chip();
+	uint8_t blank = 1;
+
+	if(!spi_chip)
+		return -1;
+	if((spimem_read_stream_h(spi_chip, addr, ftl_gc_buff, size, 256, ftl_blank_chunk, &blank) < 0) && blank)
+		return -1;
+	return blank;
+}
+
+static int ftl_blank_chunk(void* arg, uint32_t addr, uint8_t* data, uint32_t size)
+{
+	uint32_t i;
+
+	for(i = 0; i < size; i++)
+	{
+		if(data[i] != 0xFF)
+		{
+			*(uint8_t*)arg = 0;
+			return -1;						// Stop reading.
+		}
+	}
+	return 1;
+}
+
+/************************************************************************/
+/* FTL_PROGRAM_ALL / FTL_READ_PHYS                                      */
+/* @Purpose: Physical operations. Programs go to every healthy chip at	*/
+/* once (a chip which fails is dropped from service), reads come from	*/
+/* the first healthy chip.												*/
+/************************************************************************/
+static int ftl_program_all(uint32_t addr, uint8_t* data_buff, uint32_t size)
+{
+	uint8_t failed;
+	int ret;
+
+	ftl_state_drop(addr >> 12);						// The cached summary page is out of date.
+	ret = spimem_program_all_h(spimem_chip_mask(), addr, data_buff, size, &failed);
+	if(failed)
+		spimem_drop_chips(failed);
+	return ret;
+}
+
+static int ftl_read_phys(uint32_t addr, uint8_t* read_buff, uint32_t size)
+{
+	uint32_t spi_chip = ftl_primary_chip();
+
+	if(!spi_chip)
+		return -1;
+	if(spimem_read_stream_h(spi_chip, addr, read_buff, size, size, 0, 0) != (int)size)
+		return -1;
+	return 1;
+}
+
+/************************************************************************/
+/* FTL_STREAM_CHUNK                                                     */
+/* @Purpose: spimem_read_stream_h() consumer which hands the chunks of	*/
+/* a run on to the caller of spimem_ftl_read_h() with their logical		*/
+/* address. A short chunk at the end of a run which doesn't end the		*/
+/* read is left in buff, the next run tops it up.						*/
+/************************************************************************/
+static int ftl_stream_chunk(void* arg, uint32_t addr, uint8_t* data, uint32_t size)
+{
+	ftl_stream_t* stream = (ftl_stream_t*)arg;
+
+	if((size < stream->chunk_size) && !stream->last)
+	{
+		stream->tail = size;
+		return 1;
+	}
+	if(stream->callback(stream->arg, stream->addr, data, size) < 0)
+	{
+		stream->stopped = 1;
+		return -1;
+	}
+	stream->addr += size;
+	stream->accepted += size;
+	return 1;
+}
+
+static uint32_t ftl_primary_chip(void)
+{
+	if(SPI_HEALTH1)
+		return 1;
+	if(SPI_HEALTH2)
+		return 2;
+	if(SPI_HEALTH3)
+		return 3;
+	return 0;
+}
+
+static void ftl_queue_repair(uint32_t lpn)
+{
+	uint32_t i;
+
+	for(i = 0; i < ftl_repair_count; i++)
+	{
+		if(ftl_repair_queue[(ftl_repair_head + i) % FTL_REPAIR_QUEUE] == lpn)
+			return;									// Already queued.
+	}
+	if(ftl_repair_count == FTL_REPAIR_QUEUE)
+		return;										// Full, memory_wash() will get to it.
+	ftl_repair_queue[(ftl_repair_head + ftl_repair_count) % FTL_REPAIR_QUEUE] = (uint16_t)lpn;
+	ftl_repair_count++;
+	return;
+}
+
+static void ftl_reset_tables(void)
+{
+	uint32_t i;
+
+	for(i = 0; i < FTL_LOGICAL_PAGES; i++)
+		ftl_l2p[i] = FTL_UNMAPPED;
+	for(i = 0; i < FTL_NUM_SECTS; i++)
+	{
+		ftl_sect_state[i] = FTL_SECT_USED;			// Until the sector has been looked at.
+		ftl_sect_valid[i] = 0;
+		ftl_sect_erase[i] = 0;
+	}
+	ftl_active_sect = FTL_NUM_SECTS;
+	ftl_active_page = 0;
+	ftl_free_count = 0;
+	ftl_seq = 0;
+	ftl_gc_active = 0;
+	ftl_repair_head = 0;
+	ftl_repair_count = 0;
+	for(i = 0; i < FTL_STATE_CACHE; i++)
+		ftl_state_sect[i] = FTL_NUM_SECTS;
+	return;
+}
+
+/************************************************************************/
+/* FTL_STATE_DROP                                                       */
+/* @param: sect_num: Sector which is about to be programmed or erased.	*/
+/* @Purpose: Forgets the summary page spimem_ftl_page_state_h() kept	*/
+/* for the sector, if any.												*/
+/************************************************************************/
+static void ftl_state_drop(uint32_t sect_num)
+{
+	uint8_t e;
+
+	for(e = 0; e < FTL_STATE_CACHE; e++)
+	{
+		if(ftl_state_sect[e] == sect_num)
+			ftl_state_sect[e] = FTL_NUM_SECTS;
+	}
+	return;
+}
+
+static uint32_t get_u32(uint8_t* buff)
+{
+	return (uint32_t)buff[0] | ((uint32_t)buff[1] << 8) | ((uint32_t)buff[2] << 16) | ((uint32_t)buff[3] << 24);
+}
+
+static void put_u32(uint8_t* buff, uint32_t val)
+{
+	buff[0] = (uint8_t)(val & 0xFF);
+	buff[1] = (uint8_t)((val >> 8) & 0xFF);
+	buff[2] = (uint8_t)((val >> 16) & 0xFF);
+	buff[3] = (uint8_t)(val >> 24);
+	return;
+}
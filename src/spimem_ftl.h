@@ -0,0 +1,112 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		spimem_ftl.h
+*
+*	PURPOSE:		Houses the includes and definitions for spimem_ftl.c
+*
+*	FILE REFERENCES:		spimem.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	All three SPI memory chips are given exactly the same
+*											physical operations, so one map describes all of them.
+*
+*	NOTES:
+*
+*			Physical layout of each sector (16 pages):
+*
+*				Pages 0 - 14:	Data pages, written in order, never re-written until the sector is erased.
+*				Page 15:		Summary page.
+*
+*			Summary page layout:
+*
+*				[8*i + 0..1]	Logical page number stored in data page i (0xFFFF = page not written).
+*				[8*i + 2]		0xFF = live, 0x00 = obsolete (a newer copy exists elsewhere).
+*				[8*i + 4..7]	Write sequence number of data page i.
+*				[120..123]		Number of times this sector has been erased.
+*				[124..127]		FTL_MAGIC, written right after the sector is erased.
+*				[128]			0x00 once the sector has been opened for writing.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created
+*
+*					Added the voted read and the repair queue.
+*
+*					Added the per-page checksums (FTL_HDR_SUM) and spimem_ftl_page_state_h().
+*
+*					Added spimem_ftl_lookup_h().
+*
+*					Added FTL_STATE_CACHE.
+*
+*/
+
+#ifndef SPIMEM_FTL_H
+#define SPIMEM_FTL_H
+
+#include <stdint.h>
+
+/* Geometry */
+#define FTL_PAGES_PER_SECT		16
+#define FTL_DATA_PAGES			15			// Data pages per sector, the last page is the summary page.
+#define FTL_SUMMARY_PAGE		15
+#define FTL_NUM_SECTS			254			// Sectors 254 & 255 are kept out of the log.
+#define FTL_LOGICAL_PAGES		3072		// 768kB of logical space, the rest is spare for garbage collection.
+#define SPIMEM_LOGICAL_SIZE		(FTL_LOGICAL_PAGES * 256)
+#define FTL_UNMAPPED			0xFFFF
+
+/* Summary page layout */
+#define FTL_REC_SIZE			8
+#define FTL_REC_LPN				0
+#define FTL_REC_OBSOLETE		2
+#define FTL_REC_SEQ				4
+#define FTL_HDR_ERASE			120
+#define FTL_HDR_MAGIC			124
+#define FTL_HDR_OPEN			128
+#define FTL_HDR_SIZE			132			// Bytes of the summary page read back during mount & GC.
+#define FTL_HDR_SUM				132			// Fletcher-16 of each data page, 2B per page (0xFFFF = unknown).
+#define FTL_SUM_END				(FTL_HDR_SUM + 2 * FTL_DATA_PAGES)
+#define FTL_MAGIC				0x314C5446	// "FTL1"
+
+/* Sector states */
+#define FTL_SECT_FREE			0			// Erased and ready to be written.
+#define FTL_SECT_ACTIVE			1			// Currently being filled.
+#define FTL_SECT_USED			2			// Full (or closed), candidate for garbage collection.
+
+/* Garbage collection & wear leveling */
+#define FTL_GC_RESERVE			1			// Free sectors only garbage collection may use.
+#define FTL_GC_BG_THRESHOLD		8			// Background GC runs while fewer sectors than this are free.
+#define FTL_WEAR_THRESHOLD		64			// Max spread in erase counts before cold data gets moved.
+
+/* Physical page states (spimem_ftl_page_state_h()) */
+#define FTL_PAGE_BLANK			0			// Erased, never programmed.
+#define FTL_PAGE_STALE			1			// Garbage: an obsolete copy or a page without a record.
+#define FTL_PAGE_LIVE			2			// Current copy of a logical page.
+#define FTL_PAGE_META			3			// Summary page, reserved sector or FTL not mounted.
+
+/* Voted reads */
+#define FTL_REPAIR_QUEUE		8			// Logical pages waiting to be rewritten after a chip was outvoted.
+#define FTL_STATE_CACHE			2			// Summary pages kept by spimem_ftl_page_state_h(), one each for the wash and the ECC scrubber.
+
+/*		Function Prototypes				*/
+int spimem_ftl_format_h(void);																	// Driver
+int spimem_ftl_mount_h(void);																	// Driver
+int spimem_ftl_read_h(uint32_t addr, uint32_t size, uint8_t* buff, uint32_t chunk_size, int (*callback)(void*, uint32_t, uint8_t*, uint32_t), void* arg);	// Helper
+int spimem_ftl_read_voted_h(uint32_t addr, uint32_t size, uint8_t* buff);						// Helper
+int spimem_ftl_repair_h(void);																	// Helper
+int spimem_ftl_write_h(uint32_t addr, uint8_t* data_buff, uint32_t size);						// Helper
+int spimem_ftl_trim_h(uint32_t addr, uint32_t size);											// Helper
+int spimem_ftl_page_state_h(uint32_t ppn, uint16_t* checksum);									// Helper
+int spimem_ftl_lookup_h(uint32_t lpn, uint16_t* checksum);										// Helper
+int spimem_ftl_gc_step(void);																	// API, BLOCKS FOR 1 TICK
+uint32_t spimem_ftl_free_sectors(void);															// API
+uint32_t spimem_ftl_erase_count(uint32_t sect_num);												// API
+
+#endif
@@ -0,0 +1,348 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		spimem_index.c
+*
+*	PURPOSE:		Keeps an index of checksums over logical SPI memory so that a checksum of a
+*					large region (CHECK_MEM_REQUEST) doesn't have to re-read the whole region.
+*
+*	FILE REFERENCES:		spimem_index.h, spimem.h
+*
+*	EXTERNAL VARIABLES:		CHECKSUM_BASE
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	Functions ending in _h are helpers and must only be called
+*											from a section of code which has acquired Spi0_Mutex.
+*
+*	NOTES:		The checksum is the same Fletcher-64 that fletcher64_on_spimem() computes (sums of
+*				32-bit little-endian words, modulo 2^32). Fletcher sums can be combined: if A and B
+*				are two consecutive pieces and B is n words long, then
+*					sum1(AB) = sum1(A) + sum1(B)
+*					sum2(AB) = sum2(A) + sum2(B) + n * sum1(A)
+*				so the index is a tree of these sums. Leaves are the digests of single pages, they
+*				are kept in SPI memory at CHECKSUM_BASE (8B per page). Blocks of 16 pages (4kB) and
+*				super blocks of 16 blocks (64kB) are kept in RAM. A page-aligned checksum is built
+*				from the largest nodes which fit in the range.
+*
+*				The write path (spimem_cache_write_h() and spimem_ftl_trim_h()) marks the pages it
+*				touches as stale and invalidates their block and super block, without any flash
+*				access. Only stale pages are re-read when the checksum of a region is requested.
+*
+*				The stale map lives in RAM, every page starts out stale after a reset so the first
+*				checksum of a region reads it in full. The digests of CHECKSUM_BASE itself are
+*				never indexed, a checksum which overlaps it is computed the old way.
+*
+*				The index is updated from the memory task while the SPI memory server marks pages,
+*				so the flags are changed inside enter_atomic(). A flag is set BEFORE the page is read:
+*				a write which lands while the digest is being worked out clears it again.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*						Digests and nodes are worked out with fletcher64_update() and fletcher64_combine().
+*
+*/
+
+#include <string.h>
+#include "spimem.h"
+#include "checksum.h"
+
+#define INDEX_PAGE_WORDS		64
+#define INDEX_BLOCK_WORDS		(INDEX_PAGE_WORDS * SPIMEM_INDEX_BLOCK_PAGES)
+#define INDEX_SUPER_WORDS		(INDEX_BLOCK_WORDS * SPIMEM_INDEX_SUPER_BLOCKS)
+#define INDEX_SUPER_PAGES		(SPIMEM_INDEX_BLOCK_PAGES * SPIMEM_INDEX_SUPER_BLOCKS)
+
+static int index_page(uint32_t page, uint64_t* part);
+static int index_block(uint32_t block, uint64_t* part);
+static int index_block_fail(uint32_t block, uint16_t refreshed);
+static int index_super(uint32_t super, uint64_t* part);
+static void index_page_digest(uint8_t* data, uint8_t* digest);
+static uint8_t index_overlaps_digests(uint32_t page, uint32_t num_pages);
+static uint8_t index_test(uint8_t* map, uint32_t bit);
+static void index_set(uint8_t* map, uint32_t bit, uint8_t val);
+
+static uint8_t index_fresh[SPIMEM_INDEX_PAGES / 8];		// The page's digest at CHECKSUM_BASE is up to date.
+static uint8_t index_block_valid[SPIMEM_INDEX_BLOCKS / 8];
+static uint8_t index_super_valid[(SPIMEM_INDEX_SUPERS + 7) / 8];
+static uint64_t index_block_sum[SPIMEM_INDEX_BLOCKS];
+static uint64_t index_super_sum[SPIMEM_INDEX_SUPERS];
+static uint8_t index_page_buff[256];
+static uint8_t index_digest_buff[SPIMEM_INDEX_BLOCK_PAGES * SPIMEM_INDEX_DIGEST];
+
+/************************************************************************/
+/* SPIMEM_INDEX_MARK_H                                                  */
+/* @param: addr: Logical address of the first byte which changed.		*/
+/* @param: size: Number of bytes.										*/
+/* @Purpose: Marks the pages as stale, called on every logical write	*/
+/* and erase. RAM only, so it costs the write path next to nothing.		*/
+/************************************************************************/
+void spimem_index_mark_h(uint32_t addr, uint32_t size)
+{
+	uint32_t page, last;
+
+	if(!size || (addr >= SPIMEM_LOGICAL_SIZE))
+		return;
+	last = (addr + size - 1) >> 8;
+	if(last >= SPIMEM_INDEX_PAGES)
+		last = SPIMEM_INDEX_PAGES - 1;
+	for(page = addr >> 8; page <= last; page++)
+	{
+		if(index_overlaps_digests(page, 1))
+			continue;
+		enter_atomic();
+		index_set(index_fresh, page, 0);
+		index_set(index_block_valid, page / SPIMEM_INDEX_BLOCK_PAGES, 0);
+		index_set(index_super_valid, page / INDEX_SUPER_PAGES, 0);
+		exit_atomic();
+	}
+	return;
+}
+
+/************************************************************************/
+/* SPIMEM_INDEX_CHECKSUM                                                */
+/* @param: addr: Logical address, must be a multiple of 256.			*/
+/* @param: num_pages: Number of pages to hash.							*/
+/* @param: checksum: Where the Fletcher-64 is placed.					*/
+/* @return: -1 == The range can't be answered from the index (or SPI	*/
+/* memory failed), 1 == Success.										*/
+/* @Purpose: Same result as hashing the pages with						*/
+/* fletcher64_on_spimem(), built from the largest nodes of the index	*/
+/* that fit in the range. Only stale pages are read.					*/
+/************************************************************************/
+int spimem_index_checksum(uint32_t addr, uint32_t num_pages, uint64_t* checksum)
+{
+	uint64_t sums = 0, part;
+	uint32_t page, end;
+
+	if((addr & 0xFF) || !num_pages)
+		return -1;
+	page = addr >> 8;
+	end = page + num_pages;
+	if((end > SPIMEM_INDEX_PAGES) || index_overlaps_digests(page, num_pages))
+		return -1;
+
+	while(page < end)
+	{
+		if(!(page % INDEX_SUPER_PAGES) && ((page + INDEX_SUPER_PAGES) <= end))
+		{
+			if(index_super(page / INDEX_SUPER_PAGES, &part) < 0)
+				return -1;
+			sums = fletcher64_combine(sums, part, INDEX_SUPER_WORDS);
+			page += INDEX_SUPER_PAGES;
+		}
+		else if(!(page % SPIMEM_INDEX_BLOCK_PAGES) && ((page + SPIMEM_INDEX_BLOCK_PAGES) <= end))
+		{
+			if(index_block(page / SPIMEM_INDEX_BLOCK_PAGES, &part) < 0)
+				return -1;
+			sums = fletcher64_combine(sums, part, INDEX_BLOCK_WORDS);
+			page += SPIMEM_INDEX_BLOCK_PAGES;
+		}
+		else
+		{
+			if(index_page(page, &part) < 0)
+				return -1;
+			sums = fletcher64_combine(sums, part, INDEX_PAGE_WORDS);
+			page++;
+		}
+	}
+	*checksum = sums;
+	return 1;
+}
+
+/************************************************************************/
+/* INDEX_PAGE															*/
+/* @param: page: Logical page number.									*/
+/* @param: part: Where the page's checksum is placed.					*/
+/* @Purpose: Digest of a single page (ends of a range). A stale page	*/
+/* is read and its digest is saved.										*/
+/* @return: -1 == SPI memory failed, 1 == Success.						*/
+/************************************************************************/
+static int index_page(uint32_t page, uint64_t* part)
+{
+	uint8_t digest[SPIMEM_INDEX_DIGEST];
+	uint32_t digest_addr = CHECKSUM_BASE + page * SPIMEM_INDEX_DIGEST;
+
+	if(index_test(index_fresh, page))
+	{
+		if(spimem_read_stream(digest_addr, digest, SPIMEM_INDEX_DIGEST) != SPIMEM_INDEX_DIGEST)
+			return -1;
+	}
+	else
+	{
+		enter_atomic();
+		index_set(index_fresh, page, 1);
+		exit_atomic();
+		if(spimem_read_stream(page << 8, index_page_buff, 256) != 256)
+		{
+			enter_atomic();
+			index_set(index_fresh, page, 0);
+			exit_atomic();
+			return -1;
+		}
+		index_page_digest(index_page_buff, digest);
+		if(spimem_write(digest_addr, digest, SPIMEM_INDEX_DIGEST) != SPIMEM_INDEX_DIGEST)
+		{
+			enter_atomic();
+			index_set(index_fresh, page, 0);		// Still good for this answer, just not saved.
+			exit_atomic();
+		}
+	}
+	memcpy(part, digest, SPIMEM_INDEX_DIGEST);
+	return 1;
+}
+
+/************************************************************************/
+/* INDEX_BLOCK															*/
+/* @param: block: Block number (16 pages).								*/
+/* @param: part: Where the block's checksum is placed.					*/
+/* @Purpose: The block's sums come from RAM if nothing in it was		*/
+/* written. Otherwise its 16 page digests are read in one go, the stale	*/
+/* pages are re-read and the new digests are saved together.			*/
+/* @return: -1 == SPI memory failed, 1 == Success.						*/
+/************************************************************************/
+static int index_block(uint32_t block, uint64_t* part)
+{
+	uint64_t sums = 0, digest;
+	uint32_t i, page, digest_addr;
+	uint16_t refreshed = 0;
+
+	if(index_test(index_block_valid, block))
+	{
+		*part = index_block_sum[block];
+		return 1;
+	}
+	enter_atomic();
+	index_set(index_block_valid, block, 1);
+	exit_atomic();
+
+	digest_addr = CHECKSUM_BASE + block * sizeof(index_digest_buff);
+	if(spimem_read_stream(digest_addr, index_digest_buff, sizeof(index_digest_buff)) != (int)sizeof(index_digest_buff))
+		return index_block_fail(block, refreshed);
+	for(i = 0; i < SPIMEM_INDEX_BLOCK_PAGES; i++)
+	{
+		page = block * SPIMEM_INDEX_BLOCK_PAGES + i;
+		if(!index_test(index_fresh, page))
+		{
+			enter_atomic();
+			index_set(index_fresh, page, 1);
+			exit_atomic();
+			refreshed |= (1 << i);
+			if(spimem_read_stream(page << 8, index_page_buff, 256) != 256)
+				return index_block_fail(block, refreshed);
+			index_page_digest(index_page_buff, index_digest_buff + i * SPIMEM_INDEX_DIGEST);
+		}
+		memcpy(&digest, index_digest_buff + i * SPIMEM_INDEX_DIGEST, SPIMEM_INDEX_DIGEST);
+		sums = fletcher64_combine(sums, digest, INDEX_PAGE_WORDS);
+	}
+	if(refreshed && (spimem_write(digest_addr, index_digest_buff, sizeof(index_digest_buff)) != (int)sizeof(index_digest_buff)))
+	{
+		enter_atomic();
+		for(i = 0; i < SPIMEM_INDEX_BLOCK_PAGES; i++)
+		{
+			if(refreshed & (1 << i))
+				index_set(index_fresh, block * SPIMEM_INDEX_BLOCK_PAGES + i, 0);	// The sums are still right.
+		}
+		exit_atomic();
+	}
+	index_block_sum[block] = sums;
+	*part = sums;
+	return 1;
+}
+
+/************************************************************************/
+/* INDEX_BLOCK_FAIL														*/
+/* @Purpose: Undoes the flags index_block() set before a read failed.	*/
+/* @return: -1.															*/
+/************************************************************************/
+static int index_block_fail(uint32_t block, uint16_t refreshed)
+{
+	uint32_t i;
+
+	enter_atomic();
+	index_set(index_block_valid, block, 0);
+	for(i = 0; i < SPIMEM_INDEX_BLOCK_PAGES; i++)
+	{
+		if(refreshed & (1 << i))
+			index_set(index_fresh, block * SPIMEM_INDEX_BLOCK_PAGES + i, 0);
+	}
+	exit_atomic();
+	return -1;
+}
+
+/************************************************************************/
+/* INDEX_SUPER															*/
+/* @param: super: Super block number (16 blocks).						*/
+/* @param: part: Where the super block's checksum is placed.			*/
+/* @return: -1 == SPI memory failed, 1 == Success.						*/
+/************************************************************************/
+static int index_super(uint32_t super, uint64_t* part)
+{
+	uint64_t sums = 0, block_part;
+	uint32_t i;
+
+	if(index_test(index_super_valid, super))
+	{
+		*part = index_super_sum[super];
+		return 1;
+	}
+	enter_atomic();
+	index_set(index_super_valid, super, 1);
+	exit_atomic();
+	for(i = 0; i < SPIMEM_INDEX_SUPER_BLOCKS; i++)
+	{
+		if(index_block(super * SPIMEM_INDEX_SUPER_BLOCKS + i, &block_part) < 0)
+		{
+			enter_atomic();
+			index_set(index_super_valid, super, 0);
+			exit_atomic();
+			return -1;
+		}
+		sums = fletcher64_combine(sums, block_part, INDEX_BLOCK_WORDS);
+	}
+	index_super_sum[super] = sums;
+	*part = sums;
+	return 1;
+}
+
+/************************************************************************/
+/* INDEX_PAGE_DIGEST													*/
+/* @Purpose: Fletcher-64 of one page, stored as it is in memory			*/
+/* (sum1 then sum2, little-endian).										*/
+/************************************************************************/
+static void index_page_digest(uint8_t* data, uint8_t* digest)
+{
+	fletcher64_ctx_t ctx;
+	uint64_t sums;
+
+	fletcher64_init(&ctx);
+	fletcher64_update(&ctx, data, 256);
+	sums = fletcher64_final(&ctx);
+	memcpy(digest, &sums, SPIMEM_INDEX_DIGEST);
+	return;
+}
+
+static uint8_t index_overlaps_digests(uint32_t page, uint32_t num_pages)
+{
+	uint32_t first = CHECKSUM_BASE >> 8;
+	uint32_t last = first + (SPIMEM_INDEX_SIZE >> 8);
+	return (page < last) && ((page + num_pages) > first);
+}
+
+static uint8_t index_test(uint8_t* map, uint32_t bit)
+{
+	return (map[bit >> 3] >> (bit & 0x7)) & 0x1;
+}
+
+static void index_set(uint8_t* map, uint32_t bit, uint8_t val)
+{
+	if(val)
+		map[bit >> 3] |= (1 << (bit & 0x7));
+	else
+		map[bit >> 3] &= ~(1 << (bit & 0x7));
+	return;
+}
@@ -0,0 +1,45 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		spimem_index.h
+*
+*	PURPOSE:		Houses the includes and definitions for spimem_index.c
+*
+*	FILE REFERENCES:		stdint.h, spimem_ftl.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	None
+*
+*	NOTES:
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created
+*
+*/
+
+#ifndef SPIMEM_INDEX_H
+#define SPIMEM_INDEX_H
+
+#include <stdint.h>
+#include "spimem_ftl.h"
+
+#define SPIMEM_INDEX_PAGES			FTL_LOGICAL_PAGES
+#define SPIMEM_INDEX_BLOCK_PAGES	16			// Pages per block node (4kB).
+#define SPIMEM_INDEX_SUPER_BLOCKS	16			// Blocks per super node (64kB).
+#define SPIMEM_INDEX_BLOCKS			(SPIMEM_INDEX_PAGES / SPIMEM_INDEX_BLOCK_PAGES)
+#define SPIMEM_INDEX_SUPERS			(SPIMEM_INDEX_BLOCKS / SPIMEM_INDEX_SUPER_BLOCKS)
+#define SPIMEM_INDEX_DIGEST			8			// Bytes per page digest at CHECKSUM_BASE.
+#define SPIMEM_INDEX_SIZE			(SPIMEM_INDEX_PAGES * SPIMEM_INDEX_DIGEST)
+
+/*		Function Prototypes				*/
+void spimem_index_mark_h(uint32_t addr, uint32_t size);										// Helper
+int spimem_index_checksum(uint32_t addr, uint32_t num_pages, uint64_t* checksum);			// API, BLOCKS FOR 1 TICK PER FLASH ACCESS
+
+#endif
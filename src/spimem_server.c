@@ -0,0 +1,630 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		spimem_server.c
+*
+*	PURPOSE:		Houses the SPI memory server task, which owns the SPI memory chips and carries
+*					out read/write/erase requests on behalf of the other tasks.
+*
+*	FILE REFERENCES:		spimem_server.h, spimem.h, global_var.h
+*
+*	EXTERNAL VARIABLES:		Spi0_Mutex, spimem_server_HANDLE
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	Requests from one client are handled in the order they were
+*											submitted as long as that client always uses the same priority.
+*
+*	NOTES:		Every task which uses SPI memory used to call spimem_* directly and race for Spi0_Mutex
+*				with a 1-tick timeout, failing with -1 whenever another task held the bus.
+*
+*				Now, once the scheduler is running, spimem_read(), spimem_write() and the task_spimem_*
+*				wrappers turn into requests which are placed in one of two queues (high/low priority).
+*				The server wakes up, drains up to SPIMEM_SERVER_BATCH requests (high priority first)
+*				and handles all of them while holding Spi0_Mutex once:
+*
+*					- Writes to adjacent addresses are merged into one FTL write.
+*					- A read which is covered by a write earlier in the same batch is served from that
+*					  write's data rather than from flash.
+*					- Voted reads (SPIMEM_OP_READ_VOTED) read every chip. Pages on which a chip was
+*					  outvoted are rewritten one per batch, or all at once when the server is idle.
+*					- Stream reads (a SPIMEM_OP_READ with a chunk_size, spimem_read_stream_cb()) hand
+*					  the region to the client's callback in chunks, from the server task, as it is read.
+*
+*				Reads and writes go through the page cache (spimem_cache.c). The server writes dirty
+*				pages back whenever it has been idle for SPIMEM_CACHE_FLUSH_PERIOD ticks, or after a
+*				batch once a page has been dirty for that long.
+*
+*				Blocking clients borrow one of SPIMEM_SERVER_SLOTS binary semaphores to wait on,
+*				asynchronous clients get a callback from the server task instead. A blocking client which
+*				times out cancels its request if it is still queued, otherwise it keeps waiting until the
+*				server is done with its buffer.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*						The page of ECC records (spimem_edac.c) is written back along with the cache.
+*
+*						A client which timed out used to leave its request queued with a pointer into its own
+*						stack frame, which the server later read or wrote. Queued requests are now cancelled
+*						and started ones waited for. The task stack went from 2x to 4x the minimum.
+*
+*						Stream reads go through the server too (spimem_server_read_stream()). They used to take
+*						Spi0_Mutex directly with a 1-tick timeout and failed whenever the server held it.
+*						SPIMEM_SERVER_PRIORITY's comment said the server was above every client, it shares
+*						the highest priority with memory management and FDIR.
+*
+*/
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* Kernel includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Common includes. */
+#include "spimem.h"
+#include "global_var.h"
+
+/* Priorities at which the tasks are created. */
+#define SPIMEM_SERVER_PRIORITY	( tskIDLE_PRIORITY + 4 )		// The highest there is (configMAX_PRIORITIES is 5). Memory management and
+																// FDIR have it too, so the server time-slices with them instead of pre-empting them.
+
+/* Values passed to the two tasks just to check the task parameter
+functionality. */
+#define SPIMEM_SERVER_PARAMETER	( 0xABCD )
+
+/* Slot states */
+#define SLOT_FREE				0
+#define SLOT_QUEUED				1			// The request is still in one of the queues.
+#define SLOT_ACTIVE				2			// The server has taken the request and may be using buff.
+#define SLOT_DONE				3
+#define SLOT_CANCELLED			4			// The client timed out while queued, the server drops the request.
+
+/* Stack of the server task (words). The deepest call chain (cache write-back -> FTL write -> ECC
+load -> FTL mount -> sector erase -> page program -> SPI0) needs about 1.1kB, more than the
+1040 bytes of configMINIMAL_STACK_SIZE * 2 even before an exception frame is stacked on top.
+"make stack" in src/host prints the chain. */
+#define SPIMEM_SERVER_STACK		( configMINIMAL_STACK_SIZE * 4 )
+
+typedef struct
+{
+	SemaphoreHandle_t done;
+	volatile int result;
+	volatile uint8_t state;
+} spimem_slot_t;
+
+/* Functions Prototypes. */
+static void prvSpimemServerTask( void *pvParameters );
+static int submit_request(spimem_req_t* req, TickType_t timeout);
+static int request_blocking(spimem_req_t* req, TickType_t timeout);
+static uint32_t claim_batch(uint32_t count);
+static void process_batch(uint32_t count);
+static void server_idle(void);
+static int serve_read_from_batch(uint32_t index);
+static void complete_request(spimem_req_t* req, int result);
+
+/* Local variables for the SPI memory server */
+static QueueHandle_t spimem_req_high, spimem_req_low;
+static SemaphoreHandle_t spimem_req_pending;		// Counts the requests sitting in the two queues.
+static spimem_slot_t spimem_slots[SPIMEM_SERVER_SLOTS];
+static spimem_req_t batch[SPIMEM_SERVER_BATCH];
+static int batch_result[SPIMEM_SERVER_BATCH];
+static uint8_t merge_buff[SPIMEM_SERVER_MERGE];
+
+/************************************************************************/
+/* SPIMEM_SERVER (Function)												*/
+/* @Purpose: This function is used to create the SPI memory server task.*/
+/************************************************************************/
+TaskHandle_t spimem_server( void )
+{
+	uint32_t i;
+	TaskHandle_t temp_HANDLE = 0;
+
+	if(!spimem_req_pending)
+	{
+		spimem_req_high = xQueueCreate(SPIMEM_SERVER_QUEUE_LEN, sizeof(spimem_req_t));
+		spimem_req_low = xQueueCreate(SPIMEM_SERVER_QUEUE_LEN, sizeof(spimem_req_t));
+		spimem_req_pending = xSemaphoreCreateCounting(2 * SPIMEM_SERVER_QUEUE_LEN, 0);
+		for(i = 0; i < SPIMEM_SERVER_SLOTS; i++)
+		{
+			spimem_slots[i].done = xSemaphoreCreateBinary();
+			spimem_slots[i].state = SLOT_FREE;
+		}
+	}
+
+	xTaskCreate( prvSpimemServerTask,					/* The function that implements the task. */
+				"SPIMEM", 							/* The text name assigned to the task - for debug only as it is not used by the kernel. */
+				SPIMEM_SERVER_STACK, 				/* The size of the stack to allocate to the task. */
+				( void * ) SPIMEM_SERVER_PARAMETER, /* The parameter passed to the task - just to check the functionality. */
+				SPIMEM_SERVER_PRIORITY, 			/* The priority assigned to the task. */
+				&temp_HANDLE );						/* The task handle is returned so that FDIR can kill the task. */
+
+	return temp_HANDLE;
+}
+
+/************************************************************************/
+/*				SPIMEM SERVER (TASK)	                                */
+/*	Sleeps until a request arrives, then handles a batch of them.		*/
+/************************************************************************/
+static void prvSpimemServerTask( void *pvParameters )
+{
+	uint32_t count, i;
+	configASSERT( ( ( unsigned long ) pvParameters ) == SPIMEM_SERVER_PARAMETER );
+
+	/* @non-terminating@ */
+	for( ;; )
+	{
+		if(xSemaphoreTake(spimem_req_pending, (TickType_t)SPIMEM_CACHE_FLUSH_PERIOD) != pdTRUE)
+		{
+			server_idle();
+			continue;
+		}
+
+		count = 0;
+		while((count < SPIMEM_SERVER_BATCH) && (xQueueReceive(spimem_req_high, &batch[count], (TickType_t)0) == pdTRUE))
+			count++;
+		while((count < SPIMEM_SERVER_BATCH) && (xQueueReceive(spimem_req_low, &batch[count], (TickType_t)0) == pdTRUE))
+			count++;
+		for(i = 1; i < count; i++)
+			xSemaphoreTake(spimem_req_pending, (TickType_t)0);	// One count was already taken above.
+
+		count = claim_batch(count);
+		if(count)
+			process_batch(count);
+	}
+}
+
+/************************************************************************/
+/* CLAIM_BATCH															*/
+/* @Purpose: Marks the blocking requests in batch[0..count-1] as taken	*/
+/* by the server and drops the ones whose client already gave up, so	*/
+/* that a cancelled request's buffer is never touched.					*/
+/* @return: The number of requests left in batch[].						*/
+/************************************************************************/
+static uint32_t claim_batch(uint32_t count)
+{
+	uint32_t i, kept = 0;
+	spimem_slot_t* slot;
+
+	for(i = 0; i < count; i++)
+	{
+		if(batch[i].slot >= 0)
+		{
+			slot = &spimem_slots[(uint8_t)batch[i].slot];
+			taskENTER_CRITICAL();
+			if(slot->state == SLOT_CANCELLED)
+			{
+				slot->state = SLOT_FREE;
+				taskEXIT_CRITICAL();
+				continue;
+			}
+			slot->state = SLOT_ACTIVE;
+			taskEXIT_CRITICAL();
+		}
+		if(kept != i)
+			batch[kept] = batch[i];
+		kept++;
+	}
+	return kept;
+}
+
+/************************************************************************/
+/* PROCESS_BATCH														*/
+/* @Purpose: Carries out batch[0..count-1] while holding Spi0_Mutex and	*/
+/* then tells every client how its request went.						*/
+/************************************************************************/
+static void process_batch(uint32_t count)
+{
+	uint32_t i, j, k, total;
+	int ret;
+
+	for(i = 0; i < count; i++)
+		batch_result[i] = -1;
+
+	if (xSemaphoreTake(Spi0_Mutex, (TickType_t)SPIMEM_SERVER_TIMEOUT) == pdTRUE)
+	{
+		for(i = 0; i < count; i++)
+		{
+			switch(batch[i].op)
+			{
+				case SPIMEM_OP_WRITE:
+					/* Gather the writes which continue exactly where this one ends. */
+					total = batch[i].size;
+					for(j = i + 1; j < count; j++)
+					{
+						if((batch[j].op != SPIMEM_OP_WRITE) || (batch[j].addr != (batch[i].addr + total)) || ((total + batch[j].size) > SPIMEM_SERVER_MERGE))
+							break;
+						total += batch[j].size;
+					}
+					if(j == (i + 1))
+						batch_result[i] = spimem_cache_write_h(batch[i].addr, batch[i].buff, batch[i].size);
+					else
+					{
+						total = 0;
+						for(k = i; k < j; k++)
+						{
+							memcpy(merge_buff + total, batch[k].buff, batch[k].size);
+							total += batch[k].size;
+						}
+						ret = spimem_cache_write_h(batch[i].addr, merge_buff, total);
+						/* Hand each client the part of a short write which belongs to it. */
+						total = 0;
+						for(k = i; k < j; k++)
+						{
+							if(ret >= (int)(total + batch[k].size))
+								batch_result[k] = batch[k].size;
+							else if(ret > (int)total)
+								batch_result[k] = ret - total;
+							total += batch[k].size;
+						}
+						i = j - 1;
+					}
+					break;
+				case SPIMEM_OP_READ:
+					if(batch[i].chunk_size)
+					{
+						if(spimem_cache_flush_h(batch[i].addr, batch[i].size) > 0)		// Streams bypass the cache.
+							batch_result[i] = spimem_ftl_read_h(batch[i].addr, batch[i].size, batch[i].buff, batch[i].chunk_size, batch[i].chunk_cb, batch[i].chunk_arg);
+						break;
+					}
+					if(serve_read_from_batch(i) > 0)
+					{
+						batch_result[i] = batch[i].size;
+						break;
+					}
+					batch_result[i] = spimem_cache_read_h(batch[i].addr, batch[i].buff, batch[i].size);
+					break;
+				case SPIMEM_OP_READ_VOTED:
+					if(serve_read_from_batch(i) > 0)
+					{
+						batch_result[i] = batch[i].size;
+						break;
+					}
+					batch_result[i] = spimem_cache_read_voted_h(batch[i].addr, batch[i].buff, batch[i].size);
+					break;
+				case SPIMEM_OP_ERASE:
+					if(spimem_cache_flush_h(batch[i].addr, batch[i].size) < 0)
+						break;
+					spimem_cache_invalidate_h(batch[i].addr, batch[i].size);
+					batch_result[i] = spimem_ftl_trim_h(batch[i].addr, batch[i].size);
+					break;
+				default:
+					break;
+			}
+		}
+		if(spimem_cache_flush_due() || spimem_edac_flush_due())
+		{
+			spimem_cache_flush_h(0, SPIMEM_LOGICAL_SIZE);
+			spimem_edac_flush_h();
+		}
+		spimem_ftl_repair_h();								// At most one page per batch.
+		xSemaphoreGive(Spi0_Mutex);
+		spimem_report_failed_chips();
+	}
+
+	for(i = 0; i < count; i++)
+		complete_request(&batch[i], batch_result[i]);
+	return;
+}
+
+/************************************************************************/
+/* SERVER_IDLE															*/
+/* @Purpose: Background work for when no request has come in for		*/
+/* SPIMEM_CACHE_FLUSH_PERIOD ticks: write the cached pages back and		*/
+/* repair the pages which lost a vote.									*/
+/************************************************************************/
+static void server_idle(void)
+{
+	if (xSemaphoreTake(Spi0_Mutex, (TickType_t)10) != pdTRUE)
+		return;
+	spimem_cache_flush_h(0, SPIMEM_LOGICAL_SIZE);
+	spimem_edac_flush_h();
+	while(spimem_ftl_repair_h() > 0)
+	{
+		if(uxQueueMessagesWaiting(spimem_req_high) || uxQueueMessagesWaiting(spimem_req_low))
+			break;										// Clients come first.
+	}
+	xSemaphoreGive(Spi0_Mutex);
+	spimem_report_failed_chips();
+	return;
+}
+
+/************************************************************************/
+/* SERVE_READ_FROM_BATCH												*/
+/* @Purpose: Looks back through the current batch for a successful		*/
+/* write which covers the whole of read request batch[index].			*/
+/* @param: index: The read request within batch[].						*/
+/* @return: 1 == The read was filled in from the write's data,			*/
+/* -1 == The read has to go to SPI memory.								*/
+/* NOTE: The search stops at the first earlier write/erase which			*/
+/* overlaps the read without covering it, since that request changed	*/
+/* part of what the read would see.										*/
+/************************************************************************/
+static int serve_read_from_batch(uint32_t index)
+{
+	uint32_t k, start, end;
+	spimem_req_t* rd = &batch[index];
+
+	for(k = index; k > 0; k--)
+	{
+		spimem_req_t* wr = &batch[k - 1];
+		if((wr->op != SPIMEM_OP_WRITE) && (wr->op != SPIMEM_OP_ERASE))
+			continue;
+		start = wr->addr;
+		end = wr->addr + wr->size;
+		if((end <= rd->addr) || (start >= (rd->addr + rd->size)))
+			continue;											// No overlap, keep looking.
+		if((wr->op == SPIMEM_OP_WRITE) && (batch_result[k - 1] == (int)wr->size) && (start <= rd->addr) && (end >= (rd->addr + rd->size)))
+		{
+			memcpy(rd->buff, wr->buff + (rd->addr - start), rd->size);
+			return 1;
+		}
+		return -1;
+	}
+	return -1;
+}
+
+/************************************************************************/
+/* COMPLETE_REQUEST														*/
+/* @Purpose: Hands the result of a request back to whoever submitted it.*/
+/* @param: req: The request which was carried out.						*/
+/* @param: result: -1 == Failure, otherwise the number of bytes handled.*/
+/************************************************************************/
+static void complete_request(spimem_req_t* req, int result)
+{
+	spimem_slot_t* slot;
+
+	if(req->slot < 0)
+	{
+		if(req->callback)
+			req->callback(req->arg, result);
+		return;
+	}
+
+	slot = &spimem_slots[(uint8_t)req->slot];
+	taskENTER_CRITICAL();
+	slot->result = result;
+	slot->state = SLOT_DONE;
+	taskEXIT_CRITICAL();
+	xSemaphoreGive(slot->done);
+	return;
+}
+
+/************************************************************************/
+/* SUBMIT_REQUEST														*/
+/* @Purpose: Places a request in the queue matching its priority and	*/
+/* wakes up the server.													*/
+/* @param: req: The request to submit.									*/
+/* @param: timeout: Ticks to wait for room in the queue.				*/
+/* @return: -1 == The queue stayed full, 1 == Submitted.				*/
+/************************************************************************/
+static int submit_request(spimem_req_t* req, TickType_t timeout)
+{
+	QueueHandle_t queue;
+
+	queue = (req->prio == SPIMEM_PRIO_HIGH) ? spimem_req_high : spimem_req_low;
+	if(xQueueSendToBack(queue, req, timeout) != pdTRUE)
+		return -1;
+	xSemaphoreGive(spimem_req_pending);
+	return 1;
+}
+
+/************************************************************************/
+/* SPIMEM_SERVER_REQUEST												*/
+/* @Purpose: Submits a request to the SPI memory server and waits for	*/
+/* it to be carried out.												*/
+/* @param: op: SPIMEM_OP_READ, SPIMEM_OP_WRITE or SPIMEM_OP_ERASE.		*/
+/* @param: prio: SPIMEM_PRIO_HIGH or SPIMEM_PRIO_LOW.					*/
+/* @param: addr: Logical address within SPI memory.						*/
+/* @param: buff: Data to write / where to place read data (unused for	*/
+/* erase requests).														*/
+/* @param: size: Number of bytes.										*/
+/* @param: timeout: Ticks to wait for the request to be carried out.	*/
+/* @return: -1 == Failure or timeout, otherwise the number of bytes		*/
+/* read/written/erased.													*/
+/* NOTE: A request which is still queued when timeout runs out is		*/
+/* cancelled, the server drops it without touching buff. A request which*/
+/* the server has already started is waited for, however long that		*/
+/* takes, because the server is reading/writing buff (which is usually	*/
+/* on the caller's stack). Either way buff is free once this returns.	*/
+/************************************************************************/
+int spimem_server_request(uint8_t op, uint8_t prio, uint32_t addr, uint8_t* buff, uint32_t size, TickType_t timeout)
+{
+	spimem_req_t req;
+
+	req.op = op;
+	req.prio = prio;
+	req.addr = addr;
+	req.buff = buff;
+	req.size = size;
+	req.chunk_cb = 0;
+	req.chunk_arg = 0;
+	req.chunk_size = 0;
+	return request_blocking(&req, timeout);
+}
+
+/************************************************************************/
+/* SPIMEM_SERVER_READ_STREAM											*/
+/* @Purpose: Has the SPI memory server read a region and hand it to		*/
+/* chunk_cb in chunks as it arrives, see spimem_read_stream_cb(). Waits	*/
+/* until the whole region has been read.								*/
+/* @param: prio: SPIMEM_PRIO_HIGH or SPIMEM_PRIO_LOW.					*/
+/* @param: addr: Logical address within SPI memory.						*/
+/* @param: size: Number of bytes.										*/
+/* @param: chunk_buff: Scratch buffer of chunk_size bytes.				*/
+/* @param: chunk_size: Bytes handed to chunk_cb at a time.				*/
+/* @param: chunk_cb: Called from the server task while it holds			*/
+/* Spi0_Mutex, returning < 0 ends the read early. 0 = read everything	*/
+/* into chunk_buff, which must then hold size bytes.					*/
+/* @param: chunk_arg: Passed to chunk_cb.								*/
+/* @param: timeout: Ticks to wait for the read to be started.			*/
+/* @return: -1 == Failure or timeout, otherwise the number of bytes		*/
+/* read and accepted by chunk_cb.										*/
+/************************************************************************/
+int spimem_server_read_stream(uint8_t prio, uint32_t addr, uint32_t size, uint8_t* chunk_buff, uint32_t chunk_size, int (*chunk_cb)(void*, uint32_t, uint8_t*, uint32_t), void* chunk_arg, TickType_t timeout)
+{
+	spimem_req_t req;
+
+	if(!chunk_size)
+		return -1;
+	req.op = SPIMEM_OP_READ;
+	req.prio = prio;
+	req.addr = addr;
+	req.buff = chunk_buff;
+	req.size = size;
+	req.chunk_cb = chunk_cb;
+	req.chunk_arg = chunk_arg;
+	req.chunk_size = chunk_size;
+	return request_blocking(&req, timeout);
+}
+
+/************************************************************************/
+/* REQUEST_BLOCKING														*/
+/* @Purpose: Submits req from the calling task and waits for it, see	*/
+/* spimem_server_request() for how a timeout is handled.				*/
+/* @param: req: op, prio, addr, buff, size and the chunk fields set.	*/
+/* @param: timeout: Ticks to wait for the request to be carried out.	*/
+/* @return: -1 == Failure or timeout, otherwise the request's result.	*/
+/************************************************************************/
+static int request_blocking(spimem_req_t* req, TickType_t timeout)
+{
+	spimem_slot_t* slot;
+	int8_t i;
+	int result;
+
+	if(!spimem_req_pending || !req->size)
+		return -1;
+	taskENTER_CRITICAL();
+	for(i = 0; i < SPIMEM_SERVER_SLOTS; i++)
+	{
+		if(spimem_slots[i].state == SLOT_FREE)
+		{
+			spimem_slots[i].state = SLOT_QUEUED;
+			break;
+		}
+	}
+	taskEXIT_CRITICAL();
+	if(i == SPIMEM_SERVER_SLOTS)
+		return -1;
+	slot = &spimem_slots[i];
+	xSemaphoreTake(slot->done, (TickType_t)0);					// Make sure the slot starts out empty.
+
+	req->slot = i;
+	req->callback = 0;
+	req->arg = 0;
+	if(submit_request(req, timeout) < 0)
+	{
+		slot->state = SLOT_FREE;
+		return -1;
+	}
+
+	if(xSemaphoreTake(slot->done, timeout) == pdTRUE)
+	{
+		result = slot->result;
+		slot->state = SLOT_FREE;
+		return result;
+	}
+
+	taskENTER_CRITICAL();
+	if(slot->state == SLOT_QUEUED)
+	{
+		slot->state = SLOT_CANCELLED;							// The server will drop it, buff is ours again.
+		taskEXIT_CRITICAL();
+		return -1;
+	}
+	taskEXIT_CRITICAL();
+
+	/* The server is using buff right now (or finished just as we gave up), so wait for it.	*/
+	/* spimem_server_kill() releases the slot if the server is killed in the meantime.		*/
+	xSemaphoreTake(slot->done, portMAX_DELAY);
+	result = slot->result;
+	slot->state = SLOT_FREE;
+	return result;
+}
+
+/************************************************************************/
+/* SPIMEM_SERVER_REQUEST_ASYNC											*/
+/* @Purpose: Submits a request to the SPI memory server without waiting.*/
+/* @param: op, prio, addr, buff, size: As in spimem_server_request().	*/
+/* @param: callback: Called from the server task with the result once	*/
+/* the request has been carried out (may be 0).							*/
+/* @param: arg: Passed to callback.										*/
+/* @return: -1 == The queue is full, 1 == Submitted.					*/
+/* NOTE: buff belongs to the server until callback is called.			*/
+/************************************************************************/
+int spimem_server_request_async(uint8_t op, uint8_t prio, uint32_t addr, uint8_t* buff, uint32_t size, spimem_req_cb_t callback, void* arg)
+{
+	spimem_req_t req;
+
+	if(!spimem_req_pending || !size)
+		return -1;
+
+	req.op = op;
+	req.prio = prio;
+	req.slot = -1;
+	req.addr = addr;
+	req.buff = buff;
+	req.size = size;
+	req.callback = callback;
+	req.arg = arg;
+	req.chunk_cb = 0;
+	req.chunk_arg = 0;
+	req.chunk_size = 0;
+	return submit_request(&req, (TickType_t)0);
+}
+
+/************************************************************************/
+/* SPIMEM_SERVER_RUNNING												*/
+/* @Purpose: Tells spimem.c whether requests should go through the		*/
+/* server.																*/
+/* @return: 1 == Use the server, 0 == Access SPI memory directly (the	*/
+/* scheduler is not running yet, the server was killed, or the caller	*/
+/* is the server itself).												*/
+/************************************************************************/
+uint8_t spimem_server_running(void)
+{
+	if(!spimem_server_HANDLE || !spimem_req_pending)
+		return 0;
+	if(xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+		return 0;
+	if(xTaskGetCurrentTaskHandle() == spimem_server_HANDLE)
+		return 0;
+	return 1;
+}
+
+// This function will be used in the event that the SPI memory server needs to be restarted or killed.
+void spimem_server_kill(uint8_t killer)
+{
+	TaskHandle_t temp_HANDLE = spimem_server_HANDLE;
+	uint8_t i;
+
+	// Clear the handle first so that new requests go straight to SPI memory.
+	spimem_server_HANDLE = 0;
+	if(!killer)
+		vTaskDelete(NULL);
+	// Kill the task, then fail the requests it was in the middle of so their clients stop waiting.
+	vTaskDelete(temp_HANDLE);
+	for(i = 0; i < SPIMEM_SERVER_SLOTS; i++)
+	{
+		taskENTER_CRITICAL();
+		if(spimem_slots[i].state != SLOT_ACTIVE)
+		{
+			taskEXIT_CRITICAL();
+			continue;
+		}
+		spimem_slots[i].result = -1;
+		spimem_slots[i].state = SLOT_DONE;
+		taskEXIT_CRITICAL();
+		xSemaphoreGive(spimem_slots[i].done);
+	}
+	return;
+}
@@ -0,0 +1,80 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		spimem_server.h
+*
+*	PURPOSE:		Houses the includes and definitions for spimem_server.c
+*
+*	FILE REFERENCES:		FreeRTOS.h, task.h, queue.h, semphr.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	None
+*
+*	NOTES:
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created
+*
+*					Added spimem_server_read_stream(), a SPIMEM_OP_READ with a chunk_size.
+*
+*/
+
+#ifndef SPIMEM_SERVER_H
+#define SPIMEM_SERVER_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Request types */
+#define SPIMEM_OP_READ			1			// With a chunk_size, a stream read (spimem_read_stream_cb()).
+#define SPIMEM_OP_WRITE			2
+#define SPIMEM_OP_ERASE			3			// Logical erase, the region reads back as 0xFF.
+#define SPIMEM_OP_READ_VOTED	4			// Read with the three chips majority-voted.
+
+/* Request priorities */
+#define SPIMEM_PRIO_LOW			0
+#define SPIMEM_PRIO_HIGH		1
+
+#define SPIMEM_SERVER_QUEUE_LEN	8			// Per priority.
+#define SPIMEM_SERVER_BATCH		8			// Requests handled per acquisition of Spi0_Mutex.
+#define SPIMEM_SERVER_SLOTS		8			// Clients which may be blocked on a request at once.
+#define SPIMEM_SERVER_MERGE		512			// Largest write the server will build out of adjacent writes.
+#define SPIMEM_SERVER_TIMEOUT	5000		// Ticks a blocking client waits for its request.
+
+/* Called from the server task once an asynchronous request is done */
+typedef void (*spimem_req_cb_t)(void* arg, int result);
+
+typedef struct
+{
+	uint8_t op;
+	uint8_t prio;
+	int8_t slot;							// Blocking client's slot, -1 = asynchronous.
+	uint32_t addr;
+	uint8_t* buff;
+	uint32_t size;
+	spimem_req_cb_t callback;
+	void* arg;
+	int (*chunk_cb)(void*, uint32_t, uint8_t*, uint32_t);	// Stream reads: buff is refilled and handed to chunk_cb
+	void* chunk_arg;										// chunk_size bytes at a time (chunk_cb == 0: all of it
+	uint32_t chunk_size;									// lands in buff). chunk_size == 0 = an ordinary read.
+} spimem_req_t;
+
+/*		Function Prototypes				*/
+TaskHandle_t spimem_server(void);
+void spimem_server_kill(uint8_t killer);
+uint8_t spimem_server_running(void);
+int spimem_server_request(uint8_t op, uint8_t prio, uint32_t addr, uint8_t* buff, uint32_t size, TickType_t timeout);	// API, BLOCKS FOR timeout
+int spimem_server_read_stream(uint8_t prio, uint32_t addr, uint32_t size, uint8_t* chunk_buff, uint32_t chunk_size, int (*chunk_cb)(void*, uint32_t, uint8_t*, uint32_t), void* chunk_arg, TickType_t timeout);	// API, BLOCKS FOR timeout
+int spimem_server_request_async(uint8_t op, uint8_t prio, uint32_t addr, uint8_t* buff, uint32_t size, spimem_req_cb_t callback, void* arg);	// API, NON-BLOCKING
+
+#endif
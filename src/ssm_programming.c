@@ -26,6 +26,9 @@
 *	DEVELOPMENT HISTORY:
 *	01/12/2016			Created.
 *
+*	10/16/2026			reprogram_ssm() no longer disables interrupts for the whole upload, Spi0_Mutex is enough.
+*						The program length is read with the three SPI chips voted.
+*
 *	DESCRIPTION:
 *
 */
@@ -73,7 +76,7 @@ int reprogram_ssm(uint8_t ssmID)
 		RST = COMS_RST_GPIO;
 	}
 	
-	spimem_read(base, msg, 4);
+	spimem_read_voted(base, msg, 4);
 	length = (uint32_t)msg[0];
 	length += ((uint32_t)msg[1]) << 8;
 	length += ((uint32_t)msg[2]) << 16;
@@ -83,15 +86,13 @@ int reprogram_ssm(uint8_t ssmID)
 	
 	if (xSemaphoreTake(Spi0_Mutex, (TickType_t) 1000) == pdTRUE)	// Block for up to one second on the Spi0_Mutex.
 	{
-		enter_atomic();		// Uninterrupted sequence of actions below
-		
+		/* Spi0_Mutex keeps everyone else off the bus, interrupts stay enabled (this takes seconds). */
 		gpio_set_pin_high(SPI0_MEM1_HOLD);	// Turn memory holding on for SPIMEM1
 
 		ret_val = initialize_reprogramming(ssmID);
 		if(ret_val < 0)
 		{
 			xSemaphoreGive(Spi0_Mutex);
-			exit_atomic();
 			gpio_set_pin_low(SPI0_MEM1_HOLD);	// Turn memory holding off for SPIMEM1
 			gpio_set_pin_high(RST);
 			ret_val -= 3;
@@ -106,7 +107,6 @@ int reprogram_ssm(uint8_t ssmID)
 		if(ret_val < 0)
 		{
 			xSemaphoreGive(Spi0_Mutex);
-			exit_atomic();
 			gpio_set_pin_low(SPI0_MEM1_HOLD);	// Turn memory holding off for SPIMEM1
 			gpio_set_pin_high(RST);
 			ret_val -= 6;
@@ -114,7 +114,6 @@ int reprogram_ssm(uint8_t ssmID)
 		}
 		
 		xSemaphoreGive(Spi0_Mutex);
-		exit_atomic();
 		gpio_set_pin_low(SPI0_MEM1_HOLD);	// Turn memory holding off for SPIMEM1
 		gpio_set_pin_high(RST);
 		return 1;
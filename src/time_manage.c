@@ -36,6 +36,8 @@ Author: Keenan Burnett, Omar Abdeldayem
 *				what this file is meant for.
 *
 * 01/15/2015    A: Added wrapper function to handle FIFO errors.
+*
+* 10/16/2026	report_time() gives opr_wake_sem after sending to time_to_obc_fifo.
 * DESCRIPTION:
 */
 
@@ -127,9 +129,8 @@ static void prvTimeManageTask( void *pvParameters )
 	/* @non-terminating@ */	
 	for( ;; )
 	{
-		if (rtc_triggered_a2())
+		if (rtc_triggered_a2() && (rtc_get(&time) > 0))		// Try again next time if SPI0 was busy.
 		{
-			rtc_get(&time);
 			update_absolute_time();
 			//broadcast_minute();			
 			minute_count++;
@@ -202,7 +203,8 @@ void report_time(void)
 	current_command[1] = absolute_time_arr[1];
 	current_command[0] = absolute_time_arr[0];
 	
-	xQueueSendToBack(time_to_obc_fifo, current_command, (TickType_t)1);
+	if(xQueueSendToBack(time_to_obc_fifo, current_command, (TickType_t)1) == pdTRUE)
+		xSemaphoreGive(opr_wake_sem);		// The packet router blocks until it is given.
 	minute_count = 0;
 	return;
 }
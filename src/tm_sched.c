@@ -0,0 +1,326 @@
+/*
+	Author: agent
+	***********************************************************************
+*	FILE NAME:		tm_sched.c
+*
+*	PURPOSE:		Houses the per-class queues which TM packets wait in between being built by the
+*					packet router and being handed to the COMS SSM, and the scheduler which decides
+*					which class goes down next.
+*
+*	FILE REFERENCES:		tm_sched.h, pus_pool.h, global_var.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	tm_sched_init() is called before the scheduler starts.
+*											Only the packet router puts and gets, any task may read the
+*											statistics. DO NOT call these functions from an ISR.
+*
+*	NOTES:		Every TM packet used to wait in tm_buffer, so a burst of one class (science, HK)
+*				held up the packets behind it and could fill the FIFO for everyone. Each class now
+*				has its own queue of pool descriptors (see tm_class_config[]):
+*
+*				Verification and event reports have strict priority, in that order. The other
+*				classes share what is left by weighted round robin, every class with packets
+*				waiting gets its weight in packets per round.
+*
+*				Verifications are never dropped, a packet which doesn't fit stays in current_tm
+*				and is retried. Event reports keep the first ones in a burst (the cause), HK and
+*				science keep the latest. Memory dumps are refused before they are built, the dump
+*				stays in mem_to_obc_fifo and the memory task waits (tm_sched_room()).
+*
+*				Event reports and HK which don't fit go to the TM store in SPI memory instead, and
+*				come back through TM_CLASS_STORED, which is refilled as it drains.
+*
+*				The queues can hold more packets than the pool has buffers. Bulk producers leave
+*				PUS_POOL_RESERVE buffers free, which is what the packet router builds verification
+*				and event reports in.
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026			Created.
+*
+*						Added TM_CLASS_STORED and tm_sched_overflow() for the TM store.
+*
+*/
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "global_var.h"
+
+#include "pus_pool.h"
+
+#include "tm_sched.h"
+
+#define TM_CLASS_NONE		0xFF
+
+typedef struct
+{
+	uint8_t depth;				// Packets which may wait, <= TM_SCHED_MAX_DEPTH.
+	uint8_t weight;				// Packets per round, 0 = strict priority.
+	uint8_t policy;				// TM_POLICY_*
+	uint8_t store;				// 1 = a full queue overflows to the TM store first, the policy applies when that is full too.
+} tm_class_config_t;
+
+static const tm_class_config_t tm_class_config[TM_CLASSES] =
+{
+	{ 4, 0, TM_POLICY_REFUSE, 0 },			// TM_CLASS_VERIFY
+	{ 4, 0, TM_POLICY_DROP_NEWEST, 1 },		// TM_CLASS_EVENT
+	{ 3, 2, TM_POLICY_DROP_OLDEST, 1 },		// TM_CLASS_HK
+	{ 3, 1, TM_POLICY_REFUSE, 0 },			// TM_CLASS_DUMP
+	{ 2, 1, TM_POLICY_DROP_OLDEST, 0 },		// TM_CLASS_SCIENCE
+	{ 2, 1, TM_POLICY_REFUSE, 0 }			// TM_CLASS_STORED
+};
+
+/* Local variables for the TM queues */
+static uint8_t tm_queue[TM_CLASSES][TM_SCHED_MAX_DEPTH];
+static TickType_t tm_queue_time[TM_CLASSES][TM_SCHED_MAX_DEPTH];	// Tick each packet was queued at.
+static uint8_t tm_queue_head[TM_CLASSES], tm_queue_count[TM_CLASSES];
+static uint32_t tm_queue_drops[TM_CLASSES];
+static uint8_t tm_credit[TM_CLASSES];			// Packets left in this round.
+static uint8_t tm_next_class;					// Where the round robin carries on from.
+
+static uint8_t tm_sched_pick_h(void);
+static uint8_t tm_sched_pop_h(uint8_t tm_class);
+
+/************************************************************************/
+/* TM_SCHED_INIT														*/
+/* @Purpose: Empties every queue and clears the statistics.				*/
+/************************************************************************/
+void tm_sched_init(void)
+{
+	uint8_t i;
+	for(i = 0; i < TM_CLASSES; i++)
+	{
+		tm_queue_head[i] = 0;
+		tm_queue_count[i] = 0;
+		tm_queue_drops[i] = 0;
+		tm_credit[i] = tm_class_config[i].weight;
+	}
+	tm_next_class = 0;
+	return;
+}
+
+/************************************************************************/
+/* TM_SCHED_CLASS														*/
+/* @param: packet: A TM packet with its header written.					*/
+/* @return: The class of the packet, going by its service type and		*/
+/* subtype.																*/
+/************************************************************************/
+uint8_t tm_sched_class(const uint8_t* packet)
+{
+	switch(packet[144])
+	{
+		case 1:
+			return TM_CLASS_VERIFY;
+		case 5:
+			return TM_CLASS_EVENT;
+		case MEMORY_SERVICE:
+			if(packet[143] == DOWNLINKING_SCIENCE)
+				return TM_CLASS_SCIENCE;
+			return TM_CLASS_DUMP;
+		default:
+			return TM_CLASS_HK;
+	}
+}
+
+/************************************************************************/
+/* TM_SCHED_ROOM														*/
+/* @param: tm_class: TM_CLASS_*											*/
+/* @return: 1 = a packet of this class would not be refused right now,	*/
+/* 0 = it would be (TM_POLICY_REFUSE and the queue is full).			*/
+/************************************************************************/
+int tm_sched_room(uint8_t tm_class)
+{
+	if(tm_class >= TM_CLASSES)
+		return 0;
+	if(tm_class_config[tm_class].policy != TM_POLICY_REFUSE)
+		return 1;
+	return (tm_queue_count[tm_class] < tm_class_config[tm_class].depth);
+}
+
+/************************************************************************/
+/* TM_SCHED_OVERFLOW													*/
+/* @param: tm_class: TM_CLASS_*											*/
+/* @return: 1 = the queue is full and the class overflows to the TM		*/
+/* store, 0 = tm_sched_put() as usual.									*/
+/************************************************************************/
+int tm_sched_overflow(uint8_t tm_class)
+{
+	if(tm_class >= TM_CLASSES)
+		return 0;
+	return (tm_class_config[tm_class].store && (tm_queue_count[tm_class] >= tm_class_config[tm_class].depth));
+}
+
+/************************************************************************/
+/* TM_SCHED_PUT															*/
+/* @param: tm_class: TM_CLASS_*											*/
+/* @param: desc: Descriptor of the packet, the caller's reference goes	*/
+/* with it unless TM_SCHED_FULL is returned.							*/
+/* @Purpose: Queues a packet for downlink, applying the drop policy of	*/
+/* its class when the queue is full.									*/
+/* @return: TM_SCHED_QUEUED, TM_SCHED_DROPPED or TM_SCHED_FULL.			*/
+/************************************************************************/
+int tm_sched_put(uint8_t tm_class, uint8_t desc)
+{
+	const tm_class_config_t* config;
+	uint8_t dropped = PUS_POOL_NONE;
+	uint8_t slot;
+
+	if((tm_class >= TM_CLASSES) || (desc == PUS_POOL_NONE))
+		return TM_SCHED_FULL;
+	config = &tm_class_config[tm_class];
+
+	taskENTER_CRITICAL();
+	if(tm_queue_count[tm_class] >= config->depth)
+	{
+		if(config->policy == TM_POLICY_REFUSE)
+		{
+			taskEXIT_CRITICAL();
+			return TM_SCHED_FULL;
+		}
+		tm_queue_drops[tm_class]++;
+		if(config->policy == TM_POLICY_DROP_NEWEST)
+		{
+			taskEXIT_CRITICAL();
+			pus_pool_release(desc);
+			return TM_SCHED_DROPPED;
+		}
+		dropped = tm_sched_pop_h(tm_class);
+	}
+	slot = (tm_queue_head[tm_class] + tm_queue_count[tm_class]) % TM_SCHED_MAX_DEPTH;
+	tm_queue[tm_class][slot] = desc;
+	tm_queue_time[tm_class][slot] = xTaskGetTickCount();
+	tm_queue_count[tm_class]++;
+	taskEXIT_CRITICAL();
+
+	if(dropped != PUS_POOL_NONE)
+	{
+		pus_pool_release(dropped);
+		return TM_SCHED_DROPPED;
+	}
+	return TM_SCHED_QUEUED;
+}
+
+/************************************************************************/
+/* TM_SCHED_GET															*/
+/* @param: desc: Where to put the descriptor of the next packet to		*/
+/* downlink, its reference goes to the caller.							*/
+/* @return: pdTRUE = a packet was taken, pdFALSE = every queue is empty.*/
+/************************************************************************/
+BaseType_t tm_sched_get(uint8_t* desc)
+{
+	uint8_t tm_class;
+
+	taskENTER_CRITICAL();
+	tm_class = tm_sched_pick_h();
+	if(tm_class == TM_CLASS_NONE)
+	{
+		taskEXIT_CRITICAL();
+		return pdFALSE;
+	}
+	*desc = tm_sched_pop_h(tm_class);
+	taskEXIT_CRITICAL();
+	return pdTRUE;
+}
+
+/************************************************************************/
+/* TM_SCHED_COUNT														*/
+/* @return: The number of packets waiting in all the queues.			*/
+/************************************************************************/
+UBaseType_t tm_sched_count(void)
+{
+	UBaseType_t count = 0;
+	uint8_t i;
+	for(i = 0; i < TM_CLASSES; i++)
+		count += tm_queue_count[i];
+	return count;
+}
+
+/************************************************************************/
+/* TM_SCHED_STAT														*/
+/* @param: tm_class: TM_CLASS_*											*/
+/* @param: stat: TM_STAT_DEPTH, TM_STAT_AGE or TM_STAT_DROPS.			*/
+/* @return: The value of the statistic, 0 for an invalid class.			*/
+/************************************************************************/
+uint32_t tm_sched_stat(uint8_t tm_class, uint8_t stat)
+{
+	uint32_t val = 0;
+
+	if(tm_class >= TM_CLASSES)
+		return 0;
+	taskENTER_CRITICAL();
+	switch(stat)
+	{
+		case TM_STAT_DEPTH:
+			val = tm_queue_count[tm_class];
+			break;
+		case TM_STAT_AGE:
+			if(tm_queue_count[tm_class])
+				val = (uint32_t)(xTaskGetTickCount() - tm_queue_time[tm_class][tm_queue_head[tm_class]]);
+			break;
+		case TM_STAT_DROPS:
+			val = tm_queue_drops[tm_class];
+			break;
+		default:
+			break;
+	}
+	taskEXIT_CRITICAL();
+	return val;
+}
+
+/************************************************************************/
+/* TM_SCHED_PICK_H														*/
+/* @Purpose: Chooses the class which the next packet comes from. The	*/
+/* strict priority classes go first, then the weighted classes take		*/
+/* turns. When no class with packets waiting has credit left, a new		*/
+/* round starts.														*/
+/* @return: The class, TM_CLASS_NONE = nothing is waiting.				*/
+/* @NOTE: The caller must be in a critical section.						*/
+/************************************************************************/
+static uint8_t tm_sched_pick_h(void)
+{
+	uint8_t i, tm_class, round;
+
+	for(i = 0; i < TM_CLASSES; i++)
+	{
+		if(!tm_class_config[i].weight && tm_queue_count[i])
+			return i;
+	}
+	for(round = 0; round < 2; round++)
+	{
+		for(i = 0; i < TM_CLASSES; i++)
+		{
+			tm_class = (tm_next_class + i) % TM_CLASSES;
+			if(!tm_class_config[tm_class].weight || !tm_queue_count[tm_class] || !tm_credit[tm_class])
+				continue;
+			if(!--tm_credit[tm_class])
+				tm_next_class = (tm_class + 1) % TM_CLASSES;
+			else
+				tm_next_class = tm_class;
+			return tm_class;
+		}
+		for(i = 0; i < TM_CLASSES; i++)
+			tm_credit[i] = tm_class_config[i].weight;
+	}
+	return TM_CLASS_NONE;
+}
+
+/************************************************************************/
+/* TM_SCHED_POP_H														*/
+/* @param: tm_class: A class with at least one packet waiting.			*/
+/* @return: The descriptor of the oldest packet, which is removed.		*/
+/* @NOTE: The caller must be in a critical section.						*/
+/************************************************************************/
+static uint8_t tm_sched_pop_h(uint8_t tm_class)
+{
+	uint8_t desc = tm_queue[tm_class][tm_queue_head[tm_class]];
+	tm_queue_head[tm_class] = (tm_queue_head[tm_class] + 1) % TM_SCHED_MAX_DEPTH;
+	tm_queue_count[tm_class]--;
+	return desc;
+}
@@ -0,0 +1,72 @@
+/*
+	Author: agent
+
+	***********************************************************************
+*	FILE NAME:		tm_sched.h
+*
+*	PURPOSE:		Houses the includes and definitions for tm_sched.c
+*
+*	FILE REFERENCES:		FreeRTOS.h, task.h
+*
+*	EXTERNAL VARIABLES:
+*
+*	EXTERNAL REFERENCES:	Same a File References.
+*
+*	ABORNOMAL TERMINATION CONDITIONS, ERROR AND WARNING MESSAGES: None yet.
+*
+*	ASSUMPTIONS, CONSTRAINTS, CONDITIONS:	None
+*
+*	NOTES:
+*
+*	REQUIREMENTS/ FUNCTIONAL SPECIFICATION REFERENCES:
+*
+*	DEVELOPMENT HISTORY:
+*	10/16/2026		Created
+*
+*					Added TM_CLASS_STORED and tm_sched_overflow().
+*
+*/
+
+#ifndef TM_SCHED_H
+#define TM_SCHED_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* TM classes, in priority order */
+#define TM_CLASS_VERIFY			0			// TC verification (service 1).
+#define TM_CLASS_EVENT			1			// Event reports (service 5).
+#define TM_CLASS_HK				2			// Housekeeping, diagnostics, time reports and anything else.
+#define TM_CLASS_DUMP			3			// Memory dumps and checks (service 6).
+#define TM_CLASS_SCIENCE		4			// DOWNLINKING_SCIENCE (service 6).
+#define TM_CLASS_STORED			5			// Read back from the TM store in SPI memory (pus_store.c).
+#define TM_CLASSES				6
+
+#define TM_SCHED_MAX_DEPTH		4			// Largest queue depth in tm_class_config[].
+
+/* What happens to a packet which arrives when its queue is full */
+#define TM_POLICY_REFUSE		0			// Not queued, the caller keeps it and tries again.
+#define TM_POLICY_DROP_NEWEST	1			// The new packet is released.
+#define TM_POLICY_DROP_OLDEST	2			// The oldest packet in the queue is released to make room.
+
+/* Results of tm_sched_put() */
+#define TM_SCHED_QUEUED			1
+#define TM_SCHED_DROPPED		0			// A packet was released, the new one or the oldest one.
+#define TM_SCHED_FULL			-1			// TM_POLICY_REFUSE, the caller still holds the descriptor.
+
+/* Statistics (tm_sched_stat()) */
+#define TM_STAT_DEPTH			0			// Packets waiting.
+#define TM_STAT_AGE				1			// Ticks the oldest waiting packet has been queued for.
+#define TM_STAT_DROPS			2			// Packets released by the drop policy since boot.
+
+/*		Function Prototypes				*/
+void tm_sched_init(void);
+uint8_t tm_sched_class(const uint8_t* packet);											// API
+int tm_sched_room(uint8_t tm_class);													// API
+int tm_sched_overflow(uint8_t tm_class);												// API
+int tm_sched_put(uint8_t tm_class, uint8_t desc);										// API
+BaseType_t tm_sched_get(uint8_t* desc);													// API
+UBaseType_t tm_sched_count(void);														// API
+uint32_t tm_sched_stat(uint8_t tm_class, uint8_t stat);									// API
+
+#endif